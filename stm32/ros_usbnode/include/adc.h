@@ -23,6 +23,10 @@ extern "C" {
 /******************************************************************************
 * Preprocessor Constants
 *******************************************************************************/
+/* ADC2 sequences summed in the adc_u16x values, 16 x 4095 still fits in 16 bits */
+#define ADC_OVERSAMPLING 16
+/* adc_u16x value at 3.3V */
+#define ADC_FULL_SCALE (4095.0f * ADC_OVERSAMPLING)
 
 /******************************************************************************
 * Constants
@@ -47,6 +51,23 @@ union FtoU{
 
 extern RTC_HandleTypeDef hrtc;
 
+/* sums of ADC_OVERSAMPLING samples, every 250us for the charge current and
+   voltage (taken in the middle of the charge PWM pulse), every 750us for the others */
+extern volatile uint16_t adc_u16BatteryVoltage;
+extern volatile uint16_t adc_u16Current;
+extern volatile uint16_t adc_u16ChargerVoltage;
+extern volatile uint16_t adc_u16ChargerInputVoltage;
+extern volatile uint16_t adc_u16Input_NTC;
+
+/* ADC_input() results, integer */
+extern uint16_t adc_u16BatteryMilliVolt;
+extern uint16_t adc_u16ChargeMilliVolt;
+extern int16_t adc_s16CurrentMilliAmp;
+extern int16_t adc_s16CurrentWithoutOffsetMilliAmp;
+extern int16_t adc_s16BladeTemperature;     /* 0.1°C */
+extern uint16_t adc_u16ChargerInputMilliVolt;
+
+/* same values as float, for the ROS messages and the charger */
 extern float battery_voltage;
 extern float charge_voltage;
 extern float current;
@@ -54,7 +75,6 @@ extern float current_without_offset;
 extern float blade_temperature;
 extern float chargerInputVoltage;
 
-extern union FtoU ampere_acc;
 extern union FtoU charge_current_offset;
 
 /******************************************************************************
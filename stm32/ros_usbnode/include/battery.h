@@ -19,10 +19,16 @@ extern "C" {
 /******************************************************************************
 * Includes
 *******************************************************************************/
+#include <stdint.h>
+#include "charger.h"
 
 /******************************************************************************
 * Preprocessor Constants
 *******************************************************************************/
+/* BATTERY_Update() period (ms), called with the charger */
+#define BATTERY_PERIOD CHARGER_PERIOD
+/* estimator step (ms), the coulomb count is accumulated in between */
+#define BATTERY_ESTIMATE_PERIOD 1000
 
 /******************************************************************************
 * Constants
@@ -44,6 +50,11 @@ extern "C" {
 * PUBLIC Function Prototypes
 *******************************************************************************/
 
+void BATTERY_Init(void);
+void BATTERY_Update(void);
+void BATTERY_SetFull(void);
+float BATTERY_fSoc(void);
+float BATTERY_fCurrent(void);
 
 
 
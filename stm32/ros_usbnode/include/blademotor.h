@@ -20,10 +20,32 @@ extern "C" {
 * Includes
 *******************************************************************************/
 #include <stdbool.h>
+#include "board.h"
+#include "frame.h"
 
 /******************************************************************************
 * Preprocessor Constants
 *******************************************************************************/
+/* replies kept for blademotor/status, power of 2 : 32 x 20ms at 50Hz */
+#define BLADEMOTOR_SAMPLES 32
+
+/* BLADEMOTOR_u8Flags() bits */
+#define BLADEMOTOR_FLAG_ACTIVATED 0x01     /* reply says the motor runs */
+#define BLADEMOTOR_FLAG_REQUESTED 0x02     /* on requested */
+#define BLADEMOTOR_FLAG_JAMMED 0x04        /* stopped by the jam detection, until an off request */
+#define BLADEMOTOR_FLAG_FAULT 0x08         /* last reply with a non zero error byte */
+
+#if OPTION_BLADEMOTOR_JAM == 1
+/* jammed : the speed falls below (100 - DROP)% of its average while the power
+   rises above (100 + RISE)% of its average, on JAM_SAMPLES replies in a row.
+   With 2 replies at 50Hz the stop request leaves 40ms after the first one */
+#define BLADEMOTOR_JAM_RPM_DROP_PCT 30
+#define BLADEMOTOR_JAM_POWER_RISE_PCT 50
+#define BLADEMOTOR_JAM_SAMPLES 2
+/* no detection below this average speed, or before the averages settled (replies) */
+#define BLADEMOTOR_JAM_MIN_RPM 1000
+#define BLADEMOTOR_JAM_SETTLE (BLADEMOTOR_POLL_HZ * 2)
+#endif
 
 /******************************************************************************
 * Constants
@@ -36,6 +58,15 @@ extern "C" {
 /******************************************************************************
 * Typedefs
 *******************************************************************************/
+/* one reply, little endian, 8 bytes */
+typedef struct
+{
+    uint16_t u16Rpm;
+    uint16_t u16Power;
+    int16_t s16Temperature;     /* 0.1 degC, from the ADC */
+    uint8_t u8Status;           /* reply error byte */
+    uint8_t u8Flags;            /* BLADEMOTOR_FLAG_x */
+} BLADEMOTOR_Sample_t;
 
 /******************************************************************************
 * Variables
@@ -45,15 +76,21 @@ extern bool BLADEMOTOR_bActivated;
 extern uint16_t BLADEMOTOR_u16RPM;
 extern uint16_t BLADEMOTOR_u16Power;
 extern uint32_t BLADEMOTOR_u32Error;
+extern uint32_t BLADEMOTOR_u32Jams;
 /******************************************************************************
 * PUBLIC Function Prototypes
 *******************************************************************************/
 
 void BLADEMOTOR_Init(void);
 void BLADEMOTOR_App(void);
-void BLADEMOTOR_ReceiveIT(void);
+uint8_t BLADEMOTOR_ReceiveIT(void);
+void BLADEMOTOR_TxCpltIT(void);
+void BLADEMOTOR_GetLinkStats(FRAME_Stats_t *psStats);
 
 void BLADEMOTOR_Set(uint8_t on_off, uint8_t direction);
+uint8_t BLADEMOTOR_u8Flags(void);
+uint8_t BLADEMOTOR_u8GetSamples(BLADEMOTOR_Sample_t *pasSamples, uint8_t u8Max);
+void BLADEMOTOR_ConsumeSamples(uint8_t u8Count);
 
 
 #ifdef __cplusplus
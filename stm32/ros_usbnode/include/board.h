@@ -70,14 +70,14 @@ extern "C"
 
 /// nominal max charge current is 1.0 Amp
 #define MAX_CHARGE_CURRENT 1.4f
-/// limite voltag when switching in 150mA mode
-#define LIMIT_VOLTAGE_150MA 29.05f
 /// Max voltage allowed 29.4
 #define MAX_CHARGE_VOLTAGE 29.2f
 /// Max battery voltage allowed
 #define BAT_CHARGE_CUTOFF_VOLTAGE 29.15f
 /// We consider the battery is full when in CV mode the current below 0.1A
 #define CHARGE_END_LIMIT_CURRENT 0.08f
+/// After the end of the charge, charge again below this battery voltage
+#define BAT_RECHARGE_VOLTAGE 28.0f
 // if voltage is greater than this assume we are docked
 #define MIN_DOCKED_VOLTAGE 20.0f
 // if voltage is lower this assume battery is disconnected
@@ -87,6 +87,9 @@ extern "C"
 #define MIN_CHARGE_CURRENT 0.1f
 #define LOW_BAT_THRESHOLD 25.2f /* near 20% SOC */
 #define LOW_CRI_THRESHOLD 21.0f /* near 0% SOC */
+// Battery pack for the SOC estimation
+#define BATTERY_CELLS 7
+#define BATTERY_CAPACITY_MAH 2800
 
 // Emergency sensor timeouts
 #define ONE_WHEEL_LIFT_EMERGENCY_MILLIS 10000
@@ -99,6 +102,36 @@ extern "C"
 // Enable Emergency debugging
 //#define EMERGENCY_DEBUG
 
+// Profile the main loop tasks (DWT cycle counter) and publish the statistics on /diagnostics
+// set to 0 to remove the profiler completely
+#define OPTION_PROFILER 1
+
+// Wheel odometry integrated on every drive motor reply, published on /odom every ODOM_PUBLISH_TIME_MS
+#define OPTION_ODOMETRY 1
+#define ODOM_PUBLISH_TIME_MS 50
+// also broadcast the odom -> base_link transform on /tf
+#define OPTION_ODOMETRY_TF 0
+
+// Closed loop wheel speed, the PWM from PWM_PER_MPS is only the feed-forward
+#define OPTION_SPEED_CONTROL 1
+
+// Drive motor request rate (Hz), up to 200 at 115200 baud. A request waits for the reply to the previous one
+#define DRIVEMOTOR_POLL_HZ 50
+
+// Acceleration and jerk limited ramp between the cmd_vel setpoints, default limits in drivemotor.h
+#define OPTION_DRIVEMOTOR_RAMP 1
+// Publish every drive motor reply on drivemotor/capture (DRIVEMOTOR_Capture_t records) for offline replay
+#define OPTION_DRIVEMOTOR_CAPTURE 0
+
+// RAM flight recorder, one record per drive motor reply, freezes on an emergency or a drive motor error
+// dumped on recorder/dump with the mowgli/recorder service
+#define OPTION_RECORDER 1
+
+// Blade motor request rate (Hz), every reply goes to the blade sample ring and the jam detection
+#define BLADEMOTOR_POLL_HZ 50
+// Stop the blade when its speed drops while its power rises, thresholds in blademotor.h
+#define OPTION_BLADEMOTOR_JAM 1
+
 // IMU configuration options
 #define EXTERNAL_IMU_ACCELERATION  1
 #define EXTERNAL_IMU_ANGULAR       1
@@ -23,6 +23,8 @@ extern "C" {
 /******************************************************************************
 * Preprocessor Constants
 *******************************************************************************/
+/* ChargeController() period (ms), the PI gains depend on it */
+#define CHARGER_PERIOD 10
 
 /******************************************************************************
 * Constants
@@ -35,7 +37,14 @@ extern "C" {
 /******************************************************************************
 * Typedefs
 *******************************************************************************/
-
+/* chargecontrol_is_charging values */
+typedef enum{
+    CHARGER_STATE_IDLE,
+    CHARGER_STATE_CONNECTED,
+    CHARGER_STATE_CHARGING_CC,
+    CHARGER_STATE_CHARGING_CV,
+    CHARGER_STATE_END_CHARGING,
+} CHARGER_STATE_e;
 
 /******************************************************************************
 * Variables
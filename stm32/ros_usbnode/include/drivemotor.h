@@ -19,10 +19,42 @@ extern "C" {
 /******************************************************************************
 * Includes
 *******************************************************************************/
+#include "board.h"
+#include "encoder.h"
+#include "frame.h"
 
 /******************************************************************************
 * Preprocessor Constants
 *******************************************************************************/
+/* request to reply time histogram, 500us bins, the last one counts everything above */
+#define DRIVEMOTOR_RTT_BINS 16
+#define DRIVEMOTOR_RTT_BIN_US 500
+/* command latency histogram (USB receive to UART request sent), 1ms bins */
+#define DRIVEMOTOR_CMD_BINS 16
+#define DRIVEMOTOR_CMD_BIN_US 1000
+
+#define DRIVEMOTOR_LEFT 0
+#define DRIVEMOTOR_RIGHT 1
+
+/* reply length, CRC included */
+#define DRIVEMOTOR_LENGTH_RECEIVED_MSG 20
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+/* replies per drivemotor/capture message */
+#define DRIVEMOTOR_CAPTURE_RECORDS 8
+#endif
+
+#if OPTION_SPEED_CONTROL == 1
+/* default speed loop gains, PWM per m/s of error, per m and per m/s^2 */
+#define DRIVEMOTOR_KP 150.0f
+#define DRIVEMOTOR_KI 300.0f
+#define DRIVEMOTOR_KD 0.0f
+#endif
+
+#if OPTION_DRIVEMOTOR_RAMP == 1
+/* default wheel speed ramp limits, m/s^2 and m/s^3 */
+#define DRIVEMOTOR_ACC_MAX 0.6f
+#define DRIVEMOTOR_JERK_MAX 3.0f
+#endif
 
 /******************************************************************************
 * Constants
@@ -35,6 +67,28 @@ extern "C" {
 /******************************************************************************
 * Typedefs
 *******************************************************************************/
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+/* capture record, little endian, a message carries DRIVEMOTOR_CAPTURE_RECORDS of them
+   and the number of blocks lost before it in layout.data_offset */
+typedef struct
+{
+    uint32_t u32Cycles;                                 /* DWT time of the reply, SystemCoreClock, wraps */
+    uint8_t au8Frame[DRIVEMOTOR_LENGTH_RECEIVED_MSG];   /* reply as received, 0x55 0xAA ... CRC */
+} __attribute__((__packed__)) DRIVEMOTOR_Capture_t;
+#endif
+
+#if OPTION_SPEED_CONTROL == 1
+typedef struct
+{
+    float fTarget;              /* m/s */
+    float fMeasured;            /* m/s, filtered */
+    uint8_t u8Pwm;              /* last command sent */
+    uint32_t u32Samples;        /* replies with a target speed */
+    float fRmsError;            /* m/s */
+    float fMaxError;            /* m/s */
+    uint32_t u32Saturated;      /* replies with the output at its limit */
+} DRIVEMOTOR_Tracking_t;
+#endif
 
 /******************************************************************************
 * Variables
@@ -49,6 +103,18 @@ extern uint16_t  left_encoder_val;     // non accumulating
 extern uint8_t   right_power;
 extern uint8_t   left_power;
 extern uint32_t  DRIVEMOTOR_u32ErrorCnt;
+extern uint32_t  DRIVEMOTOR_u32RxDropped;   // valid replies lost, queue full
+extern uint32_t  DRIVEMOTOR_u32RxTimeout;   // requests without reply
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+extern uint32_t  DRIVEMOTOR_u32CaptureLost; // drivemotor/capture blocks given up, link busy
+#endif
+extern uint32_t  DRIVEMOTOR_au32RttHisto[DRIVEMOTOR_RTT_BINS];
+extern uint32_t  DRIVEMOTOR_u32RttMinUs;
+extern uint32_t  DRIVEMOTOR_u32RttMaxUs;
+extern uint32_t  DRIVEMOTOR_u32CmdCount;
+extern uint32_t  DRIVEMOTOR_au32CmdHisto[DRIVEMOTOR_CMD_BINS];
+extern uint32_t  DRIVEMOTOR_u32CmdMinUs;
+extern uint32_t  DRIVEMOTOR_u32CmdMaxUs;
 
 
 /******************************************************************************
@@ -56,10 +122,23 @@ extern uint32_t  DRIVEMOTOR_u32ErrorCnt;
 *******************************************************************************/
 
 void DRIVEMOTOR_Init(void);
-void DRIVEMOTOR_App_10ms(void);
+void DRIVEMOTOR_App_Poll(void);
 void DRIVEMOTOR_App_Rx(void);
-void DRIVEMOTOR_ReceiveIT(void);
+uint8_t DRIVEMOTOR_ReceiveIT(void);
+void DRIVEMOTOR_GetLinkStats(FRAME_Stats_t *psStats);
 void DRIVEMOTOR_SetSpeed(uint8_t left_speed, uint8_t right_speed, uint8_t left_dir, uint8_t right_dir);
+void DRIVEMOTOR_Stop(void);
+void DRIVEMOTOR_GetEncoder(uint8_t u8Wheel, ENCODER_Wheel_t *psEncoder);
+#if OPTION_DRIVEMOTOR_RAMP == 1
+void DRIVEMOTOR_SetLimits(float fAccMax, float fJerkMax);
+#endif
+void DRIVEMOTOR_SendNow(uint32_t u32RxCycles);
+void DRIVEMOTOR_TxCpltIT(void);
+#if OPTION_SPEED_CONTROL == 1
+void DRIVEMOTOR_SetGains(float fKp, float fKi, float fKd);
+void DRIVEMOTOR_GetTracking(uint8_t u8Wheel, DRIVEMOTOR_Tracking_t *psTracking);
+void DRIVEMOTOR_ResetTracking(void);
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,85 @@
+/****************************************************************************
+* Title                 :   encoder module
+* Filename              :   encoder.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file encoder.h
+*  \brief unwrapping of the 16 bit drive motor encoder counters
+*
+*/
+#ifndef __ENCODER_H
+#define __ENCODER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+/* fastest plausible tick rate, full PWM is ~0.85 m/s or ~255 ticks/s */
+#define ENCODER_MAX_TICKS_PER_S 400U
+/* ticks always accepted, whatever the time since the last count */
+#define ENCODER_MARGIN_TICKS 4U
+/* longest time the counter can hold its ticks before releasing them (us) */
+#define ENCODER_MAX_HOLD_US 1000000U
+/* replies after a start or a reversal during which the counter reset is expected */
+#define ENCODER_RESTART_REPLIES 3U
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef enum
+{
+    ENCODER_STOPPED,        /* direction 0, the counter is ignored */
+    ENCODER_RESTART,        /* started or reversed, a counter lower than before is a reset */
+    ENCODER_RUNNING         /* a counter lower than before is a 16 bit wrap if plausible */
+} ENCODER_State_e;
+
+typedef struct
+{
+    ENCODER_State_e eState;
+    int8_t s8Direction;         /* direction of the last reply */
+    uint16_t u16Prev;           /* last raw counter */
+    uint8_t u8Restart;          /* replies left in ENCODER_RESTART */
+    uint32_t u32SinceUs;        /* time since the counter last changed */
+    uint32_t u32Ticks;          /* accumulated, unsigned */
+    uint32_t u32Wraps;          /* 16 bit wrap arounds */
+    uint32_t u32Resets;         /* counter resets */
+    uint32_t u32Held;           /* replies without a count while running (slow or held) */
+    uint32_t u32Implausible;    /* deltas above what the wheel can do, dropped */
+} ENCODER_Wheel_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void ENCODER_Init(ENCODER_Wheel_t *psWheel);
+uint16_t ENCODER_u16Update(ENCODER_Wheel_t *psWheel, int8_t s8Direction, uint16_t u16Raw, uint32_t u32DtUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__ENCODER_H*/
+
+/*** End of File **************************************************************/
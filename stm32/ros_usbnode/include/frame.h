@@ -0,0 +1,110 @@
+/****************************************************************************
+* Title                 :   frame module
+* Filename              :   frame.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file frame.h
+*  \brief 0x55 0xAA framing shared by the peripheral UARTs
+*
+*/
+#ifndef __FRAME_H
+#define __FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+/* longest received frame, CRC included */
+#define FRAME_MAX_LENGTH 32
+/* frames waiting for the TX DMA, power of 2 */
+#define FRAME_TX_QUEUE 4
+/* header (0x55 0xAA length) and CRC bytes around the length byte count */
+#define FRAME_OVERHEAD 4
+/* number of FRAME_Stats_t values, in the order of the struct */
+#define FRAME_STATS_VALUES 6
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+/* called from the UART interrupt with a frame whose CRC is valid. The frame
+   points into the DMA buffer, it is only valid until the callback returns */
+typedef void (*FRAME_Callback_t)(const uint8_t *pcu8Frame, uint8_t u8Length);
+
+/* frame descriptor : the first bytes to match (0x55 0xAA at least) and the
+   full length, CRC included. The length byte must be u8Length - FRAME_OVERHEAD */
+typedef struct
+{
+    const uint8_t *pcu8Preamble;
+    uint8_t u8PreambleLength;
+    uint8_t u8Length;
+    FRAME_Callback_t pfCallback;
+} FRAME_Desc_t;
+
+/* same counters for every port */
+typedef struct
+{
+    uint32_t u32Valid;          /* frames given to a callback */
+    uint32_t u32CrcError;       /* complete frames with a bad CRC */
+    uint32_t u32Resync;         /* bytes dropped to find the next frame */
+    uint32_t u32UartError;      /* receptions restarted after a UART error (overrun ...) */
+    uint32_t u32TxDone;         /* frames sent */
+    uint32_t u32TxDropped;      /* frames not sent, TX queue full or HAL error */
+} FRAME_Stats_t;
+
+typedef struct
+{
+    UART_HandleTypeDef *psUart;
+    const FRAME_Desc_t *pcsDesc;
+    uint8_t u8DescCount;
+    uint8_t *pu8Dma;                    /* circular DMA buffer */
+    uint16_t u16DmaSize;
+    uint16_t u16Start;                  /* first byte of the current frame in the DMA buffer */
+    uint8_t u8Len;                      /* bytes of the current frame already checked */
+    uint8_t au8Linear[FRAME_MAX_LENGTH];/* only for the frames wrapping around the buffer end */
+    const uint8_t *apcu8Tx[FRAME_TX_QUEUE];
+    uint8_t au8TxLength[FRAME_TX_QUEUE];
+    volatile uint8_t u8TxHead;
+    volatile uint8_t u8TxTail;
+    volatile uint8_t bTxBusy;
+    FRAME_Stats_t sStats;
+} FRAME_Port_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void FRAME_Init(FRAME_Port_t *psPort, UART_HandleTypeDef *psUart, uint8_t *pu8Dma, uint16_t u16DmaSize, const FRAME_Desc_t *pcsDesc, uint8_t u8DescCount);
+uint8_t FRAME_u8ReceiveIT(FRAME_Port_t *psPort);
+uint8_t FRAME_bSend(FRAME_Port_t *psPort, const uint8_t *pcu8Data, uint8_t u8Length);
+void FRAME_TxCpltIT(FRAME_Port_t *psPort);
+void FRAME_GetStats(const FRAME_Port_t *psPort, FRAME_Stats_t *psStats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /*__FRAME_H*/
+
+/*** End of File **************************************************************/
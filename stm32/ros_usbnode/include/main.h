@@ -85,6 +85,8 @@ void setBladeMotor(uint8_t on_off);
 uint8_t crcCalc(uint8_t *msg, uint8_t msg_len);
 void msgPrint(uint8_t *msg, uint8_t msg_len);
 void chirp(uint8_t count);
+/* also called on the USART IDLE line, declared here for HAL versions without the ToIdle API */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
 
 
 extern uint16_t  chargecontrol_pwm_val;
@@ -0,0 +1,81 @@
+/****************************************************************************
+* Title                 :   odometry module
+* Filename              :   odometry.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file odometry.h
+*  \brief wheel odometry integration
+*
+*/
+#ifndef __ODOMETRY_H
+#define __ODOMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include "board.h"
+
+#if OPTION_ODOMETRY == 1
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+/* position variance added per meter travelled (m^2/m) */
+#define ODOMETRY_VAR_XY_PER_M 0.0004f
+/* heading variance added per radian turned and per meter travelled (rad^2) */
+#define ODOMETRY_VAR_YAW_PER_RAD 0.0025f
+#define ODOMETRY_VAR_YAW_PER_M 0.001f
+/* speed variances, one tick per reply is already ~0.17 m/s */
+#define ODOMETRY_VAR_V 0.01f
+#define ODOMETRY_VAR_W 0.05f
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef struct
+{
+    float fX;               /* m */
+    float fY;               /* m */
+    float fTheta;           /* rad, -pi..pi */
+    float fV;               /* m/s */
+    float fW;               /* rad/s */
+    float fVarXY;           /* m^2 */
+    float fVarTheta;        /* rad^2 */
+    uint32_t u32Stamp;      /* tick of the last integrated reply */
+} ODOMETRY_Pose_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void ODOMETRY_Init(void);
+void ODOMETRY_Update(int8_t s8LeftDirection, int8_t s8RightDirection, uint32_t u32LeftTicks, uint32_t u32RightTicks);
+void ODOMETRY_GetPose(ODOMETRY_Pose_t *psPose);
+
+#endif /* OPTION_ODOMETRY */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__ODOMETRY_H*/
+
+/*** End of File **************************************************************/
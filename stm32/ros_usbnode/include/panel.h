@@ -3,6 +3,7 @@
 
 #include "board.h"
 #include "stm32f1xx_hal.h"
+#include "frame.h"
 
 
 #ifdef __cplusplus
@@ -134,7 +135,8 @@ void PANEL_Tick(void);
 void PANEL_Set_LED(uint8_t led, PANEL_LED_STATE state);
 int PANEL_Get_Key_Pressed(void);
 
-void PANEL_ReceiceIT(void);
+uint8_t PANEL_ReceiveIT(void);
+void PANEL_GetLinkStats(FRAME_Stats_t *psStats);
 
 void PANEL_Send_Message(uint8_t *data, uint8_t dataLength, uint16_t command);
 
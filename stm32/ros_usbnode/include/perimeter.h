@@ -54,7 +54,7 @@ extern ADC_HandleTypeDef ADC_Handle;
 * PUBLIC Function Prototypes
 *******************************************************************************/
 void Perimeter_vApp(void);
-void PERIMETER_vITHandle(void);
+void PERIMETER_vITHandle(uint8_t u8Buffer);
 void Perimeter_vInit(void);
 /**
  * @brief Which signal should we listen on?
@@ -0,0 +1,73 @@
+/****************************************************************************
+* Title                 :   profiler module
+* Filename              :   profiler.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file profiler.h
+*  \brief run time statistics of the main loop tasks
+*
+*/
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include "board.h"
+
+#if OPTION_PROFILER == 1
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+/* histogram bins, powers of 4 us : <4us, <16us, <64us, ... , >=16ms */
+#define PROFILER_HISTO_BINS 8
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef struct
+{
+    uint32_t u32Count;
+    uint32_t u32Min;                /* cpu cycles */
+    uint32_t u32Max;                /* cpu cycles */
+    uint64_t u64Sum;                /* cpu cycles */
+    uint32_t au32Histo[PROFILER_HISTO_BINS];
+} PROFILER_Stats_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void PROFILER_Reset(PROFILER_Stats_t *psStats);
+void PROFILER_Record(PROFILER_Stats_t *psStats, uint32_t u32Cycles);
+uint32_t PROFILER_u32CyclesToUs(uint32_t u32Cycles);
+uint32_t PROFILER_u32AvgCycles(const PROFILER_Stats_t *psStats);
+
+#endif /* OPTION_PROFILER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__PROFILER_H*/
+
+/*** End of File **************************************************************/
@@ -0,0 +1,62 @@
+/****************************************************************************
+* Title                 :   ramp module
+* Filename              :   ramp.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file ramp.h
+*  \brief acceleration and jerk limited speed ramp
+*
+*/
+#ifndef __RAMP_H
+#define __RAMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef struct
+{
+    float fVel;             /* output, m/s */
+    float fAcc;             /* m/s^2 */
+} RAMP_State_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void RAMP_Reset(RAMP_State_t *psRamp, float fVel);
+float RAMP_fUpdate(RAMP_State_t *psRamp, float fTarget, float fAccMax, float fJerkMax, float fDt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RAMP_H*/
+
+/*** End of File **************************************************************/
@@ -0,0 +1,106 @@
+/****************************************************************************
+* Title                 :   recorder module
+* Filename              :   recorder.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file recorder.h
+*  \brief RAM flight recorder of the motor and power telemetry
+*
+*/
+#ifndef __RECORDER_H
+#define __RECORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include "board.h"
+
+#if OPTION_RECORDER == 1
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+/* records kept, one per drive motor reply : 128 x 32 bytes, 2.5s at 50Hz */
+#define RECORDER_RECORDS 128
+/* records still taken after the trigger, to see what followed */
+#define RECORDER_POST_RECORDS 32
+
+/* trigger reasons, 0 while recording */
+#define RECORDER_TRIGGER_NONE 0
+#define RECORDER_TRIGGER_EMERGENCY 1
+#define RECORDER_TRIGGER_DRIVE_ERROR 2
+#define RECORDER_TRIGGER_REQUEST 3
+
+/* u8Flags bits */
+#define RECORDER_FLAG_BLADE_ON 0x01
+#define RECORDER_FLAG_TRIGGER 0x02
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+/* raw values only, no conversion while recording. Little endian, 32 bytes */
+typedef struct
+{
+    uint32_t u32Tick;               /* ms */
+    uint16_t u16LeftTicks;          /* raw 16 bit encoder counters */
+    uint16_t u16RightTicks;
+    uint16_t u16BladeRpm;
+    uint16_t u16BladePower;
+    uint16_t u16BatteryAdc;         /* raw ADC, sums of ADC_OVERSAMPLING samples */
+    uint16_t u16CurrentAdc;
+    uint16_t u16ChargerAdc;
+    uint16_t u16ChargerInputAdc;
+    uint16_t u16NtcAdc;
+    uint8_t u8Direction;            /* drive reply direction byte */
+    uint8_t u8LeftSpeed;            /* drive reply speeds */
+    uint8_t u8RightSpeed;
+    uint8_t u8Error;                /* drive reply error */
+    uint8_t u8LeftPower;
+    uint8_t u8RightPower;
+    uint8_t u8LeftPwm;              /* sent with the next request */
+    uint8_t u8RightPwm;
+    uint8_t u8Emergency;            /* Emergency_State() */
+    uint8_t u8Flags;                /* RECORDER_FLAG_x */
+} RECORDER_Record_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void RECORDER_Init(void);
+RECORDER_Record_t *RECORDER_psNext(void);
+void RECORDER_Commit(RECORDER_Record_t *psRecord);
+void RECORDER_Freeze(uint8_t u8Reason);
+void RECORDER_Arm(void);
+uint8_t RECORDER_u8Trigger(void);
+uint8_t RECORDER_bFrozen(void);
+uint16_t RECORDER_u16Count(void);
+const RECORDER_Record_t *RECORDER_psGet(uint16_t u16Idx);
+
+#endif /* OPTION_RECORDER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__RECORDER_H*/
+
+/*** End of File **************************************************************/
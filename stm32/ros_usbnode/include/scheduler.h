@@ -0,0 +1,86 @@
+/****************************************************************************
+* Title                 :   scheduler module
+* Filename              :   scheduler.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file scheduler.h
+*  \brief deadline ordered scheduler for the main loop
+*
+*/
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include "profiler.h"
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+#define SCHEDULER_MAX_TASKS 24
+
+/* sleep with WFI until the next interrupt when nothing is due */
+#define SCHEDULER_USE_WFI 1
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef void (*SCHEDULER_TaskFunc_t)(void);
+
+typedef struct SCHEDULER_Task_s
+{
+    const char *pcName;
+    SCHEDULER_TaskFunc_t pfFunc;
+    uint32_t u32Period;             /* ms, 0 for a task only run when posted */
+    uint32_t u32Deadline;           /* tick the task is due next */
+    volatile uint8_t u8Posted;      /* set by SCHEDULER_Post() */
+    struct SCHEDULER_Task_s *psNext;
+
+    /* statistics */
+    uint32_t u32Runs;
+    uint32_t u32Skipped;            /* periods dropped because the task was too late */
+    uint32_t u32MaxLateness;        /* ms */
+    uint32_t u32MaxRunTime;         /* cpu cycles */
+#if OPTION_PROFILER == 1
+    PROFILER_Stats_t sProfile;      /* run time distribution */
+#endif
+} SCHEDULER_Task_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void SCHEDULER_Init(void);
+void SCHEDULER_AddPeriodic(SCHEDULER_Task_t *psTask, const char *pcName, SCHEDULER_TaskFunc_t pfFunc, uint32_t u32Period, uint32_t u32Phase);
+void SCHEDULER_AddEvent(SCHEDULER_Task_t *psTask, const char *pcName, SCHEDULER_TaskFunc_t pfFunc);
+void SCHEDULER_Post(SCHEDULER_Task_t *psTask);
+void SCHEDULER_Run(void);
+SCHEDULER_Task_t *SCHEDULER_GetTask(uint8_t u8Idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__SCHEDULER_H*/
+
+/*** End of File **************************************************************/
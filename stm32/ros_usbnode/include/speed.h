@@ -0,0 +1,81 @@
+/****************************************************************************
+* Title                 :   speed module
+* Filename              :   speed.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file speed.h
+*  \brief closed loop speed of one drive wheel
+*
+*/
+#ifndef __SPEED_H
+#define __SPEED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+/* integral term limit in PWM, anti-windup */
+#define SPEED_I_LIMIT 80.0f
+/* first order filter on the tick speed, one tick per reply is ~0.17 m/s */
+#define SPEED_FILTER 0.5f
+
+/******************************************************************************
+* Constants
+*******************************************************************************/
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef struct
+{
+    float fKp;              /* PWM per m/s of error */
+    float fKi;              /* PWM per m */
+    float fKd;              /* PWM per m/s^2, on the measure */
+} SPEED_Gains_t;
+
+typedef struct
+{
+    float fTarget;          /* m/s */
+    float fMeasured;        /* m/s, filtered */
+    float fIntegral;        /* PWM */
+    uint8_t u8Pwm;          /* output */
+    uint8_t u8Dir;
+    uint32_t u32Samples;
+    float fSumSqError;
+    float fMaxError;
+    uint32_t u32Saturated;
+} SPEED_Wheel_t;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+
+/******************************************************************************
+* PUBLIC Function Prototypes
+*******************************************************************************/
+
+void SPEED_Setpoint(SPEED_Wheel_t *psWheel, uint8_t u8Speed, uint8_t u8Dir);
+void SPEED_Update(SPEED_Wheel_t *psWheel, const SPEED_Gains_t *pcsGains, uint8_t u8Speed, uint8_t u8Dir, uint32_t u32Ticks, int8_t s8Direction, uint32_t u32DtUs);
+void SPEED_ResetTracking(SPEED_Wheel_t *psWheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__SPEED_H*/
+
+/*** End of File **************************************************************/
@@ -2,6 +2,7 @@
 #define __ULTRASONICSENSOR_H
 
 #include <stdint.h>
+#include "frame.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -9,7 +10,9 @@ extern "C" {
 
 void ULTRASONICSENSOR_Init(void);
 void ULTRASONICSENSOR_App(void);
-void ULTRASONICSENSOR_ReceiveIT(void);
+uint8_t ULTRASONICSENSOR_ReceiveIT(void);
+void ULTRASONICSENSOR_TxCpltIT(void);
+void ULTRASONICSENSOR_GetLinkStats(FRAME_Stats_t *psStats);
 uint32_t ULTRASONIC_MessageReceived(void);
 
 uint32_t ULTRASONICSENSOR_u32GetLeftDistance(void);
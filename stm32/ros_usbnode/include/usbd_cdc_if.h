@@ -57,6 +57,11 @@
 #define CDC_RX_DATA_HANDLED 1
 #define CDC_RX_DATA_NOTHANDLED 0
 
+// TX aggregation: data that does not fill a full USB packet is held back for up to this
+// many USB frames (1ms each, counted on SOF) so that small writes share one packet
+// 0 sends everything as soon as the endpoint is idle
+#define CDC_TX_HOLD_FRAMES 1
+
 #ifndef USE_USB_FS
 // if you are using USB_HS uncomment the following define
 // it is here because ST forgot to define it for USB FS
@@ -152,8 +157,12 @@
 
 uint8_t CDC_Transmit(const void* Buf, uint32_t Len);
 uint8_t CDC_TransmitTimed(const void* Buf, uint32_t Len, uint32_t TimeoutMs);
+uint8_t* CDC_TransmitReserve(uint32_t MaxLen);
+void CDC_TransmitCommit(uint32_t Len);
+void CDC_TransmitDropped(void);
 
 void CDC_ResumeTransmit(void);
+void CDC_SOF(void);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
 uint8_t CDC_IsBusy();
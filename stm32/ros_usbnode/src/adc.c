@@ -17,19 +17,52 @@
 #include "perimeter.h"
 #include "adc.h"
 #include <math.h>
+#include <string.h>
 /******************************************************************************
  * Module Preprocessor Constants
  *******************************************************************************/
-const float f_RTO = 10000;
-const float beta = 3380;
+/* blade NTC, 10k at 25°C */
+#define ADC_NTC_R25 10000.0
+#define ADC_NTC_BETA 3380.0
+/* segments of the NTC table over the ADC range */
+#define ADC_NTC_STEPS 64
+
+/* mV or mA at ADC_FULL_SCALE (3.3V on the pin) */
+#define ADC_FULL_BATTERY (3300.0 * 10.09)
+#define ADC_FULL_CHARGE (3300.0 * 16)
+#define ADC_FULL_CURRENT (3300.0 * 100 / 12)
+/* ACS712 output at 0A : 2.5V */
+#define ADC_CURRENT_ZERO ((int32_t)(2500.0 * 100 / 12 + 0.5))
+
+/* regular channels, converted one per TIM2 trigger (discontinuous mode) */
+#define ADC2_REGULAR_CHANNELS 3
 
 /******************************************************************************
  * Module Preprocessor Macros
  *******************************************************************************/
+/* IIR coefficient of the new value, Q8 */
+#define ADC_ALPHA(a) ((uint32_t)((a) * 256 + 0.5))
+/* Q12 gain : a filtered value (raw sum Q4) times the gain still fits in 32 bits */
+#define ADC_GAIN(full) ((uint32_t)((full) * 4096.0 / ADC_FULL_SCALE + 0.5))
+#define ADC_GAIN_BATTERY ADC_GAIN(ADC_FULL_BATTERY)
+#define ADC_GAIN_CHARGE ADC_GAIN(ADC_FULL_CHARGE)
+#define ADC_GAIN_CURRENT ADC_GAIN(ADC_FULL_CURRENT)
+/* filtered value to mV / mA */
+#define ADC_SCALE(filter, gain) (((filter) * (gain)) >> 16)
+
+/* NTC temperature in 0.1°C at the point i of the table, folded by the
+   compiler. The NTC resistance is 10 ohm per mV (the formula used before
+   the table), point 0 (0 ohm) is taken at half a step */
+#define ADC_NTC_R(i) (3300.0 * ((i) == 0 ? 0.5 : (i)) / ADC_NTC_STEPS * 10.0)
+#define ADC_NTC_T(i) ((int16_t)floor(10.0 / (log(ADC_NTC_R(i) / ADC_NTC_R25) / ADC_NTC_BETA + 1.0 / 298.15) - 2731.5 + 0.5))
+#define ADC_NTC_T4(i) ADC_NTC_T(i), ADC_NTC_T((i) + 1), ADC_NTC_T((i) + 2), ADC_NTC_T((i) + 3)
+#define ADC_NTC_T16(i) ADC_NTC_T4(i), ADC_NTC_T4((i) + 4), ADC_NTC_T4((i) + 8), ADC_NTC_T4((i) + 12)
 
 /******************************************************************************
  * Module Typedefs
  *******************************************************************************/
+/* charge current and voltage are injected channels triggered by the charge
+   PWM, the others are regular ones triggered by TIM2 */
 typedef enum
 {
     ADC2_CHANNEL_CURRENT = 0,
@@ -47,7 +80,17 @@ TIM_HandleTypeDef TIM2_Handle; // Time Base for ADC
 ADC_HandleTypeDef ADC2_Handle;
 RTC_HandleTypeDef hrtc = {0};
 
-ADC2_channelSelection_e adc2_eChannelSelection = ADC2_CHANNEL_CURRENT;
+/* regular channels in the order of the sequence, one converted per TIM2 trigger */
+static const ADC2_channelSelection_e adc2_ceRegular[ADC2_REGULAR_CHANNELS] = {
+    ADC2_CHANNEL_NTC,
+    ADC2_CHANNEL_BATTERYVOLTAGE,
+    ADC2_CHANNEL_CHARGERINPUTVOLTAGE,
+};
+/* sums of the current oversampling round, indexed by ADC2_channelSelection_e */
+static uint32_t adc2_au32Sum[ADC2_CHANNEL_MAX];
+static uint8_t adc2_u8Rank = 0;             /* next regular rank converted */
+static uint8_t adc2_u8RegularSamples = 0;   /* complete regular sequences */
+static uint8_t adc2_u8InjectedSamples = 0;
 
 volatile uint16_t adc_u16BatteryVoltage       = 0;
 volatile uint16_t adc_u16Current              = 0;
@@ -55,21 +98,38 @@ volatile uint16_t adc_u16ChargerVoltage       = 0;
 volatile uint16_t adc_u16ChargerInputVoltage  = 0;
 volatile uint16_t adc_u16Input_NTC            = 0;
 
+/* filters state, raw sums in Q4 */
+static uint32_t adc_u32FilterBattery = 0;
+static uint32_t adc_u32FilterCharge = 0;
+static uint32_t adc_u32FilterCurrent = 0;
+static uint32_t adc_u32FilterNtc = 0;
+static uint32_t adc_u32FilterChargerInput = 0;
+
+/* NTC temperature (0.1°C) every 1/ADC_NTC_STEPS of the ADC range */
+static const int16_t adc_cs16NtcTable[ADC_NTC_STEPS + 1] = {
+    ADC_NTC_T16(0), ADC_NTC_T16(16), ADC_NTC_T16(32), ADC_NTC_T16(48), ADC_NTC_T(ADC_NTC_STEPS)};
+
+uint16_t adc_u16BatteryMilliVolt;
+uint16_t adc_u16ChargeMilliVolt;
+int16_t adc_s16CurrentMilliAmp;
+int16_t adc_s16CurrentWithoutOffsetMilliAmp;
+int16_t adc_s16BladeTemperature;
+uint16_t adc_u16ChargerInputMilliVolt;
+
 float battery_voltage;
 float charge_voltage;
 float current;
 float current_without_offset;
-float ntc_voltage;
 float blade_temperature;
 float chargerInputVoltage;
 
-union FtoU ampere_acc;
 union FtoU charge_current_offset;
 
 /******************************************************************************
  * Function Prototypes
  *******************************************************************************/
-void adc2_SetChannel(ADC2_channelSelection_e channel);
+static void adc2_ConfigSequence(void);
+static uint32_t adc_u32Filter(uint32_t u32State, uint16_t u16Raw, uint32_t u32Alpha);
 
 /******************************************************************************
  *  Public Functions
@@ -78,7 +138,7 @@ void adc2_SetChannel(ADC2_channelSelection_e channel);
 /**
  * @brief TIM2 Initialization Function
  *
- * Used to start ADC every 250µs
+ * Used to convert the next ADC2 regular channel every 250µs
  *
  * @param None
  * @retval None
@@ -174,25 +234,32 @@ void ADC2_Init(void)
     /** Common config
      */
     ADC2_Handle.Instance = ADC2;
-    ADC2_Handle.Init.ScanConvMode = ADC_SCAN_DISABLE;
+    ADC2_Handle.Init.ScanConvMode = ADC_SCAN_ENABLE;
     ADC2_Handle.Init.ContinuousConvMode = DISABLE;
-    ADC2_Handle.Init.DiscontinuousConvMode = DISABLE;
+    ADC2_Handle.Init.DiscontinuousConvMode = ENABLE;
+    ADC2_Handle.Init.NbrOfDiscConversion = 1;
     ADC2_Handle.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T2_CC2;
     ADC2_Handle.Init.DataAlign = ADC_DATAALIGN_RIGHT;
-    ADC2_Handle.Init.NbrOfConversion = 1;
+    ADC2_Handle.Init.NbrOfConversion = ADC2_REGULAR_CHANNELS;
     if (HAL_ADC_Init(&ADC2_Handle) != HAL_OK)
     {
         Error_Handler();
     }
 
-    adc2_eChannelSelection = ADC2_CHANNEL_CURRENT;
-    adc2_SetChannel(adc2_eChannelSelection);
+    memset(adc2_au32Sum, 0, sizeof(adc2_au32Sum));
+    adc2_u8Rank = 0;
+    adc2_u8RegularSamples = 0;
+    adc2_u8InjectedSamples = 0;
+    adc2_ConfigSequence();
 
     HAL_NVIC_SetPriority(ADC1_2_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
 
     // calibrate  - important for accuracy !
     HAL_ADCEx_Calibration_Start(&ADC2_Handle);
+    /* injected conversions run on their own with the charge PWM (TIM1_Init()),
+       the regular end of conversion interrupt reads both */
+    HAL_ADCEx_InjectedStart(&ADC2_Handle);
     HAL_ADC_Start_IT(&ADC2_Handle);
     HAL_TIM_OC_Start(&TIM2_Handle, TIM_CHANNEL_2);
 
@@ -206,9 +273,6 @@ void ADC2_Init(void)
     /* USER CODE BEGIN RTC_MspInit 1 */
     HAL_PWR_EnableBkUpAccess();
 
-    ampere_acc.u[0] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR1);
-    ampere_acc.u[1] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR2);
-
     charge_current_offset.u[0] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR3);
     charge_current_offset.u[1] = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR4);
 }
@@ -217,169 +281,173 @@ void ADC2_Init(void)
  * @brief ADC Input Function
  *
  * get the raw data and transform to human readeable values (V,A,T)
+ * integer only : the raw sums are filtered, scaled to mV / mA and the NTC
+ * temperature interpolated in adc_cs16NtcTable, the floats are only
+ * converted at the end for the existing users
  *
  * @param None
  * @retval None
  */
-
 void ADC_input(void)
 {
-    float l_fTmp;
+    uint32_t l_u32Pos;
+    uint16_t l_u16Index;
+    int32_t l_s32Current;
 
-    /* battery volatge calculation */
-    l_fTmp = ((float)adc_u16BatteryVoltage / 4095.0f) * 3.3f * 10.09 + 0.6f;
-    battery_voltage = 0.2 * l_fTmp + 0.8 * battery_voltage;
+    /* battery volatge calculation, 0.6V drop of the protection diode */
+    adc_u32FilterBattery = adc_u32Filter(adc_u32FilterBattery, adc_u16BatteryVoltage, ADC_ALPHA(0.2));
+    adc_u16BatteryMilliVolt = ADC_SCALE(adc_u32FilterBattery, ADC_GAIN_BATTERY) + 600;
 
-     /*charger voltage calculation */
-    l_fTmp = ((float)adc_u16ChargerVoltage / 4095.0f) * 3.3f * 16;
-    charge_voltage = 0.8 * l_fTmp + 0.2 * charge_voltage;
+    /*charger voltage calculation, sampled synchronously with the PWM : no ripple to filter */
+    adc_u32FilterCharge = (uint32_t)adc_u16ChargerVoltage << 4;
+    adc_u16ChargeMilliVolt = ADC_SCALE(adc_u32FilterCharge, ADC_GAIN_CHARGE);
 
-    /*charge current calculation */
-    l_fTmp = (((float)adc_u16Current / 4095.0f) * 3.3f - 2.5f) * 100 / 12.0;
-    current_without_offset =   0.8 * l_fTmp + 0.2 * current_without_offset;          
+    /*charge current calculation, the ACS712 outputs 2.5V at 0A */
+    adc_u32FilterCurrent = (uint32_t)adc_u16Current << 4;
+    l_s32Current = (int32_t)ADC_SCALE(adc_u32FilterCurrent, ADC_GAIN_CURRENT) - ADC_CURRENT_ZERO;
+    adc_s16CurrentWithoutOffsetMilliAmp = l_s32Current;
 
     /*remove offset*/
-    current = current_without_offset - charge_current_offset.f;
+    adc_s16CurrentMilliAmp = l_s32Current - (int32_t)(charge_current_offset.f * 1000.0f);
 
-    /*blade motor temperature calculation */
-    l_fTmp = (adc_u16Input_NTC/4095.0f)*3.3f;
-    ntc_voltage = 0.5*l_fTmp + 0.5*ntc_voltage;
-
-    /*calculation for NTC temperature*/
-    l_fTmp = ntc_voltage * 10000;               //Resistance of RT
-    l_fTmp = log(l_fTmp / f_RTO);
-    l_fTmp = (1 / ((l_fTmp / beta) + (1 / (273.15+25)))); //Temperature from thermistor
-    blade_temperature = l_fTmp - 273.15;                 //Conversion to Celsius  
+    /*blade motor temperature, linear interpolation between the table points */
+    adc_u32FilterNtc = adc_u32Filter(adc_u32FilterNtc, adc_u16Input_NTC, ADC_ALPHA(0.5));
+    l_u32Pos = (adc_u32FilterNtc * (ADC_NTC_STEPS * 16)) / (uint32_t)ADC_FULL_SCALE; /* 1/256 of a step */
+    l_u16Index = l_u32Pos >> 8;
+    if (l_u16Index >= ADC_NTC_STEPS)
+    {
+        l_u16Index = ADC_NTC_STEPS - 1;
+        l_u32Pos = (ADC_NTC_STEPS << 8);
+    }
+    adc_s16BladeTemperature = adc_cs16NtcTable[l_u16Index] +
+                              (((int32_t)adc_cs16NtcTable[l_u16Index + 1] - adc_cs16NtcTable[l_u16Index]) * (int32_t)(l_u32Pos - (l_u16Index << 8))) / 256;
 
     /* Input voltage from the external supply*/
-    l_fTmp = (adc_u16ChargerInputVoltage / 4095.0f) * 3.3f * (32 / 2);
-    chargerInputVoltage = 0.5 * l_fTmp + 0.5 * chargerInputVoltage;
-
+    adc_u32FilterChargerInput = adc_u32Filter(adc_u32FilterChargerInput, adc_u16ChargerInputVoltage, ADC_ALPHA(0.5));
+    adc_u16ChargerInputMilliVolt = ADC_SCALE(adc_u32FilterChargerInput, ADC_GAIN_CHARGE);
+
+    battery_voltage = adc_u16BatteryMilliVolt * 0.001f;
+    charge_voltage = adc_u16ChargeMilliVolt * 0.001f;
+    current_without_offset = adc_s16CurrentWithoutOffsetMilliAmp * 0.001f;
+    current = adc_s16CurrentMilliAmp * 0.001f;
+    blade_temperature = adc_s16BladeTemperature * 0.1f;
+    chargerInputVoltage = adc_u16ChargerInputMilliVolt * 0.001f;
 }
 
+/*
+ * end of an ADC2 regular conversion, every 250us : the regular channel of
+ * this rank, and the last charge current and voltage converted at the middle
+ * of a PWM pulse. The sums are published every ADC_OVERSAMPLING samples
+ * (4ms for the injected channels, 12ms for the regular ones)
+ */
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
 #ifdef OPTION_PERIMETER
     if (hadc == &ADC_Handle)
     {
-        PERIMETER_vITHandle();
+        PERIMETER_vITHandle(1);
     }
 #endif
-
     if (hadc == &ADC2_Handle)
     {
-        uint16_t l_u16Rawdata = ADC2_Handle.Instance->DR;
-
-        switch (adc2_eChannelSelection)
+        adc2_au32Sum[adc2_ceRegular[adc2_u8Rank]] += ADC2->DR;
+        if (++adc2_u8Rank >= ADC2_REGULAR_CHANNELS)
         {
-        case ADC2_CHANNEL_CURRENT:
-            adc_u16Current = l_u16Rawdata;
-            break;
-
-        case ADC2_CHANNEL_CHARGEVOLTAGE:
-            adc_u16ChargerVoltage = l_u16Rawdata;
-            break;
-
-        case ADC2_CHANNEL_BATTERYVOLTAGE:
-            adc_u16BatteryVoltage = l_u16Rawdata;
-            break;
-
-        case ADC2_CHANNEL_CHARGERINPUTVOLTAGE:
-            adc_u16ChargerInputVoltage = l_u16Rawdata;
-            break;
-
-        case ADC2_CHANNEL_NTC:
-            adc_u16Input_NTC = l_u16Rawdata;
-
-            break;
-
-        case ADC2_CHANNEL_MAX:
-        default:
-            /* should not get here */
-            break;
+            adc2_u8Rank = 0;
+            if (++adc2_u8RegularSamples >= ADC_OVERSAMPLING)
+            {
+                adc_u16Input_NTC = adc2_au32Sum[ADC2_CHANNEL_NTC];
+                adc_u16BatteryVoltage = adc2_au32Sum[ADC2_CHANNEL_BATTERYVOLTAGE];
+                adc_u16ChargerInputVoltage = adc2_au32Sum[ADC2_CHANNEL_CHARGERINPUTVOLTAGE];
+                adc2_au32Sum[ADC2_CHANNEL_NTC] = 0;
+                adc2_au32Sum[ADC2_CHANNEL_BATTERYVOLTAGE] = 0;
+                adc2_au32Sum[ADC2_CHANNEL_CHARGERINPUTVOLTAGE] = 0;
+                adc2_u8RegularSamples = 0;
+            }
         }
 
-        adc2_eChannelSelection++;
-        if (adc2_eChannelSelection == ADC2_CHANNEL_MAX)
-            adc2_eChannelSelection = ADC2_CHANNEL_CURRENT;
-        adc2_SetChannel(adc2_eChannelSelection);
-
-        HAL_ADC_Start_IT(&ADC2_Handle);
+        adc2_au32Sum[ADC2_CHANNEL_CURRENT] += ADC2->JDR1;
+        adc2_au32Sum[ADC2_CHANNEL_CHARGEVOLTAGE] += ADC2->JDR2;
+        if (++adc2_u8InjectedSamples >= ADC_OVERSAMPLING)
+        {
+            adc_u16Current = adc2_au32Sum[ADC2_CHANNEL_CURRENT];
+            adc_u16ChargerVoltage = adc2_au32Sum[ADC2_CHANNEL_CHARGEVOLTAGE];
+            adc2_au32Sum[ADC2_CHANNEL_CURRENT] = 0;
+            adc2_au32Sum[ADC2_CHANNEL_CHARGEVOLTAGE] = 0;
+            adc2_u8InjectedSamples = 0;
+        }
     }
 }
 
-
+/*
+ * the perimeter DMA is circular over two captures : half transfer when the
+ * first one is complete, ConvCplt for the second one
+ */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+#ifdef OPTION_PERIMETER
+    if (hadc == &ADC_Handle)
+    {
+        PERIMETER_vITHandle(0);
+    }
+#endif
+}
 
 /******************************************************************************
  *  Private Functions
  *******************************************************************************/
 
-void adc2_SetChannel(ADC2_channelSelection_e channel)
+/* NTC, battery and charger input as regular channels converted one by one
+   with TIM2, charge current and voltage as injected channels triggered by
+   TIM1 (OC4REF on TRGO) in the middle of the charge PWM pulse. Short sampling
+   times so the regular conversion fits between two PWM periods (19.4us) */
+static void adc2_ConfigSequence(void)
 {
     ADC_ChannelConfTypeDef sConfig = {0};
-
-    switch (channel)
+    ADC_InjectionConfTypeDef sConfigInjected = {0};
+    const uint32_t l_pcu32Regular[ADC2_REGULAR_CHANNELS] = {
+        ADC_CHANNEL_13, // PC2 Blade NTC
+        ADC_CHANNEL_3,  // PA3 Battery
+        ADC_CHANNEL_7,  // PA7 Charger Input voltage
+    };
+    const uint32_t l_pcu32Injected[2] = {
+        ADC_CHANNEL_1, // PA1 Charge Current
+        ADC_CHANNEL_2, // PA2 Charge Voltage
+    };
+    uint8_t i;
+
+    sConfig.SamplingTime = ADC_SAMPLETIME_71CYCLES_5;
+    for (i = 0; i < ADC2_REGULAR_CHANNELS; i++)
     {
-    case ADC2_CHANNEL_CURRENT:
-        sConfig.Channel = ADC_CHANNEL_1; // PA1 Charge Current
-        sConfig.Rank = ADC_REGULAR_RANK_1;
-        sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
+        sConfig.Channel = l_pcu32Regular[i];
+        sConfig.Rank = ADC_REGULAR_RANK_1 + i;
         if (HAL_ADC_ConfigChannel(&ADC2_Handle, &sConfig) != HAL_OK)
         {
             Error_Handler();
         }
-        break;
-
-    case ADC2_CHANNEL_CHARGEVOLTAGE:
-        sConfig.Channel = ADC_CHANNEL_2; // PA2 Charge Voltage
-        sConfig.Rank = ADC_REGULAR_RANK_1;
-        sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
-        if (HAL_ADC_ConfigChannel(&ADC2_Handle, &sConfig) != HAL_OK)
-        {
-            Error_Handler();
-        }
-        break;
+    }
 
-    case ADC2_CHANNEL_BATTERYVOLTAGE:
-        sConfig.Channel = ADC_CHANNEL_3; // PA3 Battery
-        sConfig.Rank = ADC_REGULAR_RANK_1;
-        sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
-        if (HAL_ADC_ConfigChannel(&ADC2_Handle, &sConfig) != HAL_OK)
+    sConfigInjected.InjectedSamplingTime = ADC_SAMPLETIME_28CYCLES_5;
+    sConfigInjected.InjectedOffset = 0;
+    sConfigInjected.InjectedNbrOfConversion = 2;
+    sConfigInjected.InjectedDiscontinuousConvMode = DISABLE;
+    sConfigInjected.AutoInjectedConv = DISABLE;
+    sConfigInjected.ExternalTrigInjecConv = ADC_EXTERNALTRIGINJECCONV_T1_TRGO;
+    for (i = 0; i < 2; i++)
+    {
+        sConfigInjected.InjectedChannel = l_pcu32Injected[i];
+        sConfigInjected.InjectedRank = ADC_INJECTED_RANK_1 + i;
+        if (HAL_ADCEx_InjectedConfigChannel(&ADC2_Handle, &sConfigInjected) != HAL_OK)
         {
             Error_Handler();
         }
-        break;
+    }
+}
 
-    case ADC2_CHANNEL_CHARGERINPUTVOLTAGE:
-        sConfig.Channel = ADC_CHANNEL_7; // PA7 Charger Input voltage
-        sConfig.Rank = ADC_REGULAR_RANK_1;
-        sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
-        if (HAL_ADC_ConfigChannel(&ADC2_Handle, &sConfig) != HAL_OK)
-        {
-            Error_Handler();
-        }
-        break;
+/* first order IIR on the raw sum, state in Q4 so the small steps are kept */
+static uint32_t adc_u32Filter(uint32_t u32State, uint16_t u16Raw, uint32_t u32Alpha)
+{
+    int32_t l_s32Delta = ((int32_t)u16Raw << 4) - (int32_t)u32State;
 
-    case ADC2_CHANNEL_NTC:
-        sConfig.Channel = ADC_CHANNEL_13; // PC2
-        sConfig.Rank = ADC_REGULAR_RANK_1;
-        sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
-        if (HAL_ADC_ConfigChannel(&ADC2_Handle, &sConfig) != HAL_OK)
-        {
-            Error_Handler();
-        }
-        break;
-
-    case ADC2_CHANNEL_MAX:
-    default:
-        /* should not get here */
-        sConfig.Channel = ADC_CHANNEL_3; // PA3 Battery
-        sConfig.Rank = ADC_REGULAR_RANK_1;
-        sConfig.SamplingTime = ADC_SAMPLETIME_239CYCLES_5;
-        if (HAL_ADC_ConfigChannel(&ADC2_Handle, &sConfig) != HAL_OK)
-        {
-            Error_Handler();
-        }
-        break;
-    }
+    return u32State + (l_s32Delta * (int32_t)u32Alpha) / 256;
 }
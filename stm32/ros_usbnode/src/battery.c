@@ -9,16 +9,58 @@
 /** \file battery.c
 *  \brief battery module
 * Charge and SOC calculation
+*
+* The SOC is a one state Kalman filter : the coulomb count of the charge
+* current predicts it, the battery voltage compared to the open circuit
+* voltage table corrects it. The measurement noise depends on what the
+* voltage tells : the OCV after a rest, the OCV plus the IR drop while
+* charging, and only a rough hint under the mowing load which the charge
+* current sensor does not see. The SOC is kept in the backup registers when
+* it moved by BATTERY_BKP_STEP.
 */
 /******************************************************************************
 * Includes
 *******************************************************************************/
 
+#include <math.h>
+#include "main.h"
+#include "board.h"
+#include "adc.h"
+#include "blademotor.h"
 #include "battery.h" 
 
 /******************************************************************************
 * Module Preprocessor Constants
 *******************************************************************************/
+/* BATTERY_Update() calls per estimator step */
+#define BATTERY_STEPS (BATTERY_ESTIMATE_PERIOD / BATTERY_PERIOD)
+/* coulomb count unit : mA during BATTERY_PERIOD, full battery in this unit */
+#define BATTERY_CAPACITY_COUNT ((float)BATTERY_CAPACITY_MAH * 3600 * 1000 / BATTERY_PERIOD)
+
+/* pack and wiring resistance (ohm), IR drop of the charge current */
+#define BATTERY_RESISTANCE 0.25f
+/* at rest : no charge, blade stopped and battery voltage within BATTERY_REST_DELTA (mV)
+   for BATTERY_REST_TIME estimator steps */
+#define BATTERY_REST_DELTA 20
+#define BATTERY_REST_TIME 60
+
+/* measurement noise (V^2) : at rest, charging, under load */
+#define BATTERY_R_REST (0.05f * 0.05f)
+#define BATTERY_R_CHARGE (0.3f * 0.3f)
+#define BATTERY_R_LOAD (1.0f * 1.0f)
+/* process noise per step (SOC^2) : charging (current measured), on battery (not measured) */
+#define BATTERY_Q_CHARGE (1e-5f * 1e-5f)
+#define BATTERY_Q_LOAD (3e-4f * 3e-4f)
+/* SOC variance : unknown SOC taken from the voltage, SOC read from the backup registers */
+#define BATTERY_P_UNKNOWN (0.2f * 0.2f)
+#define BATTERY_P_BACKUP (0.05f * 0.05f)
+
+/* backup registers : SOC in 0.1%, written when it moved by BATTERY_BKP_STEP */
+#define BATTERY_BKP_MAGIC 0x50C0
+#define BATTERY_BKP_STEP 5
+
+/* open circuit voltage of one cell (mV) every 10% of SOC */
+#define BATTERY_OCV_POINTS 11
 
 /******************************************************************************
 * Module Preprocessor Macros
@@ -31,15 +73,209 @@
 /******************************************************************************
 * Module Variable Definitions
 *******************************************************************************/
+static const uint16_t battery_cu16Ocv[BATTERY_OCV_POINTS] = {
+    3000, 3450, 3600, 3660, 3710, 3760, 3830, 3910, 3990, 4080, 4170};
+
+static float battery_fSoc = 0;              /* 0 .. 1 */
+static float battery_fVariance = 0;
+static int32_t battery_s32Count = 0;        /* coulomb count of the current step */
+static uint16_t battery_u16Steps = 0;
+static uint16_t battery_u16RestRef = 0;     /* mV */
+static uint16_t battery_u16RestSteps = 0;
+static uint8_t battery_bValid = 0;          /* battery_fSoc known (backup or first voltage) */
+static uint16_t battery_u16Saved = 0;       /* SOC in the backup registers (0.1%) */
 
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
+static void battery_Estimate(void);
+static float battery_fOcv(float fSoc, float *pfSlope);
+static float battery_fSocFromOcv(float fVoltage);
+static void battery_Save(uint8_t bForce);
 
 /******************************************************************************
 *  Public Functions
 *******************************************************************************/
 
+/// @brief Restore the SOC from the backup registers, after ADC2_Init() (backup domain clock)
+void BATTERY_Init(void)
+{
+    battery_bValid = 0;
+    battery_s32Count = 0;
+    battery_u16Steps = 0;
+    battery_u16RestSteps = 0;
+    if (HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR2) == BATTERY_BKP_MAGIC)
+    {
+        battery_u16Saved = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR1);
+        if (battery_u16Saved <= 1000)
+        {
+            battery_fSoc = battery_u16Saved * 0.001f;
+            battery_fVariance = BATTERY_P_BACKUP;
+            battery_bValid = 1;
+        }
+    }
+}
+
+/// @brief Coulomb count, every BATTERY_PERIOD after ADC_input(), and estimator step every BATTERY_ESTIMATE_PERIOD
+void BATTERY_Update(void)
+{
+    battery_s32Count += adc_s16CurrentMilliAmp;
+    if (++battery_u16Steps >= BATTERY_STEPS)
+    {
+        battery_Estimate();
+        battery_s32Count = 0;
+        battery_u16Steps = 0;
+    }
+}
+
+/// @brief End of charge, the battery is full
+void BATTERY_SetFull(void)
+{
+    battery_fSoc = 1.0f;
+    battery_fVariance = 0;
+    battery_bValid = 1;
+    battery_Save(1);
+}
+
+/// @brief State of charge
+/// @retval 0 .. 1
+float BATTERY_fSoc(void)
+{
+    return battery_fSoc;
+}
+
+/// @brief Battery current, only measured while charging (the sensor is on the charge path)
+/// @retval A, NAN on battery
+float BATTERY_fCurrent(void)
+{
+    if (adc_s16CurrentMilliAmp > (int16_t)(MIN_CHARGE_CURRENT * 1000))
+    {
+        return adc_s16CurrentMilliAmp * 0.001f;
+    }
+    return NAN;
+}
+
 /******************************************************************************
 *  Private Functions
-*******************************************************************************/
\ No newline at end of file
+*******************************************************************************/
+
+/* one estimator step, float is fine once a second */
+static void battery_Estimate(void)
+{
+    float l_fVoltage = adc_u16BatteryMilliVolt * 0.001f;
+    float l_fCurrent = adc_s16CurrentMilliAmp * 0.001f;
+    uint8_t l_bCharging = adc_s16CurrentMilliAmp > (int16_t)(MIN_CHARGE_CURRENT * 1000);
+    float l_fNoise;
+    float l_fSlope;
+    float l_fGain;
+
+    if (l_fVoltage < MIN_BATTERY_VOLTAGE)
+    {
+        return;
+    }
+    if (!battery_bValid)
+    {
+        battery_fSoc = battery_fSocFromOcv(l_bCharging ? l_fVoltage - l_fCurrent * BATTERY_RESISTANCE : l_fVoltage);
+        battery_fVariance = BATTERY_P_UNKNOWN;
+        battery_bValid = 1;
+        battery_Save(1);
+        return;
+    }
+
+    /* rest detection */
+    if (l_bCharging || BLADEMOTOR_u16RPM != 0 ||
+        adc_u16BatteryMilliVolt > battery_u16RestRef + BATTERY_REST_DELTA ||
+        adc_u16BatteryMilliVolt + BATTERY_REST_DELTA < battery_u16RestRef)
+    {
+        battery_u16RestRef = adc_u16BatteryMilliVolt;
+        battery_u16RestSteps = 0;
+    }
+    else if (battery_u16RestSteps < BATTERY_REST_TIME)
+    {
+        battery_u16RestSteps++;
+    }
+
+    /* predict */
+    battery_fSoc += battery_s32Count / BATTERY_CAPACITY_COUNT;
+    battery_fVariance += l_bCharging ? BATTERY_Q_CHARGE : BATTERY_Q_LOAD;
+
+    /* correct */
+    if (l_bCharging)
+    {
+        l_fVoltage -= l_fCurrent * BATTERY_RESISTANCE;
+        l_fNoise = BATTERY_R_CHARGE;
+    }
+    else if (battery_u16RestSteps >= BATTERY_REST_TIME)
+    {
+        l_fNoise = BATTERY_R_REST;
+    }
+    else
+    {
+        l_fNoise = BATTERY_R_LOAD;
+    }
+    l_fGain = battery_fOcv(battery_fSoc, &l_fSlope);
+    l_fGain = (l_fVoltage - l_fGain) * battery_fVariance * l_fSlope / (l_fSlope * l_fSlope * battery_fVariance + l_fNoise);
+    battery_fVariance -= battery_fVariance * battery_fVariance * l_fSlope * l_fSlope / (l_fSlope * l_fSlope * battery_fVariance + l_fNoise);
+    battery_fSoc += l_fGain;
+
+    if (battery_fSoc > 1.0f)
+    {
+        battery_fSoc = 1.0f;
+    }
+    if (battery_fSoc < 0.0f)
+    {
+        battery_fSoc = 0.0f;
+    }
+
+    battery_Save(0);
+}
+
+/* pack open circuit voltage (V) and its slope (V per SOC) */
+static float battery_fOcv(float fSoc, float *pfSlope)
+{
+    float l_fPos = fSoc * (BATTERY_OCV_POINTS - 1);
+    uint8_t l_u8Index = (uint8_t)l_fPos;
+
+    if (l_u8Index >= BATTERY_OCV_POINTS - 1)
+    {
+        l_u8Index = BATTERY_OCV_POINTS - 2;
+    }
+    *pfSlope = (float)(battery_cu16Ocv[l_u8Index + 1] - battery_cu16Ocv[l_u8Index]) * BATTERY_CELLS * (BATTERY_OCV_POINTS - 1) * 0.001f;
+    return (battery_cu16Ocv[l_u8Index] * BATTERY_CELLS * 0.001f) + (l_fPos - l_u8Index) * *pfSlope / (BATTERY_OCV_POINTS - 1);
+}
+
+/* SOC whose OCV is fVoltage */
+static float battery_fSocFromOcv(float fVoltage)
+{
+    float l_fCell = fVoltage * 1000.0f / BATTERY_CELLS;
+    uint8_t i;
+
+    if (l_fCell <= battery_cu16Ocv[0])
+    {
+        return 0.0f;
+    }
+    for (i = 1; i < BATTERY_OCV_POINTS; i++)
+    {
+        if (l_fCell < battery_cu16Ocv[i])
+        {
+            return (i - 1 + (l_fCell - battery_cu16Ocv[i - 1]) / (battery_cu16Ocv[i] - battery_cu16Ocv[i - 1])) / (BATTERY_OCV_POINTS - 1);
+        }
+    }
+    return 1.0f;
+}
+
+/* keep the SOC in the backup registers, only when it moved enough */
+static void battery_Save(uint8_t bForce)
+{
+    uint16_t l_u16Soc = (uint16_t)(battery_fSoc * 1000.0f + 0.5f);
+
+    if (!bForce && l_u16Soc < battery_u16Saved + BATTERY_BKP_STEP && l_u16Soc + BATTERY_BKP_STEP > battery_u16Saved)
+    {
+        return;
+    }
+    battery_u16Saved = l_u16Soc;
+    HAL_PWR_EnableBkUpAccess();
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR1, l_u16Soc);
+    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR2, BATTERY_BKP_MAGIC);
+    HAL_PWR_DisableBkUpAccess();
+}
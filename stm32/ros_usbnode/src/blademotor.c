@@ -9,6 +9,9 @@
 /** \file blademotor.c
 *  \brief 
 *
+*  Every reply is decoded in the UART interrupt : it goes to a sample ring
+*  read by the blademotor/status publisher, and a fault or a jam sends the
+*  stop request from there without waiting for the next poll.
 */
 /******************************************************************************
 * Includes
@@ -21,14 +24,18 @@
 
 #include "main.h"
 #include "board.h"
+#include "adc.h"
 
 #include "blademotor.h" 
+#include "frame.h"
 
 /******************************************************************************
 * Module Preprocessor Constants
 *******************************************************************************/
 #define BLADEMOTOR_LENGTH_INIT_MSG 22
 #define BLADEMOTOR_LENGTH_RQST_MSG 7
+/* circular receive DMA buffer */
+#define BLADEMOTOR_RX_DMA_SIZE 32
 /******************************************************************************
 * Module Preprocessor Macros
 *******************************************************************************/
@@ -56,35 +63,49 @@ bool BLADEMOTOR_bActivated = false;
 uint16_t BLADEMOTOR_u16RPM = 0;
 uint16_t BLADEMOTOR_u16Power = 0;
 uint32_t BLADEMOTOR_u32Error = 0;
+uint32_t BLADEMOTOR_u32Jams = 0;
 
-static uint8_t blademotor_pu8ReceivedData[BLADEMOTOR_LENGTH_RECEIVED_MSG] = {0};
-static uint8_t blademotor_pu8RqstMessage[BLADEMOTOR_LENGTH_RQST_MSG]  = {0x55, 0xaa, 0x03, 0x20, 0x80, 0x00, 0xA2};
-static uint8_t blademotor_u8OnOff = 0;
+static uint8_t blademotor_au8RxDma[BLADEMOTOR_RX_DMA_SIZE];
+static FRAME_Port_t blademotor_sPort;
+static uint8_t blademotor_u8Status = 0; /* error byte of the last reply */
+/* FRAME_bSend() does not copy, so the requests are constant frames */
+static const uint8_t blademotor_pcu8RunMsg[BLADEMOTOR_LENGTH_RQST_MSG]  = {0x55, 0xaa, 0x03, 0x20, 0x80, 0x80, 0x22};
+static const uint8_t blademotor_pcu8StopMsg[BLADEMOTOR_LENGTH_RQST_MSG]  = {0x55, 0xaa, 0x03, 0x20, 0x80, 0x00, 0xA2};
+static volatile uint8_t blademotor_u8OnOff = 0;
+static volatile uint8_t blademotor_bJammed = 0;
+
+static BLADEMOTOR_Sample_t blademotor_asSamples[BLADEMOTOR_SAMPLES];
+static volatile uint8_t blademotor_u8SampleHead = 0;   /* written by the ISR */
+static uint8_t blademotor_u8SampleTail = 0;            /* written by BLADEMOTOR_u8GetSamples() */
+
+#if OPTION_BLADEMOTOR_JAM == 1
+/* averages x16, updated with the replies that do not look jammed */
+static uint32_t blademotor_u32AvgRpm = 0;
+static uint32_t blademotor_u32AvgPower = 0;
+static uint16_t blademotor_u16Running = 0;     /* replies since the motor runs */
+static uint8_t blademotor_u8JamCount = 0;
+#endif
 
 const uint8_t blademotor_pcu8Preamble[5]  = {0x55,0xAA,0x0A,0x2,0xD0};
 const uint8_t blademotor_pcu8InitMsg[BLADEMOTOR_LENGTH_INIT_MSG] =  { 0x55, 0xaa, 0x12, 0x20, 0x80, 0x00, 0xac, 0x0d, 0x00, 0x02, 0x32, 0x50, 0x1e, 0x04, 0x00, 0x15, 0x21, 0x05, 0x0a, 0x19, 0x3c, 0xaa };
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
+static void blademotor_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length);
+static void blademotor_stopNow(void);
+#if OPTION_BLADEMOTOR_JAM == 1
+static uint8_t blademotor_jamCheck(uint16_t u16Rpm, uint16_t u16Power);
+#endif
+
+/* only 0x55 0xAA is checked, the reply length depends on the board */
+static const FRAME_Desc_t blademotor_pcsFrames[] = {
+    {blademotor_pcu8Preamble, 2, BLADEMOTOR_LENGTH_RECEIVED_MSG, blademotor_rxFrame},
+};
 
 /******************************************************************************
 *  Public Functions
 *******************************************************************************/
 
-void blademotor_prepareMsg(void)
-{    
-    if (blademotor_u8OnOff)
-    {
-        blademotor_pu8RqstMessage[5] = 0x80; /* change speed Motor */
-        blademotor_pu8RqstMessage[6] = 0x22; /* change CRC */
-    }
-    else
-    {
-        blademotor_pu8RqstMessage[5] = 0x00; /* change speed Motor */
-        blademotor_pu8RqstMessage[6] = 0xa2; /* change CRC */
-    }
-}
-
 /**
  * @brief Init the Blade Motor Serial Port (PAC5223)
  * @retval None
@@ -139,7 +160,7 @@ void BLADEMOTOR_Init(void)
     hdma_uart3_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_uart3_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_uart3_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_uart3_rx.Init.Mode = DMA_NORMAL;
+    hdma_uart3_rx.Init.Mode = DMA_CIRCULAR;
     hdma_uart3_rx.Init.Priority = DMA_PRIORITY_LOW;
     if (HAL_DMA_Init(&hdma_uart3_rx) != HAL_OK)
     {
@@ -170,6 +191,9 @@ void BLADEMOTOR_Init(void)
 	HAL_NVIC_EnableIRQ(USART3_IRQn);     
     __HAL_UART_ENABLE_IT(&BLADEMOTOR_USART_Handler, UART_IT_TC);
 
+    /* receive continuously, the replies are framed by the 0x55 0xAA scanner */
+    FRAME_Init(&blademotor_sPort, &BLADEMOTOR_USART_Handler, blademotor_au8RxDma, BLADEMOTOR_RX_DMA_SIZE, blademotor_pcsFrames, sizeof(blademotor_pcsFrames) / sizeof(FRAME_Desc_t));
+
     blademotor_eState = BLADEMOTOR_INIT_1;    
 }
 
@@ -180,23 +204,21 @@ void  BLADEMOTOR_App(void){
     {
     case BLADEMOTOR_INIT_1:
 
-        HAL_UART_Transmit_DMA(&BLADEMOTOR_USART_Handler, (uint8_t*)blademotor_pcu8InitMsg, BLADEMOTOR_LENGTH_INIT_MSG);
+        FRAME_bSend(&blademotor_sPort, blademotor_pcu8InitMsg, BLADEMOTOR_LENGTH_INIT_MSG);
         blademotor_eState = BLADEMOTOR_RUN;
         debug_printf(" * Blade Motor Controller initialized\r\n");     
         break;
     
     case BLADEMOTOR_RUN:
 
-        /*error detected*/
-        if(blademotor_pu8ReceivedData[6] != 0){
-            blademotor_u8OnOff = 0;
-            BLADEMOTOR_u32Error++;
+        /* faults and jams are handled with the reply, see blademotor_rxFrame().
+           IRQs masked : a stop sent by the reply ISR must not be followed by a run request */
+        {
+            uint32_t primask = __get_PRIMASK();
+            __disable_irq();
+            FRAME_bSend(&blademotor_sPort, blademotor_u8OnOff ? blademotor_pcu8RunMsg : blademotor_pcu8StopMsg, BLADEMOTOR_LENGTH_RQST_MSG);
+            __set_PRIMASK(primask);
         }
-        blademotor_prepareMsg();
-        /* prepare to receive the message before to launch the command */        
-        HAL_UART_Receive_DMA(&BLADEMOTOR_USART_Handler, blademotor_pu8ReceivedData, BLADEMOTOR_LENGTH_RECEIVED_MSG);
-                  
-        HAL_UART_Transmit_DMA(&BLADEMOTOR_USART_Handler, (uint8_t*)blademotor_pu8RqstMessage, BLADEMOTOR_LENGTH_RQST_MSG);    
         break;
     
     default:
@@ -205,49 +227,194 @@ void  BLADEMOTOR_App(void){
 }
 
 /// @brief control blade motor (there is no speed control for this motor)
-/// @param on_off 1 to turn on, 0 to turn off
+/// @param on_off 1 to turn on, 0 to turn off. After a jam the blade stays off until an off request
 void BLADEMOTOR_Set(uint8_t on_off, uint8_t direction)
 {       
-    blademotor_u8OnOff = on_off;
-    if (on_off)
+    /* a jam detected by the reply ISR between the check and the set would be lost */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!on_off)
     {
-        /*if (direction) {
-            blademotor_pu8RqstMessage[5] = 0xC0;
-            blademotor_pu8RqstMessage[6] = 0xE2;
-        } else {*/
-            blademotor_pu8RqstMessage[5] = 0x80; /* change speed Motor */
-            blademotor_pu8RqstMessage[6] = 0x22; /* change CRC */
-        //}
+        blademotor_bJammed = 0;
     }
-    else
+    else if (blademotor_bJammed)
     {
-        blademotor_pu8RqstMessage[5] = 0x00; /* change speed Motor */
-        blademotor_pu8RqstMessage[6] = 0xa2; /* change CRC */
+        on_off = 0;
     }
+    blademotor_u8OnOff = on_off;
+    __set_PRIMASK(primask);
+    /* reverse (0xC0, CRC 0xE2) is not used, direction is ignored */
 }
 
-/// @brief drive motor receive interrupt handler
+/// @brief Current blade state
 /// @param  
-void BLADEMOTOR_ReceiveIT(void)
+/// @retval BLADEMOTOR_FLAG_x bits
+uint8_t BLADEMOTOR_u8Flags(void)
 {
-    /* decode the frame */    
-    if(memcmp(blademotor_pcu8Preamble, blademotor_pu8ReceivedData, 2) == 0){        
-        uint8_t l_u8crc = crcCalc(blademotor_pu8ReceivedData, BLADEMOTOR_LENGTH_RECEIVED_MSG-1);
-
-        if(blademotor_pu8ReceivedData[BLADEMOTOR_LENGTH_RECEIVED_MSG-1] == l_u8crc ){
-            if((blademotor_pu8ReceivedData[5] & 0x80) == 0x80){
-                BLADEMOTOR_bActivated = true;
-            }
-            else{
-                BLADEMOTOR_bActivated = false;
-            }
-            BLADEMOTOR_u16RPM = blademotor_pu8ReceivedData[7] + (blademotor_pu8ReceivedData[8]<<8);
-            BLADEMOTOR_u16Power = blademotor_pu8ReceivedData[9] + (blademotor_pu8ReceivedData[10]<<8) ;           
-        }
-  
+    uint8_t l_u8Flags = 0;
+
+    if (BLADEMOTOR_bActivated)
+    {
+        l_u8Flags |= BLADEMOTOR_FLAG_ACTIVATED;
     }
+    if (blademotor_u8OnOff)
+    {
+        l_u8Flags |= BLADEMOTOR_FLAG_REQUESTED;
+    }
+    if (blademotor_bJammed)
+    {
+        l_u8Flags |= BLADEMOTOR_FLAG_JAMMED;
+    }
+    if (blademotor_u8Status != 0)
+    {
+        l_u8Flags |= BLADEMOTOR_FLAG_FAULT;
+    }
+    return l_u8Flags;
+}
+
+/// @brief Copy the oldest replies not consumed yet, the oldest are lost if the ring overflowed
+/// @param pasSamples destination
+/// @param u8Max size of pasSamples
+/// @retval number of samples copied, they stay in the ring until BLADEMOTOR_ConsumeSamples()
+uint8_t BLADEMOTOR_u8GetSamples(BLADEMOTOR_Sample_t *pasSamples, uint8_t u8Max)
+{
+    uint8_t l_u8Head = blademotor_u8SampleHead;
+    uint8_t l_u8Tail;
+    uint8_t l_u8Count = 0;
+
+    __DMB();
+    if ((uint8_t)(l_u8Head - blademotor_u8SampleTail) > BLADEMOTOR_SAMPLES)
+    {
+        blademotor_u8SampleTail = l_u8Head - BLADEMOTOR_SAMPLES;
+    }
+    l_u8Tail = blademotor_u8SampleTail;
+    while (l_u8Tail != l_u8Head && l_u8Count < u8Max)
+    {
+        pasSamples[l_u8Count++] = blademotor_asSamples[l_u8Tail & (BLADEMOTOR_SAMPLES - 1)];
+        l_u8Tail++;
+    }
+    return l_u8Count;
+}
+
+/// @brief Free the samples returned by BLADEMOTOR_u8GetSamples() once they are sent
+/// @param u8Count number of samples sent
+void BLADEMOTOR_ConsumeSamples(uint8_t u8Count)
+{
+    blademotor_u8SampleTail += u8Count;
+}
+
+/// @brief blade motor receive interrupt handler, scans what the DMA received since the last call
+/// @param  
+/// @retval number of replies decoded
+uint8_t BLADEMOTOR_ReceiveIT(void)
+{
+    return FRAME_u8ReceiveIT(&blademotor_sPort);
+}
+
+/// @brief blade motor transmit complete interrupt handler
+/// @param  
+void BLADEMOTOR_TxCpltIT(void)
+{
+    FRAME_TxCpltIT(&blademotor_sPort);
+}
+
+/// @brief Get a copy of the blade motor UART counters
+/// @param psStats destination
+void BLADEMOTOR_GetLinkStats(FRAME_Stats_t *psStats)
+{
+    FRAME_GetStats(&blademotor_sPort, psStats);
 }
 
 /******************************************************************************
 *  Private Functions
-*******************************************************************************/
\ No newline at end of file
+*******************************************************************************/
+
+/* valid reply from the frame scanner (UART interrupt) */
+static void blademotor_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length)
+{
+    if((pcu8Frame[5] & 0x80) == 0x80){
+        BLADEMOTOR_bActivated = true;
+    }
+    else{
+        BLADEMOTOR_bActivated = false;
+    }
+    blademotor_u8Status = pcu8Frame[6];
+    BLADEMOTOR_u16RPM = pcu8Frame[7] + (pcu8Frame[8]<<8);
+    BLADEMOTOR_u16Power = pcu8Frame[9] + (pcu8Frame[10]<<8) ;           
+
+    /*error detected*/
+    if (blademotor_u8Status != 0)
+    {
+        BLADEMOTOR_u32Error++;
+        blademotor_stopNow();
+    }
+#if OPTION_BLADEMOTOR_JAM == 1
+    if (blademotor_jamCheck(BLADEMOTOR_u16RPM, BLADEMOTOR_u16Power))
+    {
+        BLADEMOTOR_u32Jams++;
+        blademotor_bJammed = 1;
+        blademotor_stopNow();
+    }
+#endif
+
+    BLADEMOTOR_Sample_t *l_psSample = &blademotor_asSamples[blademotor_u8SampleHead & (BLADEMOTOR_SAMPLES - 1)];
+    l_psSample->u16Rpm = BLADEMOTOR_u16RPM;
+    l_psSample->u16Power = BLADEMOTOR_u16Power;
+    l_psSample->s16Temperature = adc_s16BladeTemperature;
+    l_psSample->u8Status = blademotor_u8Status;
+    l_psSample->u8Flags = BLADEMOTOR_u8Flags();
+    __DMB();
+    blademotor_u8SampleHead++;
+}
+
+/* send the off request now, ahead of the next poll */
+static void blademotor_stopNow(void)
+{
+    if (blademotor_u8OnOff)
+    {
+        blademotor_u8OnOff = 0;
+        FRAME_bSend(&blademotor_sPort, blademotor_pcu8StopMsg, BLADEMOTOR_LENGTH_RQST_MSG);
+    }
+}
+
+#if OPTION_BLADEMOTOR_JAM == 1
+/* speed drop with a power rise against the running averages, 1 when jammed */
+static uint8_t blademotor_jamCheck(uint16_t u16Rpm, uint16_t u16Power)
+{
+    if (!BLADEMOTOR_bActivated || blademotor_bJammed)
+    {
+        blademotor_u16Running = 0;
+        blademotor_u8JamCount = 0;
+        return 0;
+    }
+    if (blademotor_u16Running == 0)
+    {
+        blademotor_u32AvgRpm = (uint32_t)u16Rpm << 4;
+        blademotor_u32AvgPower = (uint32_t)u16Power << 4;
+    }
+    if (blademotor_u16Running < BLADEMOTOR_JAM_SETTLE)
+    {
+        blademotor_u16Running++;
+    }
+
+    /* the averages are x16, the percentages x100 */
+    if (blademotor_u16Running >= BLADEMOTOR_JAM_SETTLE &&
+        blademotor_u32AvgRpm >= (BLADEMOTOR_JAM_MIN_RPM << 4) &&
+        (uint32_t)u16Rpm * 1600U < blademotor_u32AvgRpm * (100U - BLADEMOTOR_JAM_RPM_DROP_PCT) &&
+        (uint32_t)u16Power * 1600U > blademotor_u32AvgPower * (100U + BLADEMOTOR_JAM_POWER_RISE_PCT))
+    {
+        if (++blademotor_u8JamCount >= BLADEMOTOR_JAM_SAMPLES)
+        {
+            blademotor_u8JamCount = 0;
+            return 1;
+        }
+        return 0;
+    }
+
+    /* first order average, 1/8 per reply : ~160ms at 50Hz */
+    blademotor_u8JamCount = 0;
+    blademotor_u32AvgRpm += ((int32_t)((uint32_t)u16Rpm << 4) - (int32_t)blademotor_u32AvgRpm) / 8;
+    blademotor_u32AvgPower += ((int32_t)((uint32_t)u16Power << 4) - (int32_t)blademotor_u32AvgPower) / 8;
+    return 0;
+}
+#endif
\ No newline at end of file
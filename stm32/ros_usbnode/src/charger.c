@@ -17,25 +17,41 @@
 #include "board.h"
 #include "adc.h"
 #include "charger.h"
+#include "battery.h"
 /******************************************************************************
  * Module Preprocessor Constants
  *******************************************************************************/
+/* TIM1 counts per PWM period, and the highest duty allowed */
+#define CHARGER_PWM_PERIOD 1400
+#define CHARGER_PWM_MAX 1350
+/* the preloaded PWM is this much below the battery voltage (about 0.5V) */
+#define CHARGER_PRELOAD_MARGIN 20
+
+/* board.h limits in mV / mA */
+#define CHARGER_MAX_CURRENT ((int32_t)(MAX_CHARGE_CURRENT * 1000))
+#define CHARGER_MAX_VOLTAGE ((int32_t)(MAX_CHARGE_VOLTAGE * 1000))
+#define CHARGER_CUTOFF_VOLTAGE ((int32_t)(BAT_CHARGE_CUTOFF_VOLTAGE * 1000))
+#define CHARGER_END_CURRENT ((int32_t)(CHARGE_END_LIMIT_CURRENT * 1000))
+#define CHARGER_RECHARGE_VOLTAGE ((int32_t)(BAT_RECHARGE_VOLTAGE * 1000))
+/* CV time below CHARGER_END_CURRENT before the end of the charge (ms) */
+#define CHARGER_END_TIME 10000
+
+/* PI gains, Q16 PWM counts per mA or mV, the integral ones per CHARGER_PERIOD.
+   One PWM count is about 23mV on the buck output with a 32V supply */
+#define CHARGER_KP_CURRENT CHARGER_Q16(0.002)
+#define CHARGER_KI_CURRENT CHARGER_Q16(0.001)
+#define CHARGER_KP_VOLTAGE CHARGER_Q16(0.008)
+#define CHARGER_KI_VOLTAGE CHARGER_Q16(0.004)
 
 /******************************************************************************
  * Module Preprocessor Macros
  *******************************************************************************/
+#define CHARGER_Q16(x) ((int32_t)((x) * 65536.0 + 0.5))
 
 /******************************************************************************
  * Module Typedefs
  *******************************************************************************/
 
-typedef enum{
-    CHARGER_STATE_IDLE,
-    CHARGER_STATE_CONNECTED,
-    CHARGER_STATE_CHARGING_CC,
-    CHARGER_STATE_CHARGING_CV,
-    CHARGER_STATE_END_CHARGING,
-} CHARGER_STATE_e;
 
 /******************************************************************************
  * Module Variable Definitions
@@ -43,13 +59,22 @@ typedef enum{
 
 TIM_HandleTypeDef TIM1_Handle;  // PWM Charge Controller
 
-float SOC                           = 0;
 uint16_t chargecontrol_pwm_val      = 0;
 uint8_t  chargecontrol_is_charging  = 0;
 
+/* PI integrators, Q16 PWM counts */
+static int32_t charger_s32CurrentIntegral = 0;
+static int32_t charger_s32VoltageIntegral = 0;
+/* the voltage loop has been in control since the start of the charge */
+static uint8_t charger_bVoltageLimited = 0;
+
 /******************************************************************************
  * Function Prototypes
  *******************************************************************************/
+static void charger_Start(void);
+static void charger_SetPwm(uint16_t u16Pwm);
+static uint16_t charger_u16Regulate(void);
+static int32_t charger_s32Clamp(int32_t s32Value);
 
 /******************************************************************************
  *  Public Functions
@@ -94,7 +119,8 @@ uint8_t  chargecontrol_is_charging  = 0;
     Error_Handler();
   }
 
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  /* TRGO starts the ADC2 charge current and voltage conversions */
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_OC4REF;
   sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
   if (HAL_TIMEx_MasterConfigSynchronization(&TIM1_Handle, &sMasterConfig) != HAL_OK)
   {
@@ -113,6 +139,15 @@ uint8_t  chargecontrol_is_charging  = 0;
     Error_Handler();
   }
 
+  /* channel 4 is internal only (not started, no pin) : OC4REF rises at CCR4,
+     the middle of the channel 1 pulse, see charger_SetPwm() */
+  sConfigOC.OCMode = TIM_OCMODE_PWM2;
+  sConfigOC.Pulse = 1;
+  if (HAL_TIM_PWM_ConfigChannel(&TIM1_Handle, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
   sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_ENABLE;
   sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_ENABLE;
   sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_1;
@@ -143,7 +178,7 @@ uint8_t  chargecontrol_is_charging  = 0;
 
 
     // Charge CH1/CH1N PWM Timer
-  TIM1->CCR1 = 0;  
+  charger_SetPwm(0);
   HAL_TIM_PWM_Start(&TIM1_Handle, TIM_CHANNEL_1);
   HAL_TIMEx_PWMN_Start(&TIM1_Handle, TIM_CHANNEL_1);
   DB_TRACE(" * Charge Controler PWM Timers initialized\r\n");
@@ -152,8 +187,11 @@ uint8_t  chargecontrol_is_charging  = 0;
 /*
  * manages the charge voltage, and charge, lowbat LED
  * improvementt need to be done to avoid sparks when connected charger and disconnected 
- * todo PID current measure
- * needs to be called frequently
+ * the PWM is the lowest output of a current PI (MAX_CHARGE_CURRENT) and a
+ * voltage PI (MAX_CHARGE_VOLTAGE on the charge output, BAT_CHARGE_CUTOFF_VOLTAGE
+ * on the battery) : CC until the voltage loop takes over, then CV until the
+ * current stays below CHARGE_END_LIMIT_CURRENT
+ * needs to be called every CHARGER_PERIOD ms, after ADC_input()
  */
 void ChargeController(void)
 {                        
@@ -181,51 +219,34 @@ void ChargeController(void)
           HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR4, charge_current_offset.u[1]);   
           HAL_PWR_DisableBkUpAccess(); 
           HAL_GPIO_WritePin(TF4_GPIO_PORT, TF4_PIN, 1); /* Power on the battery  Powerbus */
+          charger_Start();
           charger_state = CHARGER_STATE_CHARGING_CC;
         }
 
         break;
 
     case CHARGER_STATE_CHARGING_CC:
-        // cap charge current at 1.5 Amps
-        if ((battery_voltage > BAT_CHARGE_CUTOFF_VOLTAGE && (chargecontrol_pwm_val > 0)) || ((current > MAX_CHARGE_CURRENT) && (chargecontrol_pwm_val > 39)))
-        {
-            chargecontrol_pwm_val--;
-        }
-        if ((battery_voltage < BAT_CHARGE_CUTOFF_VOLTAGE) && (current < MAX_CHARGE_CURRENT) && (chargecontrol_pwm_val < 1350))
-        {
-            chargecontrol_pwm_val++;
-        }
+        chargecontrol_pwm_val = charger_u16Regulate();
 
-        if(charge_voltage >= (LIMIT_VOLTAGE_150MA )){
+        /* the voltage loop limits the PWM : CV until the end of the charge */
+        if (charger_bVoltageLimited) {
             charger_state = CHARGER_STATE_CHARGING_CV;
+            timestamp = HAL_GetTick();
         }
 
         break;
 
     case CHARGER_STATE_CHARGING_CV:
-        // set PWM to approach 29.4V  charge voltage
-        if ((battery_voltage < BAT_CHARGE_CUTOFF_VOLTAGE) && (charge_voltage < (MAX_CHARGE_VOLTAGE)) && (chargecontrol_pwm_val < 1350))
-        {
-          chargecontrol_pwm_val++;
-        }            
-        if ((battery_voltage > BAT_CHARGE_CUTOFF_VOLTAGE && (chargecontrol_pwm_val > 0)) || (charge_voltage > (MAX_CHARGE_VOLTAGE) && (chargecontrol_pwm_val > 39)))
-        {
-          chargecontrol_pwm_val--;
-        }
+        chargecontrol_pwm_val = charger_u16Regulate();
 
-        /* the current is limited to 150ma */
-        if ((current > (MAX_CHARGE_CURRENT/10)) && chargecontrol_pwm_val > 0)
-        {
-            chargecontrol_pwm_val--;
+        /* battery full when the current stays low */
+        if (adc_s16CurrentMilliAmp >= CHARGER_END_CURRENT) {
+          timestamp = HAL_GetTick();
         }
-
-        /* battery full ? */
-        if (current < CHARGE_END_LIMIT_CURRENT) {
-          //charger_state = CHARGER_STATE_END_CHARGING;
-          /*consider as the battery full */
-          ampere_acc.f = 2.8;
-          SOC = 100;
+        else if ((HAL_GetTick() - timestamp) > CHARGER_END_TIME) {
+          charger_state = CHARGER_STATE_END_CHARGING;
+          chargecontrol_pwm_val = 0;
+          BATTERY_SetFull();
         }
 
         break;
@@ -234,6 +255,12 @@ void ChargeController(void)
 
         chargecontrol_pwm_val = 0;
 
+        /* the mower is still powered by the battery, top it up */
+        if (adc_u16BatteryMilliVolt < CHARGER_RECHARGE_VOLTAGE) {
+            charger_Start();
+            charger_state = CHARGER_STATE_CHARGING_CC;
+        }
+
         break;
 
 
@@ -249,26 +276,103 @@ void ChargeController(void)
         break;
     }
     
-    ampere_acc.f += ((current - charge_current_offset.f)/(100*60*60));
-    if(ampere_acc.f >= 2.8)ampere_acc.f = 2.8;
-    SOC = ampere_acc.f/2.8;
-
-    // Writes a data in a RTC Backup data Register 1
-    HAL_PWR_EnableBkUpAccess();
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR1, ampere_acc.u[0]);    
-    HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR2, ampere_acc.u[1]);   
-    HAL_PWR_DisableBkUpAccess(); 
-
     chargecontrol_is_charging = charger_state;
 
     /*Check the PWM value for safety */
-    if (chargecontrol_pwm_val > 1350){
-        chargecontrol_pwm_val = 1350;
+    if (chargecontrol_pwm_val > CHARGER_PWM_MAX){
+        chargecontrol_pwm_val = CHARGER_PWM_MAX;
     }
-    TIM1->CCR1 = chargecontrol_pwm_val;  
+    charger_SetPwm(chargecontrol_pwm_val);
     
 }
 
 /******************************************************************************
  *  Private Functions
  *******************************************************************************/
+
+/*
+ * charge PWM, and the ADC trigger in the middle of the pulse where the
+ * inductor current equals its average. Never 0 : OC4REF needs a rising edge
+ * every period to keep measuring when the PWM is off
+ */
+static void charger_SetPwm(uint16_t u16Pwm)
+{
+  TIM1->CCR1 = u16Pwm;
+  TIM1->CCR4 = (u16Pwm > 2) ? (u16Pwm / 2) : 1;
+}
+
+/*
+ * start a charge : both integrators at the PWM giving the battery voltage on
+ * the buck output (less a margin), so the current rises from 0 at once
+ * instead of ramping from a null PWM
+ */
+static void charger_Start(void)
+{
+  int32_t l_s32Pwm = 0;
+
+  if (adc_u16ChargerInputMilliVolt > 0) {
+    l_s32Pwm = ((int32_t)adc_u16BatteryMilliVolt * CHARGER_PWM_PERIOD) / adc_u16ChargerInputMilliVolt - CHARGER_PRELOAD_MARGIN;
+  }
+  if (l_s32Pwm < 0) {
+    l_s32Pwm = 0;
+  }
+  if (l_s32Pwm > CHARGER_PWM_MAX) {
+    l_s32Pwm = CHARGER_PWM_MAX;
+  }
+  charger_s32CurrentIntegral = l_s32Pwm << 16;
+  charger_s32VoltageIntegral = l_s32Pwm << 16;
+  charger_bVoltageLimited = 0;
+}
+
+/*
+ * one step of the two PI loops, returns the lowest output. The integrator of
+ * the loop not in control tracks the output so the handover has no step, and
+ * both are clamped to the PWM range (anti windup)
+ */
+static uint16_t charger_u16Regulate(void)
+{
+  int32_t l_s32CurrentError;
+  int32_t l_s32VoltageError;
+  int32_t l_s32CurrentP;
+  int32_t l_s32VoltageP;
+  int32_t l_s32Current;
+  int32_t l_s32Voltage;
+  int32_t l_s32Out;
+
+  l_s32CurrentError = CHARGER_MAX_CURRENT - adc_s16CurrentMilliAmp;
+  l_s32VoltageError = CHARGER_MAX_VOLTAGE - (int32_t)adc_u16ChargeMilliVolt;
+  if ((CHARGER_CUTOFF_VOLTAGE - (int32_t)adc_u16BatteryMilliVolt) < l_s32VoltageError) {
+    l_s32VoltageError = CHARGER_CUTOFF_VOLTAGE - (int32_t)adc_u16BatteryMilliVolt;
+  }
+
+  charger_s32CurrentIntegral = charger_s32Clamp(charger_s32CurrentIntegral + l_s32CurrentError * CHARGER_KI_CURRENT);
+  charger_s32VoltageIntegral = charger_s32Clamp(charger_s32VoltageIntegral + l_s32VoltageError * CHARGER_KI_VOLTAGE);
+  l_s32CurrentP = l_s32CurrentError * CHARGER_KP_CURRENT;
+  l_s32VoltageP = l_s32VoltageError * CHARGER_KP_VOLTAGE;
+  l_s32Current = charger_s32Clamp(charger_s32CurrentIntegral + l_s32CurrentP);
+  l_s32Voltage = charger_s32Clamp(charger_s32VoltageIntegral + l_s32VoltageP);
+
+  if (l_s32Voltage < l_s32Current) {
+    l_s32Out = l_s32Voltage;
+    charger_s32CurrentIntegral = charger_s32Clamp(l_s32Out - l_s32CurrentP);
+    charger_bVoltageLimited = 1;
+  }
+  else {
+    l_s32Out = l_s32Current;
+    charger_s32VoltageIntegral = charger_s32Clamp(l_s32Out - l_s32VoltageP);
+  }
+
+  return (uint16_t)(l_s32Out >> 16);
+}
+
+/* limit a Q16 PWM value to 0 .. CHARGER_PWM_MAX */
+static int32_t charger_s32Clamp(int32_t s32Value)
+{
+  if (s32Value < 0) {
+    return 0;
+  }
+  if (s32Value > (CHARGER_PWM_MAX << 16)) {
+    return CHARGER_PWM_MAX << 16;
+  }
+  return s32Value;
+}
@@ -15,6 +15,7 @@
  *******************************************************************************/
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include "stm32f1xx_hal.h"
 #include "stm32f1xx_hal_uart.h"
 
@@ -24,13 +25,24 @@
 #include "adc.h"
 
 #include "drivemotor.h"
+#include "odometry.h"
+#include "ramp.h"
+#include "speed.h"
+#include "recorder.h"
 
 /******************************************************************************
  * Module Preprocessor Constants
  *******************************************************************************/
 #define DRIVEMOTOR_LENGTH_INIT_MSG 38
 #define DRIVEMOTOR_LENGTH_RQST_MSG 12
-#define DRIVEMOTOR_LENGTH_RECEIVED_MSG 20
+/* time without reply after which a new request is sent and the speed loop is bypassed (ms) */
+#define DRIVEMOTOR_RX_TIMEOUT 100
+/* circular receive DMA buffer, scanned on IDLE line and half/full buffer */
+#define DRIVEMOTOR_RX_DMA_SIZE 64
+/* decoded replies waiting for DRIVEMOTOR_App_Rx(), power of 2 */
+#define DRIVEMOTOR_RX_QUEUE_SIZE 4
+/* longest ramp step (s), after a pause the ramp restarts from where it was */
+#define DRIVEMOTOR_RAMP_MAX_DT 0.1f
 /******************************************************************************
  * Module Preprocessor Macros
  *******************************************************************************/
@@ -66,6 +78,12 @@ typedef struct
     /*19*/ uint8_t u8_CRC;
 } __attribute__((__packed__)) DRIVEMOTORS_data_t;
 
+typedef struct
+{
+    DRIVEMOTORS_data_t sData;
+    uint32_t u32Cycles;     /* DWT time the reply was complete */
+} DRIVEMOTOR_RxFrame_t;
+
 /******************************************************************************
  * Module Variable Definitions
  *******************************************************************************/
@@ -75,21 +93,43 @@ DMA_HandleTypeDef hdma_usart2_rx;
 DMA_HandleTypeDef hdma_usart2_tx;
 
 static DRIVEMOTOR_STATE_e drivemotor_eState = DRIVEMOTOR_INIT_1;
-static rx_status_e drivemotors_eRxFlag = RX_WAIT;
 
 static DRIVEMOTORS_data_t drivemotor_psReceivedData = {0};
+
+static uint8_t drivemotor_au8RxDma[DRIVEMOTOR_RX_DMA_SIZE];
+static FRAME_Port_t drivemotor_sPort;
+static DRIVEMOTOR_RxFrame_t drivemotor_asRxQueue[DRIVEMOTOR_RX_QUEUE_SIZE];
+static volatile uint8_t drivemotor_u8RxHead = 0; /* written by the ISR */
+static volatile uint8_t drivemotor_u8RxTail = 0; /* written by DRIVEMOTOR_App_Rx() */
+
+/* one request in flight, the next one goes when its reply is in and the poll tick passed */
+static uint8_t drivemotor_bWaitReply = 0;
+static uint8_t drivemotor_bRequestDue = 0;
+static uint32_t drivemotor_u32TxTick = 0;
+static uint32_t drivemotor_u32TxCycles = 0;
+static uint32_t drivemotor_u32LastRxCycles = 0;
+
+/* command latency, DWT time the last command was received, 0 if none waiting */
+static uint32_t drivemotor_u32CmdCycles = 0;
+static volatile uint32_t drivemotor_u32TxCmdCycles = 0;
 static uint8_t drivemotor_pu8RqstMessage[DRIVEMOTOR_LENGTH_RQST_MSG] = {0x55, 0xaa, 0x08, 0x10, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
 const uint8_t drivemotor_pcu8Preamble[5] = {0x55, 0xAA, 0x10, 0x01, 0xE0};
+static void drivemotor_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length);
+static const FRAME_Desc_t drivemotor_pcsFrames[] = {
+    {drivemotor_pcu8Preamble, sizeof(drivemotor_pcu8Preamble), DRIVEMOTOR_LENGTH_RECEIVED_MSG, drivemotor_rxFrame},
+};
 // const uint8_t drivemotor_pcu8InitMsg[DRIVEMOTOR_LENGTH_INIT_MSG] = { 0x55, 0xaa, 0x08, 0x10, 0x80, 0xa0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x37};
 const uint8_t drivemotor_pcu8InitMsg[DRIVEMOTOR_LENGTH_INIT_MSG] = {0x55, 0xaa, 0x22, 0x10, 0x80, 0x00, 0x00, 0x00, 0x00, 0x02, 0xC8, 0x46, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x05, 0x0F, 0x14, 0x96, 0x0A, 0x1E, 0x5a, 0xfa, 0x05, 0x0A, 0x14, 0x32, 0x40, 0x04, 0x20, 0x01, 0x00, 0x00, 0x2C, 0x01, 0xEE};
 
-int8_t prev_left_direction = 0;
-int8_t prev_right_direction = 0;
-uint16_t prev_right_encoder_val = 0;
-uint16_t prev_left_encoder_val = 0;
-int16_t prev_right_wheel_speed_val = 0;
-int16_t prev_left_wheel_speed_val = 0;
+static ENCODER_Wheel_t drivemotor_asEncoder[2];
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+/* one block filled while the other one may wait for room on the link */
+static DRIVEMOTOR_Capture_t drivemotor_asCapture[2][DRIVEMOTOR_CAPTURE_RECORDS];
+static uint8_t drivemotor_u8CaptureFill = 0;
+static uint8_t drivemotor_u8CaptureLen = 0;
+static uint8_t drivemotor_bCapturePending = 0;
+#endif
 uint32_t right_encoder_ticks = 0;
 uint32_t left_encoder_ticks = 0;
 int8_t left_direction = 0;
@@ -102,16 +142,57 @@ uint8_t right_power = 0;
 uint8_t left_power = 0;
 
 uint32_t DRIVEMOTOR_u32ErrorCnt = 0;
+uint32_t DRIVEMOTOR_u32RxDropped = 0;
+uint32_t DRIVEMOTOR_u32RxTimeout = 0;
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+uint32_t DRIVEMOTOR_u32CaptureLost = 0;
+#endif
+uint32_t DRIVEMOTOR_au32RttHisto[DRIVEMOTOR_RTT_BINS] = {0};
+uint32_t DRIVEMOTOR_u32RttMinUs = UINT32_MAX;
+uint32_t DRIVEMOTOR_u32RttMaxUs = 0;
+uint32_t DRIVEMOTOR_u32CmdCount = 0;
+uint32_t DRIVEMOTOR_au32CmdHisto[DRIVEMOTOR_CMD_BINS] = {0};
+uint32_t DRIVEMOTOR_u32CmdMinUs = UINT32_MAX;
+uint32_t DRIVEMOTOR_u32CmdMaxUs = 0;
 
 static uint8_t left_speed_req;
 static uint8_t right_speed_req;
 static uint8_t left_dir_req;
 static uint8_t right_dir_req;
 
+/* speeds sent to the controller, the requests through the ramp */
+static uint8_t left_speed_out;
+static uint8_t right_speed_out;
+static uint8_t left_dir_out;
+static uint8_t right_dir_out;
+
+#if OPTION_DRIVEMOTOR_RAMP == 1
+static RAMP_State_t drivemotor_asRamp[2];
+static float drivemotor_fAccMax = DRIVEMOTOR_ACC_MAX;
+static float drivemotor_fJerkMax = DRIVEMOTOR_JERK_MAX;
+static uint32_t drivemotor_u32RampCycles = 0;
+#endif
+
+#if OPTION_SPEED_CONTROL == 1
+static SPEED_Wheel_t drivemotor_asWheel[2];
+static SPEED_Gains_t drivemotor_sGains = {DRIVEMOTOR_KP, DRIVEMOTOR_KI, DRIVEMOTOR_KD};
+static uint32_t drivemotor_u32LastRx = 0;
+#endif
+
 /******************************************************************************
  * Function Prototypes
  *******************************************************************************/
 __STATIC_INLINE void drivemotor_prepareMsg(uint8_t left_speed, uint8_t right_speed, uint8_t left_dir, uint8_t right_dir);
+static void drivemotor_rttRecord(uint32_t u32Cycles);
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+static void drivemotor_capture(uint32_t u32RxCycles);
+#endif
+static void drivemotor_sendRequest(void);
+static void drivemotor_transmitRequest(void);
+static void drivemotor_setOutput(uint8_t u8LeftSpeed, uint8_t u8RightSpeed, uint8_t u8LeftDir, uint8_t u8RightDir);
+#if OPTION_DRIVEMOTOR_RAMP == 1
+static void drivemotor_ramp(void);
+#endif
 
 /******************************************************************************
  *  Public Functions
@@ -178,7 +259,7 @@ void DRIVEMOTOR_Init(void)
     hdma_usart2_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_usart2_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_usart2_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_usart2_rx.Init.Mode = DMA_NORMAL;
+    hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
     hdma_usart2_rx.Init.Priority = DMA_PRIORITY_LOW;
     if (HAL_DMA_Init(&hdma_usart2_rx) != HAL_OK)
     {
@@ -208,140 +289,67 @@ void DRIVEMOTOR_Init(void)
 
     __HAL_UART_ENABLE_IT(&DRIVEMOTORS_USART_Handler, UART_IT_TC);
 
+    /* receive continuously, the replies are framed by the 0x55 0xAA scanner */
+    FRAME_Init(&drivemotor_sPort, &DRIVEMOTORS_USART_Handler, drivemotor_au8RxDma, DRIVEMOTOR_RX_DMA_SIZE, drivemotor_pcsFrames, sizeof(drivemotor_pcsFrames) / sizeof(FRAME_Desc_t));
+
     right_encoder_ticks = 0;
     left_encoder_ticks = 0;
-    prev_left_direction = 0;
-    prev_right_direction = 0;
-    prev_right_encoder_val = 0;
-    prev_left_encoder_val = 0;
-    prev_right_wheel_speed_val = 0;
-    prev_left_wheel_speed_val = 0;
+    ENCODER_Init(&drivemotor_asEncoder[DRIVEMOTOR_LEFT]);
+    ENCODER_Init(&drivemotor_asEncoder[DRIVEMOTOR_RIGHT]);
+#if OPTION_ODOMETRY == 1
+    ODOMETRY_Init();
+#endif
 }
 
-/// @brief handle drive motor messages
+/// @brief drive motor poll tick, runs every 1000 / DRIVEMOTOR_POLL_HZ ms
 /// @param
-void DRIVEMOTOR_App_10ms(void)
+void DRIVEMOTOR_App_Poll(void)
 {
-
-    static uint32_t l_u32Timestamp = 0;
-
-    switch (drivemotor_eState)
+    /* previous request still waiting, DRIVEMOTOR_App_Rx() sends the next one with the reply */
+    if (drivemotor_bWaitReply && (HAL_GetTick() - drivemotor_u32TxTick) < DRIVEMOTOR_RX_TIMEOUT)
     {
-    case DRIVEMOTOR_INIT_1:
-
-        HAL_UART_Transmit_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)drivemotor_pcu8InitMsg, DRIVEMOTOR_LENGTH_INIT_MSG);
-        drivemotor_eState = DRIVEMOTOR_RUN;
-        debug_printf(" * Drive Motor Controller initialized\r\n");
-        break;
-
-    case DRIVEMOTOR_RUN:
-
-        /* prepare to receive the message before to launch the command */
-        HAL_UART_Receive_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)&drivemotor_psReceivedData, sizeof(DRIVEMOTORS_data_t));
-
-        drivemotor_prepareMsg(left_speed_req, right_speed_req, left_dir_req, right_dir_req);
-        /* error State*/
-        if (drivemotor_psReceivedData.u8_error != 0)
-        {
-            drivemotor_prepareMsg(0, 0, 0, 0);
-            DRIVEMOTOR_u32ErrorCnt++;
-        }
-
-        /* todo add also accelerometer detection*/
-        if ((HALLSTOP_Left_Sense() || HALLSTOP_Right_Sense()) && (left_dir_req || right_dir_req))
-        {
-
-            switch (main_eOpenmowerStatus)
-            {
-            case OPENMOWER_STATUS_MOWING:
-                /*hit something goes back */
-                drivemotor_eState = DRIVEMOTOR_BACKWARD;
-                l_u32Timestamp = HAL_GetTick();
-                break;
-            case OPENMOWER_STATUS_DOCKING:
-                /* Get voltage from dock, stop the mower*/
-                if (chargerInputVoltage > MIN_DOCKED_VOLTAGE)
-                {
-                    drivemotor_prepareMsg(0, 0, 0, 0);
-                }
-                else
-                { /*hit something goes back */
-                    drivemotor_eState = DRIVEMOTOR_BACKWARD;
-                    l_u32Timestamp = HAL_GetTick();
-                }
-
-                break;
-            case OPENMOWER_STATUS_UNDOCKING:
-            case OPENMOWER_STATUS_IDLE:
-            case OPENMOWER_STATUS_RECORD:
-            default:
-                /* nothing to do in these modes*/
-                break;
-            }
-        }
-
-        HAL_UART_Transmit_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)drivemotor_pu8RqstMessage, DRIVEMOTOR_LENGTH_RQST_MSG);
-
-        break;
-
-    case DRIVEMOTOR_BACKWARD:
-        /* prepare to receive the message before to launch the command */
-        HAL_UART_Receive_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)&drivemotor_psReceivedData, sizeof(DRIVEMOTORS_data_t));
-        drivemotor_prepareMsg(100, 100, 0, 0); /* set to -0.33m/s  */
-        HAL_UART_Transmit_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)drivemotor_pu8RqstMessage, DRIVEMOTOR_LENGTH_RQST_MSG);
-
-        if ((HAL_GetTick() - l_u32Timestamp) > 2000)
-        {
-            drivemotor_eState = DRIVEMOTOR_WAIT;
-            l_u32Timestamp = HAL_GetTick();
-        }
-
-        break;
-
-    case DRIVEMOTOR_WAIT:
-        /* prepare to receive the message before to launch the command */
-        HAL_UART_Receive_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)&drivemotor_psReceivedData, sizeof(DRIVEMOTORS_data_t));
-        drivemotor_prepareMsg(0, 0, 0, 0);
-        HAL_UART_Transmit_DMA(&DRIVEMOTORS_USART_Handler, (uint8_t *)drivemotor_pu8RqstMessage, DRIVEMOTOR_LENGTH_RQST_MSG);
-
-        if ((HAL_GetTick() - l_u32Timestamp) > 1000)
-        {
-            drivemotor_eState = DRIVEMOTOR_RUN;
-        }
-
-        break;
-
-    default:
-        break;
+        drivemotor_bRequestDue = 1;
+        return;
     }
-
-    /* TODO error management */
-    switch (drivemotors_eRxFlag)
+    if (drivemotor_bWaitReply)
     {
-    case RX_VALID:
-        break;
-
-    case RX_WAIT:
-
-        /* todo check for timeout */
-
-        break;
-
-    case RX_CRC_ERROR:
-    case RX_INVALID_ERROR:
-    case RX_TIMEOUT_ERROR:
-    default:
-        /* inform for error */
-        break;
+        DRIVEMOTOR_u32RxTimeout++;
+        drivemotor_bWaitReply = 0;
     }
+    drivemotor_sendRequest();
 }
 
 /// @brief Decode received drive motor messages
 /// @param
 void DRIVEMOTOR_App_Rx(void)
 {
-    if (drivemotors_eRxFlag == RX_VALID)
+    while (drivemotor_u8RxTail != drivemotor_u8RxHead)
     {
+        __DMB();
+        drivemotor_psReceivedData = drivemotor_asRxQueue[drivemotor_u8RxTail].sData;
+        uint32_t l_u32RxCycles = drivemotor_asRxQueue[drivemotor_u8RxTail].u32Cycles;
+        __DMB();
+        drivemotor_u8RxTail = (drivemotor_u8RxTail + 1) & (DRIVEMOTOR_RX_QUEUE_SIZE - 1);
+
+        if (drivemotor_bWaitReply)
+        {
+            drivemotor_bWaitReply = 0;
+            drivemotor_rttRecord(l_u32RxCycles - drivemotor_u32TxCycles);
+        }
+        uint32_t l_u32DtUs = (l_u32RxCycles - drivemotor_u32LastRxCycles) / (SystemCoreClock / 1000000U);
+        if (l_u32DtUs == 0 || l_u32DtUs >= DRIVEMOTOR_RX_TIMEOUT * 1000U)
+        {
+            l_u32DtUs = 1000000U / DRIVEMOTOR_POLL_HZ;
+        }
+        drivemotor_u32LastRxCycles = l_u32RxCycles;
+
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+        drivemotor_capture(l_u32RxCycles);
+#endif
+
+        uint32_t l_u32PrevLeftTicks = left_encoder_ticks;
+        uint32_t l_u32PrevRightTicks = right_encoder_ticks;
+
         /* decode */
         uint8_t direction = drivemotor_psReceivedData.u8_direction;
         // we need to adjust for direction (+/-) !
@@ -377,35 +385,47 @@ void DRIVEMOTOR_App_Rx(void)
         left_power = drivemotor_psReceivedData.u8_left_power;
         right_power = drivemotor_psReceivedData.u8_right_power;
 
-        /*
-          Encoder value can reset to zero twice when changing direction
-          2nd reset occurs when the speed changes from zero to non-zero
-          something the ticks are holded until the next commands
-        */
-
-        left_wheel_speed_val = left_direction * drivemotor_psReceivedData.u8_left_speed;
-        if (left_direction == 0 || (left_direction != prev_left_direction) || (prev_left_wheel_speed_val == 0 && left_wheel_speed_val != 0))
+#if OPTION_RECORDER == 1
+        RECORDER_Record_t *l_psRecord = RECORDER_psNext();
+        if (l_psRecord != NULL)
         {
-            prev_left_encoder_val = 0;
+            l_psRecord->u16LeftTicks = left_encoder_val;
+            l_psRecord->u16RightTicks = right_encoder_val;
+            l_psRecord->u8Direction = direction;
+            l_psRecord->u8LeftSpeed = drivemotor_psReceivedData.u8_left_speed;
+            l_psRecord->u8RightSpeed = drivemotor_psReceivedData.u8_right_speed;
+            l_psRecord->u8Error = drivemotor_psReceivedData.u8_error;
+            l_psRecord->u8LeftPower = left_power;
+            l_psRecord->u8RightPower = right_power;
+            /* the request this reply answers */
+            l_psRecord->u8LeftPwm = drivemotor_pu8RqstMessage[6];
+            l_psRecord->u8RightPwm = drivemotor_pu8RqstMessage[7];
+            RECORDER_Commit(l_psRecord);
         }
-        left_encoder_ticks += abs(left_direction * (left_encoder_val - prev_left_encoder_val));
-        prev_left_encoder_val = left_encoder_val;
-        prev_left_wheel_speed_val = left_wheel_speed_val;
-        prev_left_direction = left_direction;
+#endif
 
-        right_wheel_speed_val = right_direction * drivemotor_psReceivedData.u8_right_speed;
-        if (right_direction == 0 || (right_direction != prev_right_direction) || (prev_right_wheel_speed_val == 0 && right_wheel_speed_val != 0))
-        {
-            prev_right_encoder_val = 0;
-        }
-        right_encoder_ticks += abs(right_direction * (right_encoder_val - prev_right_encoder_val));
-        prev_right_encoder_val = right_encoder_val;
-        prev_right_wheel_speed_val = right_wheel_speed_val;
-        prev_right_direction = right_direction;
+        /* counter resets, wrap around and held ticks are handled by the encoder module */
+        left_wheel_speed_val = left_direction * drivemotor_psReceivedData.u8_left_speed;
+        left_encoder_ticks += ENCODER_u16Update(&drivemotor_asEncoder[DRIVEMOTOR_LEFT], left_direction, left_encoder_val, l_u32DtUs);
 
+        right_wheel_speed_val = right_direction * drivemotor_psReceivedData.u8_right_speed;
+        right_encoder_ticks += ENCODER_u16Update(&drivemotor_asEncoder[DRIVEMOTOR_RIGHT], right_direction, right_encoder_val, l_u32DtUs);
+
+#if OPTION_SPEED_CONTROL == 1
+        drivemotor_u32LastRx = HAL_GetTick();
+        SPEED_Update(&drivemotor_asWheel[DRIVEMOTOR_LEFT], &drivemotor_sGains, left_speed_out, left_dir_out, left_encoder_ticks - l_u32PrevLeftTicks, left_direction, l_u32DtUs);
+        SPEED_Update(&drivemotor_asWheel[DRIVEMOTOR_RIGHT], &drivemotor_sGains, right_speed_out, right_dir_out, right_encoder_ticks - l_u32PrevRightTicks, right_direction, l_u32DtUs);
+#endif
+#if OPTION_ODOMETRY == 1
+        ODOMETRY_Update(left_direction, right_direction, left_encoder_ticks, right_encoder_ticks);
+#endif
         wheelTicks_handler(left_direction, right_direction, left_encoder_ticks, right_encoder_ticks, left_wheel_speed_val, right_wheel_speed_val);
+    }
 
-        drivemotors_eRxFlag = RX_WAIT; // ready for next message
+    /* the poll tick passed while we were waiting, no need to wait for the next one */
+    if (!drivemotor_bWaitReply && drivemotor_bRequestDue)
+    {
+        drivemotor_sendRequest();
     }
 }
 
@@ -428,29 +448,146 @@ void DRIVEMOTOR_SetSpeed(uint8_t left_speed, uint8_t right_speed, uint8_t left_d
         left_dir_req = left_dir;
         right_dir_req = right_dir;
     }
+#if OPTION_DRIVEMOTOR_RAMP != 1
+    drivemotor_setOutput(left_speed_req, right_speed_req, left_dir_req, right_dir_req);
+#endif
+}
+
+/// @brief Stop both wheels now, without the ramp (emergency)
+/// @param
+void DRIVEMOTOR_Stop(void)
+{
+    DRIVEMOTOR_SetSpeed(0, 0, 0, 0);
+#if OPTION_DRIVEMOTOR_RAMP == 1
+    RAMP_Reset(&drivemotor_asRamp[0], 0.0f);
+    RAMP_Reset(&drivemotor_asRamp[1], 0.0f);
+#endif
+    drivemotor_setOutput(0, 0, 0, 0);
+}
+
+/// @brief Get the encoder counters of a wheel
+/// @param u8Wheel DRIVEMOTOR_LEFT or DRIVEMOTOR_RIGHT
+/// @param psEncoder destination
+void DRIVEMOTOR_GetEncoder(uint8_t u8Wheel, ENCODER_Wheel_t *psEncoder)
+{
+    *psEncoder = drivemotor_asEncoder[u8Wheel];
+}
+
+#if OPTION_DRIVEMOTOR_RAMP == 1
+/// @brief Set the wheel speed ramp limits
+/// @param fAccMax acceleration limit, m/s^2
+/// @param fJerkMax jerk limit, m/s^3
+void DRIVEMOTOR_SetLimits(float fAccMax, float fJerkMax)
+{
+    if (fAccMax > 0.0f && fJerkMax > 0.0f)
+    {
+        drivemotor_fAccMax = fAccMax;
+        drivemotor_fJerkMax = fJerkMax;
+    }
+}
+#endif
+
+#if OPTION_SPEED_CONTROL == 1
+/// @brief Set the speed loop gains
+/// @param fKp proportional gain, PWM per m/s
+/// @param fKi integral gain, PWM per m
+/// @param fKd derivative gain (on the measure), PWM per m/s^2
+void DRIVEMOTOR_SetGains(float fKp, float fKi, float fKd)
+{
+    drivemotor_sGains.fKp = fKp;
+    drivemotor_sGains.fKi = fKi;
+    drivemotor_sGains.fKd = fKd;
+    DRIVEMOTOR_ResetTracking();
 }
 
-/// @brief drive motor receive interrupt handler
+/// @brief Get the speed loop tracking statistics of a wheel
+/// @param u8Wheel DRIVEMOTOR_LEFT or DRIVEMOTOR_RIGHT
+/// @param psTracking destination
+void DRIVEMOTOR_GetTracking(uint8_t u8Wheel, DRIVEMOTOR_Tracking_t *psTracking)
+{
+    const SPEED_Wheel_t *l_psWheel = &drivemotor_asWheel[u8Wheel];
+
+    psTracking->fTarget = l_psWheel->fTarget;
+    psTracking->fMeasured = l_psWheel->fMeasured;
+    psTracking->u8Pwm = l_psWheel->u8Pwm;
+    psTracking->u32Samples = l_psWheel->u32Samples;
+    psTracking->fRmsError = l_psWheel->u32Samples ? sqrtf(l_psWheel->fSumSqError / l_psWheel->u32Samples) : 0.0f;
+    psTracking->fMaxError = l_psWheel->fMaxError;
+    psTracking->u32Saturated = l_psWheel->u32Saturated;
+}
+
+/// @brief Clear the tracking statistics, e.g. after a gain change
 /// @param
-void DRIVEMOTOR_ReceiveIT(void)
+void DRIVEMOTOR_ResetTracking(void)
+{
+    SPEED_ResetTracking(&drivemotor_asWheel[DRIVEMOTOR_LEFT]);
+    SPEED_ResetTracking(&drivemotor_asWheel[DRIVEMOTOR_RIGHT]);
+}
+#endif
+
+/// @brief Send the speeds set by DRIVEMOTOR_SetSpeed() without waiting for the poll tick
+/// @param u32RxCycles DWT time the command was received, for the latency statistics
+void DRIVEMOTOR_SendNow(uint32_t u32RxCycles)
 {
-    /* decode the frame */
-    if (memcmp(drivemotor_pcu8Preamble, (uint8_t *)&drivemotor_psReceivedData, 5) == 0)
+    drivemotor_u32CmdCycles = u32RxCycles;
+    if (drivemotor_eState != DRIVEMOTOR_RUN)
     {
-        uint8_t l_u8crc = crcCalc((uint8_t *)&drivemotor_psReceivedData, DRIVEMOTOR_LENGTH_RECEIVED_MSG - 1);
-        if (drivemotor_psReceivedData.u8_CRC == l_u8crc)
+        return;
+    }
+    if (drivemotor_bWaitReply)
+    {
+        /* DRIVEMOTOR_App_Rx() sends it with the reply */
+        drivemotor_bRequestDue = 1;
+    }
+    else
+    {
+        drivemotor_sendRequest();
+    }
+}
+
+/// @brief drive motor transmit complete interrupt handler
+/// @param
+void DRIVEMOTOR_TxCpltIT(void)
+{
+    uint32_t l_u32CmdCycles = drivemotor_u32TxCmdCycles;
+
+    if (l_u32CmdCycles != 0)
+    {
+        uint32_t l_u32Us = (DWT->CYCCNT - l_u32CmdCycles) / (SystemCoreClock / 1000000U);
+        uint32_t l_u32Bin = l_u32Us / DRIVEMOTOR_CMD_BIN_US;
+
+        drivemotor_u32TxCmdCycles = 0;
+        if (l_u32Bin >= DRIVEMOTOR_CMD_BINS)
         {
-            drivemotors_eRxFlag = RX_VALID;
+            l_u32Bin = DRIVEMOTOR_CMD_BINS - 1;
         }
-        else
+        DRIVEMOTOR_au32CmdHisto[l_u32Bin]++;
+        DRIVEMOTOR_u32CmdCount++;
+        if (l_u32Us < DRIVEMOTOR_u32CmdMinUs)
         {
-            drivemotors_eRxFlag = RX_CRC_ERROR;
+            DRIVEMOTOR_u32CmdMinUs = l_u32Us;
+        }
+        if (l_u32Us > DRIVEMOTOR_u32CmdMaxUs)
+        {
+            DRIVEMOTOR_u32CmdMaxUs = l_u32Us;
         }
     }
-    else
-    {
-        drivemotors_eRxFlag = RX_INVALID_ERROR;
-    }
+    FRAME_TxCpltIT(&drivemotor_sPort);
+}
+
+/// @brief drive motor receive interrupt handler, scans what the DMA received since the last call
+/// @param
+/// @retval number of replies received, see DRIVEMOTOR_App_Rx()
+uint8_t DRIVEMOTOR_ReceiveIT(void)
+{
+    return FRAME_u8ReceiveIT(&drivemotor_sPort);
+}
+
+/// @brief Get a copy of the drive motor UART counters
+/// @param psStats destination
+void DRIVEMOTOR_GetLinkStats(FRAME_Stats_t *psStats)
+{
+    FRAME_GetStats(&drivemotor_sPort, psStats);
 }
 
 /******************************************************************************
@@ -493,3 +630,252 @@ __STATIC_INLINE void drivemotor_prepareMsg(uint8_t left_speed, uint8_t right_spe
     drivemotor_pu8RqstMessage[10] = 0;
     drivemotor_pu8RqstMessage[11] = crcCalc(drivemotor_pu8RqstMessage, DRIVEMOTOR_LENGTH_RQST_MSG - 1);
 }
+
+/* build and send the next request according to the state */
+static void drivemotor_sendRequest(void)
+{
+    static uint32_t l_u32Timestamp = 0;
+
+    switch (drivemotor_eState)
+    {
+    case DRIVEMOTOR_INIT_1:
+
+        FRAME_bSend(&drivemotor_sPort, drivemotor_pcu8InitMsg, DRIVEMOTOR_LENGTH_INIT_MSG);
+        drivemotor_eState = DRIVEMOTOR_RUN;
+        debug_printf(" * Drive Motor Controller initialized\r\n");
+        break;
+
+    case DRIVEMOTOR_RUN:
+
+#if OPTION_DRIVEMOTOR_RAMP == 1
+        drivemotor_ramp();
+#endif
+#if OPTION_SPEED_CONTROL == 1
+        /* closed loop output, open loop while the controller does not answer */
+        if ((HAL_GetTick() - drivemotor_u32LastRx) < DRIVEMOTOR_RX_TIMEOUT)
+        {
+            drivemotor_prepareMsg(drivemotor_asWheel[DRIVEMOTOR_LEFT].u8Pwm, drivemotor_asWheel[DRIVEMOTOR_RIGHT].u8Pwm,
+                                  drivemotor_asWheel[DRIVEMOTOR_LEFT].u8Dir, drivemotor_asWheel[DRIVEMOTOR_RIGHT].u8Dir);
+        }
+        else
+        {
+            drivemotor_prepareMsg(left_speed_out, right_speed_out, left_dir_out, right_dir_out);
+        }
+#else
+        drivemotor_prepareMsg(left_speed_out, right_speed_out, left_dir_out, right_dir_out);
+#endif
+        /* error State*/
+        if (drivemotor_psReceivedData.u8_error != 0)
+        {
+            drivemotor_prepareMsg(0, 0, 0, 0);
+            DRIVEMOTOR_u32ErrorCnt++;
+        }
+
+        /* todo add also accelerometer detection*/
+        if ((HALLSTOP_Left_Sense() || HALLSTOP_Right_Sense()) && (left_dir_req || right_dir_req))
+        {
+
+            switch (main_eOpenmowerStatus)
+            {
+            case OPENMOWER_STATUS_MOWING:
+                /*hit something goes back */
+                drivemotor_eState = DRIVEMOTOR_BACKWARD;
+                l_u32Timestamp = HAL_GetTick();
+                break;
+            case OPENMOWER_STATUS_DOCKING:
+                /* Get voltage from dock, stop the mower*/
+                if (chargerInputVoltage > MIN_DOCKED_VOLTAGE)
+                {
+                    drivemotor_prepareMsg(0, 0, 0, 0);
+                }
+                else
+                { /*hit something goes back */
+                    drivemotor_eState = DRIVEMOTOR_BACKWARD;
+                    l_u32Timestamp = HAL_GetTick();
+                }
+
+                break;
+            case OPENMOWER_STATUS_UNDOCKING:
+            case OPENMOWER_STATUS_IDLE:
+            case OPENMOWER_STATUS_RECORD:
+            default:
+                /* nothing to do in these modes*/
+                break;
+            }
+        }
+
+        drivemotor_transmitRequest();
+
+        break;
+
+    case DRIVEMOTOR_BACKWARD:
+        drivemotor_prepareMsg(100, 100, 0, 0); /* set to -0.33m/s  */
+        drivemotor_transmitRequest();
+
+        if ((HAL_GetTick() - l_u32Timestamp) > 2000)
+        {
+            drivemotor_eState = DRIVEMOTOR_WAIT;
+            l_u32Timestamp = HAL_GetTick();
+        }
+
+        break;
+
+    case DRIVEMOTOR_WAIT:
+        drivemotor_prepareMsg(0, 0, 0, 0);
+        drivemotor_transmitRequest();
+
+        /* back in RUN the wheels start again from standstill */
+#if OPTION_DRIVEMOTOR_RAMP == 1
+        RAMP_Reset(&drivemotor_asRamp[0], 0.0f);
+        RAMP_Reset(&drivemotor_asRamp[1], 0.0f);
+#endif
+        drivemotor_setOutput(0, 0, 0, 0);
+
+        if ((HAL_GetTick() - l_u32Timestamp) > 1000)
+        {
+            drivemotor_eState = DRIVEMOTOR_RUN;
+        }
+
+        break;
+
+    default:
+        break;
+    }
+    /* reply timeouts are counted by DRIVEMOTOR_App_Poll(), CRC errors by the frame scanner */
+}
+
+/* send the request prepared in drivemotor_pu8RqstMessage, its reply is expected next */
+static void drivemotor_transmitRequest(void)
+{
+    drivemotor_bWaitReply = 1;
+    drivemotor_bRequestDue = 0;
+    drivemotor_u32TxTick = HAL_GetTick();
+    drivemotor_u32TxCycles = DWT->CYCCNT;
+    /* the latency of a command is measured up to the end of the first request carrying it */
+    drivemotor_u32TxCmdCycles = drivemotor_u32CmdCycles;
+    drivemotor_u32CmdCycles = 0;
+    FRAME_bSend(&drivemotor_sPort, drivemotor_pu8RqstMessage, DRIVEMOTOR_LENGTH_RQST_MSG);
+}
+
+/* valid reply from the frame scanner (UART interrupt), queue it for DRIVEMOTOR_App_Rx() */
+static void drivemotor_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length)
+{
+    uint8_t l_u8Next = (drivemotor_u8RxHead + 1) & (DRIVEMOTOR_RX_QUEUE_SIZE - 1);
+
+    if (l_u8Next == drivemotor_u8RxTail)
+    {
+        DRIVEMOTOR_u32RxDropped++;
+        return;
+    }
+    memcpy(&drivemotor_asRxQueue[drivemotor_u8RxHead].sData, pcu8Frame, u8Length);
+    drivemotor_asRxQueue[drivemotor_u8RxHead].u32Cycles = DWT->CYCCNT;
+    __DMB();
+    drivemotor_u8RxHead = l_u8Next;
+}
+
+/* request to reply time statistics */
+static void drivemotor_rttRecord(uint32_t u32Cycles)
+{
+    uint32_t l_u32Us = u32Cycles / (SystemCoreClock / 1000000U);
+    uint32_t l_u32Bin = l_u32Us / DRIVEMOTOR_RTT_BIN_US;
+
+    if (l_u32Bin >= DRIVEMOTOR_RTT_BINS)
+    {
+        l_u32Bin = DRIVEMOTOR_RTT_BINS - 1;
+    }
+    DRIVEMOTOR_au32RttHisto[l_u32Bin]++;
+    if (l_u32Us < DRIVEMOTOR_u32RttMinUs)
+    {
+        DRIVEMOTOR_u32RttMinUs = l_u32Us;
+    }
+    if (l_u32Us > DRIVEMOTOR_u32RttMaxUs)
+    {
+        DRIVEMOTOR_u32RttMaxUs = l_u32Us;
+    }
+}
+
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+/*
+ * record the reply for drivemotor/capture. A full block is published at once
+ * (serialized in the TX queue, so it can be refilled), else it waits while
+ * the other block fills and is sent again on each reply. If both are full
+ * the newest is given up : a gap, counted and sent with the next block
+ */
+static void drivemotor_capture(uint32_t u32RxCycles)
+{
+    DRIVEMOTOR_Capture_t *l_psBlock = drivemotor_asCapture[drivemotor_u8CaptureFill];
+
+    if (drivemotor_bCapturePending &&
+        drivemotorCapture_handler((const uint8_t *)drivemotor_asCapture[drivemotor_u8CaptureFill ^ 1], sizeof(drivemotor_asCapture[0]), DRIVEMOTOR_u32CaptureLost))
+    {
+        drivemotor_bCapturePending = 0;
+    }
+
+    l_psBlock[drivemotor_u8CaptureLen].u32Cycles = u32RxCycles;
+    memcpy(l_psBlock[drivemotor_u8CaptureLen].au8Frame, &drivemotor_psReceivedData, DRIVEMOTOR_LENGTH_RECEIVED_MSG);
+    if (++drivemotor_u8CaptureLen < DRIVEMOTOR_CAPTURE_RECORDS)
+    {
+        return;
+    }
+    drivemotor_u8CaptureLen = 0;
+    if (drivemotor_bCapturePending)
+    {
+        DRIVEMOTOR_u32CaptureLost++;
+    }
+    else if (!drivemotorCapture_handler((const uint8_t *)l_psBlock, sizeof(drivemotor_asCapture[0]), DRIVEMOTOR_u32CaptureLost))
+    {
+        drivemotor_bCapturePending = 1;
+        drivemotor_u8CaptureFill ^= 1;
+    }
+}
+#endif
+
+/* speeds for the next requests, a new setpoint does not wait for the next reply to reach the speed loop output */
+static void drivemotor_setOutput(uint8_t u8LeftSpeed, uint8_t u8RightSpeed, uint8_t u8LeftDir, uint8_t u8RightDir)
+{
+#if OPTION_SPEED_CONTROL == 1
+    if (u8LeftSpeed != left_speed_out || u8LeftDir != left_dir_out)
+    {
+        SPEED_Setpoint(&drivemotor_asWheel[DRIVEMOTOR_LEFT], u8LeftSpeed, u8LeftDir);
+    }
+    if (u8RightSpeed != right_speed_out || u8RightDir != right_dir_out)
+    {
+        SPEED_Setpoint(&drivemotor_asWheel[DRIVEMOTOR_RIGHT], u8RightSpeed, u8RightDir);
+    }
+#endif
+    left_speed_out = u8LeftSpeed;
+    right_speed_out = u8RightSpeed;
+    left_dir_out = u8LeftDir;
+    right_dir_out = u8RightDir;
+}
+
+#if OPTION_DRIVEMOTOR_RAMP == 1
+/* one ramp step per request, whatever the poll rate, towards the requested speeds */
+static void drivemotor_ramp(void)
+{
+    uint32_t l_u32Now = DWT->CYCCNT;
+    float l_fDt = (float)(l_u32Now - drivemotor_u32RampCycles) / SystemCoreClock;
+    float l_fLeft = (left_dir_req ? 1.0f : -1.0f) * left_speed_req / PWM_PER_MPS;
+    float l_fRight = (right_dir_req ? 1.0f : -1.0f) * right_speed_req / PWM_PER_MPS;
+
+    drivemotor_u32RampCycles = l_u32Now;
+    if (l_fDt > DRIVEMOTOR_RAMP_MAX_DT)
+    {
+        l_fDt = DRIVEMOTOR_RAMP_MAX_DT;
+    }
+
+    l_fLeft = RAMP_fUpdate(&drivemotor_asRamp[0], l_fLeft, drivemotor_fAccMax, drivemotor_fJerkMax, l_fDt);
+    l_fRight = RAMP_fUpdate(&drivemotor_asRamp[1], l_fRight, drivemotor_fAccMax, drivemotor_fJerkMax, l_fDt);
+
+    uint8_t l_u8LeftSpeed = (uint8_t)fminf(fabsf(l_fLeft) * PWM_PER_MPS + 0.5f, 255.0f);
+    uint8_t l_u8RightSpeed = (uint8_t)fminf(fabsf(l_fRight) * PWM_PER_MPS + 0.5f, 255.0f);
+    if (l_u8LeftSpeed == 0 && l_u8RightSpeed == 0)
+    {
+        drivemotor_setOutput(0, 0, 0, 0);
+    }
+    else
+    {
+        drivemotor_setOutput(l_u8LeftSpeed, l_u8RightSpeed, l_fLeft > 0.0f, l_fRight > 0.0f);
+    }
+}
+#endif
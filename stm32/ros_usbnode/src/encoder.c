@@ -0,0 +1,148 @@
+/****************************************************************************
+* Title                 :   encoder module
+* Filename              :   encoder.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file encoder.c
+ *  \brief unwrapping of the 16 bit drive motor encoder counters
+ *
+ *  The PAC5210 reports an unsigned 16 bit tick counter per wheel, the
+ *  direction comes separately. The counter:
+ *  - wraps around at 65536
+ *  - resets to zero when the wheel reverses, and again when it starts
+ *    from standstill, not always in the reply where the direction changed
+ *  - sometimes holds its ticks until the next command and then releases
+ *    them at once
+ *  Each reply gives a new delta, checked against what the wheel can do in
+ *  the time since the counter last changed. Implausible deltas are counted
+ *  and dropped, the counter is then taken as the new reference.
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include "encoder.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Reset a wheel, the accumulated ticks start again from 0
+/// @param psWheel wheel state
+void ENCODER_Init(ENCODER_Wheel_t *psWheel)
+{
+    psWheel->eState = ENCODER_STOPPED;
+    psWheel->s8Direction = 0;
+    psWheel->u16Prev = 0;
+    psWheel->u8Restart = 0;
+    psWheel->u32SinceUs = 0;
+    psWheel->u32Ticks = 0;
+    psWheel->u32Wraps = 0;
+    psWheel->u32Resets = 0;
+    psWheel->u32Held = 0;
+    psWheel->u32Implausible = 0;
+}
+
+/// @brief Unwrap the counter of one reply
+/// @param psWheel wheel state
+/// @param s8Direction 1 forward, -1 backward, 0 stopped
+/// @param u16Raw counter of the reply
+/// @param u32DtUs time since the previous reply (us)
+/// @retval ticks travelled since the previous reply, also added to u32Ticks
+uint16_t ENCODER_u16Update(ENCODER_Wheel_t *psWheel, int8_t s8Direction, uint16_t u16Raw, uint32_t u32DtUs)
+{
+    uint16_t l_u16Delta = 0;
+    uint32_t l_u32Max;
+
+    psWheel->u32SinceUs += u32DtUs;
+    if (psWheel->u32SinceUs > ENCODER_MAX_HOLD_US)
+    {
+        psWheel->u32SinceUs = ENCODER_MAX_HOLD_US;
+    }
+    l_u32Max = ENCODER_MARGIN_TICKS + (ENCODER_MAX_TICKS_PER_S * psWheel->u32SinceUs) / 1000000U;
+
+    if (s8Direction == 0)
+    {
+        /* stopped, whatever the counter shows the next start resets it */
+        psWheel->eState = ENCODER_STOPPED;
+        psWheel->s8Direction = 0;
+        psWheel->u16Prev = u16Raw;
+        psWheel->u32SinceUs = 0;
+        return 0;
+    }
+
+    if (psWheel->eState == ENCODER_STOPPED || s8Direction != psWheel->s8Direction)
+    {
+        psWheel->eState = ENCODER_RESTART;
+        psWheel->u8Restart = ENCODER_RESTART_REPLIES;
+    }
+    psWheel->s8Direction = s8Direction;
+
+    if (u16Raw == psWheel->u16Prev)
+    {
+        /* held, or really not moving, the time keeps counting for the plausibility */
+        psWheel->u32Held++;
+    }
+    else
+    {
+        if (u16Raw > psWheel->u16Prev)
+        {
+            l_u16Delta = u16Raw - psWheel->u16Prev;
+        }
+        else if (psWheel->eState == ENCODER_RUNNING && (uint16_t)(u16Raw - psWheel->u16Prev) <= l_u32Max)
+        {
+            /* modulo 65536 */
+            l_u16Delta = u16Raw - psWheel->u16Prev;
+            psWheel->u32Wraps++;
+        }
+        else
+        {
+            /* restarted from 0 */
+            l_u16Delta = u16Raw;
+            psWheel->u32Resets++;
+            psWheel->eState = ENCODER_RUNNING;
+        }
+
+        if (l_u16Delta > l_u32Max)
+        {
+            psWheel->u32Implausible++;
+            l_u16Delta = 0;
+        }
+        psWheel->u16Prev = u16Raw;
+        psWheel->u32SinceUs = 0;
+    }
+
+    if (psWheel->eState == ENCODER_RESTART && --psWheel->u8Restart == 0)
+    {
+        psWheel->eState = ENCODER_RUNNING;
+    }
+
+    psWheel->u32Ticks += l_u16Delta;
+    return l_u16Delta;
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
@@ -0,0 +1,258 @@
+/****************************************************************************
+* Title                 :   frame module
+* Filename              :   frame.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file frame.c
+ *  \brief 0x55 0xAA framing shared by the peripheral UARTs
+ *
+ *  All the peripherals (drive motors, blade motor, panel, ultrasonic) use
+ *  0x55 0xAA length command ... CRC frames, the CRC being the sum of the
+ *  previous bytes. Each port receives continuously in a circular DMA buffer
+ *  (reception to idle, so the HAL also reports the idle line and the half
+ *  and full buffer). The scanner checks the new bytes in place against the
+ *  port descriptor table and calls the descriptor callback with a pointer
+ *  into the DMA buffer; only a frame wrapping around the buffer end is copied.
+ *  On a mismatch the scan restarts one byte after the start of the frame, so
+ *  a lost byte costs one frame. Transmissions go through a small queue of
+ *  buffers sent one after the other by the TX complete interrupt.
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <string.h>
+#include "stm32f1xx_hal.h"
+
+#include "frame.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+static void frame_startRx(FRAME_Port_t *psPort);
+static const FRAME_Desc_t *frame_psMatch(const FRAME_Port_t *psPort, uint8_t u8Count);
+__STATIC_INLINE uint8_t frame_u8Byte(const FRAME_Port_t *psPort, uint8_t u8Index);
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Set up a port and start the continuous reception, the DMA channel must be in circular mode
+/// @param psPort port state, owned by the peripheral module
+/// @param psUart UART, already initialized with its RX and TX DMA linked
+/// @param pu8Dma reception buffer, a few frames long
+/// @param u16DmaSize size of pu8Dma
+/// @param pcsDesc frames expected on this port
+/// @param u8DescCount number of descriptors
+void FRAME_Init(FRAME_Port_t *psPort, UART_HandleTypeDef *psUart, uint8_t *pu8Dma, uint16_t u16DmaSize, const FRAME_Desc_t *pcsDesc, uint8_t u8DescCount)
+{
+    memset(psPort, 0, sizeof(FRAME_Port_t));
+    psPort->psUart = psUart;
+    psPort->pu8Dma = pu8Dma;
+    psPort->u16DmaSize = u16DmaSize;
+    psPort->pcsDesc = pcsDesc;
+    psPort->u8DescCount = u8DescCount;
+    frame_startRx(psPort);
+}
+
+/// @brief Scan what the DMA received since the last call, from HAL_UARTEx_RxEventCallback and HAL_UART_ErrorCallback
+/// @param psPort port
+/// @retval number of frames given to the callbacks
+uint8_t FRAME_u8ReceiveIT(FRAME_Port_t *psPort)
+{
+    uint8_t l_u8Frames = 0;
+    uint16_t l_u16Write = (psPort->u16DmaSize - __HAL_DMA_GET_COUNTER(psPort->psUart->hdmarx)) % psPort->u16DmaSize;
+    uint16_t l_u16Avail = (l_u16Write + psPort->u16DmaSize - psPort->u16Start) % psPort->u16DmaSize;
+
+    while (psPort->u8Len < l_u16Avail)
+    {
+        psPort->u8Len++;
+        const FRAME_Desc_t *l_pcsDesc = frame_psMatch(psPort, psPort->u8Len);
+        if (l_pcsDesc == NULL)
+        {
+            /* not a header we know, try again from the next byte */
+            psPort->sStats.u32Resync++;
+        }
+        else if (psPort->u8Len < l_pcsDesc->u8Length)
+        {
+            continue;
+        }
+        else
+        {
+            uint8_t l_u8Crc = 0;
+            uint8_t i;
+            for (i = 0; i < l_pcsDesc->u8Length - 1; i++)
+            {
+                l_u8Crc += frame_u8Byte(psPort, i);
+            }
+            if (l_u8Crc == frame_u8Byte(psPort, l_pcsDesc->u8Length - 1))
+            {
+                const uint8_t *l_pcu8Frame = &psPort->pu8Dma[psPort->u16Start];
+                uint16_t l_u16Tail = psPort->u16DmaSize - psPort->u16Start;
+                if (l_u16Tail < l_pcsDesc->u8Length)
+                {
+                    memcpy(psPort->au8Linear, &psPort->pu8Dma[psPort->u16Start], l_u16Tail);
+                    memcpy(&psPort->au8Linear[l_u16Tail], psPort->pu8Dma, l_pcsDesc->u8Length - l_u16Tail);
+                    l_pcu8Frame = psPort->au8Linear;
+                }
+                psPort->sStats.u32Valid++;
+                l_u8Frames++;
+                l_pcsDesc->pfCallback(l_pcu8Frame, l_pcsDesc->u8Length);
+
+                psPort->u16Start = (psPort->u16Start + l_pcsDesc->u8Length) % psPort->u16DmaSize;
+                l_u16Avail -= l_pcsDesc->u8Length;
+                psPort->u8Len = 0;
+                continue;
+            }
+            psPort->sStats.u32CrcError++;
+            psPort->sStats.u32Resync++;
+        }
+        psPort->u16Start = (psPort->u16Start + 1) % psPort->u16DmaSize;
+        l_u16Avail--;
+        psPort->u8Len = 0;
+    }
+
+    /* the HAL stopped the reception (UART error, or the DMA is not circular) */
+    if (psPort->psUart->RxState == HAL_UART_STATE_READY)
+    {
+        if (psPort->psUart->ErrorCode != HAL_UART_ERROR_NONE)
+        {
+            psPort->sStats.u32UartError++;
+        }
+        frame_startRx(psPort);
+    }
+    return l_u8Frames;
+}
+
+/// @brief Send a frame now or after the ones already queued
+/// @param psPort port
+/// @param pcu8Data frame, not copied : it must stay unchanged until sent
+/// @param u8Length frame length
+/// @retval 1 sent or queued, 0 dropped
+uint8_t FRAME_bSend(FRAME_Port_t *psPort, const uint8_t *pcu8Data, uint8_t u8Length)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (psPort->bTxBusy)
+    {
+        uint8_t l_u8Next = (psPort->u8TxHead + 1) & (FRAME_TX_QUEUE - 1);
+        if (l_u8Next == psPort->u8TxTail)
+        {
+            psPort->sStats.u32TxDropped++;
+            __set_PRIMASK(primask);
+            return 0;
+        }
+        psPort->apcu8Tx[psPort->u8TxHead] = pcu8Data;
+        psPort->au8TxLength[psPort->u8TxHead] = u8Length;
+        psPort->u8TxHead = l_u8Next;
+        __set_PRIMASK(primask);
+        return 1;
+    }
+    psPort->bTxBusy = 1;
+    __set_PRIMASK(primask);
+
+    if (HAL_UART_Transmit_DMA(psPort->psUart, (uint8_t *)pcu8Data, u8Length) != HAL_OK)
+    {
+        psPort->bTxBusy = 0;
+        psPort->sStats.u32TxDropped++;
+        return 0;
+    }
+    return 1;
+}
+
+/// @brief Start the next queued frame, from HAL_UART_TxCpltCallback
+/// @param psPort port
+void FRAME_TxCpltIT(FRAME_Port_t *psPort)
+{
+    psPort->sStats.u32TxDone++;
+    while (psPort->u8TxTail != psPort->u8TxHead)
+    {
+        uint8_t l_u8Tail = psPort->u8TxTail;
+        psPort->u8TxTail = (l_u8Tail + 1) & (FRAME_TX_QUEUE - 1);
+        if (HAL_UART_Transmit_DMA(psPort->psUart, (uint8_t *)psPort->apcu8Tx[l_u8Tail], psPort->au8TxLength[l_u8Tail]) == HAL_OK)
+        {
+            return;
+        }
+        psPort->sStats.u32TxDropped++;
+    }
+    psPort->bTxBusy = 0;
+}
+
+/// @brief Get a copy of the port counters
+/// @param psPort port
+/// @param psStats destination
+void FRAME_GetStats(const FRAME_Port_t *psPort, FRAME_Stats_t *psStats)
+{
+    *psStats = psPort->sStats;
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
+
+/* (re)start the circular reception from the beginning of the buffer */
+static void frame_startRx(FRAME_Port_t *psPort)
+{
+    psPort->u16Start = 0;
+    psPort->u8Len = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(psPort->psUart, psPort->pu8Dma, psPort->u16DmaSize);
+}
+
+/* first descriptor matching the first u8Count bytes of the current frame */
+static const FRAME_Desc_t *frame_psMatch(const FRAME_Port_t *psPort, uint8_t u8Count)
+{
+    uint8_t d;
+    uint8_t i;
+
+    for (d = 0; d < psPort->u8DescCount; d++)
+    {
+        const FRAME_Desc_t *l_pcsDesc = &psPort->pcsDesc[d];
+        uint8_t l_u8Check = u8Count < l_pcsDesc->u8PreambleLength ? u8Count : l_pcsDesc->u8PreambleLength;
+
+        if (u8Count > l_pcsDesc->u8Length)
+        {
+            continue;
+        }
+        for (i = 0; i < l_u8Check; i++)
+        {
+            if (frame_u8Byte(psPort, i) != l_pcsDesc->pcu8Preamble[i])
+            {
+                break;
+            }
+        }
+        if (i < l_u8Check)
+        {
+            continue;
+        }
+        if (u8Count > 2 && frame_u8Byte(psPort, 2) != l_pcsDesc->u8Length - FRAME_OVERHEAD)
+        {
+            continue;
+        }
+        return l_pcsDesc;
+    }
+    return NULL;
+}
+
+/* byte u8Index of the current frame, in the circular buffer */
+__STATIC_INLINE uint8_t frame_u8Byte(const FRAME_Port_t *psPort, uint8_t u8Index)
+{
+    return psPort->pu8Dma[(psPort->u16Start + u8Index) % psPort->u16DmaSize];
+}
@@ -36,12 +36,14 @@
 #include "perimeter.h"
 #include "adc.h"
 #include "charger.h"
+#include "battery.h"
 #include "soft_i2c.h"
 #include "i2c.h"
 #include "imu/imu.h"
 #include "usb_device.h"
 #include "usbd_cdc_if.h"
-#include "nbt.h"
+#include "scheduler.h"
+#include "recorder.h"
 
 // ros
 #include "cpp_main.h"
@@ -52,15 +54,44 @@ static void WATCHDOG_Refresh(void);
 void TIM4_Init(void);
 void HALLSTOP_Sensor_Init(void);
 
-static nbt_t main_chargecontroller_nbt;
-static nbt_t main_statusled_nbt;
-static nbt_t main_emergency_nbt;
-static nbt_t main_blademotor_nbt;
-static nbt_t main_drivemotor_nbt;
-static nbt_t main_wdg_nbt;
-static nbt_t main_buzzer_nbt;
+static void main_ChargeControllerTask(void);
+static void main_EmergencyTask(void);
+static void main_BlademotorTask(void);
+static void main_BuzzerTask(void);
 #if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
-static nbt_t main_ultrasonicsensor_nbt;
+static void main_UltrasonicRxTask(void);
+#endif
+
+static SCHEDULER_Task_t main_chargecontroller_task;
+static SCHEDULER_Task_t main_statusled_task;
+static SCHEDULER_Task_t main_emergency_task;
+static SCHEDULER_Task_t main_blademotor_task;
+static SCHEDULER_Task_t main_bladestatus_task;
+static SCHEDULER_Task_t main_drivemotor_task;
+static SCHEDULER_Task_t main_drivemotor_rx_task;
+static SCHEDULER_Task_t main_wdg_task;
+static SCHEDULER_Task_t main_buzzer_task;
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+static SCHEDULER_Task_t main_ultrasonicsensor_task;
+static SCHEDULER_Task_t main_ultrasonic_rx_task;
+#endif
+#ifdef OPTION_PERIMETER
+static SCHEDULER_Task_t main_perimeter_task;
+#endif
+static SCHEDULER_Task_t main_ros_task;
+static SCHEDULER_Task_t main_chatter_task;
+static SCHEDULER_Task_t main_motors_task;
+static SCHEDULER_Task_t main_panel_task;
+static SCHEDULER_Task_t main_imu_task;
+static SCHEDULER_Task_t main_status_task;
+#if OPTION_ODOMETRY == 1
+static SCHEDULER_Task_t main_odometry_task;
+#endif
+#if OPTION_PROFILER == 1
+static SCHEDULER_Task_t main_diagnostics_task;
+#endif
+#if OPTION_RECORDER == 1
+static SCHEDULER_Task_t main_recorder_task;
 #endif
 volatile uint8_t master_tx_busy = 0;
 static uint8_t master_tx_buffer_len;
@@ -113,6 +144,7 @@ int main(void)
   DB_TRACE(" * LED initialized\r\n");
   TIM2_Init();
   ADC2_Init();
+  BATTERY_Init();
   #ifdef OPTION_PERIMETER
   Perimeter_vInit();
   #endif
@@ -157,6 +189,9 @@ int main(void)
 
 
 // Init Drive Motors and Blade Motor
+#if OPTION_RECORDER == 1
+  RECORDER_Init();
+#endif
 #ifdef DRIVEMOTORS_USART_ENABLED
   DRIVEMOTOR_Init();
   DB_TRACE(" * Drive Motors USART initialized\r\n");
@@ -171,20 +206,6 @@ int main(void)
   HAL_GPIO_WritePin(LED_GPIO_PORT, LED_PIN, 0);
   HAL_GPIO_WritePin(TF4_GPIO_PORT, TF4_PIN, 1);
 
-  // Initialize Main Timers
-  NBT_init(&main_chargecontroller_nbt, 10);
-  NBT_init(&main_statusled_nbt, 1000);
-  NBT_init(&main_emergency_nbt, 10);
-#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
-  NBT_init(&main_ultrasonicsensor_nbt, 50);
-#endif
-  NBT_init(&main_blademotor_nbt, 100);
-  NBT_init(&main_drivemotor_nbt, 20);
-  NBT_init(&main_wdg_nbt, 10);
-  NBT_init(&main_buzzer_nbt, 200);
-
-  DB_TRACE(" * NBT Main timers initialized\r\n");
-
 #ifdef I_DONT_NEED_MY_FINGERS
   DB_TRACE("\r\n\e[01;31m");
   DB_TRACE("=========================================================\r\n");
@@ -200,98 +221,109 @@ int main(void)
   chirp(2);
 
   WATCHDOG_vInit();
-  
+
+  // Initialize Main Tasks, tasks sharing a period get different phases (ms)
+  SCHEDULER_Init();
+  SCHEDULER_AddPeriodic(&main_wdg_task, "watchdog", WATCHDOG_Refresh, 10, 0);
+  SCHEDULER_AddPeriodic(&main_emergency_task, "emergency", main_EmergencyTask, 10, 1);
+  SCHEDULER_AddPeriodic(&main_chargecontroller_task, "charger", main_ChargeControllerTask, CHARGER_PERIOD, 2);
+  SCHEDULER_AddPeriodic(&main_ros_task, "ros_spin", spinOnce, 10, 3);
+  SCHEDULER_AddPeriodic(&main_motors_task, "motors", motors_handler, 20, 4);
+  SCHEDULER_AddPeriodic(&main_drivemotor_task, "drivemotor", DRIVEMOTOR_App_Poll, 1000 / DRIVEMOTOR_POLL_HZ, 5);
+  SCHEDULER_AddPeriodic(&main_imu_task, "imu", broadcast_handler, 20, 6);
+#if OPTION_ODOMETRY == 1
+  SCHEDULER_AddPeriodic(&main_odometry_task, "odometry", odometry_handler, ODOM_PUBLISH_TIME_MS, 10);
+#endif
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+  SCHEDULER_AddPeriodic(&main_ultrasonicsensor_task, "ultrasonic", ULTRASONICSENSOR_App, 50, 7);
+#endif
+  SCHEDULER_AddPeriodic(&main_panel_task, "panel", panel_handler, 100, 8);
+  SCHEDULER_AddPeriodic(&main_blademotor_task, "blademotor", main_BlademotorTask, 1000 / BLADEMOTOR_POLL_HZ, 9);
+  SCHEDULER_AddPeriodic(&main_bladestatus_task, "bladestatus", blademotor_handler, 100, 14);
+  SCHEDULER_AddPeriodic(&main_buzzer_task, "buzzer", main_BuzzerTask, 200, 11);
+  SCHEDULER_AddPeriodic(&main_status_task, "status", status_handler, 250, 13);
+  SCHEDULER_AddPeriodic(&main_statusled_task, "statusled", StatusLEDUpdate, 1000, 15);
+  SCHEDULER_AddPeriodic(&main_chatter_task, "chatter", chatter_handler, 1000, 17);
+#if OPTION_PROFILER == 1
+  SCHEDULER_AddPeriodic(&main_diagnostics_task, "diagnostics", diagnostics_handler, 250, 19);
+#endif
+#if OPTION_RECORDER == 1
+  SCHEDULER_AddPeriodic(&main_recorder_task, "recorder", recorder_handler, 20, 12);
+#endif
+#ifdef OPTION_PERIMETER
+  // polls the end of the ADC1 DMA, debug output needs several runs per buffer
+  SCHEDULER_AddPeriodic(&main_perimeter_task, "perimeter", Perimeter_vApp, 1, 0);
+#endif
+  SCHEDULER_AddEvent(&main_drivemotor_rx_task, "drivemotor_rx", DRIVEMOTOR_App_Rx);
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+  SCHEDULER_AddEvent(&main_ultrasonic_rx_task, "ultrasonic_rx", main_UltrasonicRxTask);
+#endif
+
   while (1)
   {
-    chatter_handler();
-    motors_handler();
-    panel_handler();
-    spinOnce();
-    broadcast_handler();
-
-    DRIVEMOTOR_App_Rx();
-    #ifdef OPTION_PERIMETER
-    Perimeter_vApp();
-    #endif
+    SCHEDULER_Run();
+  }
+}
 
-    if (NBT_handler(&main_chargecontroller_nbt))
-    {
-      ADC_input();
-      ChargeController();
-    }
-    if (NBT_handler(&main_statusled_nbt))
-    {
-      StatusLEDUpdate();
+static void main_ChargeControllerTask(void)
+{
+  ADC_input();
+  ChargeController();
+  BATTERY_Update();
+}
 
-      // DB_TRACE("master_rx_STATUS: %d  drivemotors_rx_buf_idx: %d  cnt_usart2_overrun: %x\r\n", master_rx_STATUS, drivemotors_rx_buf_idx, cnt_usart2_overrun);
-    }
-#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
-    /* try to send ros message without delay*/
-    if (ULTRASONIC_MessageReceived() == 1)
-    {
-      ultrasonic_handler();
-    }
-    if (NBT_handler(&main_ultrasonicsensor_nbt))
-    {
-      ULTRASONICSENSOR_App();
-    }
+static void main_EmergencyTask(void)
+{
+#ifndef I_DONT_NEED_MY_FINGERS
+  EmergencyController();
 #endif
-    if (NBT_handler(&main_wdg_nbt))
-    {
-      WATCHDOG_Refresh();
-    }
-
-    if (NBT_handler(&main_drivemotor_nbt))
-    {
-      DRIVEMOTOR_App_10ms();
-    }
+}
 
-    if (NBT_handler(&main_blademotor_nbt))
-    {
-      BLADEMOTOR_App();
+static void main_BlademotorTask(void)
+{
+  BLADEMOTOR_App();
 
 #ifdef OPTION_PERIMETER
-      if (!Perimeter_UsesDebug())
+  if (!Perimeter_UsesDebug())
 #endif
-      {
-        uint32_t currentTick;
-        static uint32_t old_tick;
-        DB_TRACE(" temp : %.2f \n",blade_temperature);
-        currentTick = HAL_GetTick();
-        DB_TRACE(" Current ticktime: %d    \r", (currentTick - old_tick));
-        old_tick = currentTick;
-      }
-    }
+  {
+    uint32_t currentTick;
+    static uint32_t old_tick;
+    DB_TRACE(" temp : %.2f \n",blade_temperature);
+    currentTick = HAL_GetTick();
+    DB_TRACE(" Current ticktime: %d    \r", (currentTick - old_tick));
+    old_tick = currentTick;
+  }
+}
 
-    if (NBT_handler(&main_buzzer_nbt))
-    {
-      // TODO
-      if (do_chirp)
-      {
-        TIM3_Handle.Instance->CCR4 = 10; // chirp on
-        TIM4_Handle.Instance->CCR3 = 10; // chirp on
-        do_chirp = 0;
-        do_chirp_duration_counter = 0;
-      }
-      if (do_chirp_duration_counter == 1)
-      {
-        TIM3_Handle.Instance->CCR4 = 0; // chirp off
-        TIM4_Handle.Instance->CCR3 = 0; // chirp off
-      }
-      do_chirp_duration_counter++;
-    }
+static void main_BuzzerTask(void)
+{
+  // TODO
+  if (do_chirp)
+  {
+    TIM3_Handle.Instance->CCR4 = 10; // chirp on
+    TIM4_Handle.Instance->CCR3 = 10; // chirp on
+    do_chirp = 0;
+    do_chirp_duration_counter = 0;
+  }
+  if (do_chirp_duration_counter == 1)
+  {
+    TIM3_Handle.Instance->CCR4 = 0; // chirp off
+    TIM4_Handle.Instance->CCR3 = 0; // chirp off
+  }
+  do_chirp_duration_counter++;
+}
 
-#ifndef I_DONT_NEED_MY_FINGERS
-    if (NBT_handler(&main_emergency_nbt))
-    {
-      EmergencyController();
-    }
-#endif
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+/* try to send ros message without delay */
+static void main_UltrasonicRxTask(void)
+{
+  if (ULTRASONIC_MessageReceived() == 1)
+  {
+    ultrasonic_handler();
   }
-  /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-  // we never get here ...
-  /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 }
+#endif
 
 /**
  * @brief Init the Master Serial Port  - this what connects to the upstream controller
@@ -336,7 +368,7 @@ void MASTER_USART_Init()
   hdma_uart4_rx.Init.MemInc = DMA_MINC_ENABLE;
   hdma_uart4_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
   hdma_uart4_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-  hdma_uart4_rx.Init.Mode = DMA_NORMAL;
+  hdma_uart4_rx.Init.Mode = DMA_CIRCULAR; /* continuous reception, see FRAME_Init() */
   hdma_uart4_rx.Init.Priority = DMA_PRIORITY_LOW;
   if (HAL_DMA_Init(&hdma_uart4_rx) != HAL_OK)
   {
@@ -730,15 +762,15 @@ void StatusLEDUpdate(void)
     PANEL_Set_LED(PANEL_LED_LIFTED, PANEL_LED_OFF);
   }
 
-  if (chargecontrol_is_charging == 1) // Connected to charger
+  if ((chargecontrol_is_charging == CHARGER_STATE_CONNECTED) || (chargecontrol_is_charging == CHARGER_STATE_END_CHARGING))
   {
     PANEL_Set_LED(PANEL_LED_CHARGING, PANEL_LED_ON);
   }
-  else if (chargecontrol_is_charging == 2) // CC mode 1A
+  else if (chargecontrol_is_charging == CHARGER_STATE_CHARGING_CC)
   {
     PANEL_Set_LED(PANEL_LED_CHARGING, PANEL_LED_FLASH_FAST);
   }
-  else if (chargecontrol_is_charging == 3) // CV mode
+  else if (chargecontrol_is_charging == CHARGER_STATE_CHARGING_CV)
   {
     PANEL_Set_LED(PANEL_LED_CHARGING, PANEL_LED_FLASH_SLOW);
   }
@@ -925,9 +957,13 @@ static void WATCHDOG_Refresh(void)
   }
 }
 
+/*
+ * the HAL stops the DMA reception on errors (overrun ...)
+ * the receive handlers restart it and count the error
+ */
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
 {
-  // do nothing here
+  HAL_UARTEx_RxEventCallback(huart, 0);
 }
 
 /*
@@ -942,6 +978,17 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
     {
       master_tx_busy = 0;
     }
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+    ULTRASONICSENSOR_TxCpltIT();
+#endif
+  }
+  else if (huart->Instance == DRIVEMOTORS_USART_INSTANCE)
+  {
+    DRIVEMOTOR_TxCpltIT();
+  }
+  else if (huart->Instance == BLADEMOTOR_USART_INSTANCE)
+  {
+    BLADEMOTOR_TxCpltIT();
   }
 }
 
@@ -951,24 +998,35 @@ void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart)
 }
 
 /*
- * Master UART receive ISR
- * DriveMotors UART receive ISR
- * PANEL UART receive ISR
+ * peripheral UARTs receive in circular DMA (see frame.c) : IDLE line, half and full buffer
+ * scan the new bytes and run the decoding tasks if frames were received
  */
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
-  if (huart->Instance == MASTER_USART_INSTANCE)
+  if (huart->Instance == DRIVEMOTORS_USART_INSTANCE)
   {
-#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
-    ULTRASONICSENSOR_ReceiveIT();
-#endif
+    if (DRIVEMOTOR_ReceiveIT() > 0)
+    {
+      SCHEDULER_Post(&main_drivemotor_rx_task);
+    }
   }
   else if (huart->Instance == BLADEMOTOR_USART_INSTANCE)
   {
     BLADEMOTOR_ReceiveIT();
   }
-  else if (huart->Instance == DRIVEMOTORS_USART_INSTANCE)
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+  else if (huart->Instance == MASTER_USART_INSTANCE)
   {
-    DRIVEMOTOR_ReceiveIT();
+    if (ULTRASONICSENSOR_ReceiveIT() > 0)
+    {
+      SCHEDULER_Post(&main_ultrasonic_rx_task);
+    }
   }
+#endif
+#ifdef PANEL_USART_ENABLED
+  else if (huart->Instance == PANEL_USART_INSTANCE)
+  {
+    PANEL_ReceiveIT();
+  }
+#endif
 }
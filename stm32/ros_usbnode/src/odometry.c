@@ -0,0 +1,135 @@
+/****************************************************************************
+* Title                 :   odometry module
+* Filename              :   odometry.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file odometry.c
+ *  \brief wheel odometry integration
+ *
+ *  Integrates x/y/theta from the accumulated encoder ticks on every drive
+ *  motor reply (20ms), so the pose does not depend on when the USB link
+ *  delivers the wheel ticks to the host. The position and heading variances
+ *  grow with the distance travelled and the angle turned.
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <math.h>
+#include "stm32f1xx_hal.h"
+
+#include "main.h"
+#include "odometry.h"
+
+#if OPTION_ODOMETRY == 1
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define ODOMETRY_PI 3.14159265f
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static ODOMETRY_Pose_t odometry_sPose;
+static uint32_t odometry_u32PrevLeftTicks;
+static uint32_t odometry_u32PrevRightTicks;
+static uint8_t odometry_bFirst = 1;
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Reset the pose to the origin, the next reply only sets the tick reference
+/// @param
+void ODOMETRY_Init(void)
+{
+    odometry_sPose.fX = 0.0f;
+    odometry_sPose.fY = 0.0f;
+    odometry_sPose.fTheta = 0.0f;
+    odometry_sPose.fV = 0.0f;
+    odometry_sPose.fW = 0.0f;
+    odometry_sPose.fVarXY = 0.0f;
+    odometry_sPose.fVarTheta = 0.0f;
+    odometry_sPose.u32Stamp = HAL_GetTick();
+    odometry_bFirst = 1;
+}
+
+/// @brief Integrate one drive motor reply
+/// @param s8LeftDirection 1 forward, -1 backward, 0 stopped
+/// @param s8RightDirection 1 forward, -1 backward, 0 stopped
+/// @param u32LeftTicks accumulated left ticks (unsigned)
+/// @param u32RightTicks accumulated right ticks (unsigned)
+void ODOMETRY_Update(int8_t s8LeftDirection, int8_t s8RightDirection, uint32_t u32LeftTicks, uint32_t u32RightTicks)
+{
+    uint32_t l_u32Now = HAL_GetTick();
+    uint32_t l_u32Dt = l_u32Now - odometry_sPose.u32Stamp;
+
+    if (odometry_bFirst)
+    {
+        odometry_bFirst = 0;
+        odometry_u32PrevLeftTicks = u32LeftTicks;
+        odometry_u32PrevRightTicks = u32RightTicks;
+        odometry_sPose.u32Stamp = l_u32Now;
+        return;
+    }
+
+    /* accumulated ticks only grow, the sign comes with the direction of the reply */
+    float l_fLeft = (float)(u32LeftTicks - odometry_u32PrevLeftTicks) * s8LeftDirection / TICKS_PER_M;
+    float l_fRight = (float)(u32RightTicks - odometry_u32PrevRightTicks) * s8RightDirection / TICKS_PER_M;
+    odometry_u32PrevLeftTicks = u32LeftTicks;
+    odometry_u32PrevRightTicks = u32RightTicks;
+
+    float l_fDist = (l_fLeft + l_fRight) * 0.5f;
+    float l_fDTheta = (l_fRight - l_fLeft) / WHEEL_BASE;
+
+    /* second order Runge-Kutta, heading at the middle of the step */
+    float l_fMidTheta = odometry_sPose.fTheta + l_fDTheta * 0.5f;
+    odometry_sPose.fX += l_fDist * cosf(l_fMidTheta);
+    odometry_sPose.fY += l_fDist * sinf(l_fMidTheta);
+    odometry_sPose.fTheta += l_fDTheta;
+    if (odometry_sPose.fTheta > ODOMETRY_PI)
+    {
+        odometry_sPose.fTheta -= 2.0f * ODOMETRY_PI;
+    }
+    else if (odometry_sPose.fTheta < -ODOMETRY_PI)
+    {
+        odometry_sPose.fTheta += 2.0f * ODOMETRY_PI;
+    }
+
+    odometry_sPose.fVarXY += ODOMETRY_VAR_XY_PER_M * fabsf(l_fDist);
+    odometry_sPose.fVarTheta += ODOMETRY_VAR_YAW_PER_RAD * fabsf(l_fDTheta) + ODOMETRY_VAR_YAW_PER_M * fabsf(l_fDist);
+
+    if (l_u32Dt > 0)
+    {
+        odometry_sPose.fV = l_fDist * 1000.0f / l_u32Dt;
+        odometry_sPose.fW = l_fDTheta * 1000.0f / l_u32Dt;
+    }
+    odometry_sPose.u32Stamp = l_u32Now;
+}
+
+/// @brief Get a copy of the current pose
+/// @param psPose destination
+void ODOMETRY_GetPose(ODOMETRY_Pose_t *psPose)
+{
+    *psPose = odometry_sPose;
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
+
+#endif /* OPTION_ODOMETRY */
@@ -19,10 +19,13 @@
 #include "panel.h"
 #include "board.h"
 #include "main.h"
+#include "frame.h"
 
 #define PANEL_LENGTH_INIT_MSG 22
 #define PANEL_LENGTH_RQST_MSG 18
-#define PANEL_LENGTH_RECEIVED_MSG 20
+#define PANEL_LENGTH_RECEIVED_MSG 14
+/* circular receive DMA buffer */
+#define PANEL_RX_DMA_SIZE 64
 
 void PANEL_SendLEDMessage(void);
 
@@ -66,6 +69,18 @@ static uint8_t panel_pu8RqstMessage[50]  = {0};
 
 const uint8_t panel_pcu8PreAmbule[5]  = {0x55,0xAA,0x0A,0x50,0x3C};
 
+#ifdef PANEL_USART_ENABLED
+static void panel_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length);
+
+/* only the buttons message is decoded */
+static const FRAME_Desc_t panel_pcsFrames[] = {
+    {panel_pcu8PreAmbule, sizeof(panel_pcu8PreAmbule), PANEL_LENGTH_RECEIVED_MSG, panel_rxFrame},
+};
+
+static uint8_t panel_au8RxDma[PANEL_RX_DMA_SIZE];
+static FRAME_Port_t panel_sPort;
+#endif
+
 static uint8_t panel_u8OldStateButtonStart = 0;
 static uint8_t panel_u8OldStateButtonHome = 0;
 
@@ -129,7 +144,7 @@ void PANEL_Init(void)
     hdma_uart1_rx.Init.MemInc = DMA_MINC_ENABLE;
     hdma_uart1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_uart1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
-    hdma_uart1_rx.Init.Mode = DMA_NORMAL;
+    hdma_uart1_rx.Init.Mode = DMA_CIRCULAR;
     hdma_uart1_rx.Init.Priority = DMA_PRIORITY_LOW;
     if (HAL_DMA_Init(&hdma_uart1_rx) != HAL_OK)
     {
@@ -195,9 +210,8 @@ void PANEL_Init(void)
     memset(Led_States, 0x0, LED_STATE_SIZE);    
     PANEL_SendLEDMessage();
 
-    /* prepare to receive the next message */
-    HAL_UARTEx_ReceiveToIdle_DMA(&PANEL_USART_Handler,panel_pu8ReceivedData,PANEL_LENGTH_RECEIVED_MSG);
-    __HAL_DMA_DISABLE_IT(&hdma_uart1_rx, DMA_IT_HT);
+    /* receive continuously, the messages are framed by the 0x55 0xAA scanner */
+    FRAME_Init(&panel_sPort, &PANEL_USART_Handler, panel_au8RxDma, PANEL_RX_DMA_SIZE, panel_pcsFrames, sizeof(panel_pcsFrames) / sizeof(FRAME_Desc_t));
 
 #endif
 }
@@ -345,25 +359,25 @@ void PANEL_Send_Message(uint8_t *data, uint8_t dataLength, uint16_t command)
 }
 
 
-void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+#ifdef PANEL_USART_ENABLED
+/// @brief panel receive interrupt handler, scans what the DMA received since the last call
+/// @retval number of buttons messages received
+uint8_t PANEL_ReceiveIT(void)
 {
-	if (huart->Instance == PANEL_USART_INSTANCE)
-	{
-        /* take only the buttons message */
-        if(Size == PANEL_LENGTH_RECEIVED_MSG ){
-                    /* decode the frame */
-            if(memcmp(panel_pcu8PreAmbule,panel_pu8ReceivedData,5) == 0){
-                uint8_t l_u8crc = crcCalc(panel_pu8ReceivedData,14-1);
-                if(panel_pu8ReceivedData[14-1] == l_u8crc ){
-                    Frame_Received_Panel = 1;
-                }
-            }
-        }
-
+    return FRAME_u8ReceiveIT(&panel_sPort);
+}
 
-        /* prepare to receive the next message */
-        HAL_UARTEx_ReceiveToIdle_DMA(&PANEL_USART_Handler,panel_pu8ReceivedData,PANEL_LENGTH_RECEIVED_MSG);
-        __HAL_DMA_DISABLE_IT(&hdma_uart1_rx, DMA_IT_HT);
+/// @brief Get a copy of the panel UART counters
+/// @param psStats destination
+void PANEL_GetLinkStats(FRAME_Stats_t *psStats)
+{
+    FRAME_GetStats(&panel_sPort, psStats);
+}
 
-	}
-}
\ No newline at end of file
+/* buttons message from the frame scanner (UART interrupt), PANEL_Tick() decodes it */
+static void panel_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length)
+{
+    memcpy(panel_pu8ReceivedData, pcu8Frame, u8Length);
+    Frame_Received_Panel = 1;
+}
+#endif
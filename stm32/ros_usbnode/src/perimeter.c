@@ -24,7 +24,9 @@
 /******************************************************************************
 * Module Preprocessor Constants
 *******************************************************************************/
-#define PERIMETER_NBPTS 1284 /* 12 ms / 9.333 µs */
+#define PERIMETER_NBPTS 642 /* one capture, 6 ms / 9.333 µs */
+/* captures in the circular DMA buffer : one is processed while the other fills */
+#define PERIMETER_BUFFERS 2
 #define PERIMETER_OVERSAMPLING 3
 #define PERIMETER_AVERAGE_N 3
 
@@ -48,11 +50,22 @@ static const int32_t sigcode1[]={ -2, -2, -2, 2, 2, 2, -2, -2, 2, 2, 2, 2, 2, 2,
 #define SIGCODE1_LENGTH (sizeof(sigcode1)/sizeof(int32_t))
 static const int32_t sigcode2[]={ -2, -3, 0, 3, 3, -1, -2, -1, 3, 3, 3, 3, 3, 2, 0, -2, -2, -2, -2, -2, -2, -2, -2, -2, 3, 3, 3, 3, 3, 3, 1, 0, -1, -2, -2, -2, -2, -2, -2, -1, -1 };
 #define SIGCODE2_LENGTH (sizeof(sigcode2)/sizeof(int32_t))
-uint16_t pu16_PerimeterADC_buffer[PERIMETER_NBPTS]; /* Input from perimeter coil */
-
-bool perimeter_bFlagIT = false;
+/* one more than the longest code */
+#define KERNEL_MAX (SIGCODE2_LENGTH+1)
+uint16_t pu16_PerimeterADC_buffer[PERIMETER_BUFFERS*PERIMETER_NBPTS] __ALIGNED(4); /* Input from perimeter coil */
+
+static volatile int8_t perimeter_s8Ready = -1;      /* capture to process, -1 none */
+static int8_t perimeter_s8Print = -1;               /* capture being printed (debug), -1 none */
+static volatile uint32_t perimeter_u32Captures = 0; /* captures completed by the DMA */
+static perimeter_CoilNumber_e perimeter_aeCoil[PERIMETER_BUFFERS]; /* coil of each capture */
+static uint32_t perimeter_u32Overruns = 0;          /* captures overwritten before processed */
 static const int32_t *sigcode=NULL;
 static int sigcode_length;
+/* the code as steps : correlation[i] = sum of kernel_weight[t]*suffix[i+kernel_pos[t]],
+   suffix[k] being the sum of the samples from k. One tap per run of the code */
+static uint8_t kernel_pos[KERNEL_MAX];
+static int32_t kernel_weight[KERNEL_MAX];
+static int kernel_taps=0;
 static int print_pos=-1;
 
 float coilSigSum[COIL_OFF] = {0.0,0.0,0.0};
@@ -63,7 +76,9 @@ perimeter_CoilNumber_e idxCoil = COIL_LEFT;
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
-static double corrFilter(void);
+static double corrFilter(uint16_t *capture);
+static void perimeter_BuildKernel(void);
+static void perimeter_Start(void);
 void perimeter_SetCoil(perimeter_CoilNumber_e idx);
 
 /******************************************************************************
@@ -129,7 +144,7 @@ void Perimeter_vInit(void){
     hdma_adc.Init.MemInc = DMA_MINC_ENABLE;
     hdma_adc.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
     hdma_adc.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
-    hdma_adc.Init.Mode = DMA_NORMAL;
+    hdma_adc.Init.Mode = DMA_CIRCULAR;
     hdma_adc.Init.Priority = DMA_PRIORITY_HIGH;
     if (HAL_DMA_Init(&hdma_adc) != HAL_OK)
     {
@@ -141,40 +156,59 @@ void Perimeter_vInit(void){
   // calibrate  - important for accuracy !
   HAL_ADCEx_Calibration_Start(&ADC_Handle); 
 
-  perimeter_bFlagIT = false;
+  /* started by Perimeter_ListenOn() */
   idxCoil = COIL_OFF;
   perimeter_SetCoil(idxCoil);
-  HAL_ADC_Start_DMA(&ADC_Handle,(uint32_t*)&pu16_PerimeterADC_buffer[0],PERIMETER_NBPTS);
-  __HAL_DMA_DISABLE_IT(&hdma_adc,DMA_IT_HT);
 }
 
 void Perimeter_vApp(void){
+  int8_t buffer;
+  uint32_t captures;
+  uint32_t primask;
 
-  if(sigcode && perimeter_bFlagIT == true){
-    if (print_pos>=0) {
-      if (print_pos<PERIMETER_NBPTS) {
-        for (int c=0; c<4 && print_pos<PERIMETER_NBPTS; c++) {
-          DB_TRACE("%c%d",print_pos ? ',' : '\n',(int32_t) pu16_PerimeterADC_buffer[print_pos]);
-          print_pos++;
-        }
-        return;
-      }
-      print_pos=0;
-    }
-    perimeter_bFlagIT = false;
-
-    if (print_pos<0) {
-      coilSigSum[idxCoil]+=corrFilter();
-      coilSigN[idxCoil]++;
-      idxCoil ++;
-      if(idxCoil == COIL_OFF){
-        idxCoil = COIL_LEFT;
+  if(!sigcode){
+    return;
+  }
+  if (perimeter_s8Print>=0) {
+    /* debug output : the acquisition is stopped while the capture is printed */
+    uint16_t *capture=&pu16_PerimeterADC_buffer[perimeter_s8Print*PERIMETER_NBPTS];
+    if (print_pos<PERIMETER_NBPTS) {
+      for (int c=0; c<4 && print_pos<PERIMETER_NBPTS; c++) {
+        DB_TRACE("%c%d",print_pos ? ',' : '\n',(int32_t) capture[print_pos]);
+        print_pos++;
       }
-      perimeter_SetCoil(idxCoil);
+      return;
     }
-    HAL_ADC_Start_DMA(&ADC_Handle,(uint32_t*)&pu16_PerimeterADC_buffer[0],PERIMETER_NBPTS);
-    __HAL_DMA_DISABLE_IT(&hdma_adc,DMA_IT_HT);
+    print_pos=0;
+    perimeter_s8Print=-1;
+    perimeter_Start();
+    return;
+  }
+
+  primask=__get_PRIMASK();
+  __disable_irq();
+  buffer=perimeter_s8Ready;
+  perimeter_s8Ready=-1;
+  captures=perimeter_u32Captures;
+  __set_PRIMASK(primask);
+  if(buffer<0){
+    return;
+  }
+  if (print_pos>=0) {
+    HAL_ADC_Stop_DMA(&ADC_Handle);
+    perimeter_s8Print=buffer;
+    return;
+  }
+
+  uint16_t *capture=&pu16_PerimeterADC_buffer[buffer*PERIMETER_NBPTS];
+  double sig=corrFilter(capture);
+  /* the DMA is back in this capture once the other one is complete */
+  if (perimeter_u32Captures!=captures) {
+    perimeter_u32Overruns++;
+    return;
   }
+  coilSigSum[perimeter_aeCoil[buffer]]+=sig;
+  coilSigN[perimeter_aeCoil[buffer]]++;
 }
 
 void Perimeter_ListenOn(uint8_t sig) {
@@ -194,21 +228,24 @@ void Perimeter_ListenOn(uint8_t sig) {
     default:
       sigcode=NULL;
   }
+  if (oldsigcode) {
+    HAL_ADC_Stop_DMA(&ADC_Handle);
+  }
+  perimeter_s8Print=-1;
   if (sigcode) {
+    perimeter_BuildKernel();
     print_pos=sig & 0x80 ? 0 : -1;
-    if (!oldsigcode) {
+    if (sig & 0x80) {
+      idxCoil=sig & 3;
+    } else if (!oldsigcode) {
       idxCoil=COIL_LEFT;
-      perimeter_SetCoil(idxCoil);
+    }
+    if (!oldsigcode) {
       for (int i=0; i<COIL_OFF; i++) {
         coilSigSum[i]=coilSigN[i]=0;
       }
-      HAL_ADC_Start_DMA(&ADC_Handle,(uint32_t*)&pu16_PerimeterADC_buffer[0],PERIMETER_NBPTS);
-      __HAL_DMA_DISABLE_IT(&hdma_adc,DMA_IT_HT);
-    }
-    if (sig & 0x80) {
-      idxCoil=sig & 3;
-      perimeter_SetCoil(idxCoil);
     }
+    perimeter_Start();
   } else {
     print_pos=-1;
   }
@@ -235,10 +272,24 @@ int Perimeter_UsesDebug(void) {
   return print_pos>=0;
 }
 
-void PERIMETER_vITHandle(void){
-  /* stop DMA and set flag */
-  HAL_ADC_Stop_DMA(&ADC_Handle);
-  perimeter_bFlagIT = true;
+/* 
+ * half (u8Buffer 0) or full (u8Buffer 1) transfer : this capture is complete
+ * and the DMA goes on with the other one, switch its coil now
+ */
+void PERIMETER_vITHandle(uint8_t u8Buffer){
+  perimeter_aeCoil[u8Buffer] = idxCoil;
+  if (print_pos<0) {
+    idxCoil++;
+    if(idxCoil == COIL_OFF){
+      idxCoil = COIL_LEFT;
+    }
+    perimeter_SetCoil(idxCoil);
+  }
+  if (perimeter_s8Ready>=0) {
+    perimeter_u32Overruns++;
+  }
+  perimeter_s8Ready = u8Buffer;
+  perimeter_u32Captures++;
 }
 
 
@@ -249,7 +300,7 @@ void PERIMETER_vITHandle(void){
  * @brief matched filter (cross correlation)
  * @return detected signal strength
  */
-double corrFilter() {
+double corrFilter(uint16_t *capture) {
 
   /* Calculate oversampling: n=effective number of samples */
   const int n=PERIMETER_NBPTS/PERIMETER_OVERSAMPLING;
@@ -257,31 +308,42 @@ double corrFilter() {
   #error Possible overflow in unit16_t
   #endif
   {
-    uint16_t *p=pu16_PerimeterADC_buffer;
+    uint16_t *p=capture;
     for (int i=0; i<n; i++) {
       uint16_t tmp=*(p++);
       for (int j=PERIMETER_OVERSAMPLING; --j>0; ) {
         tmp+=*(p++);
       }
-      pu16_PerimeterADC_buffer[i]=tmp;
+      capture[i]=tmp;
     }
   }
 
-  /* We store the correlation result in the unused part of the same array! */
+  /* Suffix sums in place, from the end : suffix[k] overwrites samples 2k and
+   * 2k+1, already added. suffix[n] is 0. The correlations then overwrite the
+   * suffix sums, correlation i only reads suffix i and above.
+   */
 #if PERIMETER_OVERSAMPLING<3
 #error Need oversampling for data storage
 #endif
-  int32_t *correlations=(int32_t*) (pu16_PerimeterADC_buffer+n);
+  int32_t *suffix=(int32_t*) capture;
+  {
+    int32_t sum=0;
+    suffix[n]=0;
+    for (int k=n; --k>=0; ) {
+      sum+=capture[k];
+      suffix[k]=sum;
+    }
+  }
+  int32_t *correlations=suffix;
 
   int32_t corr_max_abs=0,corr_max=0; // Maximum (absolute) correlation
   int corr_max_pos; // Position of the maximum correlation
 
   for (int i=0; i<=n-sigcode_length; i++) {
     int32_t sum=0;
-    uint16_t *datap=pu16_PerimeterADC_buffer+i;
-    const int32_t *sigcodep=sigcode;
+    const int32_t *suffixp=suffix+i;
 
-    for (int j=0; j<sigcode_length; j++) sum+=*(datap++)**(sigcodep++);
+    for (int t=0; t<kernel_taps; t++) sum+=kernel_weight[t]*suffixp[kernel_pos[t]];
     correlations[i]=sum;
     if (sum<0) {
       if (-sum>corr_max_abs) {
@@ -332,6 +394,27 @@ double corrFilter() {
   return corr_max/noiseDeviation;
 }
 
+/* (re)start the circular acquisition with the first capture, the DMA must be stopped */
+static void perimeter_Start(void) {
+  perimeter_s8Ready=-1;
+  perimeter_SetCoil(idxCoil);
+  HAL_ADC_Start_DMA(&ADC_Handle,(uint32_t*)pu16_PerimeterADC_buffer,PERIMETER_BUFFERS*PERIMETER_NBPTS);
+}
+
+/* steps of the code : weight c[b]-c[b-1] at each b where the code changes,
+   the code being 0 before and after */
+static void perimeter_BuildKernel(void) {
+  kernel_taps=0;
+  for (int b=0; b<=sigcode_length; b++) {
+    int32_t w=(b<sigcode_length ? sigcode[b] : 0)-(b>0 ? sigcode[b-1] : 0);
+    if (w!=0) {
+      kernel_pos[kernel_taps]=b;
+      kernel_weight[kernel_taps]=w;
+      kernel_taps++;
+    }
+  }
+}
+
 void perimeter_SetCoil(perimeter_CoilNumber_e idx){
   switch (idx)
   {
@@ -0,0 +1,116 @@
+/****************************************************************************
+* Title                 :   profiler module
+* Filename              :   profiler.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file profiler.c
+ *  \brief run time statistics of the main loop tasks
+ *
+ *  The scheduler measures each task run with the DWT cycle counter and
+ *  records it here : count, min/avg/max and a small histogram. Recording is
+ *  a handful of instructions so it can stay enabled on the mower, set
+ *  OPTION_PROFILER to 0 in board.h to remove it completely.
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include "stm32f1xx_hal.h"
+
+#include "profiler.h"
+
+#if OPTION_PROFILER == 1
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Clear the statistics
+/// @param psStats statistics to clear
+void PROFILER_Reset(PROFILER_Stats_t *psStats)
+{
+    uint8_t l_u8Idx;
+
+    psStats->u32Count = 0;
+    psStats->u32Min = UINT32_MAX;
+    psStats->u32Max = 0;
+    psStats->u64Sum = 0;
+    for (l_u8Idx = 0; l_u8Idx < PROFILER_HISTO_BINS; l_u8Idx++)
+    {
+        psStats->au32Histo[l_u8Idx] = 0;
+    }
+}
+
+/// @brief Add one run to the statistics
+/// @param psStats statistics to update
+/// @param u32Cycles run time in cpu cycles
+void PROFILER_Record(PROFILER_Stats_t *psStats, uint32_t u32Cycles)
+{
+    uint32_t l_u32Us = PROFILER_u32CyclesToUs(u32Cycles);
+    /* log4 of the run time in us, 0 for less than 4us */
+    uint32_t l_u32Bin = (31 - __CLZ(l_u32Us | 1)) / 2;
+
+    if (l_u32Bin >= PROFILER_HISTO_BINS)
+    {
+        l_u32Bin = PROFILER_HISTO_BINS - 1;
+    }
+    psStats->au32Histo[l_u32Bin]++;
+
+    psStats->u32Count++;
+    psStats->u64Sum += u32Cycles;
+    if (u32Cycles < psStats->u32Min)
+    {
+        psStats->u32Min = u32Cycles;
+    }
+    if (u32Cycles > psStats->u32Max)
+    {
+        psStats->u32Max = u32Cycles;
+    }
+}
+
+/// @brief Convert cpu cycles to us
+/// @param u32Cycles cpu cycles
+/// @retval time in us
+uint32_t PROFILER_u32CyclesToUs(uint32_t u32Cycles)
+{
+    return u32Cycles / (SystemCoreClock / 1000000U);
+}
+
+/// @brief Average run time
+/// @param psStats statistics
+/// @retval average in cpu cycles, 0 if the task never ran
+uint32_t PROFILER_u32AvgCycles(const PROFILER_Stats_t *psStats)
+{
+    if (psStats->u32Count == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)(psStats->u64Sum / psStats->u32Count);
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
+
+#endif /* OPTION_PROFILER */
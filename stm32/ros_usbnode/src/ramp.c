@@ -0,0 +1,142 @@
+/****************************************************************************
+* Title                 :   ramp module
+* Filename              :   ramp.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file ramp.c
+ *  \brief acceleration and jerk limited speed ramp
+ *
+ *  Moves a speed towards a target with the acceleration limited to fAccMax
+ *  and its rate of change limited to fJerkMax. The acceleration asked for is
+ *  the largest one that can still be brought back to 0, one jerk step per
+ *  update, when the speed reaches the target (the discrete form of
+ *  a^2 / 2j = remaining speed), so the target is reached without overshoot
+ *  unless it changes while the ramp is accelerating hard.
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <math.h>
+
+#include "ramp.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+/* landing allowed with a jerk step this much larger, for the float rounding */
+#define RAMP_ROUNDING 1.0001f
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+static float ramp_fPlan(float fError, float fStep, float fAccMax);
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Restart the ramp at a given speed, without acceleration
+/// @param psRamp ramp state
+/// @param fVel speed (m/s)
+void RAMP_Reset(RAMP_State_t *psRamp, float fVel)
+{
+    psRamp->fVel = fVel;
+    psRamp->fAcc = 0.0f;
+}
+
+/// @brief Advance the ramp by one step
+/// @param psRamp ramp state
+/// @param fTarget speed to reach (m/s)
+/// @param fAccMax acceleration limit (m/s^2)
+/// @param fJerkMax jerk limit (m/s^3)
+/// @param fDt step (s)
+/// @retval the new speed (m/s)
+float RAMP_fUpdate(RAMP_State_t *psRamp, float fTarget, float fAccMax, float fJerkMax, float fDt)
+{
+    float l_fError = fTarget - psRamp->fVel;
+    float l_fStep = fJerkMax * fDt;
+    float l_fAcc;
+
+    if (fDt <= 0.0f)
+    {
+        return psRamp->fVel;
+    }
+
+    /* on the target in this step, with an acceleration that can stop in the next one */
+    l_fAcc = l_fError / fDt;
+    if (fabsf(l_fAcc) <= l_fStep * RAMP_ROUNDING && fabsf(l_fAcc - psRamp->fAcc) <= l_fStep * RAMP_ROUNDING)
+    {
+        psRamp->fVel = fTarget;
+        psRamp->fAcc = l_fAcc;
+        return psRamp->fVel;
+    }
+
+    l_fAcc = ramp_fPlan(fabsf(l_fAcc), l_fStep, fAccMax);
+    if (l_fError < 0.0f)
+    {
+        l_fAcc = -l_fAcc;
+    }
+
+    /* the acceleration follows with the jerk limit */
+    if (l_fAcc > psRamp->fAcc + l_fStep)
+    {
+        psRamp->fAcc += l_fStep;
+    }
+    else if (l_fAcc < psRamp->fAcc - l_fStep)
+    {
+        psRamp->fAcc -= l_fStep;
+    }
+    else
+    {
+        psRamp->fAcc = l_fAcc;
+    }
+
+    psRamp->fVel += psRamp->fAcc * fDt;
+    return psRamp->fVel;
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
+
+/*
+ * largest acceleration a towards the target such that this update and the
+ * next ones, a lowered by fStep each, end on the target. With a in
+ * ((m-1).fStep, m.fStep] the speed still moves by
+ * (m.a - fStep.m(m-1)/2).dt, fError is the remaining speed over dt
+ */
+static float ramp_fPlan(float fError, float fStep, float fAccMax)
+{
+    float l_fAcc = 0.0f;
+    float m;
+
+    if (fStep <= 0.0f)
+    {
+        return 0.0f;
+    }
+    for (m = 1.0f; l_fAcc < fAccMax; m += 1.0f)
+    {
+        if (fStep * m * (m + 1.0f) * 0.5f >= fError)
+        {
+            l_fAcc = (fError + fStep * m * (m - 1.0f) * 0.5f) / m;
+            break;
+        }
+        l_fAcc = m * fStep;
+    }
+    return l_fAcc > fAccMax ? fAccMax : l_fAcc;
+}
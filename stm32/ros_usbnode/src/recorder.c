@@ -0,0 +1,190 @@
+/****************************************************************************
+* Title                 :   recorder module
+* Filename              :   recorder.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file recorder.c
+ *  \brief RAM flight recorder of the motor and power telemetry
+ *
+ *  One record per drive motor reply in a circular buffer : the drive frame,
+ *  the last blade values, the raw ADC channels and the emergency bits. The
+ *  drive motor module fills its part in the slot given by RECORDER_psNext(),
+ *  RECORDER_Commit() adds the rest. Only copies, so it can stay enabled.
+ *  An emergency or a drive motor error triggers the recorder, it takes
+ *  RECORDER_POST_RECORDS more records and freezes until RECORDER_Arm().
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include "stm32f1xx_hal.h"
+
+#include "main.h"
+#include "adc.h"
+#include "blademotor.h"
+#include "emergency.h"
+#include "recorder.h"
+
+#if OPTION_RECORDER == 1
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static RECORDER_Record_t recorder_asRecords[RECORDER_RECORDS];
+static uint16_t recorder_u16Head = 0;       /* next slot */
+static uint16_t recorder_u16Count = 0;
+static uint8_t recorder_u8Trigger = RECORDER_TRIGGER_NONE;
+static uint16_t recorder_u16Post = 0;       /* records left after the trigger */
+static uint8_t recorder_u8PrevEmergency = 0;
+static uint8_t recorder_u8PrevError = 0;
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Clear the records and start recording
+/// @param
+void RECORDER_Init(void)
+{
+    recorder_u16Head = 0;
+    recorder_u16Count = 0;
+    recorder_u8PrevEmergency = 0;
+    recorder_u8PrevError = 0;
+    RECORDER_Arm();
+}
+
+/// @brief Slot for the next record
+/// @param
+/// @retval the slot, NULL while frozen
+RECORDER_Record_t *RECORDER_psNext(void)
+{
+    if (RECORDER_bFrozen())
+    {
+        return NULL;
+    }
+    return &recorder_asRecords[recorder_u16Head];
+}
+
+/// @brief Complete the record with the blade, ADC and emergency values and check the triggers
+/// @param psRecord slot from RECORDER_psNext(), drive fields already set
+void RECORDER_Commit(RECORDER_Record_t *psRecord)
+{
+    psRecord->u32Tick = HAL_GetTick();
+    psRecord->u16BladeRpm = BLADEMOTOR_u16RPM;
+    psRecord->u16BladePower = BLADEMOTOR_u16Power;
+    psRecord->u16BatteryAdc = adc_u16BatteryVoltage;
+    psRecord->u16CurrentAdc = adc_u16Current;
+    psRecord->u16ChargerAdc = adc_u16ChargerVoltage;
+    psRecord->u16ChargerInputAdc = adc_u16ChargerInputVoltage;
+    psRecord->u16NtcAdc = adc_u16Input_NTC;
+    psRecord->u8Emergency = Emergency_State();
+    psRecord->u8Flags = BLADEMOTOR_bActivated ? RECORDER_FLAG_BLADE_ON : 0;
+
+    /* on the rising edge only, an emergency still active after RECORDER_Arm() does not freeze again */
+    if (recorder_u8Trigger == RECORDER_TRIGGER_NONE)
+    {
+        if (psRecord->u8Emergency != 0 && recorder_u8PrevEmergency == 0)
+        {
+            recorder_u8Trigger = RECORDER_TRIGGER_EMERGENCY;
+        }
+        else if (psRecord->u8Error != 0 && recorder_u8PrevError == 0)
+        {
+            recorder_u8Trigger = RECORDER_TRIGGER_DRIVE_ERROR;
+        }
+        if (recorder_u8Trigger != RECORDER_TRIGGER_NONE)
+        {
+            recorder_u16Post = RECORDER_POST_RECORDS;
+            psRecord->u8Flags |= RECORDER_FLAG_TRIGGER;
+        }
+    }
+    else
+    {
+        recorder_u16Post--;
+    }
+    recorder_u8PrevEmergency = psRecord->u8Emergency;
+    recorder_u8PrevError = psRecord->u8Error;
+
+    recorder_u16Head = (recorder_u16Head + 1) % RECORDER_RECORDS;
+    if (recorder_u16Count < RECORDER_RECORDS)
+    {
+        recorder_u16Count++;
+    }
+}
+
+/// @brief Stop recording now, keeps the reason of a trigger already running
+/// @param u8Reason RECORDER_TRIGGER_x
+void RECORDER_Freeze(uint8_t u8Reason)
+{
+    if (recorder_u8Trigger == RECORDER_TRIGGER_NONE)
+    {
+        recorder_u8Trigger = u8Reason;
+    }
+    recorder_u16Post = 0;
+}
+
+/// @brief Record again, the frozen records are overwritten from the oldest
+/// @param
+void RECORDER_Arm(void)
+{
+    recorder_u8Trigger = RECORDER_TRIGGER_NONE;
+    recorder_u16Post = 0;
+}
+
+/// @brief Reason of the trigger
+/// @param
+/// @retval RECORDER_TRIGGER_x, RECORDER_TRIGGER_NONE while recording
+uint8_t RECORDER_u8Trigger(void)
+{
+    return recorder_u8Trigger;
+}
+
+/// @brief Triggered and the post trigger records taken
+/// @param
+/// @retval 1 if frozen
+uint8_t RECORDER_bFrozen(void)
+{
+    return (recorder_u8Trigger != RECORDER_TRIGGER_NONE && recorder_u16Post == 0);
+}
+
+/// @brief Number of records available
+/// @param
+/// @retval count, up to RECORDER_RECORDS
+uint16_t RECORDER_u16Count(void)
+{
+    return recorder_u16Count;
+}
+
+/// @brief Get a record, oldest first
+/// @param u16Idx 0 .. RECORDER_u16Count() - 1
+/// @retval the record, NULL past the last one
+const RECORDER_Record_t *RECORDER_psGet(uint16_t u16Idx)
+{
+    if (u16Idx >= recorder_u16Count)
+    {
+        return NULL;
+    }
+    return &recorder_asRecords[(recorder_u16Head + RECORDER_RECORDS - recorder_u16Count + u16Idx) % RECORDER_RECORDS];
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
+
+#endif /* OPTION_RECORDER */
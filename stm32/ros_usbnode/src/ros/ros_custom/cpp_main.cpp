@@ -21,7 +21,10 @@
 #include "panel.h"
 #include "emergency.h"
 #include "drivemotor.h"
+#include "recorder.h"
 #include "blademotor.h"
+#include "battery.h"
+#include "charger.h"
 #include "ultrasonic_sensor.h"
 #include "stm32f1xx_hal.h"
 #include "ringbuffer.h"
@@ -39,8 +42,12 @@
 #include "std_msgs/UInt32.h"
 #include "std_msgs/Int16MultiArray.h"
 #include "nav_msgs/Odometry.h"
-#include "nbt.h"
 #include "geometry_msgs/Twist.h"
+#include "geometry_msgs/Vector3.h"
+#include "std_msgs/Float32MultiArray.h"
+#include "std_msgs/UInt16MultiArray.h"
+#include "std_msgs/UInt32MultiArray.h"
+#include "std_msgs/UInt8MultiArray.h"
 #include "std_srvs/SetBool.h"
 #include "std_srvs/Empty.h"
 
@@ -49,6 +56,7 @@
 #include "sensor_msgs/Imu.h"
 #include "sensor_msgs/Range.h"
 #include "sensor_msgs/Temperature.h"
+#include "sensor_msgs/BatteryState.h"
 
 // Flash Configuration Services
 #include "mowgli/SetCfg.h"
@@ -65,19 +73,27 @@
 #include "mower_msgs/HighLevelControlSrv.h"
 #include "mower_msgs/HighLevelStatus.h"
 
+#if OPTION_ODOMETRY == 1
+	#include "odometry.h"
+#endif
+
+#if OPTION_PROFILER == 1
+	#include <stdio.h>
+	#include "scheduler.h"
+	#include "diagnostic_msgs/DiagnosticArray.h"
+#endif
+
 #ifdef OPTION_PERIMETER
 	#include "perimeter.h"
 	#include "mower_msgs/Perimeter.h"
 	#include "mower_msgs/PerimeterControlSrv.h"
 #endif
 
-#define ODOM_NBT_TIME_MS 100
-#define IMU_NBT_TIME_MS 20
-#define MOTORS_NBT_TIME_MS 20
-#define STATUS_NBT_TIME_MS 250
+#define HIGH_LEVEL_CONTROL_TIMEOUT_MS 1000
 
 uint8_t RxBuffer[RxBufferSize];
 struct ringbuffer rb;
+volatile uint32_t usb_rx_cycles; // DWT stamp of the first byte of the current USB burst
 
 ros::Time last_cmd_vel(0, 0);
 double last_cmd_vel_age; // age of last velocity command
@@ -162,6 +178,7 @@ void cbGetCfg(const mowgli::GetCfgRequest &req, mowgli::GetCfgResponse &res);
 void cbEnableMowerMotor(const mower_msgs::MowerControlSrvRequest &req, mower_msgs::MowerControlSrvResponse &res);
 void cbSetEmergency(const mower_msgs::EmergencyStopSrvRequest &req, mower_msgs::EmergencyStopSrvResponse &res);
 void cbReboot(const std_srvs::Empty::Request &req, std_srvs::Empty::Response &res);
+void cbHighLevelControl(const mower_msgs::HighLevelControlSrvResponse &res, bool timed_out);
 
 // ros::ServiceServer<mowgli::SetCfgRequest, mowgli::SetCfgResponse> svcSetCfg("mowgli/SetCfg", cbSetCfg);
 // ros::ServiceServer<mowgli::GetCfgRequest, mowgli::GetCfgResponse> svcGetCfg("mowgli/GetCfg", cbGetCfg);
@@ -170,6 +187,33 @@ ros::ServiceServer<mower_msgs::EmergencyStopSrvRequest, mower_msgs::EmergencySto
 ros::ServiceClient<mower_msgs::HighLevelControlSrvRequest, mower_msgs::HighLevelControlSrvResponse> svcHighLevelControl("mower_service/high_level_control");
 ros::ServiceServer<std_srvs::Empty::Request, std_srvs::Empty::Response> svcReboot("mowgli/Reboot", cbReboot);
 
+// blade motor : flags (BLADEMOTOR_FLAG_x), rpm, power, temperature (0.1 degC, signed), errors, jams
+// then the replies since the last message, rpm, power, temperature, status << 8 | flags for each
+// layout.data_offset is the index of the first reply
+#define BLADE_STATUS_HEADER 6
+#define BLADE_STATUS_SAMPLES 8
+std_msgs::UInt16MultiArray blade_status_msg;
+uint16_t blade_status_data[BLADE_STATUS_HEADER + 4 * BLADE_STATUS_SAMPLES];
+ros::Publisher pubBladeStatus("blademotor/status", &blade_status_msg);
+
+// battery : SOC estimation, current only while charging (NaN on battery, the discharge is not measured)
+sensor_msgs::BatteryState battery_state_msg;
+ros::Publisher pubBatteryState("battery/state", &battery_state_msg);
+
+#if OPTION_RECORDER == 1
+// flight recorder : true freezes it and dumps the records on recorder/dump, false records again
+// layout.data_offset of a dump message is the index of its first record, oldest first
+#define RECORDER_DUMP_RECORDS 8
+void cbRecorder(const std_srvs::SetBool::Request &req, std_srvs::SetBool::Response &res);
+ros::ServiceServer<std_srvs::SetBool::Request, std_srvs::SetBool::Response> svcRecorder("mowgli/recorder", cbRecorder);
+std_msgs::UInt8MultiArray recorder_dump_msg;
+ros::Publisher pubRecorderDump("recorder/dump", &recorder_dump_msg);
+static RECORDER_Record_t recorder_dump_data[RECORDER_DUMP_RECORDS];
+static char recorder_status[48];
+static uint16_t recorder_dump_next = 0;
+static bool recorder_dumping = false;
+#endif
+
 #ifdef OPTION_PERIMETER
 // om perimeter signal
 mower_msgs::Perimeter om_perimeter_msg;
@@ -178,18 +222,85 @@ ros::Publisher pubPerimeter("mower/perimeter",&om_perimeter_msg);
 ros::ServiceServer<mower_msgs::PerimeterControlSrvRequest, mower_msgs::PerimeterControlSrvResponse> svcPerimeterListen("mower_service/perimeter_listen",cbPerimeterListen);
 #endif
 
-/*
- * NON BLOCKING TIMERS
- */
-static nbt_t ros_nbt;
-static nbt_t publish_nbt;
-static nbt_t motors_nbt;
-static nbt_t panel_nbt;
-static nbt_t imu_nbt;
-static nbt_t status_nbt;
+// cmd_vel latency, USB receive to drive motor request sent : count, min/max (us), histogram (1ms bins)
+#define CMD_LATENCY_VALUES (3 + DRIVEMOTOR_CMD_BINS)
+std_msgs::UInt32MultiArray cmd_latency_msg;
+uint32_t cmd_latency_data[CMD_LATENCY_VALUES];
+ros::Publisher pubCmdLatency("cmd_vel/latency", &cmd_latency_msg);
+
+// drive motor link : valid, crc errors, resync bytes, dropped, timeouts, rtt min/max (us), rtt histogram (500us bins)
+#define DRIVEMOTOR_LINK_VALUES (7 + DRIVEMOTOR_RTT_BINS)
+std_msgs::UInt32MultiArray drivemotor_link_msg;
+uint32_t drivemotor_link_data[DRIVEMOTOR_LINK_VALUES];
+ros::Publisher pubDrivemotorLink("drivemotor/link", &drivemotor_link_msg);
+
+// peripheral UART framing counters, FRAME_STATS_VALUES per port : drive motors, blade motor, panel, ultrasonic
+// valid, crc errors, resync bytes, uart errors, frames sent, frames not sent (zeros for a port not used)
+#define UART_LINK_PORTS 4
+std_msgs::UInt32MultiArray uart_link_msg;
+uint32_t uart_link_data[UART_LINK_PORTS * FRAME_STATS_VALUES];
+ros::Publisher pubUartLink("uart/link", &uart_link_msg);
+
+// encoder counters, left then right : wraps, resets, replies without count, implausible deltas
+#define ENCODER_VALUES 4
+std_msgs::UInt32MultiArray encoder_msg;
+uint32_t encoder_data[2 * ENCODER_VALUES];
+ros::Publisher pubEncoder("drivemotor/encoder", &encoder_msg);
+
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+// raw drive motor replies, DRIVEMOTOR_CAPTURE_RECORDS x DRIVEMOTOR_Capture_t
+std_msgs::UInt8MultiArray drivemotor_capture_msg;
+ros::Publisher pubDrivemotorCapture("drivemotor/capture", &drivemotor_capture_msg);
+#endif
+
+#if OPTION_SPEED_CONTROL == 1
+// wheel speed loop gains (x = kp, y = ki, z = kd) and tracking statistics
+// left then right : target, measured, pwm, samples, rms error, max error, saturated
+#define SPEED_TRACKING_VALUES 7
+extern "C" void CommandSpeedGainsMessageCb(const geometry_msgs::Vector3 &msg);
+ros::Subscriber<geometry_msgs::Vector3> subSpeedGains("drivemotor/gains", CommandSpeedGainsMessageCb);
+std_msgs::Float32MultiArray speed_tracking_msg;
+float speed_tracking_data[2 * SPEED_TRACKING_VALUES];
+ros::Publisher pubSpeedTracking("drivemotor/tracking", &speed_tracking_msg);
+#endif
+
+#if OPTION_DRIVEMOTOR_RAMP == 1
+// wheel speed ramp limits (x = acceleration, y = jerk)
+extern "C" void CommandRampLimitsMessageCb(const geometry_msgs::Vector3 &msg);
+ros::Subscriber<geometry_msgs::Vector3> subRampLimits("drivemotor/limits", CommandRampLimitsMessageCb);
+#endif
+
+#if OPTION_ODOMETRY == 1
+// on board wheel odometry
+nav_msgs::Odometry odom_msg;
+ros::Publisher pubOdometry("odom", &odom_msg);
+#if OPTION_ODOMETRY_TF == 1
+geometry_msgs::TransformStamped odom_trans;
+tf::TransformBroadcaster odom_broadcaster;
+#endif
+#endif
+
+#if OPTION_PROFILER == 1
+// main loop task statistics, a few tasks per message to stay below the rosserial OUTPUT_SIZE
+#define DIAGNOSTICS_TASKS_PER_MSG 3
+#define DIAGNOSTICS_NB_VALUES 7
+#define DIAGNOSTICS_VALUE_SIZE 12
+diagnostic_msgs::DiagnosticArray diagnostics_msg;
+diagnostic_msgs::DiagnosticStatus diagnostics_status[DIAGNOSTICS_TASKS_PER_MSG];
+diagnostic_msgs::KeyValue diagnostics_values[DIAGNOSTICS_TASKS_PER_MSG][DIAGNOSTICS_NB_VALUES];
+static char diagnostics_strings[DIAGNOSTICS_TASKS_PER_MSG][DIAGNOSTICS_NB_VALUES - 1][DIAGNOSTICS_VALUE_SIZE];
+static char diagnostics_histo[DIAGNOSTICS_TASKS_PER_MSG][PROFILER_HISTO_BINS * DIAGNOSTICS_VALUE_SIZE];
+static uint8_t diagnostics_next_task = 0;
+// prioritized publishers, "replaced,dropped" per topic, sent alone after each round of the tasks
+#define DIAGNOSTICS_MAX_PUBLISHERS 16
+diagnostic_msgs::KeyValue diagnostics_pub_values[DIAGNOSTICS_MAX_PUBLISHERS];
+static char diagnostics_pub_strings[DIAGNOSTICS_MAX_PUBLISHERS][2 * DIAGNOSTICS_VALUE_SIZE];
+static bool diagnostics_send_publishers = false;
+ros::Publisher pubDiagnostics("/diagnostics", &diagnostics_msg);
+#endif
 
 /*
- * reboot flag, if true we reboot after next publish_nbt
+ * reboot flag, if true we reboot after next chatter_handler() run
  */
 static bool reboot_flag = false;
 
@@ -285,7 +396,7 @@ extern "C" void CommandHighLevelStatusMessageCb(const mower_msgs::HighLevelStatu
 }
 /*
  * receive and parse cmd_vel messages
- * actual driving (updating drivemotors) is done in the drivemotors_nbt
+ * actual driving (updating drivemotors) is done in motors_handler()
  */
 extern "C" void CommandVelocityMessageCb(const geometry_msgs::Twist &msg)
 {	
@@ -334,36 +445,66 @@ extern "C" void CommandVelocityMessageCb(const geometry_msgs::Twist &msg)
 	left_speed = abs(left_mps * PWM_PER_MPS);
 	right_speed = abs(right_mps * PWM_PER_MPS);
 
+	// fast path, send the request now instead of at the next motors_handler() and poll tick
+	// motors_handler() still stops the motors if the commands stop coming
+	if (!Emergency_State())
+	{
+		DRIVEMOTOR_SetSpeed(left_speed, right_speed, left_dir, right_dir);
+		DRIVEMOTOR_SendNow(usb_rx_cycles);
+	}
+
 	//	debug_printf("left_mps: %f (%c)  right_mps: %f (%c)\r\n", left_mps, left_dir?'F':'R', right_mps, right_dir?'F':'R');
 }
 
 uint8_t CDC_DataReceivedHandler(const uint8_t *Buf, uint32_t len)
 {
 
+	// start of a burst, received commands are timed from here
+	if (ringbuffer_data_len(&rb) == 0)
+	{
+		usb_rx_cycles = DWT->CYCCNT;
+	}
 	ringbuffer_put(&rb, Buf, len);
 	return CDC_RX_DATA_HANDLED;
 }
 
+#if OPTION_DRIVEMOTOR_RAMP == 1
+/*
+ * runtime tuning of the wheel speed ramp, x = acceleration (m/s^2), y = jerk (m/s^3)
+ */
+extern "C" void CommandRampLimitsMessageCb(const geometry_msgs::Vector3 &msg)
+{
+	DRIVEMOTOR_SetLimits(msg.x, msg.y);
+}
+#endif
+
+#if OPTION_SPEED_CONTROL == 1
+/*
+ * runtime tuning of the wheel speed loop, also clears the tracking statistics
+ */
+extern "C" void CommandSpeedGainsMessageCb(const geometry_msgs::Vector3 &msg)
+{
+	DRIVEMOTOR_SetGains(msg.x, msg.y, msg.z);
+}
+#endif
+
 /*
  * Update various chatters topics
  */
 extern "C" void chatter_handler()
 {
-	if (NBT_handler(&publish_nbt))
-	{
-		#ifdef ROS_PUBLISH_MOWGLI
-			imu_onboard_temperature = IMU_Onboard_ReadTemp();
-		#endif
+	#ifdef ROS_PUBLISH_MOWGLI
+		imu_onboard_temperature = IMU_Onboard_ReadTemp();
+	#endif
 
-		HAL_GPIO_TogglePin(LED_GPIO_PORT, LED_PIN); // flash LED
+	HAL_GPIO_TogglePin(LED_GPIO_PORT, LED_PIN); // flash LED
 
-		// reboot if set via cbReboot (mowgli/Reboot)
-		if (reboot_flag)
-		{
-			nh.spinOnce();
-			NVIC_SystemReset();
-			// we never get here ...
-		}
+	// reboot if set via cbReboot (mowgli/Reboot)
+	if (reboot_flag)
+	{
+		nh.spinOnce();
+		NVIC_SystemReset();
+		// we never get here ...
 	}
 }
 
@@ -373,33 +514,42 @@ extern "C" void chatter_handler()
  */
 extern "C" void motors_handler()
 {
-	if (NBT_handler(&motors_nbt))
+	blade_on_off = target_blade_on_off;
+	if (Emergency_State())
 	{
-		blade_on_off = target_blade_on_off;
-		if (Emergency_State())
+		DRIVEMOTOR_Stop();
+		blade_on_off = 0;
+	}
+	else
+	{
+		// if the last velocity cmd is older than 1sec we stop the drive motors
+		last_cmd_vel_age = nh.now().toSec() - last_cmd_vel.toSec();
+		if (last_cmd_vel_age > 0.2)
 		{
 			DRIVEMOTOR_SetSpeed(0, 0, 0, 0);
-			blade_on_off = 0;
 		}
 		else
 		{
-			// if the last velocity cmd is older than 1sec we stop the drive motors
-			last_cmd_vel_age = nh.now().toSec() - last_cmd_vel.toSec();
-			if (last_cmd_vel_age > 0.2)
-			{
-				DRIVEMOTOR_SetSpeed(0, 0, 0, 0);
-			}
-			else
-			{
-				DRIVEMOTOR_SetSpeed(left_speed, right_speed, left_dir, right_dir);
-			}
+			DRIVEMOTOR_SetSpeed(left_speed, right_speed, left_dir, right_dir);
+		}
 
-			if (last_cmd_vel_age > 25) // Blade can take up to 10 seconds to switch on
-			{
-				blade_on_off = 0;
-			}
+		if (last_cmd_vel_age > 25) // Blade can take up to 10 seconds to switch on
+		{
+			blade_on_off = 0;
 		}
-		BLADEMOTOR_Set(blade_on_off, blade_direction);
+	}
+	BLADEMOTOR_Set(blade_on_off, blade_direction);
+}
+
+/*
+ *  completion of the mower_service/high_level_control call
+ */
+void cbHighLevelControl(const mower_msgs::HighLevelControlSrvResponse &res, bool timed_out)
+{
+	if (timed_out)
+	{
+		debug_printf("ROS: high_level_control timed out (%lu timeouts, %lu late, %lu dropped)\r\n",
+			svcHighLevelControl.timeout_count, svcHighLevelControl.late_count, svcHighLevelControl.dropped_count);
 	}
 }
 
@@ -408,42 +558,38 @@ extern "C" void motors_handler()
  */
 extern "C" void panel_handler()
 {
-	if (NBT_handler(&panel_nbt))
+	PANEL_Tick();
+	if (buttonupdated == 1 && buttoncleared == 0)
 	{
-		PANEL_Tick();
-		if (buttonupdated == 1 && buttoncleared == 0)
+		debug_printf("ROS: panel_handler() - buttonstate changed\r\n");
+		mower_msgs::HighLevelControlSrvRequest highControlRequest;
+		if (buttonstate[PANEL_BUTTON_DEF_S1])
 		{
-			debug_printf("ROS: panel_nbt() - buttonstate changed\r\n");
-			mower_msgs::HighLevelControlSrvRequest highControlRequest;
-			mower_msgs::HighLevelControlSrvResponse highControlResponse;
-			if (buttonstate[PANEL_BUTTON_DEF_S1])
-			{
-				highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_S1;
-			}
-			if (buttonstate[PANEL_BUTTON_DEF_S2])
-			{
-				highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_S2;
-			}
-			if (buttonstate[PANEL_BUTTON_DEF_LOCK])
-			{
-				highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_RESET_EMERGENCY;
-			}
-			if (buttonstate[PANEL_BUTTON_DEF_SUN])
-			{
-				/*seems a little risky, a wrong touch and hops need to redo the maps*/
-				// highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_DELETE_MAPS;
-			}
-			if (buttonstate[PANEL_BUTTON_DEF_START])
-			{
-				highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_START;
-			}
-			if (buttonstate[PANEL_BUTTON_DEF_HOME])
-			{
-				highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_HOME;
-			}
-			svcHighLevelControl.call(highControlRequest, highControlResponse);
-			buttonupdated = 0;
+			highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_S1;
+		}
+		if (buttonstate[PANEL_BUTTON_DEF_S2])
+		{
+			highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_S2;
+		}
+		if (buttonstate[PANEL_BUTTON_DEF_LOCK])
+		{
+			highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_RESET_EMERGENCY;
+		}
+		if (buttonstate[PANEL_BUTTON_DEF_SUN])
+		{
+			/*seems a little risky, a wrong touch and hops need to redo the maps*/
+			// highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_DELETE_MAPS;
+		}
+		if (buttonstate[PANEL_BUTTON_DEF_START])
+		{
+			highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_START;
 		}
+		if (buttonstate[PANEL_BUTTON_DEF_HOME])
+		{
+			highControlRequest.command = mower_msgs::HighLevelControlSrvRequest::COMMAND_HOME;
+		}
+		svcHighLevelControl.call_async(highControlRequest, cbHighLevelControl, HIGH_LEVEL_CONTROL_TIMEOUT_MS);
+		buttonupdated = 0;
 	}
 }
 #if OPTION_ULTRASONIC == 1
@@ -496,116 +642,391 @@ extern "C" void wheelTicks_handler(int8_t p_u8LeftDirection, int8_t p_u8RightDir
 	pubWheelTicks.publish(&wheel_ticks_msg);
 }
 
+/* \fn drivemotorCapture_handler
+ * \brief Send a block of raw drive motor replies, for offline replay
+ * is called by the drive motor module every DRIVEMOTOR_CAPTURE_RECORDS replies,
+ * and again with the same block until it returns 1. u32Lost blocks before
+ * this one could not be sent
+ */
+extern "C" uint8_t drivemotorCapture_handler(const uint8_t *pu8Data, uint16_t u16Len, uint32_t u32Lost)
+{
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+	drivemotor_capture_msg.layout.data_offset = u32Lost;
+	drivemotor_capture_msg.data_length = u16Len;
+	drivemotor_capture_msg.data = (uint8_t *)pu8Data;
+	return pubDrivemotorCapture.tryPublish(&drivemotor_capture_msg) > 0;
+#else
+	return 1;
+#endif
+}
+
+#if OPTION_ODOMETRY == 1
+/*
+ *  /odom and optionally the odom -> base_link transform
+ *  the pose is integrated by the odometry module on every drive motor reply
+ */
+extern "C" void odometry_handler()
+{
+	ODOMETRY_Pose_t pose;
+	ODOMETRY_GetPose(&pose);
+
+	// stamp with the time of the last integrated reply, not the time we publish
+	uint32_t age_ms = HAL_GetTick() - pose.u32Stamp;
+	ros::Time stamp = nh.now();
+	stamp -= ros::Duration(age_ms / 1000, (age_ms % 1000) * 1000000UL);
+	geometry_msgs::Quaternion orientation = tf::createQuaternionFromYaw(pose.fTheta);
+
+	odom_msg.header.stamp = stamp;
+	odom_msg.header.frame_id = "odom";
+	odom_msg.child_frame_id = "base_link";
+	odom_msg.pose.pose.position.x = pose.fX;
+	odom_msg.pose.pose.position.y = pose.fY;
+	odom_msg.pose.pose.position.z = 0;
+	odom_msg.pose.pose.orientation = orientation;
+	odom_msg.twist.twist.linear.x = pose.fV;
+	odom_msg.twist.twist.angular.z = pose.fW;
+
+	// planar robot, z/roll/pitch (and lateral speed) are not observed
+	for (int i = 0; i < 6; i++)
+	{
+		odom_msg.pose.covariance[i * 7] = 1e6;
+		odom_msg.twist.covariance[i * 7] = 1e6;
+	}
+	odom_msg.pose.covariance[0] = pose.fVarXY;		// x
+	odom_msg.pose.covariance[7] = pose.fVarXY;		// y
+	odom_msg.pose.covariance[35] = pose.fVarTheta;	// yaw
+	odom_msg.twist.covariance[0] = ODOMETRY_VAR_V;	// vx
+	odom_msg.twist.covariance[7] = 1e-6;			// vy, non holonomic
+	odom_msg.twist.covariance[35] = ODOMETRY_VAR_W;	// wz
+	pubOdometry.publish(&odom_msg);
+
+#if OPTION_ODOMETRY_TF == 1
+	odom_trans.header.stamp = stamp;
+	odom_trans.header.frame_id = "odom";
+	odom_trans.child_frame_id = "base_link";
+	odom_trans.transform.translation.x = pose.fX;
+	odom_trans.transform.translation.y = pose.fY;
+	odom_trans.transform.translation.z = 0;
+	odom_trans.transform.rotation = orientation;
+	odom_broadcaster.sendTransform(odom_trans);
+#endif
+}
+#endif
+
 extern "C" void broadcast_handler()
 {
-	if (NBT_handler(&imu_nbt))
-	{
-		////////////////////////////////////////
-		// IMU Messages
-		////////////////////////////////////////
-		imu_msg.header.frame_id = "imu";
-
-		// No Orientation in IMU message
-		imu_msg.orientation.x =
-		imu_msg.orientation.y = 
-		imu_msg.orientation.z = 
-		imu_msg.orientation.w = 0;
-		imu_msg.orientation_covariance[0] = -1;
-
-		/**********************************/
-		/* Exernal Accelerometer 		  */
-		/**********************************/
+	////////////////////////////////////////
+	// IMU Messages
+	////////////////////////////////////////
+	imu_msg.header.frame_id = "imu";
+
+	// No Orientation in IMU message
+	imu_msg.orientation.x =
+	imu_msg.orientation.y = 
+	imu_msg.orientation.z = 
+	imu_msg.orientation.w = 0;
+	imu_msg.orientation_covariance[0] = -1;
+
+	/**********************************/
+	/* Exernal Accelerometer 		  */
+	/**********************************/
 #ifdef EXTERNAL_IMU_ACCELERATION
-		// Linear acceleration
-		IMU_ReadAccelerometer(&imu_msg.linear_acceleration.x, &imu_msg.linear_acceleration.y, &imu_msg.linear_acceleration.z);
-		IMU_AccelerometerSetCovariance(imu_msg.linear_acceleration_covariance);
+	// Linear acceleration
+	IMU_ReadAccelerometer(&imu_msg.linear_acceleration.x, &imu_msg.linear_acceleration.y, &imu_msg.linear_acceleration.z);
+	IMU_AccelerometerSetCovariance(imu_msg.linear_acceleration_covariance);
 #else
-		imu_msg.linear_acceleration.x = imu_msg.linear_acceleration.y = imu_msg.linear_acceleration.z = 0;
-		imu_msg.linear_acceleration_covariance[0] = -1;
+	imu_msg.linear_acceleration.x = imu_msg.linear_acceleration.y = imu_msg.linear_acceleration.z = 0;
+	imu_msg.linear_acceleration_covariance[0] = -1;
 #endif
-		/**********************************/
-		/* Exernal Gyro					  */
-		/**********************************/
+	/**********************************/
+	/* Exernal Gyro					  */
+	/**********************************/
 #ifdef EXTERNAL_IMU_ANGULAR
-		// Angular velocity
-		IMU_ReadGyro(&imu_msg.angular_velocity.x, &imu_msg.angular_velocity.y, &imu_msg.angular_velocity.z);
-		IMU_GyroSetCovariance(imu_msg.angular_velocity_covariance);
+	// Angular velocity
+	IMU_ReadGyro(&imu_msg.angular_velocity.x, &imu_msg.angular_velocity.y, &imu_msg.angular_velocity.z);
+	IMU_GyroSetCovariance(imu_msg.angular_velocity_covariance);
 #else
-		imu_msg.angular_velocity.x = imu_msg.angular_velocity.y = imu_msg.angular_velocity.z = 0;
-		imu_msg.angular_velocity_covariance[0] = -1;
+	imu_msg.angular_velocity.x = imu_msg.angular_velocity.y = imu_msg.angular_velocity.z = 0;
+	imu_msg.angular_velocity_covariance[0] = -1;
 #endif
-		imu_msg.header.stamp = nh.now();
-		pubIMU.publish(&imu_msg);
+	imu_msg.header.stamp = nh.now();
+	pubIMU.publish(&imu_msg);
 
 #ifdef OPTION_PERIMETER
-		if (Perimeter_UpdateMsg(&om_perimeter_msg.left,&om_perimeter_msg.center,&om_perimeter_msg.right)) {
-			pubPerimeter.publish(&om_perimeter_msg);
-		}
+	if (Perimeter_UpdateMsg(&om_perimeter_msg.left,&om_perimeter_msg.center,&om_perimeter_msg.right)) {
+		pubPerimeter.publish(&om_perimeter_msg);
+	}
 #endif
-	} // if (NBT_handler(&imu_nbt))
+}
 
-	if (NBT_handler(&status_nbt))
-	{
+/*
+ *  mowgli/status and mower/status
+ */
+extern "C" void status_handler()
+{
 #ifdef ROS_PUBLISH_MOWGLI
-		////////////////////////////////////////
-		// mowgli/status Message
-		////////////////////////////////////////
-		status_msg.stamp = nh.now();
-		status_msg.rain_detected = RAIN_Sense();
-		status_msg.emergency_status = Emergency_State();
-		status_msg.emergency_left_stop = HALLSTOP_Left_Sense();
-		status_msg.emergency_right_stop = HALLSTOP_Right_Sense();
-		status_msg.emergency_tilt_mech_triggered = Emergency_Tilt();
-		status_msg.emergency_tilt_accel_triggered = Emergency_LowZAccelerometer();
-		status_msg.emergency_left_wheel_lifted = Emergency_WheelLiftBlue();
-		status_msg.emergency_right_wheel_lifted = Emergency_WheelLiftRed();
-		status_msg.emergency_stopbutton_triggered = Emergency_StopButtonYellow() || Emergency_StopButtonWhite();
-		/* not used anymore*/
-		status_msg.left_encoder_ticks = DRIVEMOTOR_u32ErrorCnt;
-		status_msg.right_encoder_ticks = 0;
-		status_msg.v_charge = charge_voltage;
-		status_msg.i_charge = current;
-		status_msg.v_battery = battery_voltage;
-		status_msg.charge_pwm = chargecontrol_pwm_val;
-		status_msg.is_charging = chargecontrol_is_charging;
-		status_msg.imu_temp = imu_onboard_temperature;
-		status_msg.blade_motor_ctrl_enabled = blade_on_off;
-		status_msg.drive_motor_ctrl_enabled = true;				// hardcoded for now
-		status_msg.blade_motor_enabled = BLADEMOTOR_bActivated; // set by feedback from blademotor
-		status_msg.left_power = left_power;
-		status_msg.right_power = right_power;
-		status_msg.blade_power = BLADEMOTOR_u16Power;
-		status_msg.blade_RPM = BLADEMOTOR_u16RPM;
-		status_msg.blade_temperature = blade_temperature;
-		status_msg.sw_ver_maj = MOWGLI_SW_VERSION_MAJOR;
-		status_msg.sw_ver_bra = MOWGLI_SW_VERSION_BRANCH;
-		status_msg.sw_ver_min = MOWGLI_SW_VERSION_MINOR;
-		pubStatus.publish(&status_msg);
-#endif
-
-		om_mower_status_msg.stamp = nh.now();
-		om_mower_status_msg.mower_status = mower_msgs::Status::MOWER_STATUS_OK;
-		om_mower_status_msg.rain_detected = RAIN_Sense();
-		om_mower_status_msg.emergency = Emergency_State();
-		om_mower_status_msg.v_charge = chargerInputVoltage;
-		om_mower_status_msg.charge_current = current;
-		om_mower_status_msg.v_battery = battery_voltage;
-		om_mower_status_msg.left_esc_status.current = left_power;
-		om_mower_status_msg.right_esc_status.current = right_power;
-		om_mower_status_msg.mow_esc_status.temperature_motor = blade_temperature;
-		om_mower_status_msg.mow_esc_status.tacho =
-		om_mower_status_msg.mow_esc_status.rpm = BLADEMOTOR_u16RPM;
-		om_mower_status_msg.mow_esc_status.current = (float)BLADEMOTOR_u16Power / 1000.0;
-		om_mower_status_msg.mow_esc_status.temperature_pcb = BLADEMOTOR_u32Error;
-		om_mower_status_msg.mow_esc_status.status = mower_msgs::ESCStatus::ESC_STATUS_OK;
-		om_mower_status_msg.left_esc_status.status = mower_msgs::ESCStatus::ESC_STATUS_OK;
-		om_mower_status_msg.right_esc_status.status = mower_msgs::ESCStatus::ESC_STATUS_OK;
-		om_mower_status_msg.mow_enabled = target_blade_on_off;
-		pubOMStatus.publish(&om_mower_status_msg);
-
-	}
-	// if (NBT_handler(&status_nbt))
+	////////////////////////////////////////
+	// mowgli/status Message
+	////////////////////////////////////////
+	status_msg.stamp = nh.now();
+	status_msg.rain_detected = RAIN_Sense();
+	status_msg.emergency_status = Emergency_State();
+	status_msg.emergency_left_stop = HALLSTOP_Left_Sense();
+	status_msg.emergency_right_stop = HALLSTOP_Right_Sense();
+	status_msg.emergency_tilt_mech_triggered = Emergency_Tilt();
+	status_msg.emergency_tilt_accel_triggered = Emergency_LowZAccelerometer();
+	status_msg.emergency_left_wheel_lifted = Emergency_WheelLiftBlue();
+	status_msg.emergency_right_wheel_lifted = Emergency_WheelLiftRed();
+	status_msg.emergency_stopbutton_triggered = Emergency_StopButtonYellow() || Emergency_StopButtonWhite();
+	/* not used anymore*/
+	status_msg.left_encoder_ticks = DRIVEMOTOR_u32ErrorCnt;
+	status_msg.right_encoder_ticks = 0;
+	status_msg.v_charge = charge_voltage;
+	status_msg.i_charge = current;
+	status_msg.v_battery = battery_voltage;
+	status_msg.charge_pwm = chargecontrol_pwm_val;
+	status_msg.is_charging = chargecontrol_is_charging;
+	status_msg.imu_temp = imu_onboard_temperature;
+	status_msg.blade_motor_ctrl_enabled = blade_on_off;
+	status_msg.drive_motor_ctrl_enabled = true;				// hardcoded for now
+	status_msg.blade_motor_enabled = BLADEMOTOR_bActivated; // set by feedback from blademotor
+	status_msg.left_power = left_power;
+	status_msg.right_power = right_power;
+	status_msg.blade_power = BLADEMOTOR_u16Power;
+	status_msg.blade_RPM = BLADEMOTOR_u16RPM;
+	status_msg.blade_temperature = blade_temperature;
+	status_msg.sw_ver_maj = MOWGLI_SW_VERSION_MAJOR;
+	status_msg.sw_ver_bra = MOWGLI_SW_VERSION_BRANCH;
+	status_msg.sw_ver_min = MOWGLI_SW_VERSION_MINOR;
+	pubStatus.publish(&status_msg);
+#endif
+
+	om_mower_status_msg.stamp = nh.now();
+	om_mower_status_msg.mower_status = mower_msgs::Status::MOWER_STATUS_OK;
+	om_mower_status_msg.rain_detected = RAIN_Sense();
+	om_mower_status_msg.emergency = Emergency_State();
+	om_mower_status_msg.v_charge = chargerInputVoltage;
+	om_mower_status_msg.charge_current = current;
+	om_mower_status_msg.v_battery = battery_voltage;
+	om_mower_status_msg.left_esc_status.current = left_power;
+	om_mower_status_msg.right_esc_status.current = right_power;
+	om_mower_status_msg.mow_esc_status.temperature_motor = blade_temperature;
+	om_mower_status_msg.mow_esc_status.tacho =
+	om_mower_status_msg.mow_esc_status.rpm = BLADEMOTOR_u16RPM;
+	om_mower_status_msg.mow_esc_status.current = (float)BLADEMOTOR_u16Power / 1000.0;
+	om_mower_status_msg.mow_esc_status.temperature_pcb = BLADEMOTOR_u32Error;
+	om_mower_status_msg.mow_esc_status.status = mower_msgs::ESCStatus::ESC_STATUS_OK;
+	om_mower_status_msg.left_esc_status.status = mower_msgs::ESCStatus::ESC_STATUS_OK;
+	om_mower_status_msg.right_esc_status.status = mower_msgs::ESCStatus::ESC_STATUS_OK;
+	om_mower_status_msg.mow_enabled = target_blade_on_off;
+	pubOMStatus.publish(&om_mower_status_msg);
+
+	battery_state_msg.header.stamp = nh.now();
+	battery_state_msg.voltage = battery_voltage;
+	battery_state_msg.current = BATTERY_fCurrent();
+	battery_state_msg.percentage = BATTERY_fSoc();
+	battery_state_msg.design_capacity = BATTERY_CAPACITY_MAH / 1000.0f;
+	battery_state_msg.capacity = battery_state_msg.design_capacity;
+	battery_state_msg.charge = battery_state_msg.percentage * battery_state_msg.capacity;
+	battery_state_msg.power_supply_technology = sensor_msgs::BatteryState::POWER_SUPPLY_TECHNOLOGY_LION;
+	battery_state_msg.present = battery_voltage > MIN_BATTERY_VOLTAGE;
+	if (chargecontrol_is_charging == CHARGER_STATE_CHARGING_CC || chargecontrol_is_charging == CHARGER_STATE_CHARGING_CV)
+		battery_state_msg.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_CHARGING;
+	else if (chargecontrol_is_charging == CHARGER_STATE_END_CHARGING)
+		battery_state_msg.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_FULL;
+	else if (chargecontrol_is_charging == CHARGER_STATE_CONNECTED)
+		battery_state_msg.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_NOT_CHARGING;
+	else
+		battery_state_msg.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_DISCHARGING;
+	battery_state_msg.temperature = NAN;
+	pubBatteryState.publish(&battery_state_msg);
+
+	FRAME_Stats_t link_stats[UART_LINK_PORTS];
+	memset(link_stats, 0, sizeof(link_stats));
+	DRIVEMOTOR_GetLinkStats(&link_stats[0]);
+	BLADEMOTOR_GetLinkStats(&link_stats[1]);
+#ifdef PANEL_USART_ENABLED
+	PANEL_GetLinkStats(&link_stats[2]);
+#endif
+#if (DEBUG_TYPE != DEBUG_TYPE_UART) && (OPTION_ULTRASONIC == 1)
+	ULTRASONICSENSOR_GetLinkStats(&link_stats[3]);
+#endif
+	memcpy(uart_link_data, link_stats, sizeof(uart_link_data));
+	uart_link_msg.data_length = UART_LINK_PORTS * FRAME_STATS_VALUES;
+	uart_link_msg.data = uart_link_data;
+	pubUartLink.publish(&uart_link_msg);
+
+	drivemotor_link_data[0] = link_stats[0].u32Valid;
+	drivemotor_link_data[1] = link_stats[0].u32CrcError;
+	drivemotor_link_data[2] = link_stats[0].u32Resync;
+	drivemotor_link_data[3] = DRIVEMOTOR_u32RxDropped;
+	drivemotor_link_data[4] = DRIVEMOTOR_u32RxTimeout;
+	drivemotor_link_data[5] = DRIVEMOTOR_u32RttMinUs;
+	drivemotor_link_data[6] = DRIVEMOTOR_u32RttMaxUs;
+	memcpy(&drivemotor_link_data[7], DRIVEMOTOR_au32RttHisto, sizeof(DRIVEMOTOR_au32RttHisto));
+	drivemotor_link_msg.data_length = DRIVEMOTOR_LINK_VALUES;
+	drivemotor_link_msg.data = drivemotor_link_data;
+	pubDrivemotorLink.publish(&drivemotor_link_msg);
+
+	cmd_latency_data[0] = DRIVEMOTOR_u32CmdCount;
+	cmd_latency_data[1] = DRIVEMOTOR_u32CmdMinUs;
+	cmd_latency_data[2] = DRIVEMOTOR_u32CmdMaxUs;
+	memcpy(&cmd_latency_data[3], DRIVEMOTOR_au32CmdHisto, sizeof(DRIVEMOTOR_au32CmdHisto));
+	cmd_latency_msg.data_length = CMD_LATENCY_VALUES;
+	cmd_latency_msg.data = cmd_latency_data;
+	pubCmdLatency.publish(&cmd_latency_msg);
+
+	for (uint8_t wheel = DRIVEMOTOR_LEFT; wheel <= DRIVEMOTOR_RIGHT; wheel++)
+	{
+		ENCODER_Wheel_t encoder;
+		uint32_t *data = &encoder_data[wheel * ENCODER_VALUES];
+		DRIVEMOTOR_GetEncoder(wheel, &encoder);
+		data[0] = encoder.u32Wraps;
+		data[1] = encoder.u32Resets;
+		data[2] = encoder.u32Held;
+		data[3] = encoder.u32Implausible;
+	}
+	encoder_msg.data_length = 2 * ENCODER_VALUES;
+	encoder_msg.data = encoder_data;
+	pubEncoder.publish(&encoder_msg);
+
+#if OPTION_SPEED_CONTROL == 1
+	for (uint8_t wheel = DRIVEMOTOR_LEFT; wheel <= DRIVEMOTOR_RIGHT; wheel++)
+	{
+		DRIVEMOTOR_Tracking_t tracking;
+		float *data = &speed_tracking_data[wheel * SPEED_TRACKING_VALUES];
+		DRIVEMOTOR_GetTracking(wheel, &tracking);
+		data[0] = tracking.fTarget;
+		data[1] = tracking.fMeasured;
+		data[2] = tracking.u8Pwm;
+		data[3] = tracking.u32Samples;
+		data[4] = tracking.fRmsError;
+		data[5] = tracking.fMaxError;
+		data[6] = tracking.u32Saturated;
+	}
+	speed_tracking_msg.data_length = 2 * SPEED_TRACKING_VALUES;
+	speed_tracking_msg.data = speed_tracking_data;
+	pubSpeedTracking.publish(&speed_tracking_msg);
+#endif
+}
+
+#if OPTION_PROFILER == 1
+/*
+ *  replaced (newer value published before sending) and dropped counts of
+ *  the prioritized publishers, in diagnostics_status[0]
+ */
+static void diagnostics_publishers()
+{
+	uint8_t nb_values = 0;
+	uint32_t dropped = 0;
+
+	for (int i = 0; nb_values < DIAGNOSTICS_MAX_PUBLISHERS; i++)
+	{
+		ros::Publisher *pub = nh.getPublisher(i);
+		if (pub == nullptr)
+		{
+			break;
+		}
+		if (pub->getPriority() == ros::Publisher::PRIORITY_IMMEDIATE)
+		{
+			continue;
+		}
+		snprintf(diagnostics_pub_strings[nb_values], sizeof(diagnostics_pub_strings[0]), "%lu,%lu",
+			(unsigned long)pub->replaced_, (unsigned long)pub->dropped_);
+		diagnostics_pub_values[nb_values].key = pub->topic_;
+		diagnostics_pub_values[nb_values].value = diagnostics_pub_strings[nb_values];
+		dropped += pub->dropped_;
+		nb_values++;
+	}
+
+	diagnostic_msgs::DiagnosticStatus *status = &diagnostics_status[0];
+	status->level = dropped ? diagnostic_msgs::DiagnosticStatus::WARN : diagnostic_msgs::DiagnosticStatus::OK;
+	status->name = "rosserial publishers";
+	status->message = "replaced,dropped";
+	status->hardware_id = "mowgli";
+	status->values_length = nb_values;
+	status->values = diagnostics_pub_values;
+}
+
+/*
+ *  /diagnostics, run time of the main loop tasks
+ *  the tasks are sent DIAGNOSTICS_TASKS_PER_MSG at a time, round robin,
+ *  each round is followed by the publisher counters
+ */
+extern "C" void diagnostics_handler()
+{
+	static const char *keys[DIAGNOSTICS_NB_VALUES] = {
+		"runs", "min_us", "avg_us", "max_us", "max_late_ms", "skipped", "histo_us_4^n"};
+	uint8_t nb_status = 0;
+
+	if (diagnostics_send_publishers)
+	{
+		// alone in its message, it can be as long as a few tasks
+		diagnostics_send_publishers = false;
+		diagnostics_publishers();
+		nb_status = 1;
+	}
+	else while (nb_status < DIAGNOSTICS_TASKS_PER_MSG)
+	{
+		SCHEDULER_Task_t *task = SCHEDULER_GetTask(diagnostics_next_task);
+		if (task == NULL)
+		{
+			// end of the list : the publishers, then the first task again
+			diagnostics_next_task = 0;
+			if (nb_status == 0)
+			{
+				diagnostics_publishers();
+				nb_status = 1;
+			}
+			else
+			{
+				diagnostics_send_publishers = true;
+			}
+			break;
+		}
+		diagnostics_next_task++;
+
+		const PROFILER_Stats_t *prof = &task->sProfile;
+		uint32_t numbers[DIAGNOSTICS_NB_VALUES - 1] = {
+			prof->u32Count,
+			prof->u32Count ? PROFILER_u32CyclesToUs(prof->u32Min) : 0,
+			PROFILER_u32CyclesToUs(PROFILER_u32AvgCycles(prof)),
+			PROFILER_u32CyclesToUs(prof->u32Max),
+			task->u32MaxLateness,
+			task->u32Skipped};
+		diagnostic_msgs::KeyValue *values = diagnostics_values[nb_status];
+		for (uint8_t i = 0; i < DIAGNOSTICS_NB_VALUES - 1; i++)
+		{
+			snprintf(diagnostics_strings[nb_status][i], DIAGNOSTICS_VALUE_SIZE, "%lu", (unsigned long)numbers[i]);
+			values[i].key = keys[i];
+			values[i].value = diagnostics_strings[nb_status][i];
+		}
+
+		char *histo = diagnostics_histo[nb_status];
+		int len = 0;
+		for (uint8_t i = 0; i < PROFILER_HISTO_BINS; i++)
+		{
+			len += snprintf(histo + len, sizeof(diagnostics_histo[0]) - len, i ? ",%lu" : "%lu", (unsigned long)prof->au32Histo[i]);
+		}
+		values[DIAGNOSTICS_NB_VALUES - 1].key = keys[DIAGNOSTICS_NB_VALUES - 1];
+		values[DIAGNOSTICS_NB_VALUES - 1].value = histo;
+
+		diagnostic_msgs::DiagnosticStatus *status = &diagnostics_status[nb_status];
+		status->level = task->u32Skipped ? diagnostic_msgs::DiagnosticStatus::WARN : diagnostic_msgs::DiagnosticStatus::OK;
+		status->name = task->pcName;
+		status->message = task->u32Skipped ? "periods skipped" : "";
+		status->hardware_id = "mowgli";
+		status->values_length = DIAGNOSTICS_NB_VALUES;
+		status->values = values;
+		nb_status++;
+	}
+
+	diagnostics_msg.header.stamp = nh.now();
+	diagnostics_msg.status_length = nb_status;
+	diagnostics_msg.status = diagnostics_status;
+	pubDiagnostics.publish(&diagnostics_msg);
 }
+#endif
 
 /*
  *  callback for mowgli/EnableMowerMotor Service
@@ -640,6 +1061,90 @@ void cbPerimeterListen(const mower_msgs::PerimeterControlSrvRequest &req, mower_
 /*
  *  callback for mowgli/Reboot Service
  */
+#if OPTION_RECORDER == 1
+void cbRecorder(const std_srvs::SetBool::Request &req, std_srvs::SetBool::Response &res)
+{
+	if (req.data)
+	{
+		RECORDER_Freeze(RECORDER_TRIGGER_REQUEST);
+		recorder_dump_next = 0;
+		recorder_dumping = true;
+	}
+	else
+	{
+		RECORDER_Arm();
+		recorder_dumping = false;
+	}
+	snprintf(recorder_status, sizeof(recorder_status), "trigger %u, %u records", RECORDER_u8Trigger(), RECORDER_u16Count());
+	res.success = true;
+	res.message = recorder_status;
+}
+
+/*
+ * send the frozen records, RECORDER_DUMP_RECORDS per run. A chunk the
+ * link has no room for is sent again on the next run
+ */
+extern "C" void recorder_handler()
+{
+	uint8_t count = 0;
+
+	if (!recorder_dumping)
+	{
+		return;
+	}
+	while (count < RECORDER_DUMP_RECORDS && recorder_dump_next + count < RECORDER_u16Count())
+	{
+		recorder_dump_data[count] = *RECORDER_psGet(recorder_dump_next + count);
+		count++;
+	}
+	if (count == 0)
+	{
+		recorder_dumping = false;
+		return;
+	}
+	recorder_dump_msg.layout.data_offset = recorder_dump_next;
+	recorder_dump_msg.data_length = count * sizeof(RECORDER_Record_t);
+	recorder_dump_msg.data = (uint8_t *)recorder_dump_data;
+	if (pubRecorderDump.tryPublish(&recorder_dump_msg) > 0)
+	{
+		recorder_dump_next += count;
+	}
+}
+#endif
+
+/*
+ * blade motor state and the replies received since the last run, the
+ * replies stay queued in blademotor.c until a message carrying them is sent
+ */
+extern "C" void blademotor_handler()
+{
+	BLADEMOTOR_Sample_t samples[BLADE_STATUS_SAMPLES];
+	uint8_t count = BLADEMOTOR_u8GetSamples(samples, BLADE_STATUS_SAMPLES);
+	uint8_t i;
+
+	blade_status_data[0] = BLADEMOTOR_u8Flags();
+	blade_status_data[1] = BLADEMOTOR_u16RPM;
+	blade_status_data[2] = BLADEMOTOR_u16Power;
+	blade_status_data[3] = (uint16_t)adc_s16BladeTemperature;
+	blade_status_data[4] = (uint16_t)BLADEMOTOR_u32Error;
+	blade_status_data[5] = (uint16_t)BLADEMOTOR_u32Jams;
+	for (i = 0; i < count; i++)
+	{
+		uint16_t *sample = &blade_status_data[BLADE_STATUS_HEADER + 4 * i];
+		sample[0] = samples[i].u16Rpm;
+		sample[1] = samples[i].u16Power;
+		sample[2] = (uint16_t)samples[i].s16Temperature;
+		sample[3] = (samples[i].u8Status << 8) | samples[i].u8Flags;
+	}
+	blade_status_msg.layout.data_offset = BLADE_STATUS_HEADER;
+	blade_status_msg.data_length = BLADE_STATUS_HEADER + 4 * count;
+	blade_status_msg.data = blade_status_data;
+	if (pubBladeStatus.tryPublish(&blade_status_msg) > 0)
+	{
+		BLADEMOTOR_ConsumeSamples(count);
+	}
+}
+
 void cbReboot(const std_srvs::Empty::Request &req, std_srvs::Empty::Response &res)
 {
 	// debug_printf("cbReboot:\r\n");
@@ -651,31 +1156,28 @@ void cbReboot(const std_srvs::Empty::Request &req, std_srvs::Empty::Response &re
  */
 extern "C" void spinOnce()
 {
-	if (NBT_handler(&ros_nbt))
-	{
-		nh.spinOnce();
+	nh.spinOnce();
 #if OPTION_BUMPER == 1
-		bumper_left_msg.header.stamp = nh.now();
-		bumper_left_msg.header.frame_id = "bumper_left_link";
-		bumper_right_msg.header.stamp = nh.now();
-		bumper_right_msg.header.frame_id = "bumper_right_link";
-
-		bumper_left_msg.radiation_type = 0;
-		bumper_left_msg.field_of_view = 1.64; /* 90°*/
-		bumper_left_msg.min_range = 0.0;
-		bumper_left_msg.max_range = 0.20;
-		bumper_left_msg.range = HALLSTOP_Left_Sense() * 0.05;
-
-		bumper_right_msg.radiation_type = 0;
-		bumper_right_msg.field_of_view = 1.64; /* 90°*/
-		bumper_right_msg.min_range = 0.0;
-		bumper_right_msg.max_range = 0.20;
-		bumper_right_msg.range = HALLSTOP_Right_Sense() * 0.05;
-
-		pubLeftBumper.publish(&bumper_left_msg);
-		pubRightBumper.publish(&bumper_right_msg);
+	bumper_left_msg.header.stamp = nh.now();
+	bumper_left_msg.header.frame_id = "bumper_left_link";
+	bumper_right_msg.header.stamp = nh.now();
+	bumper_right_msg.header.frame_id = "bumper_right_link";
+
+	bumper_left_msg.radiation_type = 0;
+	bumper_left_msg.field_of_view = 1.64; /* 90°*/
+	bumper_left_msg.min_range = 0.0;
+	bumper_left_msg.max_range = 0.20;
+	bumper_left_msg.range = HALLSTOP_Left_Sense() * 0.05;
+
+	bumper_right_msg.radiation_type = 0;
+	bumper_right_msg.field_of_view = 1.64; /* 90°*/
+	bumper_right_msg.min_range = 0.0;
+	bumper_right_msg.max_range = 0.20;
+	bumper_right_msg.range = HALLSTOP_Right_Sense() * 0.05;
+
+	pubLeftBumper.publish(&bumper_left_msg);
+	pubRightBumper.publish(&bumper_right_msg);
 #endif
-	}
 }
 
 /*
@@ -705,10 +1207,67 @@ extern "C" void init_ROS()
 #endif
 	nh.advertise(pubOMStatus);
 	nh.advertise(pubWheelTicks);
+	nh.advertise(pubDrivemotorLink);
+	nh.advertise(pubUartLink);
+	nh.advertise(pubBladeStatus);
+	nh.advertise(pubBatteryState);
+	nh.advertise(pubCmdLatency);
+	nh.advertise(pubEncoder);
+#if OPTION_DRIVEMOTOR_CAPTURE == 1
+	nh.advertise(pubDrivemotorCapture);
+#endif
+#if OPTION_SPEED_CONTROL == 1
+	nh.advertise(pubSpeedTracking);
+#endif
+#if OPTION_ODOMETRY == 1
+	nh.advertise(pubOdometry);
+#if OPTION_ODOMETRY_TF == 1
+	odom_broadcaster.init(nh);
+#endif
+#endif
+#if OPTION_PROFILER == 1
+	nh.advertise(pubDiagnostics);
+#endif
+
+	// Publish priorities, odometry relevant topics first when USB is congested
+	pubWheelTicks.setPriority(0);
+#if OPTION_ODOMETRY == 1
+	pubOdometry.setPriority(0);
+#endif
+	pubIMU.setPriority(1);
+#if OPTION_ULTRASONIC == 1
+	pubLeftUltrasonic.setPriority(2);
+	pubRightUltrasonic.setPriority(2);
+#endif
+#if OPTION_BUMPER == 1
+	pubLeftBumper.setPriority(2);
+	pubRightBumper.setPriority(2);
+#endif
+#ifdef ROS_PUBLISH_MOWGLI
+	pubStatus.setPriority(3);
+#endif
+	pubOMStatus.setPriority(3);
+	pubDrivemotorLink.setPriority(3);
+	pubUartLink.setPriority(3);
+	pubBatteryState.setPriority(3);
+	pubCmdLatency.setPriority(3);
+	pubEncoder.setPriority(3);
+#if OPTION_SPEED_CONTROL == 1
+	pubSpeedTracking.setPriority(3);
+#endif
+#if OPTION_PROFILER == 1
+	pubDiagnostics.setPriority(3);
+#endif
 
 	// Initialize Subscribers
 	nh.subscribe(subCommandVelocity);
 	nh.subscribe(subCommandHighLevelStatus);
+#if OPTION_SPEED_CONTROL == 1
+	nh.subscribe(subSpeedGains);
+#endif
+#if OPTION_DRIVEMOTOR_RAMP == 1
+	nh.subscribe(subRampLimits);
+#endif
 
 	// Initialize Services
 	// nh.advertiseService(svcSetCfg);
@@ -716,20 +1275,17 @@ extern "C" void init_ROS()
 	nh.advertiseService(svcEnableMowerMotor);
 	nh.advertiseService(svcSetEmergency);
 	nh.advertiseService(svcReboot);
+#if OPTION_RECORDER == 1
+	nh.advertiseService(svcRecorder);
+	nh.advertise(pubRecorderDump);
+#endif
 	nh.serviceClient(svcHighLevelControl);
 
 #ifdef OPTION_PERIMETER
 	nh.advertise(pubPerimeter);
 	nh.advertiseService(svcPerimeterListen);
+	pubPerimeter.setPriority(1);
 #endif
-
-	// Initialize Timers
-	NBT_init(&publish_nbt, 1000);
-	NBT_init(&panel_nbt, 100);
-	NBT_init(&status_nbt, STATUS_NBT_TIME_MS);
-	NBT_init(&imu_nbt, IMU_NBT_TIME_MS);
-	NBT_init(&motors_nbt, MOTORS_NBT_TIME_MS);
-	NBT_init(&ros_nbt, 10);
 }
 
 float clamp(float d, float min, float max)
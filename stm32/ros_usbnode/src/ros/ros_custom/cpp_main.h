@@ -16,6 +16,12 @@ void chatter_handler();
 void motors_handler();
 void panel_handler();
 void broadcast_handler();
+void status_handler();
+void odometry_handler();
+void diagnostics_handler();
+void recorder_handler();
+void blademotor_handler();
+uint8_t drivemotorCapture_handler(const uint8_t *pu8Data, uint16_t u16Len, uint32_t u32Lost);
 void ultrasonic_handler();
 void wheelTicks_handler(int8_t p_u8LeftDirection,int8_t p_u8RightDirection, uint32_t p_u16LeftTicks, uint32_t p_u16RightTicks, int16_t p_s16LeftSpeed, int16_t p_s16RightSpeed);
 
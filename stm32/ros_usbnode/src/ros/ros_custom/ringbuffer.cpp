@@ -26,132 +26,92 @@
 #include "stm32f1xx_hal.h"
 #include "ringbuffer.h"
 #include <string.h>
+#include <atomic>
 
-#define ASSERT(EX)                                                         \
+/*
+ * The producer publishes data by advancing head after the copy, the consumer
+ * frees space by advancing tail after it is done with the data. The compiler
+ * fences keep the copies on the right side of the index updates, the
+ * Cortex-M3 does not reorder them and both sides run on the same core.
+ */
 
-__inline enum ringbuffer_state  ringbuffer_status(struct  ringbuffer *rb)
+/** return the size of the pool */
+uint32_t  ringbuffer_get_size(struct  ringbuffer *rb)
 {
-	if (rb->read_index == rb->write_index) {
-		if (rb->read_mirror == rb->write_mirror)
-			return RT_RINGBUFFER_EMPTY;
-		else
-			return RT_RINGBUFFER_FULL;
-	}
-	return RT_RINGBUFFER_HALFFULL;
+	return rb->mask + 1;
 }
 
 /** return the size of data in rb */
-uint16_t  ringbuffer_data_len(struct  ringbuffer *rb)
+uint32_t  ringbuffer_data_len(struct  ringbuffer *rb)
 {
-	switch ( ringbuffer_status(rb)) {
-	case RT_RINGBUFFER_EMPTY:
-		return 0;
-	case RT_RINGBUFFER_FULL:
-		return rb->buffer_size;
-	case RT_RINGBUFFER_HALFFULL:
-	default:
-		if (rb->write_index > rb->read_index)
-			return rb->write_index - rb->read_index;
-		else
-			return rb->buffer_size - (rb->read_index - rb->write_index);
-	};
+	std::atomic_signal_fence(std::memory_order_acquire);
+	return rb->head - rb->tail;
 }
 
-/** return the free space size of rb */
-uint16_t  ringbuffer_free_len(struct  ringbuffer *rb)
+enum ringbuffer_state  ringbuffer_status(struct  ringbuffer *rb)
 {
-	return rb->buffer_size - ringbuffer_data_len(rb);
+	uint32_t len = ringbuffer_data_len(rb);
+
+	if (len == 0)
+		return RT_RINGBUFFER_EMPTY;
+	if (len == ringbuffer_get_size(rb))
+		return RT_RINGBUFFER_FULL;
+	return RT_RINGBUFFER_HALFFULL;
 }
 
 /**
  * put a block of data into ring buffer
+ *
+ * Data that does not fit is dropped and counted in rb->dropped.
  */
 uint32_t  ringbuffer_put(struct  ringbuffer *rb,
                             const uint8_t     *ptr,
-                            uint16_t           length)
+                            uint32_t           length)
 {
-    uint16_t size;
-
-    ASSERT(rb != NULL);
+    std::atomic_signal_fence(std::memory_order_acquire);
+    uint32_t head = rb->head;
+    uint32_t space = ringbuffer_get_size(rb) - (head - rb->tail);
 
-    /* whether has enough space */
-    size =  ringbuffer_empty_space(rb);
-
-    /* no space */
-    if (size == 0)
-        return 0;
-
-    /* drop some data */
-    if (size < length)
-        length = size;
-
-    if (rb->buffer_size - rb->write_index > length)
+    if (length > space)
     {
-        /* read_index - write_index = empty space */
-        memcpy(&rb->buffer_ptr[rb->write_index], ptr, length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        rb->write_index += length;
-        return length;
+        rb->dropped += length - space;
+        length = space;
     }
 
-    memcpy(&rb->buffer_ptr[rb->write_index],
-           &ptr[0],
-           rb->buffer_size - rb->write_index);
-    memcpy(&rb->buffer_ptr[0],
-           &ptr[rb->buffer_size - rb->write_index],
-           length - (rb->buffer_size - rb->write_index));
+    uint32_t index = head & rb->mask;
+    uint32_t first = ringbuffer_get_size(rb) - index;
+    if (first > length)
+        first = length;
+
+    memcpy(&rb->buffer_ptr[index], ptr, first);
+    memcpy(&rb->buffer_ptr[0], ptr + first, length - first);
 
-    /* we are going into the other side of the mirror */
-    rb->write_mirror = ~rb->write_mirror;
-    rb->write_index = length - (rb->buffer_size - rb->write_index);
+    std::atomic_signal_fence(std::memory_order_release);
+    rb->head = head + length;
 
     return length;
 }
 
 /**
- * put a block of data into ring buffer
- *
- * When the buffer is full, it will discard the old data.
+ * put a character into ring buffer
  */
-uint32_t ringbuffer_put_force(struct ringbuffer *rb, const uint8_t *ptr, uint16_t length)
+uint32_t  ringbuffer_putchar(struct  ringbuffer *rb, const uint8_t ch)
 {
-	enum ringbuffer_state old_state;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    uint32_t head = rb->head;
 
-	ASSERT(rb != NULL);
-
-	old_state = ringbuffer_status(rb);
-
-	if (length > rb->buffer_size)
-		length = rb->buffer_size;
-
-	if (rb->buffer_size - rb->write_index > length) {
-		/* read_index - write_index = empty space */
-		memcpy(&rb->buffer_ptr[rb->write_index], ptr, length);
-		/* this should not cause overflow because there is enough space for
-		 * length of data in current mirror */
-		rb->write_index += length;
-
-		if (old_state == RT_RINGBUFFER_FULL)
-			rb->read_index = rb->write_index;
-
-		return length;
-	}
-
-	memcpy(&rb->buffer_ptr[rb->write_index], &ptr[0], rb->buffer_size - rb->write_index);
-	memcpy(&rb->buffer_ptr[0], &ptr[rb->buffer_size - rb->write_index],
-			length - (rb->buffer_size - rb->write_index));
+    if (head - rb->tail == ringbuffer_get_size(rb))
+    {
+        rb->dropped++;
+        return 0;
+    }
 
-	/* we are going into the other side of the mirror */
-	rb->write_mirror = ~rb->write_mirror;
-	rb->write_index = length - (rb->buffer_size - rb->write_index);
+    rb->buffer_ptr[head & rb->mask] = ch;
 
-	if (old_state == RT_RINGBUFFER_FULL) {
-		rb->read_mirror = ~rb->read_mirror;
-		rb->read_index = rb->write_index;
-	}
+    std::atomic_signal_fence(std::memory_order_release);
+    rb->head = head + 1;
 
-	return length;
+    return 1;
 }
 
 /**
@@ -159,156 +119,102 @@ uint32_t ringbuffer_put_force(struct ringbuffer *rb, const uint8_t *ptr, uint16_
  */
 uint32_t  ringbuffer_get(struct  ringbuffer *rb,
                             uint8_t           *ptr,
-                            uint16_t           length)
+                            uint32_t           length)
 {
-    uint32_t size;
-
-    ASSERT(rb != NULL);
-
-    /* whether has enough data  */
-    size =  ringbuffer_data_len(rb);
+    uint32_t size = ringbuffer_data_len(rb);
+    uint32_t tail = rb->tail;
 
-    /* no data */
-    if (size == 0)
-        return 0;
-
-    /* less data */
-    if (size < length)
+    if (length > size)
         length = size;
 
-    if (rb->buffer_size - rb->read_index > length)
-    {
-        /* copy all of data */
-        memcpy(ptr, &rb->buffer_ptr[rb->read_index], length);
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        rb->read_index += length;
-        return length;
-    }
+    uint32_t index = tail & rb->mask;
+    uint32_t first = ringbuffer_get_size(rb) - index;
+    if (first > length)
+        first = length;
 
-    memcpy(&ptr[0],
-           &rb->buffer_ptr[rb->read_index],
-           rb->buffer_size - rb->read_index);
-    memcpy(&ptr[rb->buffer_size - rb->read_index],
-           &rb->buffer_ptr[0],
-           length - (rb->buffer_size - rb->read_index));
+    memcpy(ptr, &rb->buffer_ptr[index], first);
+    memcpy(ptr + first, &rb->buffer_ptr[0], length - first);
 
-    /* we are going into the other side of the mirror */
-    rb->read_mirror = ~rb->read_mirror;
-    rb->read_index = length - (rb->buffer_size - rb->read_index);
+    std::atomic_signal_fence(std::memory_order_release);
+    rb->tail = tail + length;
 
     return length;
 }
 
 /**
- * put a character into ring buffer
+ * get a character from a ringbuffer
  */
-uint32_t  ringbuffer_putchar(struct  ringbuffer *rb, const uint8_t ch)
+uint32_t  ringbuffer_getchar(struct  ringbuffer *rb, uint8_t *ch)
 {
-    ASSERT(rb != NULL);
-
-    /* whether has enough space */
-	if (! ringbuffer_empty_space(rb))
-		return 0;
+    /* ringbuffer is empty */
+    if (!ringbuffer_data_len(rb))
+        return 0;
 
-	rb->buffer_ptr[rb->write_index] = ch;
+    uint32_t tail = rb->tail;
+    *ch = rb->buffer_ptr[tail & rb->mask];
 
-	/* flip mirror */
-	if (rb->write_index == rb->buffer_size - 1) {
-		rb->write_mirror = ~rb->write_mirror;
-		rb->write_index = 0;
-	} else {
-		rb->write_index++;
-	}
+    std::atomic_signal_fence(std::memory_order_release);
+    rb->tail = tail + 1;
 
-	return 1;
+    return 1;
 }
 
 /**
- * put a character into ring buffer
+ * get a pointer to the data at the tail without consuming it
  *
- * When the buffer is full, it will discard one old data.
+ * Only the contiguous part up to the end of the pool is returned, the
+ * remainder (if any) is returned by the next call after ringbuffer_consume().
+ * The data stays valid until it is consumed.
  */
-uint32_t  ringbuffer_putchar_force(struct  ringbuffer *rb, const uint8_t ch)
+uint32_t  ringbuffer_peek_contiguous(struct  ringbuffer *rb, uint8_t **ptr)
 {
-    enum  ringbuffer_state old_state;
+    uint32_t size = ringbuffer_data_len(rb);
+    uint32_t index = rb->tail & rb->mask;
 
-    ASSERT(rb != NULL);
+    *ptr = &rb->buffer_ptr[index];
 
-    old_state =  ringbuffer_status(rb);
+    /* only until the end of the pool */
+    if (size > ringbuffer_get_size(rb) - index)
+        size = ringbuffer_get_size(rb) - index;
 
-    rb->buffer_ptr[rb->write_index] = ch;
-
-    /* flip mirror */
-    if (rb->write_index == rb->buffer_size-1)
-    {
-        rb->write_mirror = ~rb->write_mirror;
-        rb->write_index = 0;
-        if (old_state == RT_RINGBUFFER_FULL)
-        {
-            rb->read_mirror = ~rb->read_mirror;
-            rb->read_index = rb->write_index;
-        }
-    }
-    else
-    {
-        rb->write_index++;
-        if (old_state == RT_RINGBUFFER_FULL)
-            rb->read_index = rb->write_index;
-    }
-
-    return 1;
+    return size;
 }
 
 /**
- * get a character from a ringbuffer
+ * drop data previously returned by ringbuffer_peek_contiguous()
  */
-uint32_t  ringbuffer_getchar(struct  ringbuffer *rb, uint8_t *ch)
+void  ringbuffer_consume(struct  ringbuffer *rb, uint32_t length)
 {
-    ASSERT(rb != NULL);
-
-    /* ringbuffer is empty */
-    if (! ringbuffer_data_len(rb))
-        return 0;
+    uint32_t size = ringbuffer_data_len(rb);
 
-    /* put character */
-    *ch = rb->buffer_ptr[rb->read_index];
-
-    if (rb->read_index == rb->buffer_size-1)
-    {
-        rb->read_mirror = ~rb->read_mirror;
-        rb->read_index = 0;
-    }
-    else
-    {
-        rb->read_index++;
-    }
+    if (length > size)
+        length = size;
 
-    return 1;
+    std::atomic_signal_fence(std::memory_order_release);
+    rb->tail += length;
 }
 
+/**
+ * drop all data, called from the consumer side
+ */
 void  ringbuffer_flush(struct  ringbuffer *rb)
 {
-    ASSERT(rb != NULL);
-
-    /* initialize read and write index */
-    rb->read_mirror = rb->read_index = 0;
-    rb->write_mirror = rb->write_index = 0;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    rb->tail = rb->head;
+    std::atomic_signal_fence(std::memory_order_release);
 }
 
 void  ringbuffer_init(struct  ringbuffer *rb,
                         uint8_t           *pool,
-                        int16_t            size)
+                        uint32_t           size)
 {
-    ASSERT(rb != NULL);
-    ASSERT(size > 0);
+    /* the masking needs a power of two, use the largest one that fits */
+    while (size & (size - 1))
+        size &= size - 1;
 
-    /* initialize read and write index */
-    rb->read_mirror = rb->read_index = 0;
-    rb->write_mirror = rb->write_index = 0;
-
-    /* set buffer pool and size */
     rb->buffer_ptr = pool;
-    rb->buffer_size = size; //ALIGN_DOWN(size, ALIGN_SIZE);
+    rb->mask = size - 1;
+    rb->head = 0;
+    rb->tail = 0;
+    rb->dropped = 0;
 }
-
@@ -33,6 +33,19 @@ public:
 			return -1;
 	}
 
+	// Get the contiguous block of received data without consuming it.
+	// Returns the number of bytes available at *data, 0 if none
+	int peek(uint8_t **data)
+	{
+		return ringbuffer_peek_contiguous(&rb, data);
+	}
+
+	// Drop length bytes previously returned by peek()
+	void consume(int length)
+	{
+		ringbuffer_consume(&rb, length);
+	}
+
 
 	// Send a byte of data to ROS connection
 	void write(uint8_t* data, int length)
@@ -42,6 +55,25 @@ public:
 		//debug_printf("post send no longer busy !!!!!\r\n");
 	}
 
+	// Reserve length bytes in the transmit queue to serialize into.
+	// If the queue is full, returns NULL
+	uint8_t* reserve(int length)
+	{
+		return CDC_TransmitReserve(length);
+	}
+
+	// Send the first length bytes of the reserved block, 0 to drop it
+	void commit(int length)
+	{
+		CDC_TransmitCommit(length);
+	}
+
+	// Count a message given up because reserve() had no room
+	void dropped()
+	{
+		CDC_TransmitDropped();
+	}
+
 	// Returns milliseconds since start of program
 	unsigned long time(void)
 	{
@@ -36,6 +36,13 @@ namespace actionlib
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->feedback);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
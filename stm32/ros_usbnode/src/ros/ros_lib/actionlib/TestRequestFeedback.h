@@ -23,6 +23,12 @@ namespace actionlib
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -123,6 +123,25 @@ namespace actionlib
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->terminate_status);
+      offset += sizeof(this->ignore_cancel);
+      uint32_t length_result_text = strlen(this->result_text);
+      offset += 4;
+      offset += length_result_text;
+      offset += sizeof(this->the_result);
+      offset += sizeof(this->is_simple_client);
+      offset += sizeof(this->delay_accept.sec);
+      offset += sizeof(this->delay_accept.nsec);
+      offset += sizeof(this->delay_terminate.sec);
+      offset += sizeof(this->delay_terminate.nsec);
+      offset += sizeof(this->pause_status.sec);
+      offset += sizeof(this->pause_status.nsec);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
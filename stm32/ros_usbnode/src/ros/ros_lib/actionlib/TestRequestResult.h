@@ -46,6 +46,14 @@ namespace actionlib
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->the_result);
+      offset += sizeof(this->is_simple_server);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -45,6 +45,17 @@ namespace actionlib_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->stamp.sec);
+      offset += sizeof(this->stamp.nsec);
+      uint32_t length_id = strlen(this->id);
+      offset += 4;
+      offset += length_id;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -51,6 +51,17 @@ namespace actionlib_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->goal_id.serializedLength();
+      offset += sizeof(this->status);
+      uint32_t length_text = strlen(this->text);
+      offset += 4;
+      offset += length_text;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
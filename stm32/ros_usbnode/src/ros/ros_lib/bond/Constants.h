@@ -29,6 +29,12 @@ namespace bond
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
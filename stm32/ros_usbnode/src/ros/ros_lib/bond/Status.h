@@ -80,6 +80,22 @@ namespace bond
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      uint32_t length_id = strlen(this->id);
+      offset += 4;
+      offset += length_id;
+      uint32_t length_instance_id = strlen(this->instance_id);
+      offset += 4;
+      offset += length_instance_id;
+      offset += sizeof(this->active);
+      offset += sizeof(this->heartbeat_timeout);
+      offset += sizeof(this->heartbeat_period);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
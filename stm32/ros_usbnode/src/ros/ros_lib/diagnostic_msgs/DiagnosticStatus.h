@@ -75,6 +75,26 @@ namespace diagnostic_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->level);
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      uint32_t length_message = strlen(this->message);
+      offset += 4;
+      offset += length_message;
+      uint32_t length_hardware_id = strlen(this->hardware_id);
+      offset += 4;
+      offset += length_hardware_id;
+      offset += sizeof(this->values_length);
+      for( uint32_t i = 0; i < values_length; i++){
+      offset += this->values[i].serializedLength();
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -39,6 +39,18 @@ namespace diagnostic_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_key = strlen(this->key);
+      offset += 4;
+      offset += length_key;
+      uint32_t length_value = strlen(this->value);
+      offset += 4;
+      offset += length_value;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
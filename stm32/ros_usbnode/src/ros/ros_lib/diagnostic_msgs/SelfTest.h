@@ -25,6 +25,12 @@ static const char SELFTEST[] = "diagnostic_msgs/SelfTest";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -81,6 +87,20 @@ static const char SELFTEST[] = "diagnostic_msgs/SelfTest";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_id = strlen(this->id);
+      offset += 4;
+      offset += length_id;
+      offset += sizeof(this->passed);
+      offset += sizeof(this->status_length);
+      for( uint32_t i = 0; i < status_length; i++){
+      offset += this->status[i].serializedLength();
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
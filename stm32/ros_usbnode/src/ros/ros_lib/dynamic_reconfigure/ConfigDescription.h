@@ -50,6 +50,19 @@ namespace dynamic_reconfigure
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->groups_length);
+      for( uint32_t i = 0; i < groups_length; i++){
+      offset += this->groups[i].serializedLength();
+      }
+      offset += this->max.serializedLength();
+      offset += this->min.serializedLength();
+      offset += this->dflt.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -35,6 +35,16 @@ namespace dynamic_reconfigure
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      offset += 8;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
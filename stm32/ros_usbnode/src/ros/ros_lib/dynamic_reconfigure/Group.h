@@ -79,6 +79,24 @@ namespace dynamic_reconfigure
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      uint32_t length_type = strlen(this->type);
+      offset += 4;
+      offset += length_type;
+      offset += sizeof(this->parameters_length);
+      for( uint32_t i = 0; i < parameters_length; i++){
+      offset += this->parameters[i].serializedLength();
+      }
+      offset += sizeof(this->parent);
+      offset += sizeof(this->id);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -63,6 +63,25 @@ namespace dynamic_reconfigure
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      uint32_t length_type = strlen(this->type);
+      offset += 4;
+      offset += length_type;
+      offset += sizeof(this->level);
+      uint32_t length_description = strlen(this->description);
+      offset += 4;
+      offset += length_description;
+      uint32_t length_edit_method = strlen(this->edit_method);
+      offset += 4;
+      offset += length_edit_method;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -56,6 +56,20 @@ namespace geometry_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += 8;
+      offset += this->com.serializedLength();
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
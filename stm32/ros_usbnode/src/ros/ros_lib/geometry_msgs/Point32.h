@@ -62,6 +62,15 @@ namespace geometry_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->x);
+      offset += sizeof(this->y);
+      offset += sizeof(this->z);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -33,6 +33,14 @@ namespace geometry_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += this->polygon.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
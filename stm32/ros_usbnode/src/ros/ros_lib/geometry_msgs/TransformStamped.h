@@ -41,6 +41,17 @@ namespace geometry_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      uint32_t length_child_frame_id = strlen(this->child_frame_id);
+      offset += 4;
+      offset += length_child_frame_id;
+      offset += this->transform.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
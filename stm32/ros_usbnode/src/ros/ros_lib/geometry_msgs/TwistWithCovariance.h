@@ -33,6 +33,16 @@ namespace geometry_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->twist.serializedLength();
+      for( uint32_t i = 0; i < 36; i++){
+      offset += 8;
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -91,6 +91,18 @@ namespace mower_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->status);
+      offset += sizeof(this->current);
+      offset += sizeof(this->tacho);
+      offset += sizeof(this->rpm);
+      offset += sizeof(this->temperature_motor);
+      offset += sizeof(this->temperature_pcb);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -35,6 +35,13 @@ static const char HIGHLEVELCONTROLSRV[] = "mower_msgs/HighLevelControlSrv";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->command);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -62,6 +69,12 @@ static const char HIGHLEVELCONTROLSRV[] = "mower_msgs/HighLevelControlSrv";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
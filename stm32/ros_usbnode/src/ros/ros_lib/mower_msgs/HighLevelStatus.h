@@ -132,6 +132,26 @@ namespace mower_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->state);
+      uint32_t length_state_name = strlen(this->state_name);
+      offset += 4;
+      offset += length_state_name;
+      uint32_t length_sub_state_name = strlen(this->sub_state_name);
+      offset += 4;
+      offset += length_sub_state_name;
+      offset += sizeof(this->current_area);
+      offset += sizeof(this->current_path);
+      offset += sizeof(this->current_path_index);
+      offset += sizeof(this->gps_quality_percent);
+      offset += sizeof(this->battery_percent);
+      offset += sizeof(this->is_charging);
+      offset += sizeof(this->emergency);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -65,6 +65,22 @@ namespace mower_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->dt);
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
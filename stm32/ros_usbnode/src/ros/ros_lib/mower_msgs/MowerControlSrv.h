@@ -34,6 +34,14 @@ static const char MOWERCONTROLSRV[] = "mower_msgs/MowerControlSrv";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->mow_enabled);
+      offset += sizeof(this->mow_direction);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -63,6 +71,12 @@ static const char MOWERCONTROLSRV[] = "mower_msgs/MowerControlSrv";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -62,6 +62,15 @@ namespace mower_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->left);
+      offset += sizeof(this->center);
+      offset += sizeof(this->right);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -29,6 +29,13 @@ static const char PERIMETERCONTROLSRV[] = "mower_msgs/PerimeterControlSrv";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->listenOn);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -56,6 +63,12 @@ static const char PERIMETERCONTROLSRV[] = "mower_msgs/PerimeterControlSrv";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -200,6 +200,33 @@ namespace mower_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->stamp.sec);
+      offset += sizeof(this->stamp.nsec);
+      offset += sizeof(this->mower_status);
+      offset += sizeof(this->raspberry_pi_power);
+      offset += sizeof(this->gps_power);
+      offset += sizeof(this->esc_power);
+      offset += sizeof(this->rain_detected);
+      offset += sizeof(this->sound_module_available);
+      offset += sizeof(this->sound_module_busy);
+      offset += sizeof(this->ui_board_available);
+      for( uint32_t i = 0; i < 5; i++){
+      offset += sizeof(this->ultrasonic_ranges[i]);
+      }
+      offset += sizeof(this->emergency);
+      offset += sizeof(this->v_charge);
+      offset += sizeof(this->v_battery);
+      offset += sizeof(this->charge_current);
+      offset += sizeof(this->mow_enabled);
+      offset += this->left_esc_status.serializedLength();
+      offset += this->right_esc_status.serializedLength();
+      offset += this->mow_esc_status.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
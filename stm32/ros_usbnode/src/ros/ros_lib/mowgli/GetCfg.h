@@ -40,6 +40,15 @@ static const char GETCFG[] = "mowgli/GetCfg";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -98,6 +107,18 @@ static const char GETCFG[] = "mowgli/GetCfg";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->type);
+      offset += sizeof(this->data_length);
+      for( uint32_t i = 0; i < data_length; i++){
+      offset += sizeof(this->data[i]);
+      }
+      offset += sizeof(this->status);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
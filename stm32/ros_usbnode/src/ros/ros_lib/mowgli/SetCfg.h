@@ -59,6 +59,20 @@ static const char SETCFG[] = "mowgli/SetCfg";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->type);
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      offset += sizeof(this->data_length);
+      for( uint32_t i = 0; i < data_length; i++){
+      offset += sizeof(this->data[i]);
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -113,6 +127,13 @@ static const char SETCFG[] = "mowgli/SetCfg";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->status);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
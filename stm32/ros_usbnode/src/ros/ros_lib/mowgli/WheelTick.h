@@ -106,6 +106,24 @@ namespace xbot_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->stamp.sec);
+      offset += sizeof(this->stamp.nsec);
+      offset += sizeof(this->wheel_tick_factor);
+      offset += sizeof(this->valid_wheels);
+      offset += sizeof(this->wheel_direction_fl);
+      offset += sizeof(this->wheel_ticks_fl);
+      offset += sizeof(this->wheel_direction_fr);
+      offset += sizeof(this->wheel_ticks_fr);
+      offset += sizeof(this->wheel_direction_rl);
+      offset += sizeof(this->wheel_ticks_rl);
+      offset += sizeof(this->wheel_direction_rr);
+      offset += sizeof(this->wheel_ticks_rr);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -291,6 +291,42 @@ namespace mowgli
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->stamp.sec);
+      offset += sizeof(this->stamp.nsec);
+      offset += sizeof(this->rain_detected);
+      offset += sizeof(this->emergency_status);
+      offset += sizeof(this->emergency_left_stop);
+      offset += sizeof(this->emergency_right_stop);
+      offset += sizeof(this->emergency_left_wheel_lifted);
+      offset += sizeof(this->emergency_right_wheel_lifted);
+      offset += sizeof(this->emergency_tilt_accel_triggered);
+      offset += sizeof(this->emergency_tilt_mech_triggered);
+      offset += sizeof(this->emergency_stopbutton_triggered);
+      offset += sizeof(this->v_charge);
+      offset += sizeof(this->v_battery);
+      offset += sizeof(this->i_charge);
+      offset += sizeof(this->charge_pwm);
+      offset += sizeof(this->is_charging);
+      offset += sizeof(this->blade_motor_ctrl_enabled);
+      offset += sizeof(this->drive_motor_ctrl_enabled);
+      offset += sizeof(this->left_encoder_ticks);
+      offset += sizeof(this->right_encoder_ticks);
+      offset += sizeof(this->left_power);
+      offset += sizeof(this->right_power);
+      offset += sizeof(this->blade_power);
+      offset += sizeof(this->blade_RPM);
+      offset += sizeof(this->blade_temperature);
+      offset += sizeof(this->imu_temp);
+      offset += sizeof(this->blade_motor_enabled);
+      offset += sizeof(this->sw_ver_maj);
+      offset += sizeof(this->sw_ver_bra);
+      offset += sizeof(this->sw_ver_min);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
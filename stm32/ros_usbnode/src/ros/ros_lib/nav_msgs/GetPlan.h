@@ -47,6 +47,15 @@ static const char GETPLAN[] = "nav_msgs/GetPlan";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->start.serializedLength();
+      offset += this->goal.serializedLength();
+      offset += sizeof(this->tolerance);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -89,6 +98,13 @@ static const char GETPLAN[] = "nav_msgs/GetPlan";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->plan.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -33,6 +33,15 @@ static const char LOADMAP[] = "nav_msgs/LoadMap";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_map_url = strlen(this->map_url);
+      offset += 4;
+      offset += length_map_url;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -81,6 +90,14 @@ static const char LOADMAP[] = "nav_msgs/LoadMap";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->map.serializedLength();
+      offset += sizeof(this->result);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -71,6 +71,18 @@ namespace nav_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->map_load_time.sec);
+      offset += sizeof(this->map_load_time.nsec);
+      offset += sizeof(this->resolution);
+      offset += sizeof(this->width);
+      offset += sizeof(this->height);
+      offset += this->origin.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -52,6 +52,18 @@ namespace nav_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += this->info.serializedLength();
+      offset += sizeof(this->data_length);
+      for( uint32_t i = 0; i < data_length; i++){
+      offset += sizeof(this->data[i]);
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
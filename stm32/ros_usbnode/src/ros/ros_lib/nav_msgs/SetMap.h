@@ -34,6 +34,14 @@ static const char SETMAP[] = "nav_msgs/SetMap";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->map.serializedLength();
+      offset += this->initial_pose.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -71,6 +79,13 @@ static const char SETMAP[] = "nav_msgs/SetMap";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->success);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
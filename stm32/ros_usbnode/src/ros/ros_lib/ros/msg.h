@@ -47,6 +47,8 @@ class Msg
 {
 public:
   virtual int serialize(unsigned char *outbuffer) const = 0;
+  /* number of bytes serialize() writes */
+  virtual int serializedLength() const = 0;
   virtual int deserialize(unsigned char *data) = 0;
   virtual const char * getType() = 0;
   virtual const char * getMD5() = 0;
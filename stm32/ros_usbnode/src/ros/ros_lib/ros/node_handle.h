@@ -36,6 +36,7 @@
 #define ROS_NODE_HANDLE_H_
 
 #include <stdint.h>
+#include <string.h>
 
 #include "std_msgs/Time.h"
 #include "rosserial_msgs/TopicInfo.h"
@@ -51,8 +52,12 @@ class NodeHandleBase_
 {
 public:
   virtual int publish(int id, const Msg* msg) = 0;
+  virtual int send(int id, const Msg* msg) = 0;
   virtual int spinOnce() = 0;
   virtual bool connected() = 0;
+  virtual void flushPending() = 0;
+  /* hardware time in ms, the clock of the service call timeouts */
+  virtual uint32_t hardwareTime() = 0;
 };
 }
 
@@ -70,6 +75,9 @@ const int SPIN_TIMEOUT = -2;
 const int SPIN_TX_STOP_REQUESTED = -3;
 const int SPIN_TIME_RECV = -4;
 
+/* returned by publish() if the transport has no room for the message */
+const int PUBLISH_QUEUE_FULL = -2;
+
 const uint8_t SYNC_SECONDS  = 5;
 const uint8_t MODE_FIRST_FF = 0;
 /*
@@ -118,7 +126,6 @@ protected:
   uint32_t spin_timeout_{0};
 
   uint8_t message_in[INPUT_SIZE] = {0};
-  uint8_t message_out[OUTPUT_SIZE] = {0};
 
   Publisher * publishers[MAX_PUBLISHERS] = {nullptr};
   Subscriber_ * subscribers[MAX_SUBSCRIBERS] = {nullptr};
@@ -154,8 +161,8 @@ public:
 
   /**
    * @brief Sets the maximum time in millisconds that spinOnce() can work.
-   * This will not effect the processing of the buffer, as spinOnce processes
-   * one byte at a time. It simply sets the maximum time that one call can
+   * This will not effect the processing of the buffer, as spinOnce consumes
+   * only the frames it has parsed. It simply sets the maximum time that one call can
    * process for. You can choose to clear the buffer if that is beneficial if
    * SPIN_TIMEOUT is returned from spinOnce().
    * @param timeout The timeout in milliseconds that spinOnce will function.
@@ -207,7 +214,7 @@ public:
     bool tx_stop_requested = false;
     bool saw_time_msg = false;
 
-    /* while available buffer, read data */
+    /* while available buffer, parse whole spans of data */
     while (true)
     {
       // If a timeout has been specified, check how long spinOnce has been running.
@@ -223,111 +230,61 @@ public:
           return SPIN_TIMEOUT;
         }
       }
-      int data = hardware_.read();
-      if (data < 0)
+      uint8_t * span;
+      int avail = hardware_.peek(&span);
+      if (avail <= 0)
         break;
-      checksum_ += data;
-      if (mode_ == MODE_MESSAGE)          /* message data being recieved */
-      {
-        message_in[index_++] = data;
-        bytes_--;
-        if (bytes_ == 0)                 /* is message complete? if so, checksum */
-          mode_ = MODE_MSG_CHECKSUM;
-      }
-      else if (mode_ == MODE_FIRST_FF)
-      {
-        if (data == 0xff)
-        {
-          mode_++;
-          last_msg_timeout_time = c_time + SERIAL_MSG_TIMEOUT;
-        }
-        else if (hardware_.time() - c_time > (SYNC_SECONDS * 1000))
-        {
-          /* We have been stuck in spinOnce too long, return error */
-          configured_ = false;
-          return SPIN_TIMEOUT;
-        }
-      }
-      else if (mode_ == MODE_PROTOCOL_VER)
-      {
-        if (data == PROTOCOL_VER)
-        {
-          mode_++;
-        }
-        else
-        {
-          mode_ = MODE_FIRST_FF;
-          if (configured_ == false)
-            requestSyncTime();  /* send a msg back showing our protocol version */
-        }
-      }
-      else if (mode_ == MODE_SIZE_L)      /* bottom half of message size */
-      {
-        bytes_ = data;
-        index_ = 0;
-        mode_++;
-        checksum_ = data;               /* first byte for calculating size checksum */
-      }
-      else if (mode_ == MODE_SIZE_H)      /* top half of message size */
-      {
-        bytes_ += data << 8;
-        mode_++;
-      }
-      else if (mode_ == MODE_SIZE_CHECKSUM)
-      {
-        if ((checksum_ % 256) == 255)
-          mode_++;
-        else
-          mode_ = MODE_FIRST_FF;          /* Abandon the frame if the msg len is wrong */
-      }
-      else if (mode_ == MODE_TOPIC_L)     /* bottom half of topic id */
-      {
-        topic_ = data;
-        mode_++;
-        checksum_ = data;               /* first byte included in checksum */
-      }
-      else if (mode_ == MODE_TOPIC_H)     /* top half of topic id */
-      {
-        topic_ += data << 8;
-        mode_ = MODE_MESSAGE;
-        if (bytes_ == 0)
-          mode_ = MODE_MSG_CHECKSUM;
-      }
-      else if (mode_ == MODE_MSG_CHECKSUM)    /* do checksum */
+
+      int pos = 0;
+      int rv = SPIN_OK;
+      while (pos < avail && rv != SPIN_ERR && rv != SPIN_TIMEOUT)
       {
-        mode_ = MODE_FIRST_FF;
-        if ((checksum_ % 256) == 255)
+        if (mode_ == MODE_FIRST_FF)
         {
-          if (topic_ == TopicInfo::ID_PUBLISHER)
-          {
-            requestSyncTime();
-            negotiateTopics();
-            last_sync_time = c_time;
-            last_sync_receive_time = c_time;
-            return SPIN_ERR;
-          }
-          else if (topic_ == TopicInfo::ID_TIME)
+          /* skip everything up to the next sync byte in one go */
+          uint8_t * sync = (uint8_t *) memchr(span + pos, 0xff, avail - pos);
+          if (sync == nullptr)
           {
-            saw_time_msg = true;
-            syncTime(message_in);
+            pos = avail;
+            if (hardware_.time() - c_time > (SYNC_SECONDS * 1000))
+            {
+              /* We have been stuck in spinOnce too long, return error */
+              configured_ = false;
+              rv = SPIN_TIMEOUT;
+            }
+            break;
           }
-          else if (topic_ == TopicInfo::ID_PARAMETER_REQUEST)
-          {
-            req_param_resp.deserialize(message_in);
-            param_received = true;
-          }
-          else if (topic_ == TopicInfo::ID_TX_STOP)
-          {
-            configured_ = false;
-            tx_stop_requested = true;
-          }
-          else
+          pos = sync - span;
+
+          /* fast path: the whole frame is contiguous, hand it out in place */
+          int frame_len = frameLength(span + pos, avail - pos);
+          if (frame_len > 0)
           {
-            if (subscribers[topic_ - 100])
-              subscribers[topic_ - 100]->callback(message_in);
+            rv = handleFrame(span + pos, frame_len, c_time);
+            pos += frame_len;
+            saw_time_msg |= (rv == SPIN_TIME_RECV);
+            tx_stop_requested |= (rv == SPIN_TX_STOP_REQUESTED);
+            continue;
           }
         }
+        /* slow path: frame is split or not complete yet, copy it byte by byte */
+        rv = parseByte(span[pos++], c_time);
+        saw_time_msg |= (rv == SPIN_TIME_RECV);
+        tx_stop_requested |= (rv == SPIN_TX_STOP_REQUESTED);
       }
+      hardware_.consume(pos);
+      if (rv == SPIN_ERR || rv == SPIN_TIMEOUT)
+        return rv;
+    }
+
+    /* send what was held back while the transport was busy */
+    flushPending();
+
+    /* let pending service calls time out */
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++)
+    {
+      if (subscribers[i])
+        subscribers[i]->checkTimeout(c_time);
     }
 
     /* occasionally sync time */
@@ -340,6 +297,141 @@ public:
     return saw_time_msg ? SPIN_TIME_RECV : (tx_stop_requested ? SPIN_TX_STOP_REQUESTED : SPIN_OK);
   }
 
+protected:
+  /* Length of the frame starting at data if its header is valid and the
+   * whole frame (header, payload and checksum) is in the span, 0 otherwise.
+   */
+  int frameLength(const uint8_t * data, int avail)
+  {
+    if (avail < 8 || data[0] != 0xff || data[1] != PROTOCOL_VER)
+      return 0;
+    if (((data[2] + data[3] + data[4]) % 256) != 255)
+      return 0;
+    int length = data[2] + (data[3] << 8);
+    if (length > INPUT_SIZE || length + 8 > avail)
+      return 0;
+    return length + 8;
+  }
+
+  /* Check and dispatch a complete frame, data stays valid during the callbacks */
+  int handleFrame(uint8_t * data, int frame_len, uint32_t c_time)
+  {
+    int checksum = 0;
+    for (int i = 5; i < frame_len; i++)
+      checksum += data[i];
+    if ((checksum % 256) != 255)
+      return SPIN_OK;
+    return dispatch(data[5] + (data[6] << 8), data + 7, c_time);
+  }
+
+  /* Hand a received message to its consumer */
+  int dispatch(int topic, uint8_t * data, uint32_t c_time)
+  {
+    if (topic == TopicInfo::ID_PUBLISHER)
+    {
+      requestSyncTime();
+      negotiateTopics();
+      last_sync_time = c_time;
+      last_sync_receive_time = c_time;
+      return SPIN_ERR;
+    }
+    else if (topic == TopicInfo::ID_TIME)
+    {
+      syncTime(data);
+      return SPIN_TIME_RECV;
+    }
+    else if (topic == TopicInfo::ID_PARAMETER_REQUEST)
+    {
+      req_param_resp.deserialize(data);
+      param_received = true;
+    }
+    else if (topic == TopicInfo::ID_TX_STOP)
+    {
+      configured_ = false;
+      return SPIN_TX_STOP_REQUESTED;
+    }
+    else if (topic >= 100 && topic < 100 + MAX_SUBSCRIBERS)
+    {
+      if (subscribers[topic - 100])
+        subscribers[topic - 100]->callback(data);
+    }
+    return SPIN_OK;
+  }
+
+  /* Byte wise state machine, used for frames that wrap in the buffer */
+  int parseByte(uint8_t data, uint32_t c_time)
+  {
+    checksum_ += data;
+    if (mode_ == MODE_MESSAGE)          /* message data being recieved */
+    {
+      message_in[index_++] = data;
+      bytes_--;
+      if (bytes_ == 0)                 /* is message complete? if so, checksum */
+        mode_ = MODE_MSG_CHECKSUM;
+    }
+    else if (mode_ == MODE_FIRST_FF)
+    {
+      if (data == 0xff)
+      {
+        mode_++;
+        last_msg_timeout_time = c_time + SERIAL_MSG_TIMEOUT;
+      }
+    }
+    else if (mode_ == MODE_PROTOCOL_VER)
+    {
+      if (data == PROTOCOL_VER)
+      {
+        mode_++;
+      }
+      else
+      {
+        mode_ = MODE_FIRST_FF;
+        if (configured_ == false)
+          requestSyncTime();  /* send a msg back showing our protocol version */
+      }
+    }
+    else if (mode_ == MODE_SIZE_L)      /* bottom half of message size */
+    {
+      bytes_ = data;
+      index_ = 0;
+      mode_++;
+      checksum_ = data;               /* first byte for calculating size checksum */
+    }
+    else if (mode_ == MODE_SIZE_H)      /* top half of message size */
+    {
+      bytes_ += data << 8;
+      mode_++;
+    }
+    else if (mode_ == MODE_SIZE_CHECKSUM)
+    {
+      if ((checksum_ % 256) == 255 && bytes_ <= INPUT_SIZE)
+        mode_++;
+      else
+        mode_ = MODE_FIRST_FF;          /* Abandon the frame if the msg len is wrong */
+    }
+    else if (mode_ == MODE_TOPIC_L)     /* bottom half of topic id */
+    {
+      topic_ = data;
+      mode_++;
+      checksum_ = data;               /* first byte included in checksum */
+    }
+    else if (mode_ == MODE_TOPIC_H)     /* top half of topic id */
+    {
+      topic_ += data << 8;
+      mode_ = MODE_MESSAGE;
+      if (bytes_ == 0)
+        mode_ = MODE_MSG_CHECKSUM;
+    }
+    else if (mode_ == MODE_MSG_CHECKSUM)    /* do checksum */
+    {
+      mode_ = MODE_FIRST_FF;
+      if ((checksum_ % 256) == 255)
+        return dispatch(topic_, message_in, c_time);
+    }
+    return SPIN_OK;
+  }
+
+public:
 
   /* Are we connected to the PC? */
   virtual bool connected() override
@@ -434,8 +526,8 @@ public:
   }
 
   /* Register a new Service Client */
-  template<typename MReq, typename MRes>
-  bool serviceClient(ServiceClient<MReq, MRes>& srv)
+  template<typename MReq, typename MRes, int MAX_IN_FLIGHT>
+  bool serviceClient(ServiceClient<MReq, MRes, MAX_IN_FLIGHT>& srv)
   {
     bool v = advertise(srv.pub);
     bool w = subscribe(srv);
@@ -474,12 +566,36 @@ public:
   }
 
   virtual int publish(int id, const Msg * msg) override
+  {
+    int l = send(id, msg);
+    /* the caller does not retry it : lost */
+    if (l == PUBLISH_QUEUE_FULL)
+      hardware_.dropped();
+    return l;
+  }
+
+  /* serialize msg in the transmit queue, PUBLISH_QUEUE_FULL when there is
+   * no room for it yet. Not a drop : the caller sends it again later
+   */
+  virtual int send(int id, const Msg * msg) override
   {
     if (id >= 100 && !configured_)
       return 0;
 
+    int l = msg->serializedLength();
+    if (l + 8 > OUTPUT_SIZE)
+    {
+      logerror("Message from device dropped: message larger than buffer.");
+      return -1;
+    }
+
+    /* serialize straight into the transmit queue */
+    uint8_t * message_out = hardware_.reserve(l + 8);
+    if (message_out == nullptr)
+      return PUBLISH_QUEUE_FULL;
+
     /* serialize message */
-    int l = msg->serialize(message_out + 7);
+    msg->serialize(message_out + 7);
 
     /* setup the header */
     message_out[0] = 0xff;
@@ -491,21 +607,47 @@ public:
     message_out[6] = (uint8_t)((int16_t)id >> 8);
 
     /* calculate checksum */
-    int chk = 0;
-    for (int i = 5; i < l + 7; i++)
+    int chk = message_out[5] + message_out[6];
+    for (int i = 7; i < l + 7; i++)
       chk += message_out[i];
     l += 7;
     message_out[l++] = 255 - (chk % 256);
 
-    if (l <= OUTPUT_SIZE)
-    {
-      hardware_.write(message_out, l);
-      return l;
-    }
-    else
+    hardware_.commit(l);
+    return l;
+  }
+
+  virtual uint32_t hardwareTime() override
+  {
+    return hardware_.time();
+  }
+
+  /* advertised publisher number index, nullptr past the last one */
+  Publisher * getPublisher(int index)
+  {
+    return index < MAX_PUBLISHERS ? publishers[index] : nullptr;
+  }
+
+  /* Send the pending messages of prioritized publishers, most urgent
+   * class first. Stops at the first message the transport has no room
+   * for, the rest is retried on the next call.
+   */
+  virtual void flushPending() override
+  {
+    for (int priority = 0; priority < Publisher::PRIORITY_CLASSES; priority++)
     {
-      logerror("Message from device dropped: message larger than buffer.");
-      return -1;
+      for (int i = 0; i < MAX_PUBLISHERS; i++)
+      {
+        Publisher * p = publishers[i];
+        if (p == nullptr || p->pending_ == nullptr || p->getPriority() != priority)
+          continue;
+        int l = send(p->id_, p->pending_);
+        if (l == PUBLISH_QUEUE_FULL)
+          return;
+        if (l <= 0)
+          p->dropped_++;
+        p->pending_ = nullptr;
+      }
     }
   }
 
@@ -45,19 +45,50 @@ namespace ros
 class Publisher
 {
 public:
+  /* publish() sends right away unless a priority is set */
+  static const int PRIORITY_IMMEDIATE = -1;
+  /* 0 is the most urgent priority class */
+  static const int PRIORITY_CLASSES = 4;
+
   Publisher(const char * topic_name, Msg * msg, int endpoint = rosserial_msgs::TopicInfo::ID_PUBLISHER) :
     topic_(topic_name),
     msg_(msg),
     endpoint_(endpoint) {};
 
+  /* With a priority the message is only marked pending and the node handle
+   * sends the pending messages by priority as soon as the transport has
+   * room. Until then msg must stay valid, a newer publish() replaces the
+   * pending one.
+   */
   int publish(const Msg * msg)
   {
-    return nh_->publish(id_, msg);
+    if (priority_ == PRIORITY_IMMEDIATE)
+      return nh_->publish(id_, msg);
+    if (pending_ != nullptr)
+      replaced_++;
+    pending_ = msg;
+    nh_->flushPending();
+    return 0;
+  };
+  /* Sends right away, a full transmit queue is not counted as a drop :
+   * for callers keeping msg and publishing it again until this returns > 0
+   */
+  int tryPublish(const Msg * msg)
+  {
+    return nh_->send(id_, msg);
   };
   int getEndpointType()
   {
     return endpoint_;
   }
+  void setPriority(int priority)
+  {
+    priority_ = priority;
+  }
+  int getPriority()
+  {
+    return priority_;
+  }
 
   const char * topic_;
   Msg *msg_;
@@ -65,8 +96,14 @@ public:
   int id_;
   NodeHandleBase_* nh_;
 
+  // latest value not sent yet, handled by NodeHandle::flushPending()
+  const Msg * pending_ = nullptr;
+  uint32_t replaced_ = 0;   // pending messages overwritten by a newer one
+  uint32_t dropped_ = 0;    // pending messages the node handle refused to send
+
 private:
   int endpoint_;
+  int priority_ = PRIORITY_IMMEDIATE;
 };
 
 }
@@ -43,10 +43,17 @@
 namespace ros
 {
 
-template<typename MReq , typename MRes>
+/* Service client, either blocking with call() or non blocking with call_async().
+ * rosserial answers the requests of a service in order, so the requests in
+ * flight are kept in a FIFO and a response always belongs to the oldest one.
+ */
+template<typename MReq , typename MRes, int MAX_IN_FLIGHT = 4>
 class ServiceClient : public Subscriber_
 {
 public:
+  /* called with the response, or with timed_out set if none arrived in time */
+  typedef void(*CallbackT)(const MRes & response, bool timed_out);
+
   ServiceClient(const char* topic_name) :
     pub(topic_name, &req, rosserial_msgs::TopicInfo::ID_SERVICE_CLIENT + rosserial_msgs::TopicInfo::ID_PUBLISHER)
   {
@@ -64,11 +71,83 @@ public:
       if (pub.nh_->spinOnce() < 0) break;
   }
 
+  /* Send the request and return immediately, cb is called from spinOnce()
+   * once the response arrived or timeout_ms elapsed.
+   * Returns false if the request could not be sent.
+   */
+  bool call_async(const MReq & request, CallbackT cb, uint32_t timeout_ms)
+  {
+    if (!pub.nh_->connected() || in_flight >= MAX_IN_FLIGHT)
+    {
+      dropped_count++;
+      return false;
+    }
+    if (pub.publish(&request) <= 0)
+    {
+      dropped_count++;
+      return false;
+    }
+    Request & r = requests[(first + in_flight) % MAX_IN_FLIGHT];
+    r.cb = cb;
+    r.timeout = timeout_ms;
+    r.deadline = pub.nh_->hardwareTime() + timeout_ms;
+    r.timed_out = false;
+    in_flight++;
+    return true;
+  }
+
   // these refer to the subscriber
   virtual void callback(unsigned char *data) override
   {
-    ret->deserialize(data);
-    waiting = false;
+    if (in_flight > 0)
+    {
+      Request & r = requests[first];
+      first = (first + 1) % MAX_IN_FLIGHT;
+      in_flight--;
+      if (r.timed_out)
+      {
+        /* the caller already got its timeout */
+        late_count++;
+        return;
+      }
+      resp.deserialize(data);
+      if (r.cb)
+        r.cb(resp, false);
+    }
+    else if (waiting && ret)
+    {
+      ret->deserialize(data);
+      waiting = false;
+    }
+    else
+    {
+      dropped_count++;
+    }
+  }
+  virtual void checkTimeout(uint32_t time) override
+  {
+    for (int i = 0; i < in_flight; i++)
+    {
+      Request & r = requests[(first + i) % MAX_IN_FLIGHT];
+      if (!r.timed_out && (int32_t)(time - r.deadline) >= 0)
+      {
+        r.timed_out = true;
+        timeout_count++;
+        if (r.cb)
+          r.cb(resp, true);
+      }
+    }
+    /* keep timed out requests for one more timeout to swallow late responses,
+     * after that the response is considered lost */
+    while (in_flight > 0)
+    {
+      Request & r = requests[first];
+      if (!r.timed_out || (int32_t)(time - r.deadline) < (int32_t)r.timeout)
+        break;
+      first = (first + 1) % MAX_IN_FLIGHT;
+      in_flight--;
+      dropped_count++;
+    }
   }
   virtual const char * getMsgType() override
   {
@@ -85,9 +164,26 @@ public:
 
   MReq req;
   MRes resp;
-  MRes * ret;
+  MRes * ret = nullptr;
   bool waiting;
   Publisher pub;
+
+  /* statistics of call_async() */
+  uint32_t timeout_count = 0;   // requests without response in time
+  uint32_t late_count = 0;      // responses received after the timeout
+  uint32_t dropped_count = 0;   // requests not sent and responses never received
+
+private:
+  struct Request
+  {
+    CallbackT cb;
+    uint32_t deadline;
+    uint32_t timeout;
+    bool timed_out;
+  };
+  Request requests[MAX_IN_FLIGHT];
+  int first = 0;
+  int in_flight = 0;
 };
 
 }
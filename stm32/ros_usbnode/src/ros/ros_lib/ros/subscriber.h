@@ -52,6 +52,8 @@ public:
 
   virtual const char * getMsgType() = 0;
   virtual const char * getMsgMD5() = 0;
+  // called on every spinOnce() with the current time in ms
+  virtual void checkTimeout(uint32_t time) {}
   const char * topic_;
 };
 
@@ -40,6 +40,18 @@ static const char SETLOGGERLEVEL[] = "roscpp/SetLoggerLevel";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_logger = strlen(this->logger);
+      offset += 4;
+      offset += length_logger;
+      uint32_t length_level = strlen(this->level);
+      offset += 4;
+      offset += length_level;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -83,6 +95,12 @@ static const char SETLOGGERLEVEL[] = "roscpp/SetLoggerLevel";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -37,6 +37,14 @@ namespace rosgraph_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->clock.sec);
+      offset += sizeof(this->clock.nsec);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -100,6 +100,33 @@ namespace rosgraph_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += sizeof(this->level);
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      uint32_t length_msg = strlen(this->msg);
+      offset += 4;
+      offset += length_msg;
+      uint32_t length_file = strlen(this->file);
+      offset += 4;
+      offset += length_file;
+      uint32_t length_function = strlen(this->function);
+      offset += 4;
+      offset += length_function;
+      offset += sizeof(this->line);
+      offset += sizeof(this->topics_length);
+      for( uint32_t i = 0; i < topics_length; i++){
+      uint32_t length_topicsi = strlen(this->topics[i]);
+      offset += 4;
+      offset += length_topicsi;
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -192,6 +192,40 @@ namespace rosgraph_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_topic = strlen(this->topic);
+      offset += 4;
+      offset += length_topic;
+      uint32_t length_node_pub = strlen(this->node_pub);
+      offset += 4;
+      offset += length_node_pub;
+      uint32_t length_node_sub = strlen(this->node_sub);
+      offset += 4;
+      offset += length_node_sub;
+      offset += sizeof(this->window_start.sec);
+      offset += sizeof(this->window_start.nsec);
+      offset += sizeof(this->window_stop.sec);
+      offset += sizeof(this->window_stop.nsec);
+      offset += sizeof(this->delivered_msgs);
+      offset += sizeof(this->dropped_msgs);
+      offset += sizeof(this->traffic);
+      offset += sizeof(this->period_mean.sec);
+      offset += sizeof(this->period_mean.nsec);
+      offset += sizeof(this->period_stddev.sec);
+      offset += sizeof(this->period_stddev.nsec);
+      offset += sizeof(this->period_max.sec);
+      offset += sizeof(this->period_max.nsec);
+      offset += sizeof(this->stamp_age_mean.sec);
+      offset += sizeof(this->stamp_age_mean.nsec);
+      offset += sizeof(this->stamp_age_stddev.sec);
+      offset += sizeof(this->stamp_age_stddev.nsec);
+      offset += sizeof(this->stamp_age_max.sec);
+      offset += sizeof(this->stamp_age_max.nsec);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
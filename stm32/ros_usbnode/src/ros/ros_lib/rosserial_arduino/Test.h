@@ -32,6 +32,15 @@ static const char TEST[] = "rosserial_arduino/Test";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_input = strlen(this->input);
+      offset += 4;
+      offset += length_input;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -74,6 +83,15 @@ static const char TEST[] = "rosserial_arduino/Test";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_output = strlen(this->output);
+      offset += 4;
+      offset += length_output;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -59,6 +59,18 @@ namespace rosserial_mbed
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->adc0);
+      offset += sizeof(this->adc1);
+      offset += sizeof(this->adc2);
+      offset += sizeof(this->adc3);
+      offset += sizeof(this->adc4);
+      offset += sizeof(this->adc5);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -41,6 +41,16 @@ namespace rosserial_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->level);
+      uint32_t length_msg = strlen(this->msg);
+      offset += 4;
+      offset += length_msg;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
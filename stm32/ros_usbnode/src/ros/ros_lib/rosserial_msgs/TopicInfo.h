@@ -74,6 +74,23 @@ namespace rosserial_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->topic_id);
+      uint32_t length_topic_name = strlen(this->topic_name);
+      offset += 4;
+      offset += length_topic_name;
+      uint32_t length_message_type = strlen(this->message_type);
+      offset += 4;
+      offset += length_message_type;
+      uint32_t length_md5sum = strlen(this->md5sum);
+      offset += 4;
+      offset += length_md5sum;
+      offset += sizeof(this->buffer_size);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
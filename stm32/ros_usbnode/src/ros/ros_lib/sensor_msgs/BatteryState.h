@@ -225,6 +225,38 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += sizeof(this->voltage);
+      offset += sizeof(this->temperature);
+      offset += sizeof(this->current);
+      offset += sizeof(this->charge);
+      offset += sizeof(this->capacity);
+      offset += sizeof(this->design_capacity);
+      offset += sizeof(this->percentage);
+      offset += sizeof(this->power_supply_status);
+      offset += sizeof(this->power_supply_health);
+      offset += sizeof(this->power_supply_technology);
+      offset += sizeof(this->present);
+      offset += sizeof(this->cell_voltage_length);
+      for( uint32_t i = 0; i < cell_voltage_length; i++){
+      offset += sizeof(this->cell_voltage[i]);
+      }
+      offset += sizeof(this->cell_temperature_length);
+      for( uint32_t i = 0; i < cell_temperature_length; i++){
+      offset += sizeof(this->cell_temperature[i]);
+      }
+      uint32_t length_location = strlen(this->location);
+      offset += 4;
+      offset += length_location;
+      uint32_t length_serial_number = strlen(this->serial_number);
+      offset += 4;
+      offset += length_serial_number;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
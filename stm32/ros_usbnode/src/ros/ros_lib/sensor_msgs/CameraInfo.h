@@ -101,6 +101,34 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += sizeof(this->height);
+      offset += sizeof(this->width);
+      uint32_t length_distortion_model = strlen(this->distortion_model);
+      offset += 4;
+      offset += length_distortion_model;
+      offset += sizeof(this->D_length);
+      for( uint32_t i = 0; i < D_length; i++){
+      offset += 8;
+      }
+      for( uint32_t i = 0; i < 9; i++){
+      offset += 8;
+      }
+      for( uint32_t i = 0; i < 9; i++){
+      offset += 8;
+      }
+      for( uint32_t i = 0; i < 12; i++){
+      offset += 8;
+      }
+      offset += sizeof(this->binning_x);
+      offset += sizeof(this->binning_y);
+      offset += this->roi.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -79,6 +79,24 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += sizeof(this->height);
+      offset += sizeof(this->width);
+      uint32_t length_encoding = strlen(this->encoding);
+      offset += 4;
+      offset += length_encoding;
+      offset += sizeof(this->is_bigendian);
+      offset += sizeof(this->step);
+      offset += sizeof(this->data_length);
+      for( uint32_t i = 0; i < data_length; i++){
+      offset += sizeof(this->data[i]);
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -57,6 +57,25 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += this->orientation.serializedLength();
+      for( uint32_t i = 0; i < 9; i++){
+      offset += 8;
+      }
+      offset += this->angular_velocity.serializedLength();
+      for( uint32_t i = 0; i < 9; i++){
+      offset += 8;
+      }
+      offset += this->linear_acceleration.serializedLength();
+      for( uint32_t i = 0; i < 9; i++){
+      offset += 8;
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
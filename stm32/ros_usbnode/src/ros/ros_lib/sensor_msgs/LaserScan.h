@@ -163,6 +163,28 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += sizeof(this->angle_min);
+      offset += sizeof(this->angle_max);
+      offset += sizeof(this->angle_increment);
+      offset += sizeof(this->time_increment);
+      offset += sizeof(this->scan_time);
+      offset += sizeof(this->range_min);
+      offset += sizeof(this->range_max);
+      offset += sizeof(this->ranges_length);
+      for( uint32_t i = 0; i < ranges_length; i++){
+      offset += sizeof(this->ranges[i]);
+      }
+      offset += sizeof(this->intensities_length);
+      for( uint32_t i = 0; i < intensities_length; i++){
+      offset += sizeof(this->intensities[i]);
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
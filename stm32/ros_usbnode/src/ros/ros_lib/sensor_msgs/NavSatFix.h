@@ -59,6 +59,21 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += this->status.serializedLength();
+      offset += 8;
+      offset += 8;
+      offset += 8;
+      for( uint32_t i = 0; i < 9; i++){
+      offset += 8;
+      }
+      offset += sizeof(this->position_covariance_type);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
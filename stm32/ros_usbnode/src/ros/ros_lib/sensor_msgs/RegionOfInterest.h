@@ -65,6 +65,17 @@ namespace sensor_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->x_offset);
+      offset += sizeof(this->y_offset);
+      offset += sizeof(this->height);
+      offset += sizeof(this->width);
+      offset += sizeof(this->do_rectify);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
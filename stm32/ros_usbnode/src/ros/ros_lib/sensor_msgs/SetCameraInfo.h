@@ -29,6 +29,13 @@ static const char SETCAMERAINFO[] = "sensor_msgs/SetCameraInfo";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->camera_info.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -73,6 +80,16 @@ static const char SETCAMERAINFO[] = "sensor_msgs/SetCameraInfo";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->success);
+      uint32_t length_status_message = strlen(this->status_message);
+      offset += 4;
+      offset += length_status_message;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -32,6 +32,15 @@ namespace shape_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      for( uint32_t i = 0; i < 3; i++){
+      offset += sizeof(this->vertex_indices[i]);
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
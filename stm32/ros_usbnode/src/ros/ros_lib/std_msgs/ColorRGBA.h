@@ -75,6 +75,16 @@ namespace std_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->r);
+      offset += sizeof(this->g);
+      offset += sizeof(this->b);
+      offset += sizeof(this->a);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -47,6 +47,17 @@ namespace std_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_label = strlen(this->label);
+      offset += 4;
+      offset += length_label;
+      offset += sizeof(this->size);
+      offset += sizeof(this->stride);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
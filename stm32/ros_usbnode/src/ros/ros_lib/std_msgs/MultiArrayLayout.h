@@ -49,6 +49,17 @@ namespace std_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->dim_length);
+      for(uint32_t i = 0; i < dim_length; i++) {
+        offset += this->dim[i].serializedLength();
+      }
+      offset += sizeof(this->data_offset);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
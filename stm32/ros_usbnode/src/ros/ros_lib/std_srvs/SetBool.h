@@ -34,6 +34,13 @@ static const char SETBOOL[] = "std_srvs/SetBool";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->data);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -85,6 +92,16 @@ static const char SETBOOL[] = "std_srvs/SetBool";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->success);
+      uint32_t length_message = strlen(this->message);
+      offset += 4;
+      offset += length_message;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
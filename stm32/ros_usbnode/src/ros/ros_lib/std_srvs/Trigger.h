@@ -24,6 +24,12 @@ static const char TRIGGER[] = "std_srvs/Trigger";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -67,6 +73,16 @@ static const char TRIGGER[] = "std_srvs/Trigger";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->success);
+      uint32_t length_message = strlen(this->message);
+      offset += 4;
+      offset += length_message;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
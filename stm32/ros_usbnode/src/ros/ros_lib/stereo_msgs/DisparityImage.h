@@ -103,6 +103,20 @@ namespace stereo_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += this->image.serializedLength();
+      offset += sizeof(this->f);
+      offset += sizeof(this->T);
+      offset += this->valid_window.serializedLength();
+      offset += sizeof(this->min_disparity);
+      offset += sizeof(this->max_disparity);
+      offset += sizeof(this->delta_d);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
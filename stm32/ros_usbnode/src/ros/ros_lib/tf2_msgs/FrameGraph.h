@@ -24,6 +24,12 @@ static const char FRAMEGRAPH[] = "tf2_msgs/FrameGraph";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -57,6 +63,15 @@ static const char FRAMEGRAPH[] = "tf2_msgs/FrameGraph";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_frame_yaml = strlen(this->frame_yaml);
+      offset += 4;
+      offset += length_frame_yaml;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
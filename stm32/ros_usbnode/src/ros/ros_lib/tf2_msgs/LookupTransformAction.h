@@ -38,6 +38,15 @@ namespace tf2_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->action_goal.serializedLength();
+      offset += this->action_result.serializedLength();
+      offset += this->action_feedback.serializedLength();
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
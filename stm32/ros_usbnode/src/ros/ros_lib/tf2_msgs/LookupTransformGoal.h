@@ -98,6 +98,28 @@ namespace tf2_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_target_frame = strlen(this->target_frame);
+      offset += 4;
+      offset += length_target_frame;
+      uint32_t length_source_frame = strlen(this->source_frame);
+      offset += 4;
+      offset += length_source_frame;
+      offset += sizeof(this->source_time.sec);
+      offset += sizeof(this->source_time.nsec);
+      offset += sizeof(this->timeout.sec);
+      offset += sizeof(this->timeout.nsec);
+      offset += sizeof(this->target_time.sec);
+      offset += sizeof(this->target_time.nsec);
+      uint32_t length_fixed_frame = strlen(this->fixed_frame);
+      offset += 4;
+      offset += length_fixed_frame;
+      offset += sizeof(this->advanced);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
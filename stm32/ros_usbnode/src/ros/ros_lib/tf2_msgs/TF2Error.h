@@ -43,6 +43,16 @@ namespace tf2_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->error);
+      uint32_t length_error_string = strlen(this->error_string);
+      offset += 4;
+      offset += length_error_string;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -32,6 +32,15 @@ static const char DEMUXADD[] = "topic_tools/DemuxAdd";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_topic = strlen(this->topic);
+      offset += 4;
+      offset += length_topic;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -66,6 +75,12 @@ static const char DEMUXADD[] = "topic_tools/DemuxAdd";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -32,6 +32,15 @@ static const char DEMUXSELECT[] = "topic_tools/DemuxSelect";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_topic = strlen(this->topic);
+      offset += 4;
+      offset += length_topic;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -74,6 +83,15 @@ static const char DEMUXSELECT[] = "topic_tools/DemuxSelect";
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_prev_topic = strlen(this->prev_topic);
+      offset += 4;
+      offset += length_prev_topic;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -154,6 +154,34 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      uint32_t length_ns = strlen(this->ns);
+      offset += 4;
+      offset += length_ns;
+      offset += sizeof(this->id);
+      offset += sizeof(this->type);
+      offset += sizeof(this->action);
+      offset += this->position.serializedLength();
+      offset += sizeof(this->scale);
+      offset += this->outline_color.serializedLength();
+      offset += sizeof(this->filled);
+      offset += this->fill_color.serializedLength();
+      offset += sizeof(this->lifetime.sec);
+      offset += sizeof(this->lifetime.nsec);
+      offset += sizeof(this->points_length);
+      for( uint32_t i = 0; i < points_length; i++){
+      offset += this->points[i].serializedLength();
+      }
+      offset += sizeof(this->outline_colors_length);
+      for( uint32_t i = 0; i < outline_colors_length; i++){
+      offset += this->outline_colors[i].serializedLength();
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
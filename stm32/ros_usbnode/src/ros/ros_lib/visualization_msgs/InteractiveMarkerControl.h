@@ -101,6 +101,27 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      offset += this->orientation.serializedLength();
+      offset += sizeof(this->orientation_mode);
+      offset += sizeof(this->interaction_mode);
+      offset += sizeof(this->always_visible);
+      offset += sizeof(this->markers_length);
+      for( uint32_t i = 0; i < markers_length; i++){
+      offset += this->markers[i].serializedLength();
+      }
+      offset += sizeof(this->independent_marker_orientation);
+      uint32_t length_description = strlen(this->description);
+      offset += 4;
+      offset += length_description;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -91,6 +91,27 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      uint32_t length_client_id = strlen(this->client_id);
+      offset += 4;
+      offset += length_client_id;
+      uint32_t length_marker_name = strlen(this->marker_name);
+      offset += 4;
+      offset += length_marker_name;
+      uint32_t length_control_name = strlen(this->control_name);
+      offset += 4;
+      offset += length_control_name;
+      offset += sizeof(this->event_type);
+      offset += this->pose.serializedLength();
+      offset += sizeof(this->menu_entry_id);
+      offset += this->mouse_point.serializedLength();
+      offset += sizeof(this->mouse_point_valid);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -57,6 +57,20 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      uint32_t length_server_id = strlen(this->server_id);
+      offset += 4;
+      offset += length_server_id;
+      offset += sizeof(this->seq_num);
+      offset += sizeof(this->markers_length);
+      for( uint32_t i = 0; i < markers_length; i++){
+      offset += this->markers[i].serializedLength();
+      }
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
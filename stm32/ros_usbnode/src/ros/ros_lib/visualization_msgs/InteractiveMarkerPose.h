@@ -41,6 +41,17 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      offset += this->pose.serializedLength();
+      uint32_t length_name = strlen(this->name);
+      offset += 4;
+      offset += length_name;
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -183,6 +183,40 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += this->header.serializedLength();
+      uint32_t length_ns = strlen(this->ns);
+      offset += 4;
+      offset += length_ns;
+      offset += sizeof(this->id);
+      offset += sizeof(this->type);
+      offset += sizeof(this->action);
+      offset += this->pose.serializedLength();
+      offset += this->scale.serializedLength();
+      offset += this->color.serializedLength();
+      offset += sizeof(this->lifetime.sec);
+      offset += sizeof(this->lifetime.nsec);
+      offset += sizeof(this->frame_locked);
+      offset += sizeof(this->points_length);
+      for( uint32_t i = 0; i < points_length; i++){
+      offset += this->points[i].serializedLength();
+      }
+      offset += sizeof(this->colors_length);
+      for( uint32_t i = 0; i < colors_length; i++){
+      offset += this->colors[i].serializedLength();
+      }
+      uint32_t length_text = strlen(this->text);
+      offset += 4;
+      offset += length_text;
+      uint32_t length_mesh_resource = strlen(this->mesh_resource);
+      offset += 4;
+      offset += length_mesh_resource;
+      offset += sizeof(this->mesh_use_embedded_materials);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
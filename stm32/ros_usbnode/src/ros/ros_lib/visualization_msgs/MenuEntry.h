@@ -63,6 +63,21 @@ namespace visualization_msgs
       return offset;
     }
 
+    virtual int serializedLength() const override
+    {
+      int offset = 0;
+      offset += sizeof(this->id);
+      offset += sizeof(this->parent_id);
+      uint32_t length_title = strlen(this->title);
+      offset += 4;
+      offset += length_title;
+      uint32_t length_command = strlen(this->command);
+      offset += 4;
+      offset += length_command;
+      offset += sizeof(this->command_type);
+      return offset;
+    }
+
     virtual int deserialize(unsigned char *inbuffer) override
     {
       int offset = 0;
@@ -0,0 +1,230 @@
+/****************************************************************************
+* Title                 :   scheduler module
+* Filename              :   scheduler.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file scheduler.c
+ *  \brief deadline ordered scheduler for the main loop
+ *
+ *  Periodic tasks are kept in a list sorted by their next deadline, so only
+ *  the head has to be checked. A task is rescheduled relative to its previous
+ *  deadline and not to the time it actually ran, so the periods do not drift.
+ *  Event tasks are run once each time they are posted, typically from an ISR.
+ *  When nothing is due the CPU sleeps until the next interrupt (at least the
+ *  1ms SysTick).
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stddef.h>
+#include "stm32f1xx_hal.h"
+
+#include "main.h"
+#include "scheduler.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+/* true if tick a is at or after tick b, safe over the tick wrap around */
+#define SCHEDULER_DUE(a, b) ((int32_t)((a) - (b)) >= 0)
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static SCHEDULER_Task_t *scheduler_psQueue = NULL;
+static SCHEDULER_Task_t *scheduler_psTasks[SCHEDULER_MAX_TASKS];
+static uint8_t scheduler_u8NbTasks = 0;
+static volatile uint8_t scheduler_u8Posted = 0;
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+static void scheduler_Register(SCHEDULER_Task_t *psTask, const char *pcName, SCHEDULER_TaskFunc_t pfFunc, uint32_t u32Period);
+static void scheduler_Insert(SCHEDULER_Task_t *psTask);
+static void scheduler_Execute(SCHEDULER_Task_t *psTask, uint32_t u32Lateness);
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Init the scheduler, enables the DWT cycle counter used for the run times
+/// @param
+void SCHEDULER_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    scheduler_psQueue = NULL;
+    scheduler_u8NbTasks = 0;
+    scheduler_u8Posted = 0;
+}
+
+/// @brief Add a periodic task
+/// @param psTask task storage, must stay valid
+/// @param pcName name used for the statistics
+/// @param pfFunc function to run
+/// @param u32Period period in ms
+/// @param u32Phase delay of the first run in ms, used to spread tasks with the same period
+void SCHEDULER_AddPeriodic(SCHEDULER_Task_t *psTask, const char *pcName, SCHEDULER_TaskFunc_t pfFunc, uint32_t u32Period, uint32_t u32Phase)
+{
+    scheduler_Register(psTask, pcName, pfFunc, u32Period);
+    psTask->u32Deadline = HAL_GetTick() + u32Phase;
+    scheduler_Insert(psTask);
+}
+
+/// @brief Add a task which only runs when posted with SCHEDULER_Post()
+/// @param psTask task storage, must stay valid
+/// @param pcName name used for the statistics
+/// @param pfFunc function to run
+void SCHEDULER_AddEvent(SCHEDULER_Task_t *psTask, const char *pcName, SCHEDULER_TaskFunc_t pfFunc)
+{
+    scheduler_Register(psTask, pcName, pfFunc, 0);
+}
+
+/// @brief Request one run of an event task, can be called from an ISR
+/// @param psTask task to run
+void SCHEDULER_Post(SCHEDULER_Task_t *psTask)
+{
+    psTask->u32Deadline = HAL_GetTick();
+    psTask->u8Posted = 1;
+    scheduler_u8Posted = 1;
+}
+
+/// @brief Run the posted and due tasks, sleep if there is nothing to do
+/// @param
+void SCHEDULER_Run(void)
+{
+    uint8_t l_u8Idx;
+    uint32_t l_u32Now;
+    SCHEDULER_Task_t *l_psTask;
+
+    /* posted events first, they are waited for by someone */
+    if (scheduler_u8Posted)
+    {
+        scheduler_u8Posted = 0;
+        for (l_u8Idx = 0; l_u8Idx < scheduler_u8NbTasks; l_u8Idx++)
+        {
+            l_psTask = scheduler_psTasks[l_u8Idx];
+            if (l_psTask->u8Posted)
+            {
+                l_psTask->u8Posted = 0;
+                scheduler_Execute(l_psTask, HAL_GetTick() - l_psTask->u32Deadline);
+            }
+        }
+    }
+
+    /* then every periodic task whose deadline passed, earliest first */
+    l_u32Now = HAL_GetTick();
+    while (scheduler_psQueue != NULL && SCHEDULER_DUE(l_u32Now, scheduler_psQueue->u32Deadline))
+    {
+        l_psTask = scheduler_psQueue;
+        scheduler_psQueue = l_psTask->psNext;
+
+        scheduler_Execute(l_psTask, l_u32Now - l_psTask->u32Deadline);
+
+        /* fixed phase, skip the periods we are already too late for */
+        l_psTask->u32Deadline += l_psTask->u32Period;
+        l_u32Now = HAL_GetTick();
+        while (SCHEDULER_DUE(l_u32Now, l_psTask->u32Deadline + l_psTask->u32Period))
+        {
+            l_psTask->u32Deadline += l_psTask->u32Period;
+            l_psTask->u32Skipped++;
+        }
+        scheduler_Insert(l_psTask);
+    }
+
+#if SCHEDULER_USE_WFI == 1
+    /* with interrupts masked, an ISR posting an event now still wakes up the WFI */
+    __disable_irq();
+    if (!scheduler_u8Posted && (scheduler_psQueue == NULL || !SCHEDULER_DUE(HAL_GetTick(), scheduler_psQueue->u32Deadline)))
+    {
+        __WFI();
+    }
+    __enable_irq();
+#endif
+}
+
+/// @brief Get a registered task, used to report the statistics
+/// @param u8Idx index of the task
+/// @retval the task or NULL past the last one
+SCHEDULER_Task_t *SCHEDULER_GetTask(uint8_t u8Idx)
+{
+    if (u8Idx >= scheduler_u8NbTasks)
+    {
+        return NULL;
+    }
+    return scheduler_psTasks[u8Idx];
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
+
+static void scheduler_Register(SCHEDULER_Task_t *psTask, const char *pcName, SCHEDULER_TaskFunc_t pfFunc, uint32_t u32Period)
+{
+    if (scheduler_u8NbTasks >= SCHEDULER_MAX_TASKS)
+    {
+        Error_Handler();
+    }
+
+    psTask->pcName = pcName;
+    psTask->pfFunc = pfFunc;
+    psTask->u32Period = u32Period;
+    psTask->u8Posted = 0;
+    psTask->psNext = NULL;
+    psTask->u32Runs = 0;
+    psTask->u32Skipped = 0;
+    psTask->u32MaxLateness = 0;
+    psTask->u32MaxRunTime = 0;
+#if OPTION_PROFILER == 1
+    PROFILER_Reset(&psTask->sProfile);
+#endif
+
+    scheduler_psTasks[scheduler_u8NbTasks++] = psTask;
+}
+
+/* insert in deadline order, after the tasks with the same deadline */
+static void scheduler_Insert(SCHEDULER_Task_t *psTask)
+{
+    SCHEDULER_Task_t **l_ppsPos = &scheduler_psQueue;
+
+    while (*l_ppsPos != NULL && SCHEDULER_DUE(psTask->u32Deadline, (*l_ppsPos)->u32Deadline))
+    {
+        l_ppsPos = &(*l_ppsPos)->psNext;
+    }
+    psTask->psNext = *l_ppsPos;
+    *l_ppsPos = psTask;
+}
+
+static void scheduler_Execute(SCHEDULER_Task_t *psTask, uint32_t u32Lateness)
+{
+    uint32_t l_u32Start = DWT->CYCCNT;
+
+    psTask->pfFunc();
+
+    uint32_t l_u32RunTime = DWT->CYCCNT - l_u32Start;
+    psTask->u32Runs++;
+    if (u32Lateness > psTask->u32MaxLateness)
+    {
+        psTask->u32MaxLateness = u32Lateness;
+    }
+    if (l_u32RunTime > psTask->u32MaxRunTime)
+    {
+        psTask->u32MaxRunTime = l_u32RunTime;
+    }
+#if OPTION_PROFILER == 1
+    PROFILER_Record(&psTask->sProfile, l_u32RunTime);
+#endif
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+* Title                 :   speed module
+* Filename              :   speed.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file speed.c
+ *  \brief closed loop speed of one drive wheel
+ *
+ *  PI(D) run on every drive motor reply, on the speed from the tick delta.
+ *  The PWM_PER_MPS map is the feed-forward, the loop only corrects what the
+ *  load and the battery change. The integral is frozen while the output is
+ *  saturated (anti-windup). The tracking error is summed for the statistics.
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <math.h>
+
+#include "board.h"
+#include "speed.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Preprocessor Macros
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+
+/******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+
+/******************************************************************************
+ *  Public Functions
+ *******************************************************************************/
+
+/// @brief Output for a new setpoint until the next reply runs the loop, a stop is immediate
+/// @param psWheel wheel state
+/// @param u8Speed requested PWM
+/// @param u8Dir requested direction, 1 forward
+void SPEED_Setpoint(SPEED_Wheel_t *psWheel, uint8_t u8Speed, uint8_t u8Dir)
+{
+    float l_fDrive = u8Speed;
+
+    if (u8Speed == 0 || u8Dir != psWheel->u8Dir)
+    {
+        psWheel->fIntegral = 0.0f;
+    }
+    if (u8Speed != 0)
+    {
+        l_fDrive += (u8Dir == 1) ? psWheel->fIntegral : -psWheel->fIntegral;
+        if (l_fDrive < 0.0f)
+        {
+            l_fDrive = 0.0f;
+        }
+        else if (l_fDrive > 255.0f)
+        {
+            l_fDrive = 255.0f;
+        }
+    }
+    psWheel->u8Pwm = (uint8_t)(l_fDrive + 0.5f);
+    psWheel->u8Dir = u8Speed ? u8Dir : 0;
+}
+
+/// @brief Run the loop on one reply
+/// @param psWheel wheel state
+/// @param pcsGains loop gains
+/// @param u8Speed requested PWM
+/// @param u8Dir requested direction, 1 forward
+/// @param u32Ticks ticks since the previous reply
+/// @param s8Direction direction of the ticks, -1, 0 or 1
+/// @param u32DtUs time since the previous reply (us)
+void SPEED_Update(SPEED_Wheel_t *psWheel, const SPEED_Gains_t *pcsGains, uint8_t u8Speed, uint8_t u8Dir, uint32_t u32Ticks, int8_t s8Direction, uint32_t u32DtUs)
+{
+    float l_fSign = (u8Dir == 1) ? 1.0f : -1.0f;
+    float l_fTarget = l_fSign * u8Speed / PWM_PER_MPS;
+    float l_fPrevMeasured = psWheel->fMeasured;
+    float l_fSpeed = s8Direction * (float)u32Ticks * 1000000.0f / (TICKS_PER_M * u32DtUs);
+
+    psWheel->fMeasured += SPEED_FILTER * (l_fSpeed - psWheel->fMeasured);
+
+    /* stopped or reversing, start again from the feed-forward */
+    if (u8Speed == 0 || l_fTarget * psWheel->fTarget < 0.0f)
+    {
+        psWheel->fIntegral = 0.0f;
+    }
+    psWheel->fTarget = l_fTarget;
+    if (u8Speed == 0)
+    {
+        psWheel->u8Pwm = 0;
+        psWheel->u8Dir = 0;
+        return;
+    }
+
+    float l_fError = l_fTarget - psWheel->fMeasured;
+    float l_fOut = l_fTarget * PWM_PER_MPS + pcsGains->fKp * l_fError + psWheel->fIntegral - pcsGains->fKd * (psWheel->fMeasured - l_fPrevMeasured) * 1000000.0f / u32DtUs;
+
+    /* never drive against the requested direction, at most stop the wheel */
+    float l_fDrive = l_fOut * l_fSign;
+    int8_t l_s8Saturated = 0;
+    if (l_fDrive < 0.0f)
+    {
+        l_fDrive = 0.0f;
+        l_s8Saturated = -1;
+    }
+    else if (l_fDrive > 255.0f)
+    {
+        l_fDrive = 255.0f;
+        l_s8Saturated = 1;
+    }
+
+    /* anti-windup, only integrate when it brings the output back from its limit */
+    if (l_s8Saturated == 0 || (l_fError * l_fSign * l_s8Saturated) < 0.0f)
+    {
+        psWheel->fIntegral += pcsGains->fKi * l_fError * u32DtUs / 1000000.0f;
+        if (psWheel->fIntegral > SPEED_I_LIMIT)
+        {
+            psWheel->fIntegral = SPEED_I_LIMIT;
+        }
+        else if (psWheel->fIntegral < -SPEED_I_LIMIT)
+        {
+            psWheel->fIntegral = -SPEED_I_LIMIT;
+        }
+    }
+
+    psWheel->u8Pwm = (uint8_t)(l_fDrive + 0.5f);
+    psWheel->u8Dir = u8Dir;
+
+    psWheel->u32Samples++;
+    psWheel->fSumSqError += l_fError * l_fError;
+    if (fabsf(l_fError) > psWheel->fMaxError)
+    {
+        psWheel->fMaxError = fabsf(l_fError);
+    }
+    if (l_s8Saturated != 0)
+    {
+        psWheel->u32Saturated++;
+    }
+}
+
+/// @brief Clear the tracking statistics, e.g. after a gain change
+/// @param psWheel wheel state
+void SPEED_ResetTracking(SPEED_Wheel_t *psWheel)
+{
+    psWheel->u32Samples = 0;
+    psWheel->fSumSqError = 0.0f;
+    psWheel->fMaxError = 0.0f;
+    psWheel->u32Saturated = 0;
+}
+
+/******************************************************************************
+ *  Private Functions
+ *******************************************************************************/
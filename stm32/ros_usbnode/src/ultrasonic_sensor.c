@@ -7,6 +7,10 @@
 #include "board.h"
 #include "main.h"
 #include "ultrasonic_sensor.h"
+#include "frame.h"
+
+/* circular receive DMA buffer */
+#define ULTRASONIC_RX_DMA_SIZE 32
 
 extern UART_HandleTypeDef MASTER_USART_Handler; // UART  Handle
 
@@ -24,7 +28,14 @@ const uint8_t ultrasonic_RqstMessage[6]  = {0x55,0xAA,0x02,0x70,0x39,0xAA};
 
 const uint8_t ultrasonic_PreAmbule[5]  = {0x55,0xAA,0x06,0x70,0x39};
 
-static uint8_t ultrasonic_pu8ReceivedData[10] = {0};
+static void ultrasonic_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length);
+
+static const FRAME_Desc_t ultrasonic_pcsFrames[] = {
+    {ultrasonic_PreAmbule, sizeof(ultrasonic_PreAmbule), 10, ultrasonic_rxFrame},
+};
+
+static uint8_t ultrasonic_au8RxDma[ULTRASONIC_RX_DMA_SIZE];
+static FRAME_Port_t ultrasonic_sPort;
 
 static uint8_t ultrasonic_RxFlag = 0;
 
@@ -35,6 +46,7 @@ void ULTRASONICSENSOR_Init(void){
     ultrasonic_state = ULTRASONIC_INIT_1;
     ultrasonic_u32LeftDistance = 0;
     ultrasonic_u32RightDistance = 0;
+    FRAME_Init(&ultrasonic_sPort, &MASTER_USART_Handler, ultrasonic_au8RxDma, ULTRASONIC_RX_DMA_SIZE, ultrasonic_pcsFrames, sizeof(ultrasonic_pcsFrames) / sizeof(FRAME_Desc_t));
 }
 
 void ULTRASONICSENSOR_App(void){
@@ -42,20 +54,17 @@ void ULTRASONICSENSOR_App(void){
     switch (ultrasonic_state)
     {
     case ULTRASONIC_INIT_1:
-        HAL_UART_Transmit_DMA(&MASTER_USART_Handler, (uint8_t*)ultrasonic_InitMessage1, 6);
+        FRAME_bSend(&ultrasonic_sPort, ultrasonic_InitMessage1, 6);
         ultrasonic_state = ULTRASONIC_INIT_2;
         break;
     
     case ULTRASONIC_INIT_2:
-        HAL_UART_Transmit_DMA(&MASTER_USART_Handler, (uint8_t*)ultrasonic_InitMessage2, 6);
+        FRAME_bSend(&ultrasonic_sPort, ultrasonic_InitMessage2, 6);
         ultrasonic_state = ULTRASONIC_RUN;
         break;
 
     case ULTRASONIC_RUN:
-        
-        /* prepare to receive the message before to lauch the command */
-        HAL_UART_Receive_DMA(&MASTER_USART_Handler,ultrasonic_pu8ReceivedData,10);
-        HAL_UART_Transmit_DMA(&MASTER_USART_Handler, (uint8_t*)ultrasonic_RqstMessage, 6);
+        FRAME_bSend(&ultrasonic_sPort, ultrasonic_RqstMessage, 6);
 
 
         break;
@@ -65,17 +74,30 @@ void ULTRASONICSENSOR_App(void){
     }
 }
 
-void ULTRASONICSENSOR_ReceiveIT(void)
+/* scan what the DMA received since the last call, returns the number of measures decoded */
+uint8_t ULTRASONICSENSOR_ReceiveIT(void)
 {
-    /* decode the frame */
-    if(memcmp(ultrasonic_PreAmbule,ultrasonic_pu8ReceivedData,5) == 0){
-        /* todo calculate the CRC */
-        ultrasonic_u32LeftDistance = (ultrasonic_pu8ReceivedData[5] << 8) + ultrasonic_pu8ReceivedData[6];
-        ultrasonic_u32RightDistance  = (ultrasonic_pu8ReceivedData[7] << 8) + ultrasonic_pu8ReceivedData[8];
-
-        DB_TRACE(" R: %dmm, L: %dmm \r\n",ultrasonic_u32RightDistance/10,ultrasonic_u32LeftDistance/10);
-        ultrasonic_RxFlag = 1;
-    }
+    return FRAME_u8ReceiveIT(&ultrasonic_sPort);
+}
+
+void ULTRASONICSENSOR_TxCpltIT(void)
+{
+    FRAME_TxCpltIT(&ultrasonic_sPort);
+}
+
+void ULTRASONICSENSOR_GetLinkStats(FRAME_Stats_t *psStats)
+{
+    FRAME_GetStats(&ultrasonic_sPort, psStats);
+}
+
+/* valid measure from the frame scanner (UART interrupt), the CRC is checked there */
+static void ultrasonic_rxFrame(const uint8_t *pcu8Frame, uint8_t u8Length)
+{
+    ultrasonic_u32LeftDistance = (pcu8Frame[5] << 8) + pcu8Frame[6];
+    ultrasonic_u32RightDistance  = (pcu8Frame[7] << 8) + pcu8Frame[8];
+
+    DB_TRACE(" R: %dmm, L: %dmm \r\n",ultrasonic_u32RightDistance/10,ultrasonic_u32LeftDistance/10);
+    ultrasonic_RxFlag = 1;
 }
 
 uint32_t ULTRASONIC_MessageReceived(void){
@@ -104,6 +104,9 @@ uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
 static uint32_t s_txhead = 0;
 static uint32_t s_txtail = 0;
+static uint32_t s_txskip = 0;       // head position where the data of the current lap ends, valid if s_txskipPending
+static uint8_t s_txskipPending = 0;
+static uint32_t s_txreserveSkip = 0; // bytes left unused before the wrap around by the current reservation
 static uint32_t s_rxhead = 0;
 static uint32_t s_rxtail = 0;
 
@@ -113,6 +116,7 @@ static uint32_t s_rxDropCounterHead = 0;
 static uint32_t s_rxDropCounterTail = 0;
 static uint32_t s_txDropCounterHead = 0;
 static uint32_t s_txDropCounterTail = 0;
+static uint32_t s_txHeldFrames = 0;   // USB frames the queued data has been held back for aggregation
 
 #ifdef USE_USB_FS
     static uint8_t ReceiveBuffer[CDC_DATA_FS_MAX_PACKET_SIZE];
@@ -171,6 +175,8 @@ static int8_t CDC_TransmitCplt(uint8_t *pbuf, uint32_t *Len, uint8_t epnum);
 static uint8_t CDC_RXQueue_Enqueue(const uint8_t *buffer, uint32_t length);
 static uint8_t CDC_TXQueue_Enqueue(const uint8_t *buffer, uint32_t length);
 static const uint8_t* CDC_TXQueue_Dequeue(uint32_t *length);
+static uint8_t* CDC_TXQueue_Reserve(uint32_t length);
+static void CDC_TXQueue_Commit(uint32_t length);
 //static void CDC_ResumeTransmit(void);
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
 
@@ -417,6 +423,63 @@ uint8_t CDC_TransmitTimed(const void* Buf, uint32_t Len, uint32_t TimeoutMs)
     return result;
 }
 
+/**
+ * @brief  CDC_TransmitReserve
+ *         Reserve a contiguous block in the transmission queue, so that data can be
+ *         written in place instead of being copied by CDC_Transmit
+ *         @note only one reservation may be open at a time, and no other data may be
+ *         enqueued before it is committed with CDC_TransmitCommit
+ *
+ *
+ * @param  MaxLen: Maximum number of bytes that will be written
+ * @retval pointer to the reserved block, NULL if the queue has not enough space left,
+ *         see CDC_TransmitDropped
+ */
+uint8_t* CDC_TransmitReserve(uint32_t MaxLen)
+{
+    /* USER CODE BEGIN 14 */
+    uint8_t *buffer = CDC_TXQueue_Reserve(MaxLen);
+    /* USER CODE END 14 */
+    return buffer;
+}
+
+/**
+ * @brief  CDC_TransmitDropped
+ *         Count a message discarded by the caller because CDC_TransmitReserve
+ *         had no room for it. A message the caller retries later is not a drop
+ *
+ */
+void CDC_TransmitDropped(void)
+{
+    s_txDropCounterHead++;
+    atomic_signal_fence(memory_order_release);
+}
+
+/**
+ * @brief  CDC_TransmitCommit
+ *         Enqueue the data written to the block returned by CDC_TransmitReserve and send it
+ *
+ *
+ * @param  Len: Number of bytes actually written, at most the reserved length
+ *         0 releases the reservation without sending anything
+ */
+void CDC_TransmitCommit(uint32_t Len)
+{
+    CDC_ENTER_CRITICAL_SECTION();
+    /* USER CODE BEGIN 15 */
+
+    if (Len > 0) {
+        s_lastTransmitStart = HAL_GetTick();
+        CDC_TXQueue_Commit(Len);
+    }
+    s_txreserveSkip = 0;
+
+    CDC_ResumeTransmit();
+
+    CDC_EXIT_CRITICAL_SECTION();
+    /* USER CODE END 15 */
+}
+
 /**
  * @brief  CDC_TransmitCplt_FS
  *         Data transmited callback
@@ -456,16 +519,39 @@ static int8_t CDC_TransmitCplt(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
  */
 void CDC_ResumeTransmit(void)
 {
-    if (CDC_IsBusy()) {
-        return;
+    // called from the SOF and transfer complete interrupts as well, so only one caller may start a transfer
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (!CDC_IsBusy()) {
+        uint32_t queueLength;
+        const uint8_t *queueData = CDC_TXQueue_Dequeue(&queueLength);
+        if (queueLength > 0) {
+            s_txHeldFrames = 0;
+            USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*) queueData, queueLength);
+            USBD_CDC_TransmitPacket(&hUsbDevice);
+        }
     }
 
-    uint32_t queueLength;
-    const uint8_t *queueData = CDC_TXQueue_Dequeue(&queueLength);
-    if (queueLength > 0) {
-        USBD_CDC_SetTxBuffer(&hUsbDevice, (uint8_t*) queueData, queueLength);
-        USBD_CDC_TransmitPacket(&hUsbDevice);
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  CDC_SOF
+ *         Start of frame handler, called every 1ms by the USB interrupt
+ *         Sends the data held back for aggregation once CDC_TX_HOLD_FRAMES frames passed
+ *
+ */
+void CDC_SOF(void)
+{
+#if CDC_TX_HOLD_FRAMES > 0
+    if (hUsbDevice.pClassData == NULL || CDC_IsBusy() || CDC_TXQueue_GetReadAvailable() == 0) {
+        return;
     }
+
+    s_txHeldFrames++;
+    CDC_ResumeTransmit();
+#endif
 }
 
 /**
@@ -558,6 +644,70 @@ uint8_t CDC_TXQueue_Enqueue(const uint8_t *buffer, uint32_t length)
     return USBD_OK;
 }
 
+/**
+ * @brief  CDC_TXQueue_Reserve
+ *         Get a contiguous block of the transmission queue to write into
+ *
+ *         @note
+ *         If the block does not fit before the end of the buffer, it is placed at the start
+ *         of the buffer and the bytes till the end are skipped when the block is committed
+ *
+ * @param  length: size of the block
+ * @retval pointer to the block, NULL if the queue has not enough space left
+ */
+uint8_t* CDC_TXQueue_Reserve(uint32_t length)
+{
+    uint32_t available = CDC_TXQueue_GetWriteAvailable();
+
+    atomic_signal_fence(memory_order_acquire);
+    uint32_t head = s_txhead;
+    uint32_t sizeTillWrapAround = APP_TX_DATA_SIZE - (head % APP_TX_DATA_SIZE);
+
+    if (length <= sizeTillWrapAround) {
+        if (length > available) {
+            return NULL;
+        }
+        s_txreserveSkip = 0;
+        return UserTxBufferFS + (head % APP_TX_DATA_SIZE);
+    }
+
+    if (sizeTillWrapAround + length > available) {
+        return NULL;
+    }
+    s_txreserveSkip = sizeTillWrapAround;
+    return UserTxBufferFS;
+}
+
+/**
+ * @brief  CDC_TXQueue_Commit
+ *         Enqueue the data written to the block returned by CDC_TXQueue_Reserve
+ *
+ * @param  length: length of data written to the block
+ */
+void CDC_TXQueue_Commit(uint32_t length)
+{
+    // the skip and the head must change together for the dequeue of the transfer complete interrupt
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    atomic_signal_fence(memory_order_acquire);
+    uint32_t head = s_txhead;
+
+    if (s_txreserveSkip > 0) {
+        // data of this lap ends here, the dequeue moves the tail to the start of the buffer
+        s_txskip = head;
+        s_txskipPending = 1;
+        head += s_txreserveSkip;
+    }
+    head += length;
+
+    atomic_signal_fence(memory_order_acquire);
+    s_txhead = head;
+    atomic_signal_fence(memory_order_release);
+
+    __set_PRIMASK(primask);
+}
+
 /**
  * @brief  CDC_RXQueue_Enqueue
  *         Enqueue data into the reception queue
@@ -608,25 +758,52 @@ uint8_t CDC_RXQueue_Enqueue(const uint8_t *buffer, uint32_t length)
  */
 const uint8_t* CDC_TXQueue_Dequeue(uint32_t *length)
 {
+    atomic_signal_fence(memory_order_acquire);
+    uint32_t tail = s_txtail;
+
+    // skip the unused end of the buffer left by a reservation that wrapped around
+    if (s_txskipPending && tail == s_txskip) {
+        tail += APP_TX_DATA_SIZE - (tail % APP_TX_DATA_SIZE);
+        s_txskipPending = 0;
+        s_txtail = tail;
+        atomic_signal_fence(memory_order_release);
+    }
+
     uint32_t queueSize = CDC_TXQueue_GetReadAvailable();
     if (queueSize == 0) {
         *length = 0;
         return NULL;
     }
 
-    atomic_signal_fence(memory_order_acquire);
-
     // length is capped so that we get no buffer wrap around
     // this reduces complexity and reduces memory requirements, but decreases throughput
     // length is also capped to 4096 due to ST internals
-    uint32_t tail = s_txtail;
     uint32_t sizeTillWrapAround = APP_TX_DATA_SIZE - (tail % APP_TX_DATA_SIZE);
+    if (s_txskipPending) {
+        sizeTillWrapAround = s_txskip - tail;
+    }
     uint32_t dequeueLength = MIN(MIN(queueSize, sizeTillWrapAround), 4096);
 
+#if CDC_TX_HOLD_FRAMES > 0
+    // aggregation: only send full packets until the data waited CDC_TX_HOLD_FRAMES frames,
+    // the remainder is held back so that following writes can fill up the packet
+    if (s_txHeldFrames < CDC_TX_HOLD_FRAMES) {
+        if (queueSize < CDC_DATA_MAX_PACKET_SIZE) {
+            *length = 0;
+            return NULL;
+        }
+        if (dequeueLength >= CDC_DATA_MAX_PACKET_SIZE) {
+            dequeueLength -= dequeueLength % CDC_DATA_MAX_PACKET_SIZE;
+        }
+    }
+#endif
+
     // this is a small optimization: if we send a packet multiple of 64 bytes (512 bytes for HS)
     // the next USB transfer slot is wasted with a ZLP, so instead send 1 byte in next slot
     // or possibly even more, if new data got enqueued
     // this increases throughput at the cost of latency
+    // with aggregation the transfer then ends with a short packet of 63 bytes, and the
+    // remaining byte is held back to start the next packet
     if (dequeueLength % CDC_DATA_MAX_PACKET_SIZE == 0) {
         dequeueLength--;
     }
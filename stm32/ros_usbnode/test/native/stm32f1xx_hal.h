@@ -0,0 +1,546 @@
+/****************************************************************************
+* Title                 :   host HAL stub
+* Filename              :   stm32f1xx_hal.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file stm32f1xx_hal.h
+*  \brief the few HAL and CMSIS pieces the portable modules use, for the
+*         native test env. The tests drive the DMA counter themselves.
+*/
+#ifndef __STM32F1XX_HAL_STUB_H
+#define __STM32F1XX_HAL_STUB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+#define HAL_OK 0
+#define HAL_ERROR 1
+#define HAL_UART_STATE_READY 0x20U
+#define HAL_UART_STATE_BUSY_RX 0x22U
+#define HAL_UART_ERROR_NONE 0x00U
+#define HAL_UART_ERROR_ORE 0x08U
+#define DISABLE 0U
+#define ENABLE 1U
+
+#define GPIO_PIN_0 0x0001U
+#define GPIO_PIN_1 0x0002U
+#define GPIO_PIN_2 0x0004U
+#define GPIO_PIN_3 0x0008U
+#define GPIO_PIN_4 0x0010U
+#define GPIO_PIN_5 0x0020U
+#define GPIO_PIN_6 0x0040U
+#define GPIO_PIN_7 0x0080U
+#define GPIO_PIN_8 0x0100U
+#define GPIO_PIN_9 0x0200U
+#define GPIO_PIN_10 0x0400U
+#define GPIO_PIN_11 0x0800U
+#define GPIO_PIN_12 0x1000U
+#define GPIO_PIN_13 0x2000U
+#define GPIO_PIN_14 0x4000U
+#define GPIO_PIN_15 0x8000U
+#define GPIO_MODE_INPUT 0x00U
+#define GPIO_MODE_OUTPUT_PP 0x01U
+#define GPIO_MODE_AF_PP 0x02U
+#define GPIO_MODE_ANALOG 0x03U
+#define GPIO_NOPULL 0x00U
+#define GPIO_SPEED_FREQ_LOW 0x02U
+#define GPIO_SPEED_FREQ_MEDIUM 0x01U
+#define GPIO_SPEED_FREQ_HIGH 0x03U
+#define GPIO_SPEED_MEDIUM GPIO_SPEED_FREQ_MEDIUM
+
+#define ADC_SCAN_DISABLE 0x00U
+#define ADC_EXTERNALTRIG_EDGE_NONE 0x00U
+#define ADC_DATAALIGN_RIGHT 0x00U
+#define ADC_REGULAR_RANK_1 0x01U
+#define ADC_SCAN_ENABLE 0x100U
+#define ADC_CHANNEL_1 0x01U
+#define ADC_CHANNEL_2 0x02U
+#define ADC_CHANNEL_3 0x03U
+#define ADC_CHANNEL_6 0x06U
+#define ADC_CHANNEL_7 0x07U
+#define ADC_CHANNEL_13 0x0DU
+#define ADC_SAMPLETIME_28CYCLES_5 0x03U
+#define ADC_SAMPLETIME_71CYCLES_5 0x06U
+#define ADC_EXTERNALTRIGCONV_T2_CC2 0x60000U
+#define ADC_EXTERNALTRIGINJECCONV_T1_TRGO 0x00U
+#define ADC_INJECTED_RANK_1 0x01U
+
+#define DMA_PERIPH_TO_MEMORY 0x00U
+#define DMA_PINC_DISABLE 0x00U
+#define DMA_MINC_ENABLE 0x80U
+#define DMA_PDATAALIGN_HALFWORD 0x100U
+#define DMA_MDATAALIGN_HALFWORD 0x400U
+#define DMA_NORMAL 0x00U
+#define DMA_CIRCULAR 0x20U
+#define DMA_PRIORITY_HIGH 0x2000U
+
+#define TIM_CHANNEL_1 0x00U
+#define TIM_CHANNEL_2 0x04U
+#define TIM_CHANNEL_3 0x08U
+#define TIM_CHANNEL_4 0x0CU
+#define TIM_COUNTERMODE_UP 0x00U
+#define TIM_CLOCKDIVISION_DIV1 0x00U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0x00U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE 0x80U
+#define TIM_CLOCKSOURCE_INTERNAL 0x00U
+#define TIM_TRGO_RESET 0x00U
+#define TIM_TRGO_OC4REF 0x70U
+#define TIM_MASTERSLAVEMODE_DISABLE 0x00U
+#define TIM_OCMODE_TOGGLE 0x30U
+#define TIM_OCMODE_PWM1 0x60U
+#define TIM_OCMODE_PWM2 0x70U
+#define TIM_OCPOLARITY_HIGH 0x00U
+#define TIM_OCNPOLARITY_HIGH 0x00U
+#define TIM_OCFAST_DISABLE 0x00U
+#define TIM_OCIDLESTATE_RESET 0x00U
+#define TIM_OCNIDLESTATE_RESET 0x00U
+#define TIM_OSSR_ENABLE 0x800U
+#define TIM_OSSI_ENABLE 0x400U
+#define TIM_LOCKLEVEL_1 0x100U
+#define TIM_BREAK_DISABLE 0x00U
+#define TIM_BREAKPOLARITY_HIGH 0x2000U
+#define TIM_AUTOMATICOUTPUT_ENABLE 0x4000U
+
+#define ADC1_2_IRQn 18
+
+#define RTC_BKP_DR1 1U
+#define RTC_BKP_DR2 2U
+#define RTC_BKP_DR3 3U
+#define RTC_BKP_DR4 4U
+
+/* never dereferenced, only compared */
+#define GPIOA ((GPIO_TypeDef *)0x40010800UL)
+#define GPIOB ((GPIO_TypeDef *)0x40010C00UL)
+#define GPIOC ((GPIO_TypeDef *)0x40011000UL)
+#define GPIOD ((GPIO_TypeDef *)0x40011400UL)
+#define GPIOE ((GPIO_TypeDef *)0x40011800UL)
+#define ADC1 ((ADC_TypeDef *)0x40012400UL)
+/* the registers the modules write directly, the tests read them back */
+#define TIM1 (&hal_stub_sTim1)
+#define TIM2 (&hal_stub_sTim2)
+#define ADC2 (&hal_stub_sAdc2)
+#define DMA1_Channel1 ((DMA_Channel_TypeDef *)0x40020008UL)
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+#define __STATIC_INLINE static inline
+#define __ALIGNED(x) __attribute__((aligned(x)))
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do { (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); (__DMA_HANDLE__).Parent = (__HANDLE__); } while (0)
+#define __HAL_RCC_ADC1_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_GPIOE_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_TIM1_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_TIM2_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_ADC2_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_PWR_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_BKP_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_RTC_ENABLE() do { } while (0)
+#define __HAL_AFIO_REMAP_TIM1_ENABLE() do { } while (0)
+/* remaining transfers of the channel, what CNDTR holds on the target */
+#define __HAL_DMA_GET_COUNTER(__HANDLE__) ((__HANDLE__)->u32Counter)
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef int HAL_StatusTypeDef;
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct
+{
+    uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t DR;
+    volatile uint32_t JDR1;
+    volatile uint32_t JDR2;
+} ADC_TypeDef;
+
+typedef struct
+{
+    uint32_t CNDTR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t CCR1;
+    volatile uint32_t CCR2;
+    volatile uint32_t CCR3;
+    volatile uint32_t CCR4;
+} TIM_TypeDef;
+
+typedef struct
+{
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct
+{
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t OCMode;
+    uint32_t Pulse;
+    uint32_t OCPolarity;
+    uint32_t OCNPolarity;
+    uint32_t OCFastMode;
+    uint32_t OCIdleState;
+    uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct
+{
+    uint32_t ClockSource;
+    uint32_t ClockPolarity;
+    uint32_t ClockPrescaler;
+    uint32_t ClockFilter;
+} TIM_ClockConfigTypeDef;
+
+typedef struct
+{
+    uint32_t MasterOutputTrigger;
+    uint32_t MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+typedef struct
+{
+    uint32_t OffStateRunMode;
+    uint32_t OffStateIDLEMode;
+    uint32_t LockLevel;
+    uint32_t DeadTime;
+    uint32_t BreakState;
+    uint32_t BreakPolarity;
+    uint32_t AutomaticOutput;
+} TIM_BreakDeadTimeConfigTypeDef;
+
+typedef struct
+{
+    uint16_t au16Backup[11];
+} RTC_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+typedef struct
+{
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct
+{
+    DMA_Channel_TypeDef *Instance;
+    DMA_InitTypeDef Init;
+    void *Parent;
+    uint32_t u32Counter;
+} DMA_HandleTypeDef;
+
+typedef struct
+{
+    uint32_t DataAlign;
+    uint32_t ScanConvMode;
+    uint32_t ContinuousConvMode;
+    uint32_t NbrOfConversion;
+    uint32_t DiscontinuousConvMode;
+    uint32_t NbrOfDiscConversion;
+    uint32_t ExternalTrigConv;
+} ADC_InitTypeDef;
+
+typedef struct
+{
+    uint32_t Channel;
+    uint32_t Rank;
+    uint32_t SamplingTime;
+} ADC_ChannelConfTypeDef;
+
+typedef struct
+{
+    uint32_t InjectedChannel;
+    uint32_t InjectedRank;
+    uint32_t InjectedSamplingTime;
+    uint32_t InjectedOffset;
+    uint32_t InjectedNbrOfConversion;
+    uint32_t InjectedDiscontinuousConvMode;
+    uint32_t AutoInjectedConv;
+    uint32_t ExternalTrigInjecConv;
+} ADC_InjectionConfTypeDef;
+
+typedef struct
+{
+    ADC_TypeDef *Instance;
+    ADC_InitTypeDef Init;
+    DMA_HandleTypeDef *DMA_Handle;
+    uint32_t u32Started;                /* HAL_ADC_Start_DMA() calls */
+} ADC_HandleTypeDef;
+
+typedef struct
+{
+    DMA_HandleTypeDef *hdmarx;
+    volatile uint32_t RxState;
+    volatile uint32_t ErrorCode;
+    const uint8_t *pcu8TxData;          /* last HAL_UART_Transmit_DMA() */
+    uint16_t u16TxLength;
+    uint32_t u32TxCount;
+} UART_HandleTypeDef;
+
+/******************************************************************************
+* Variables
+*******************************************************************************/
+static TIM_TypeDef hal_stub_sTim1 __attribute__((unused));
+static TIM_TypeDef hal_stub_sTim2 __attribute__((unused));
+static ADC_TypeDef hal_stub_sAdc2 __attribute__((unused));
+
+/******************************************************************************
+* Functions
+*******************************************************************************/
+/* defined by the tests which need the time */
+uint32_t HAL_GetTick(void);
+
+static inline uint32_t __get_PRIMASK(void)
+{
+    return 0;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __set_PRIMASK(uint32_t u32Primask)
+{
+    (void)u32Primask;
+}
+
+static inline void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+static inline void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    (void)GPIOx;
+    (void)GPIO_Pin;
+    (void)PinState;
+}
+
+static inline HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig)
+{
+    (void)hadc;
+    (void)sConfig;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADCEx_InjectedConfigChannel(ADC_HandleTypeDef *hadc, ADC_InjectionConfTypeDef *sConfigInjected)
+{
+    (void)hadc;
+    (void)sConfigInjected;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADCEx_InjectedStart(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADC_Start_IT(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    (void)pData;
+    (void)Length;
+    hadc->u32Started++;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+static inline void HAL_NVIC_SetPriority(int IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+static inline void HAL_NVIC_EnableIRQ(int IRQn)
+{
+    (void)IRQn;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    (void)htim;
+    (void)sConfig;
+    (void)Channel;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_OC_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    (void)htim;
+    (void)Channel;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef *htim, TIM_ClockConfigTypeDef *sClockSourceConfig)
+{
+    (void)htim;
+    (void)sClockSourceConfig;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *sMasterConfig)
+{
+    (void)htim;
+    (void)sMasterConfig;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel)
+{
+    (void)htim;
+    (void)sConfig;
+    (void)Channel;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef *htim, TIM_BreakDeadTimeConfigTypeDef *sBreakDeadTimeConfig)
+{
+    (void)htim;
+    (void)sBreakDeadTimeConfig;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    (void)htim;
+    (void)Channel;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    (void)htim;
+    (void)Channel;
+    return HAL_OK;
+}
+
+static inline void HAL_PWR_EnableBkUpAccess(void)
+{
+}
+
+static inline void HAL_PWR_DisableBkUpAccess(void)
+{
+}
+
+static inline uint32_t HAL_RTCEx_BKUPRead(RTC_HandleTypeDef *hrtc, uint32_t BackupRegister)
+{
+    return hrtc->au16Backup[BackupRegister];
+}
+
+static inline void HAL_RTCEx_BKUPWrite(RTC_HandleTypeDef *hrtc, uint32_t BackupRegister, uint32_t Data)
+{
+    hrtc->au16Backup[BackupRegister] = (uint16_t)Data;
+}
+
+static inline HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    (void)pData;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    huart->ErrorCode = HAL_UART_ERROR_NONE;
+    huart->hdmarx->u32Counter = Size;
+    return HAL_OK;
+}
+
+static inline HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    huart->pcu8TxData = pData;
+    huart->u16TxLength = Size;
+    huart->u32TxCount++;
+    return HAL_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__STM32F1XX_HAL_STUB_H*/
@@ -0,0 +1,114 @@
+/****************************************************************************
+* Title                 :   host USB CDC class stub
+* Filename              :   usbd_cdc.h
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file usbd_cdc.h
+*  \brief the few pieces of the ST USB device CDC class usbd_cdc_if.c uses,
+*         for the native test env. The tests play the IN endpoint : they
+*         define USBD_CDC_SetTxBuffer() and USBD_CDC_TransmitPacket() and call
+*         the TransmitCplt of the interface when a transfer is done.
+*/
+#ifndef __USBD_CDC_STUB_H
+#define __USBD_CDC_STUB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+#include "stm32f1xx_hal.h"
+
+/******************************************************************************
+* Preprocessor Constants
+*******************************************************************************/
+#define USBD_OK 0U
+#define USBD_BUSY 1U
+#define USBD_FAIL 3U
+
+#define CDC_DATA_HS_MAX_PACKET_SIZE 512U
+#define CDC_DATA_FS_MAX_PACKET_SIZE 64U
+
+#define CDC_SEND_ENCAPSULATED_COMMAND 0x00U
+#define CDC_GET_ENCAPSULATED_RESPONSE 0x01U
+#define CDC_SET_COMM_FEATURE 0x02U
+#define CDC_GET_COMM_FEATURE 0x03U
+#define CDC_CLEAR_COMM_FEATURE 0x04U
+#define CDC_SET_LINE_CODING 0x20U
+#define CDC_GET_LINE_CODING 0x21U
+#define CDC_SET_CONTROL_LINE_STATE 0x22U
+#define CDC_SEND_BREAK 0x23U
+
+/******************************************************************************
+* Macros
+*******************************************************************************/
+#define __weak __attribute__((weak))
+#define UNUSED(X) (void)(X)
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+/* main.h on the target, through usbd_conf.h */
+#define DB_TRACE(...) do { } while (0)
+
+/******************************************************************************
+* Typedefs
+*******************************************************************************/
+typedef struct
+{
+    uint32_t bitrate;
+    uint8_t format;
+    uint8_t paritytype;
+    uint8_t datatype;
+} USBD_CDC_LineCodingTypeDef;
+
+typedef struct
+{
+    int8_t (*Init)(void);
+    int8_t (*DeInit)(void);
+    int8_t (*Control)(uint8_t cmd, uint8_t *pbuf, uint16_t length);
+    int8_t (*Receive)(uint8_t *Buf, uint32_t *Len);
+    int8_t (*TransmitCplt)(uint8_t *Buf, uint32_t *Len, uint8_t epnum);
+} USBD_CDC_ItfTypeDef;
+
+typedef struct
+{
+    uint8_t *TxBuffer;
+    uint32_t TxLength;
+    volatile uint32_t TxState;
+} USBD_CDC_HandleTypeDef;
+
+typedef struct
+{
+    void *pClassData;
+} USBD_HandleTypeDef;
+
+/******************************************************************************
+* Functions
+*******************************************************************************/
+/* defined by the tests, the endpoint */
+uint8_t USBD_CDC_SetTxBuffer(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint32_t length);
+uint8_t USBD_CDC_TransmitPacket(USBD_HandleTypeDef *pdev);
+
+static inline uint8_t USBD_CDC_SetRxBuffer(USBD_HandleTypeDef *pdev, uint8_t *pbuff)
+{
+    (void)pdev;
+    (void)pbuff;
+    return USBD_OK;
+}
+
+static inline uint8_t USBD_CDC_ReceivePacket(USBD_HandleTypeDef *pdev)
+{
+    (void)pdev;
+    return USBD_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__USBD_CDC_STUB_H*/
@@ -0,0 +1,323 @@
+/****************************************************************************
+* Title                 :   adc conversion tests
+* Filename              :   test_adc.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_adc.c
+ *  \brief host comparison of the fixed point ADC_input() with the float one
+ *
+ *  The reference below is the previous float ADC_input(), its filter states
+ *  kept in test_sReference. Both are fed the same oversampled sums over the
+ *  whole ADC range, at steady state and after steps. The charge voltage and
+ *  current are no longer filtered (sampled in the middle of the PWM pulse),
+ *  they are only compared at steady state. The benchmark times both on the
+ *  host, which has an FPU : the gain on the F103 soft float is larger.
+ *  Run with : pio test -d test -f test_adc
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+
+#include "adc.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+/* ADC_input() calls to reach the steady state of the slowest (0.2) filter */
+#define TEST_SETTLE 200
+/* step between two tested sums : every value of the ADC range */
+#define TEST_RANGE_STEP 1
+#define TEST_BENCH_CALLS 200000
+
+/* bounds against the float formulas */
+#define TEST_VOLTAGE_TOLERANCE 0.007
+#define TEST_CURRENT_TOLERANCE 0.004
+#define TEST_NTC_TOLERANCE_60 0.25
+#define TEST_NTC_TOLERANCE_100 1.2
+/* while a filter moves : 0.2 in Q8 is 51/256, up to 0.16% of the step */
+#define TEST_STEP_ERROR 0.002
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+typedef struct
+{
+    float battery_voltage;
+    float charge_voltage;
+    float current;
+    float current_without_offset;
+    float ntc_voltage;
+    float blade_temperature;
+    float chargerInputVoltage;
+} test_reference_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static test_reference_t test_sReference;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+void debug_printf(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+void Error_Handler(void)
+{
+    TEST_FAIL_MESSAGE("Error_Handler");
+}
+
+/* the previous ADC_input(), the globals it set moved in test_sReference */
+static void test_vReferenceInput(void)
+{
+    const float f_RTO = 10000;
+    const float beta = 3380;
+    test_reference_t *r = &test_sReference;
+    float l_fTmp;
+
+    /* battery volatge calculation */
+    l_fTmp = ((float)adc_u16BatteryVoltage / ADC_FULL_SCALE) * 3.3f * 10.09 + 0.6f;
+    r->battery_voltage = 0.2 * l_fTmp + 0.8 * r->battery_voltage;
+
+     /*charger voltage calculation */
+    l_fTmp = ((float)adc_u16ChargerVoltage / ADC_FULL_SCALE) * 3.3f * 16;
+    r->charge_voltage = 0.8 * l_fTmp + 0.2 * r->charge_voltage;
+
+    /*charge current calculation */
+    l_fTmp = (((float)adc_u16Current / ADC_FULL_SCALE) * 3.3f - 2.5f) * 100 / 12.0;
+    r->current_without_offset =   0.8 * l_fTmp + 0.2 * r->current_without_offset;
+
+    /*remove offset*/
+    r->current = r->current_without_offset - charge_current_offset.f;
+
+    /*blade motor temperature calculation */
+    l_fTmp = (adc_u16Input_NTC/ADC_FULL_SCALE)*3.3f;
+    r->ntc_voltage = 0.5*l_fTmp + 0.5*r->ntc_voltage;
+
+    /*calculation for NTC temperature*/
+    l_fTmp = r->ntc_voltage * 10000;               //Resistance of RT
+    l_fTmp = log(l_fTmp / f_RTO);
+    l_fTmp = (1 / ((l_fTmp / beta) + (1 / (273.15+25)))); //Temperature from thermistor
+    r->blade_temperature = l_fTmp - 273.15;                 //Conversion to Celsius
+
+    /* Input voltage from the external supply*/
+    l_fTmp = (adc_u16ChargerInputVoltage / ADC_FULL_SCALE) * 3.3f * (32 / 2);
+    r->chargerInputVoltage = 0.5 * l_fTmp + 0.5 * r->chargerInputVoltage;
+}
+
+/* the same sum on all the channels */
+static void test_vSetInputs(uint16_t u16Sum)
+{
+    adc_u16BatteryVoltage = u16Sum;
+    adc_u16ChargerVoltage = u16Sum;
+    adc_u16Current = u16Sum;
+    adc_u16Input_NTC = u16Sum;
+    adc_u16ChargerInputVoltage = u16Sum;
+}
+
+static void test_vBoth(uint16_t n)
+{
+    while (n--)
+    {
+        ADC_input();
+        test_vReferenceInput();
+    }
+}
+
+/* blade temperatures compared : the float formula gives -273°C at 0V, and
+   above 100°C the blade motor is already stopped, the table is coarse there */
+static bool test_bNtcCompared(float fTemperature)
+{
+    return fTemperature > -30.0f && fTemperature < 100.0f;
+}
+
+/* the NTC tolerance grows with the temperature, the table steps get coarse */
+static float test_fNtcTolerance(float fTemperature)
+{
+    return fTemperature < 60.0f ? TEST_NTC_TOLERANCE_60 : TEST_NTC_TOLERANCE_100;
+}
+
+void setUp(void)
+{
+    adc_u32FilterBattery = 0;
+    adc_u32FilterCharge = 0;
+    adc_u32FilterCurrent = 0;
+    adc_u32FilterNtc = 0;
+    adc_u32FilterChargerInput = 0;
+    memset(&test_sReference, 0, sizeof(test_sReference));
+    charge_current_offset.f = 0.0f;
+    test_vSetInputs(0);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_voltages_over_the_range(void)
+{
+    uint32_t s;
+
+    for (s = 0; s <= (uint32_t)ADC_FULL_SCALE; s += TEST_RANGE_STEP)
+    {
+        test_vSetInputs(s);
+        test_vBoth(TEST_SETTLE);
+        TEST_ASSERT_FLOAT_WITHIN(TEST_VOLTAGE_TOLERANCE, test_sReference.battery_voltage, battery_voltage);
+        TEST_ASSERT_FLOAT_WITHIN(TEST_VOLTAGE_TOLERANCE, test_sReference.charge_voltage, charge_voltage);
+        TEST_ASSERT_FLOAT_WITHIN(TEST_VOLTAGE_TOLERANCE, test_sReference.chargerInputVoltage, chargerInputVoltage);
+    }
+}
+
+static void test_current_over_the_range(void)
+{
+    uint32_t s;
+
+    charge_current_offset.f = 0.125f;
+    for (s = 0; s <= (uint32_t)ADC_FULL_SCALE; s += TEST_RANGE_STEP)
+    {
+        test_vSetInputs(s);
+        test_vBoth(TEST_SETTLE);
+        TEST_ASSERT_FLOAT_WITHIN(TEST_CURRENT_TOLERANCE, test_sReference.current_without_offset, current_without_offset);
+        TEST_ASSERT_FLOAT_WITHIN(TEST_CURRENT_TOLERANCE, test_sReference.current, current);
+    }
+    /* 0A at 2.5V on the ACS712 */
+    test_vSetInputs((uint16_t)(ADC_FULL_SCALE * 2.5f / 3.3f + 0.5f));
+    ADC_input();
+    TEST_ASSERT_FLOAT_WITHIN(TEST_CURRENT_TOLERANCE, 0.0f, current_without_offset);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_CURRENT_TOLERANCE, -0.125f, current);
+}
+
+static void test_ntc_over_the_range(void)
+{
+    uint32_t s;
+
+    for (s = 0; s <= (uint32_t)ADC_FULL_SCALE; s += TEST_RANGE_STEP)
+    {
+        test_vSetInputs(s);
+        test_vBoth(TEST_SETTLE);
+        if (test_bNtcCompared(test_sReference.blade_temperature))
+        {
+            TEST_ASSERT_FLOAT_WITHIN(test_fNtcTolerance(test_sReference.blade_temperature),
+                                     test_sReference.blade_temperature, blade_temperature);
+        }
+        TEST_ASSERT_FLOAT_WITHIN(0.051f, adc_s16BladeTemperature * 0.1f, blade_temperature);
+    }
+}
+
+static void test_ntc_table_is_monotonic(void)
+{
+    int i;
+
+    for (i = 0; i < ADC_NTC_STEPS; i++)
+    {
+        TEST_ASSERT_TRUE(adc_cs16NtcTable[i + 1] < adc_cs16NtcTable[i]);
+    }
+    /* 10k at 25°C : 1V on the pin, 1/3.3 of the range */
+    test_vSetInputs((uint16_t)(ADC_FULL_SCALE / 3.3f + 0.5f));
+    test_vBoth(TEST_SETTLE);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 25.0f, blade_temperature);
+}
+
+/* the 0.2 and 0.5 filters follow steps up and down as the float ones did */
+static void test_filters_follow_steps(void)
+{
+    static const uint16_t l_cau16Steps[] = {20000, 60000, 100, 40000, 39000, 65520, 0};
+    uint16_t l_u16Previous = 0;
+    float l_fBatteryTolerance;
+    float l_fInputTolerance;
+    unsigned k;
+    int n;
+
+    /* from the same steady state, the float filters start at 0V, not 0.6V */
+    test_vBoth(TEST_SETTLE);
+    for (k = 0; k < sizeof(l_cau16Steps) / sizeof(l_cau16Steps[0]); k++)
+    {
+        float l_fStep = fabsf((float)l_cau16Steps[k] - l_u16Previous) / ADC_FULL_SCALE * 3.3f;
+
+        l_fBatteryTolerance = TEST_VOLTAGE_TOLERANCE + TEST_STEP_ERROR * l_fStep * 10.09f;
+        l_fInputTolerance = TEST_VOLTAGE_TOLERANCE + TEST_STEP_ERROR * l_fStep * 16;
+        l_u16Previous = l_cau16Steps[k];
+        test_vSetInputs(l_cau16Steps[k]);
+        for (n = 0; n < 40; n++)
+        {
+            test_vBoth(1);
+            TEST_ASSERT_FLOAT_WITHIN(l_fBatteryTolerance, test_sReference.battery_voltage, battery_voltage);
+            TEST_ASSERT_FLOAT_WITHIN(l_fInputTolerance, test_sReference.chargerInputVoltage, chargerInputVoltage);
+            if (test_bNtcCompared(test_sReference.blade_temperature))
+            {
+                TEST_ASSERT_FLOAT_WITHIN(test_fNtcTolerance(test_sReference.blade_temperature),
+                                         test_sReference.blade_temperature, blade_temperature);
+            }
+        }
+    }
+}
+
+/* charge voltage and current : the new sum right away, no more 0.8 filter */
+static void test_charge_is_not_filtered(void)
+{
+    test_vSetInputs(20000);
+    test_vBoth(TEST_SETTLE);
+    test_vSetInputs(40000);
+    ADC_input();
+    TEST_ASSERT_FLOAT_WITHIN(TEST_VOLTAGE_TOLERANCE, 40000 / ADC_FULL_SCALE * 3.3f * 16, charge_voltage);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_CURRENT_TOLERANCE, (40000 / ADC_FULL_SCALE * 3.3f - 2.5f) * 100 / 12, current_without_offset);
+    /* the battery still moves by 0.2 of the step */
+    TEST_ASSERT_FLOAT_WITHIN(TEST_VOLTAGE_TOLERANCE, (20000 + 0.2f * 20000) / ADC_FULL_SCALE * 3.3f * 10.09f + 0.6f, battery_voltage);
+}
+
+static void test_benchmark(void)
+{
+    char l_acMessage[96];
+    volatile float l_fSink = 0;
+    clock_t l_tStart;
+    double l_dReference;
+    double l_dFixed;
+    uint32_t n;
+
+    l_tStart = clock();
+    for (n = 0; n < TEST_BENCH_CALLS; n++)
+    {
+        test_vSetInputs((n * 331) & 0xFFFF);
+        test_vReferenceInput();
+        l_fSink += test_sReference.blade_temperature;
+    }
+    l_dReference = (double)(clock() - l_tStart) / CLOCKS_PER_SEC;
+    l_tStart = clock();
+    for (n = 0; n < TEST_BENCH_CALLS; n++)
+    {
+        test_vSetInputs((n * 331) & 0xFFFF);
+        ADC_input();
+        l_fSink += blade_temperature;
+    }
+    l_dFixed = (double)(clock() - l_tStart) / CLOCKS_PER_SEC;
+    (void)l_fSink;
+    snprintf(l_acMessage, sizeof(l_acMessage), "float %.1f ns, fixed point %.1f ns per ADC_input() on the host",
+             l_dReference * 1e9 / TEST_BENCH_CALLS, l_dFixed * 1e9 / TEST_BENCH_CALLS);
+    TEST_MESSAGE(l_acMessage);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_voltages_over_the_range);
+    RUN_TEST(test_current_over_the_range);
+    RUN_TEST(test_ntc_over_the_range);
+    RUN_TEST(test_ntc_table_is_monotonic);
+    RUN_TEST(test_filters_follow_steps);
+    RUN_TEST(test_charge_is_not_filtered);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,437 @@
+/****************************************************************************
+* Title                 :   USB CDC transmit tests
+* Filename              :   test_cdc.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_cdc.c
+ *  \brief host tests of the transmit aggregation of usbd_cdc_if.c
+ *
+ *  The test plays the full speed bulk IN endpoint : each 1 ms frame starts
+ *  with CDC_SOF() and has TEST_SLOTS_PER_FRAME packet slots, a transfer sends
+ *  one packet per slot, ends on a short packet or on a ZLP after a multiple
+ *  of 64 bytes, then TransmitCplt starts the next one. The host sees a
+ *  rosserial frame when the transfer holding its last byte ends, that is its
+ *  latency. A transfer of a multiple of 64 bytes is sent as 63 bytes and the
+ *  last byte is held : the messages which end on that byte are tracked, with
+ *  the delay against a transfer which had sent it with a ZLP.
+ *  Run with : pio test -d test -f test_cdc
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "usbd_cdc_if.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+/* 64 byte bulk packets in a full speed frame, at most */
+#define TEST_SLOTS_PER_FRAME 19U
+#define TEST_PACKET CDC_DATA_FS_MAX_PACKET_SIZE
+#define TEST_MAX_MESSAGES 65536U
+#define TEST_MAX_MESSAGE_SIZE 512U
+/* frames of the mixed load */
+#define TEST_LOAD_FRAMES 10000U
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t u32Written;        /* slot of CDC_Transmit() */
+    uint32_t u32End;            /* stream offset after the last byte */
+    uint32_t u32Done;           /* slot the transfer of the last byte ended */
+} TEST_Message_t;
+
+typedef struct
+{
+    uint32_t u32Transfers;
+    uint32_t u32Packets;
+    uint32_t u32Short;
+    uint32_t u32Zlp;
+    uint32_t u32BusySlots;
+    uint32_t u32Held;           /* transfers which held their 64th byte */
+    uint32_t u32HeldMessages;   /* messages which ended on a held byte */
+    uint32_t u32HeldDelay;      /* their slots over a transfer with a ZLP */
+    uint32_t u32HeldMaxDelay;
+    uint32_t u32Wrong;          /* bytes out of order */
+} TEST_Stats_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+USBD_HandleTypeDef hUsbDeviceFS;
+static USBD_CDC_HandleTypeDef test_sCdc;
+
+static uint32_t test_u32Frame;
+static uint32_t test_u32Slot;
+/* the transfer on the endpoint */
+static uint8_t *test_pu8Tx;
+static uint32_t test_u32TxLength;
+static uint32_t test_u32TxSent;
+static uint8_t test_u8TxZlp;
+/* bytes the endpoint took from the queue and bytes written to it */
+static uint32_t test_u32Stream;
+static uint32_t test_u32Written;
+/* the byte held by the transfer on the endpoint, then by the last one and the slot it ended */
+static uint32_t test_u32TxHeldEnd;
+static uint32_t test_u32HeldEnd;
+static uint32_t test_u32HeldSlot;
+
+static TEST_Message_t test_asMessages[TEST_MAX_MESSAGES];
+static uint32_t test_u32Messages;
+static uint32_t test_u32Pending;
+static TEST_Stats_t test_sStats;
+static uint32_t test_u32Seed;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+uint32_t HAL_GetTick(void)
+{
+    return test_u32Frame;
+}
+
+uint8_t USBD_CDC_SetTxBuffer(USBD_HandleTypeDef *pdev, uint8_t *pbuff, uint32_t length)
+{
+    (void)pdev;
+    test_pu8Tx = pbuff;
+    test_u32TxLength = length;
+    return USBD_OK;
+}
+
+uint8_t USBD_CDC_TransmitPacket(USBD_HandleTypeDef *pdev)
+{
+    (void)pdev;
+    if (test_sCdc.TxState != 0)
+    {
+        return USBD_BUSY;
+    }
+    test_sCdc.TxState = 1;
+    test_u32TxSent = 0;
+    test_u8TxZlp = 0;
+    test_u32TxHeldEnd = UINT32_MAX;
+    test_sStats.u32Transfers++;
+    /* 63 bytes short of a packet while there was one more, the 64th is held */
+    if (test_u32TxLength % TEST_PACKET == TEST_PACKET - 1 && CDC_TXQueue_GetReadAvailable() > test_u32TxLength)
+    {
+        test_sStats.u32Held++;
+        test_u32TxHeldEnd = test_u32Stream + test_u32TxLength + 1;
+    }
+    return USBD_OK;
+}
+
+static uint32_t test_u32Random(void)
+{
+    test_u32Seed = test_u32Seed * 1103515245U + 12345U;
+    return test_u32Seed >> 16;
+}
+
+/* byte n of the stream */
+static uint8_t test_u8Byte(uint32_t n)
+{
+    return (uint8_t)(n * 131U + (n >> 8));
+}
+
+/* one rosserial frame, 0 if the queue had no room for it */
+static uint8_t test_u8Write(uint32_t u32Length)
+{
+    uint8_t l_au8Frame[TEST_MAX_MESSAGE_SIZE];
+    uint32_t i;
+
+    for (i = 0; i < u32Length; i++)
+    {
+        l_au8Frame[i] = test_u8Byte(test_u32Written + i);
+    }
+    if (test_u32Messages == TEST_MAX_MESSAGES || CDC_Transmit(l_au8Frame, u32Length) != USBD_OK)
+    {
+        return 0;
+    }
+    test_u32Written += u32Length;
+    test_asMessages[test_u32Messages].u32Written = test_u32Slot;
+    test_asMessages[test_u32Messages].u32End = test_u32Written;
+    test_asMessages[test_u32Messages].u32Done = UINT32_MAX;
+    test_u32Messages++;
+    return 1;
+}
+
+/* the transfer ended, the host has every message up to its last byte */
+static void test_complete(void)
+{
+    uint32_t l_u32Length = test_u32TxLength;
+
+    test_u32Stream += test_u32TxLength;
+    while (test_u32Pending < test_u32Messages && test_asMessages[test_u32Pending].u32End <= test_u32Stream)
+    {
+        TEST_Message_t *l_psMessage = &test_asMessages[test_u32Pending++];
+
+        l_psMessage->u32Done = test_u32Slot;
+        /* sent with a ZLP, it had ended one slot after the 63 bytes */
+        if (l_psMessage->u32End == test_u32HeldEnd)
+        {
+            uint32_t l_u32Delay = test_u32Slot - (test_u32HeldSlot + 1);
+
+            test_sStats.u32HeldMessages++;
+            test_sStats.u32HeldDelay += l_u32Delay;
+            if (l_u32Delay > test_sStats.u32HeldMaxDelay)
+            {
+                test_sStats.u32HeldMaxDelay = l_u32Delay;
+            }
+        }
+    }
+    if (test_u32TxHeldEnd != UINT32_MAX)
+    {
+        test_u32HeldEnd = test_u32TxHeldEnd;
+        test_u32HeldSlot = test_u32Slot;
+    }
+    test_sCdc.TxState = 0;
+    USBD_Interface_fops_FS.TransmitCplt(test_pu8Tx, &l_u32Length, 1);
+}
+
+/* one packet slot of the endpoint, the SOF on the first one of the frame */
+static void test_endpoint(void)
+{
+    if (test_sCdc.TxState != 0)
+    {
+        test_sStats.u32BusySlots++;
+        if (test_u8TxZlp)
+        {
+            test_sStats.u32Zlp++;
+            test_complete();
+        }
+        else
+        {
+            uint32_t l_u32Packet = MIN(TEST_PACKET, test_u32TxLength - test_u32TxSent);
+            uint32_t i;
+
+            for (i = 0; i < l_u32Packet; i++)
+            {
+                if (test_pu8Tx[test_u32TxSent + i] != test_u8Byte(test_u32Stream + test_u32TxSent + i))
+                {
+                    test_sStats.u32Wrong++;
+                }
+            }
+            test_u32TxSent += l_u32Packet;
+            test_sStats.u32Packets++;
+            if (l_u32Packet < TEST_PACKET)
+            {
+                test_sStats.u32Short++;
+                test_complete();
+            }
+            else if (test_u32TxSent == test_u32TxLength)
+            {
+                test_u8TxZlp = 1;
+            }
+        }
+    }
+    test_u32Slot++;
+    if (test_u32Slot % TEST_SLOTS_PER_FRAME == 0)
+    {
+        test_u32Frame++;
+        CDC_SOF();
+    }
+}
+
+static void test_run(uint32_t u32Slots)
+{
+    while (u32Slots-- > 0)
+    {
+        test_endpoint();
+    }
+}
+
+static uint32_t test_u32Latency(uint32_t u32Message)
+{
+    return test_asMessages[u32Message].u32Done - test_asMessages[u32Message].u32Written;
+}
+
+static float test_fUs(float fSlots)
+{
+    return fSlots * 1000.0f / TEST_SLOTS_PER_FRAME;
+}
+
+static int test_compare(const void *pvA, const void *pvB)
+{
+    uint32_t l_u32A = *(const uint32_t *)pvA;
+    uint32_t l_u32B = *(const uint32_t *)pvB;
+
+    return (l_u32A > l_u32B) - (l_u32A < l_u32B);
+}
+
+void setUp(void)
+{
+    s_txhead = s_txtail = 0;
+    s_txskip = 0;
+    s_txskipPending = 0;
+    s_txreserveSkip = 0;
+    s_txHeldFrames = 0;
+    s_lastTransmitStart = s_lastTransmitComplete = 0;
+    s_txDropCounterHead = s_txDropCounterTail = 0;
+    memset(&test_sCdc, 0, sizeof(test_sCdc));
+    hUsbDeviceFS.pClassData = &test_sCdc;
+    USBD_Interface_fops_FS.Init();
+
+    test_u32Frame = 1;
+    test_u32Slot = 0;
+    test_u32Stream = test_u32Written = 0;
+    test_u32TxHeldEnd = test_u32HeldEnd = UINT32_MAX;
+    test_u32HeldSlot = 0;
+    test_u32Messages = test_u32Pending = 0;
+    memset(&test_sStats, 0, sizeof(test_sStats));
+    test_u32Seed = 1;
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_small_writes_share_a_packet(void)
+{
+    uint32_t i;
+
+    /* a few slots into the frame, one small frame per slot */
+    test_run(2);
+    for (i = 0; i < 10; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT8(1, test_u8Write(6));
+        test_run(1);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Transfers);
+
+    /* out on the first SOF with the endpoint idle, in one short packet */
+    test_run(TEST_SLOTS_PER_FRAME * (CDC_TX_HOLD_FRAMES + 1));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sStats.u32Transfers);
+    TEST_ASSERT_EQUAL_UINT32(1, test_sStats.u32Packets);
+    TEST_ASSERT_EQUAL_UINT32(10, test_u32Pending);
+    TEST_ASSERT_TRUE(test_u32Latency(0) <= TEST_SLOTS_PER_FRAME * CDC_TX_HOLD_FRAMES + 1);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Wrong);
+}
+
+static void test_full_transfer_holds_a_byte(void)
+{
+    char l_acMessage[120];
+
+    /* two full packets : 127 bytes at once, the 128th on the next SOF */
+    test_run(5);
+    TEST_ASSERT_EQUAL_UINT8(1, test_u8Write(2 * TEST_PACKET));
+    test_run(3);
+    TEST_ASSERT_EQUAL_UINT32(1, test_sStats.u32Transfers);
+    TEST_ASSERT_EQUAL_UINT32(1, test_sStats.u32Short);
+    TEST_ASSERT_EQUAL_UINT32(2 * TEST_PACKET - 1, test_u32Stream);
+    TEST_ASSERT_EQUAL_UINT32(0, test_u32Pending);
+
+    test_run(TEST_SLOTS_PER_FRAME * (CDC_TX_HOLD_FRAMES + 1));
+    TEST_ASSERT_EQUAL_UINT32(2, test_sStats.u32Transfers);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Zlp);
+    TEST_ASSERT_EQUAL_UINT32(1, test_u32Pending);
+    TEST_ASSERT_EQUAL_UINT32(1, test_sStats.u32HeldMessages);
+    TEST_ASSERT_TRUE(test_sStats.u32HeldMaxDelay <= TEST_SLOTS_PER_FRAME * CDC_TX_HOLD_FRAMES);
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "128 byte frame : %.0f us, %.0f us later than with a ZLP",
+             test_fUs(test_u32Latency(0)), test_fUs(test_sStats.u32HeldMaxDelay));
+    TEST_MESSAGE(l_acMessage);
+}
+
+static void test_throughput(void)
+{
+    static const uint32_t l_cau32Sizes[] = {20, 64, 100, 300};
+    char l_acMessage[160];
+    uint32_t k;
+
+    for (k = 0; k < sizeof(l_cau32Sizes) / sizeof(l_cau32Sizes[0]); k++)
+    {
+        uint32_t l_u32Frames = 1000;
+        uint32_t l_u32Slots = l_u32Frames * TEST_SLOTS_PER_FRAME;
+        float l_fCapacity = (float)l_u32Slots * TEST_PACKET;
+        uint32_t l_u32Sent;
+        uint32_t i;
+
+        setUp();
+        /* the queue kept full */
+        for (i = 0; i < l_u32Slots; i++)
+        {
+            while (test_u8Write(l_cau32Sizes[k]))
+            {
+            }
+            test_run(1);
+        }
+
+        /* with the packets of the transfer still on the endpoint */
+        l_u32Sent = test_u32Stream + test_u32TxSent;
+        TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Wrong);
+        TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Zlp);
+        TEST_ASSERT_TRUE(l_u32Sent > 0.99f * l_fCapacity);
+
+        snprintf(l_acMessage, sizeof(l_acMessage), "%3u byte frames : %.0f B/ms, %.2f %% of the slots, %.2f %% with a ZLP per full transfer",
+                 (unsigned)l_cau32Sizes[k], (float)l_u32Sent / l_u32Frames, 100.0f * l_u32Sent / l_fCapacity,
+                 100.0f * l_u32Sent / ((float)(l_u32Slots + test_sStats.u32Held) * TEST_PACKET));
+        TEST_MESSAGE(l_acMessage);
+    }
+}
+
+static void test_latency(void)
+{
+    static uint32_t l_au32Latency[TEST_MAX_MESSAGES];
+    char l_acMessage[200];
+    uint32_t l_u32Slots = TEST_LOAD_FRAMES * TEST_SLOTS_PER_FRAME;
+    uint64_t l_u64Sum = 0;
+    uint32_t i;
+
+    /* rosserial frames of 8 to 300 bytes, about 40 % of the bus */
+    for (i = 0; i < l_u32Slots; i++)
+    {
+        if (test_u32Random() % 6 == 0)
+        {
+            TEST_ASSERT_EQUAL_UINT8(1, test_u8Write(8 + test_u32Random() % 293));
+        }
+        test_run(1);
+    }
+    test_run(TEST_SLOTS_PER_FRAME * (CDC_TX_HOLD_FRAMES + 2));
+
+    TEST_ASSERT_EQUAL_UINT32(test_u32Messages, test_u32Pending);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Wrong);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sStats.u32Zlp);
+    for (i = 0; i < test_u32Messages; i++)
+    {
+        l_au32Latency[i] = test_u32Latency(i);
+        l_u64Sum += l_au32Latency[i];
+    }
+    qsort(l_au32Latency, test_u32Messages, sizeof(l_au32Latency[0]), test_compare);
+
+    /* a frame waits the hold, then the transfers queued before it */
+    TEST_ASSERT_TRUE(l_au32Latency[test_u32Messages - 1] <= TEST_SLOTS_PER_FRAME * (CDC_TX_HOLD_FRAMES + 2));
+    /* the held byte costs at most the hold */
+    TEST_ASSERT_TRUE(test_sStats.u32HeldMessages > 0);
+    TEST_ASSERT_TRUE(test_sStats.u32HeldMaxDelay <= TEST_SLOTS_PER_FRAME * CDC_TX_HOLD_FRAMES);
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "%u frames, %.0f B/ms : latency mean %.0f us, p99 %.0f us, max %.0f us, %.1f frames per transfer",
+             (unsigned)test_u32Messages, (float)test_u32Stream / TEST_LOAD_FRAMES, test_fUs((float)l_u64Sum / test_u32Messages),
+             test_fUs(l_au32Latency[test_u32Messages * 99 / 100]), test_fUs(l_au32Latency[test_u32Messages - 1]),
+             (float)test_u32Messages / test_sStats.u32Transfers);
+    TEST_MESSAGE(l_acMessage);
+    snprintf(l_acMessage, sizeof(l_acMessage), "held 64th byte : %u transfers, %u frames ended on it, %.0f us mean, %.0f us max later than with a ZLP",
+             (unsigned)test_sStats.u32Held, (unsigned)test_sStats.u32HeldMessages,
+             test_fUs((float)test_sStats.u32HeldDelay / test_sStats.u32HeldMessages), test_fUs(test_sStats.u32HeldMaxDelay));
+    TEST_MESSAGE(l_acMessage);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_small_writes_share_a_packet);
+    RUN_TEST(test_full_transfer_holds_a_byte);
+    RUN_TEST(test_throughput);
+    RUN_TEST(test_latency);
+    return UNITY_END();
+}
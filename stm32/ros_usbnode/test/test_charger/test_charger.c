@@ -0,0 +1,338 @@
+/****************************************************************************
+* Title                 :   charger tests
+* Filename              :   test_charger.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_charger.c
+ *  \brief host simulation of ChargeController() on a buck stage and a 7S pack
+ *
+ *  Every CHARGER_PERIOD the simulation gives the controller what ADC_input()
+ *  would : the charge current and voltage of the last period (sampled in the
+ *  middle of the PWM pulse, so the average, not filtered) and the battery
+ *  voltage through its 0.2 IIR. The buck output is the duty times the
+ *  charger input, the inductor settles far below 10 ms so it is not modelled.
+ *  The pack is an open circuit voltage linear in the state of charge, a
+ *  series resistance and the wiring resistance, no current flows back.
+ *  Run with : pio test -d test -f test_charger
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "charger.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_INPUT_VOLTAGE 32.0
+#define TEST_CAPACITY_AH 2.8
+#define TEST_CELLS 7
+/* CC settling requirements */
+#define TEST_T90_MAX_S 1.1
+#define TEST_OVERSHOOT_MAX 0.04
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+typedef struct
+{
+    double dSoc;                /* 0 .. 1 */
+    double dPackOhm;            /* cells and connections */
+    double dWiringOhm;          /* between the charge output and the battery voltage sense */
+    double dInputVoltage;       /* charger supply, 0 unplugged */
+    double dCurrent;            /* A, last period */
+    double dChargeVoltage;      /* V, buck output */
+    double dBatteryVoltage;     /* V, pack terminals */
+    double dFilteredBattery;    /* V, as filtered by ADC_input() */
+    uint32_t u32Steps;
+} TEST_Sim_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+/* adc.c */
+uint16_t adc_u16BatteryMilliVolt;
+uint16_t adc_u16ChargeMilliVolt;
+int16_t adc_s16CurrentMilliAmp;
+uint16_t adc_u16ChargerInputMilliVolt;
+float chargerInputVoltage;
+float current_without_offset;
+union FtoU charge_current_offset;
+RTC_HandleTypeDef hrtc;
+
+static uint32_t test_u32Tick;
+static uint32_t test_u32Full;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+void debug_printf(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+void Error_Handler(void)
+{
+    TEST_FAIL_MESSAGE("Error_Handler");
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return test_u32Tick;
+}
+
+void BATTERY_SetFull(void)
+{
+    test_u32Full++;
+}
+
+/* current of one PWM count : the regulation can not be finer than that */
+static double test_dCountCurrent(const TEST_Sim_t *pcsSim)
+{
+    return pcsSim->dInputVoltage / CHARGER_PWM_PERIOD / (pcsSim->dPackOhm + pcsSim->dWiringOhm);
+}
+
+/* open circuit voltage, 3.3 V to 4.2 V per cell */
+static double test_dOcv(double dSoc)
+{
+    return TEST_CELLS * (3.3 + 0.9 * dSoc);
+}
+
+static void test_simInit(TEST_Sim_t *psSim, double dSoc, double dPackOhm, double dWiringOhm)
+{
+    memset(psSim, 0, sizeof(TEST_Sim_t));
+    psSim->dSoc = dSoc;
+    psSim->dPackOhm = dPackOhm;
+    psSim->dWiringOhm = dWiringOhm;
+    psSim->dInputVoltage = TEST_INPUT_VOLTAGE;
+    psSim->dBatteryVoltage = test_dOcv(dSoc);
+    psSim->dFilteredBattery = psSim->dBatteryVoltage;
+}
+
+/* one CHARGER_PERIOD with the PWM set by the previous ChargeController() */
+static void test_simStep(TEST_Sim_t *psSim, double dLoad)
+{
+    double l_dOutput = TIM1->CCR1 * psSim->dInputVoltage / CHARGER_PWM_PERIOD;
+    double l_dOcv = test_dOcv(psSim->dSoc);
+
+    psSim->dCurrent = 0;
+    psSim->dChargeVoltage = l_dOcv - dLoad * psSim->dPackOhm;
+    if (l_dOutput > psSim->dChargeVoltage)
+    {
+        psSim->dCurrent = (l_dOutput - psSim->dChargeVoltage) / (psSim->dPackOhm + psSim->dWiringOhm);
+        psSim->dChargeVoltage = l_dOutput;
+    }
+    psSim->dBatteryVoltage = l_dOcv + (psSim->dCurrent - dLoad) * psSim->dPackOhm;
+    psSim->dSoc += (psSim->dCurrent - dLoad) * CHARGER_PERIOD / 1000.0 / (TEST_CAPACITY_AH * 3600.0);
+    psSim->dFilteredBattery += 0.2 * (psSim->dBatteryVoltage - psSim->dFilteredBattery);
+
+    adc_u16ChargerInputMilliVolt = psSim->dInputVoltage * 1000.0;
+    chargerInputVoltage = psSim->dInputVoltage;
+    adc_s16CurrentMilliAmp = psSim->dCurrent * 1000.0;
+    adc_u16ChargeMilliVolt = psSim->dChargeVoltage * 1000.0;
+    adc_u16BatteryMilliVolt = psSim->dFilteredBattery * 1000.0;
+
+    test_u32Tick += CHARGER_PERIOD;
+    ChargeController();
+    psSim->u32Steps++;
+}
+
+/* docked, until the controller is charging */
+static void test_simDock(TEST_Sim_t *psSim)
+{
+    uint32_t n;
+
+    for (n = 0; n < 100 && chargecontrol_is_charging != CHARGER_STATE_CHARGING_CC; n++)
+    {
+        test_simStep(psSim, 0);
+    }
+    TEST_ASSERT_EQUAL_INT(CHARGER_STATE_CHARGING_CC, chargecontrol_is_charging);
+    psSim->u32Steps = 0;
+}
+
+void setUp(void)
+{
+    TEST_Sim_t l_sSim;
+
+    test_u32Tick = 0;
+    test_u32Full = 0;
+    /* undocked : back to idle */
+    test_simInit(&l_sSim, 0.5, 0.3, 0.1);
+    l_sSim.dInputVoltage = 0;
+    test_simStep(&l_sSim, 0);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_cc_settling(void)
+{
+    static const double l_pcdOhm[][2] = {{0.15, 0.05}, {0.3, 0.1}, {0.5, 0.2}, {0.6, 0.3}};
+    char l_acMessage[128];
+    TEST_Sim_t l_sSim;
+    unsigned r;
+
+    for (r = 0; r < sizeof(l_pcdOhm) / sizeof(l_pcdOhm[0]); r++)
+    {
+        double l_dPeak = 0;
+        double l_dT90 = -1;
+        double l_dMean = 0;
+
+        setUp();
+        test_simInit(&l_sSim, 0.2, l_pcdOhm[r][0], l_pcdOhm[r][1]);
+        test_simDock(&l_sSim);
+        while (l_sSim.u32Steps < 1000)
+        {
+            test_simStep(&l_sSim, 0);
+            if (l_sSim.dCurrent > l_dPeak)
+            {
+                l_dPeak = l_sSim.dCurrent;
+            }
+            if (l_dT90 < 0 && l_sSim.dCurrent >= 0.9 * MAX_CHARGE_CURRENT)
+            {
+                l_dT90 = l_sSim.u32Steps * CHARGER_PERIOD / 1000.0;
+            }
+            /* the last second */
+            if (l_sSim.u32Steps > 900)
+            {
+                l_dMean += l_sSim.dCurrent / 100;
+            }
+        }
+        snprintf(l_acMessage, sizeof(l_acMessage), "%.2f ohm : 90%% in %.2f s, overshoot %.1f%% (one PWM count %.1f%%), mean %.3f A",
+                 l_pcdOhm[r][0] + l_pcdOhm[r][1], l_dT90, 100.0 * (l_dPeak / MAX_CHARGE_CURRENT - 1.0),
+                 100.0 * test_dCountCurrent(&l_sSim) / MAX_CHARGE_CURRENT, l_dMean);
+        TEST_MESSAGE(l_acMessage);
+
+        TEST_ASSERT_TRUE(l_dT90 >= 0);
+        TEST_ASSERT_LESS_THAN_FLOAT(TEST_T90_MAX_S, l_dT90);
+        /* the overshoot of the loop, plus the PWM resolution with a low resistance */
+        TEST_ASSERT_LESS_THAN_FLOAT(MAX_CHARGE_CURRENT * (1.0 + TEST_OVERSHOOT_MAX) + test_dCountCurrent(&l_sSim), l_dPeak);
+        TEST_ASSERT_FLOAT_WITHIN(0.02 + test_dCountCurrent(&l_sSim) / 2, MAX_CHARGE_CURRENT, l_dMean);
+        TEST_ASSERT_EQUAL_INT(CHARGER_STATE_CHARGING_CC, chargecontrol_is_charging);
+    }
+}
+
+static void test_cc_to_cv_handover(void)
+{
+    char l_acMessage[128];
+    TEST_Sim_t l_sSim;
+    double l_dMaxCharge = 0;
+    double l_dMaxBattery = 0;
+    double l_dMaxStep = 0;
+    double l_dPrevious;
+    uint32_t l_u32Cv;
+
+    test_simInit(&l_sSim, 0.85, 0.3, 0.1);
+    test_simDock(&l_sSim);
+    /* settled CC first */
+    while (l_sSim.u32Steps < 300)
+    {
+        test_simStep(&l_sSim, 0);
+    }
+    l_dPrevious = l_sSim.dCurrent;
+    /* until one minute into CV */
+    l_u32Cv = 0;
+    while (l_u32Cv < 6000)
+    {
+        if (chargecontrol_is_charging == CHARGER_STATE_CHARGING_CV)
+        {
+            l_u32Cv++;
+        }
+        test_simStep(&l_sSim, 0);
+        if (l_sSim.dChargeVoltage > l_dMaxCharge)
+        {
+            l_dMaxCharge = l_sSim.dChargeVoltage;
+        }
+        if (l_sSim.dBatteryVoltage > l_dMaxBattery)
+        {
+            l_dMaxBattery = l_sSim.dBatteryVoltage;
+        }
+        if (fabs(l_sSim.dCurrent - l_dPrevious) > l_dMaxStep)
+        {
+            l_dMaxStep = fabs(l_sSim.dCurrent - l_dPrevious);
+        }
+        l_dPrevious = l_sSim.dCurrent;
+        TEST_ASSERT_TRUE(l_sSim.u32Steps < 200000);
+    }
+    snprintf(l_acMessage, sizeof(l_acMessage), "charge output up to %.3f V, battery up to %.3f V, largest current step %.3f A",
+             l_dMaxCharge, l_dMaxBattery, l_dMaxStep);
+    TEST_MESSAGE(l_acMessage);
+
+    TEST_ASSERT_LESS_THAN_FLOAT(MAX_CHARGE_VOLTAGE + 0.05, l_dMaxCharge);
+    TEST_ASSERT_LESS_THAN_FLOAT(BAT_CHARGE_CUTOFF_VOLTAGE + 0.05, l_dMaxBattery);
+    /* the current tapers, no jump when the voltage loop takes over */
+    TEST_ASSERT_LESS_THAN_FLOAT(1.5 * test_dCountCurrent(&l_sSim), l_dMaxStep);
+    TEST_ASSERT_LESS_THAN_FLOAT(MAX_CHARGE_CURRENT, l_sSim.dCurrent);
+}
+
+static void test_end_of_charge_and_recharge(void)
+{
+    TEST_Sim_t l_sSim;
+
+    test_simInit(&l_sSim, 0.93, 0.3, 0.1);
+    test_simDock(&l_sSim);
+    while (chargecontrol_is_charging != CHARGER_STATE_END_CHARGING)
+    {
+        test_simStep(&l_sSim, 0);
+        TEST_ASSERT_TRUE(l_sSim.u32Steps < 360000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, test_u32Full);
+    TEST_ASSERT_LESS_THAN_FLOAT(CHARGE_END_LIMIT_CURRENT + 0.01, l_sSim.dCurrent);
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.95, l_sSim.dSoc);
+
+    /* off while full */
+    test_simStep(&l_sSim, 0);
+    TEST_ASSERT_EQUAL_UINT16(0, TIM1->CCR1);
+    TEST_ASSERT_EQUAL_INT(CHARGER_STATE_END_CHARGING, chargecontrol_is_charging);
+
+    /* the mower draws from the battery until it needs a top up */
+    l_sSim.u32Steps = 0;
+    while (chargecontrol_is_charging == CHARGER_STATE_END_CHARGING)
+    {
+        test_simStep(&l_sSim, 1.0);
+        TEST_ASSERT_TRUE(l_sSim.u32Steps < 360000);
+    }
+    TEST_ASSERT_EQUAL_INT(CHARGER_STATE_CHARGING_CC, chargecontrol_is_charging);
+    TEST_ASSERT_LESS_THAN_FLOAT(BAT_RECHARGE_VOLTAGE, l_sSim.dFilteredBattery);
+}
+
+static void test_undock_stops_the_charge(void)
+{
+    TEST_Sim_t l_sSim;
+
+    test_simInit(&l_sSim, 0.5, 0.3, 0.1);
+    test_simDock(&l_sSim);
+    while (l_sSim.u32Steps < 100)
+    {
+        test_simStep(&l_sSim, 0);
+    }
+    TEST_ASSERT_TRUE(TIM1->CCR1 > 0);
+    l_sSim.dInputVoltage = 0;
+    test_simStep(&l_sSim, 0);
+    TEST_ASSERT_EQUAL_INT(CHARGER_STATE_IDLE, chargecontrol_is_charging);
+    TEST_ASSERT_EQUAL_UINT16(0, TIM1->CCR1);
+    /* the ADC trigger keeps running */
+    TEST_ASSERT_EQUAL_UINT16(1, TIM1->CCR4);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cc_settling);
+    RUN_TEST(test_cc_to_cv_handover);
+    RUN_TEST(test_end_of_charge_and_recharge);
+    RUN_TEST(test_undock_stops_the_charge);
+    return UNITY_END();
+}
@@ -0,0 +1,431 @@
+/****************************************************************************
+* Title                 :   encoder tests
+* Filename              :   test_encoder.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_encoder.c
+ *  \brief host tests of the encoder unwrapping and replay of drive motor captures
+ *
+ *  The replay reads DRIVEMOTOR_Capture_t records (drivemotor/capture, see
+ *  drivemotor.h) : the DWT time of the reply, little endian, then the 20 byte
+ *  reply. It decodes them as DRIVEMOTOR_App_Rx() does and integrates the
+ *  ticks of both wheels with ENCODER_u16Update().
+ *  A simulated PAC5210 writes such records with a known distance : counter
+ *  wraps, resets one or two replies late, held ticks, corrupted counters and
+ *  reply jitter. A recorded capture can be replayed too :
+ *    ENCODER_CAPTURE=capture.bin ENCODER_TRUTH_M="12.3 12.1" pio test -d test -f test_encoder
+ *  capture.bin being the data of the drivemotor/capture messages one after
+ *  the other, all with the same layout.data_offset (the blocks lost before
+ *  each one, a change is a gap), ENCODER_TRUTH_M the measured distance of the left and right
+ *  wheel (optional, the result is printed anyway).
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "drivemotor.h"
+#include "encoder.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_CORE_CLOCK 72000000U
+#define TEST_REPLY_US (1000000U / DRIVEMOTOR_POLL_HZ)
+/* same as DRIVEMOTOR_RX_TIMEOUT in drivemotor.c (ms) */
+#define TEST_RX_TIMEOUT_MS 100U
+#define TEST_RECORD_SIZE (4 + DRIVEMOTOR_LENGTH_RECEIVED_MSG)
+/* 20 minutes of replies */
+#define TEST_REPLIES (20 * 60 * DRIVEMOTOR_POLL_HZ)
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+/* replay of a capture */
+typedef struct
+{
+    ENCODER_Wheel_t asWheel[2];
+    uint32_t u32LastCycles;
+    uint32_t u32Records;
+    uint32_t u32BadFrames;
+} TEST_Replay_t;
+
+/* simulated counter of one wheel */
+typedef struct
+{
+    int8_t s8Direction;
+    uint16_t u16Counter;
+    uint16_t u16Shown;
+    uint8_t u8ResetIn;          /* replies before the reset of a start or reversal, 0 none */
+    uint8_t u8HoldFor;          /* replies left showing the same counter */
+    uint16_t u16ChangeOdds;     /* one direction change every u16ChangeOdds replies on average */
+    float fFraction;
+    uint32_t u32Truth;          /* ticks really travelled */
+} TEST_SimWheel_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static ENCODER_Wheel_t test_sWheel;
+static uint8_t test_au8Capture[TEST_REPLIES * TEST_RECORD_SIZE];
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+static uint16_t test_u16Step(int8_t s8Direction, uint16_t u16Raw)
+{
+    return ENCODER_u16Update(&test_sWheel, s8Direction, u16Raw, TEST_REPLY_US);
+}
+
+/* direction bits of the reply, as decoded by DRIVEMOTOR_App_Rx() */
+static int8_t test_s8Direction(uint8_t u8Direction, uint8_t u8Wheel)
+{
+    uint8_t l_u8Shift = u8Wheel == DRIVEMOTOR_LEFT ? 0 : 2;
+
+    if (((u8Direction << l_u8Shift) & 0xc0) == 0xc0)
+    {
+        return 1;
+    }
+    if (((u8Direction << l_u8Shift) & 0xc0) == 0x80)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+static void test_replayInit(TEST_Replay_t *psReplay)
+{
+    memset(psReplay, 0, sizeof(TEST_Replay_t));
+    ENCODER_Init(&psReplay->asWheel[DRIVEMOTOR_LEFT]);
+    ENCODER_Init(&psReplay->asWheel[DRIVEMOTOR_RIGHT]);
+}
+
+/* integrate the records of a capture, the frames with a bad header or CRC are skipped */
+static void test_replay(TEST_Replay_t *psReplay, const uint8_t *pcu8Data, uint32_t u32Length)
+{
+    uint32_t r;
+
+    for (r = 0; r + TEST_RECORD_SIZE <= u32Length; r += TEST_RECORD_SIZE)
+    {
+        const uint8_t *l_pcu8Frame = &pcu8Data[r + 4];
+        uint32_t l_u32Cycles = pcu8Data[r] | pcu8Data[r + 1] << 8 | pcu8Data[r + 2] << 16 | (uint32_t)pcu8Data[r + 3] << 24;
+        uint8_t l_u8Crc = 0;
+        uint8_t i;
+
+        for (i = 0; i < DRIVEMOTOR_LENGTH_RECEIVED_MSG - 1; i++)
+        {
+            l_u8Crc += l_pcu8Frame[i];
+        }
+        if (l_pcu8Frame[0] != 0x55 || l_pcu8Frame[1] != 0xAA || l_u8Crc != l_pcu8Frame[DRIVEMOTOR_LENGTH_RECEIVED_MSG - 1])
+        {
+            psReplay->u32BadFrames++;
+            continue;
+        }
+
+        uint32_t l_u32DtUs = (l_u32Cycles - psReplay->u32LastCycles) / (TEST_CORE_CLOCK / 1000000U);
+        if (l_u32DtUs == 0 || l_u32DtUs >= TEST_RX_TIMEOUT_MS * 1000U)
+        {
+            l_u32DtUs = TEST_REPLY_US;
+        }
+        psReplay->u32LastCycles = l_u32Cycles;
+
+        ENCODER_u16Update(&psReplay->asWheel[DRIVEMOTOR_LEFT], test_s8Direction(l_pcu8Frame[5], DRIVEMOTOR_LEFT),
+                          l_pcu8Frame[13] | l_pcu8Frame[14] << 8, l_u32DtUs);
+        ENCODER_u16Update(&psReplay->asWheel[DRIVEMOTOR_RIGHT], test_s8Direction(l_pcu8Frame[5], DRIVEMOTOR_RIGHT),
+                          l_pcu8Frame[15] | l_pcu8Frame[16] << 8, l_u32DtUs);
+        psReplay->u32Records++;
+    }
+}
+
+/* one reply of the simulated PAC5210 for a wheel */
+static void test_simStep(TEST_SimWheel_t *psSim)
+{
+    /* new direction now and then, the counter resets in this reply or one or two later */
+    if (rand() % psSim->u16ChangeOdds == 0)
+    {
+        int8_t l_s8Direction = (rand() % 3) - 1;
+        if (l_s8Direction != psSim->s8Direction && l_s8Direction != 0)
+        {
+            psSim->u8ResetIn = 1 + rand() % 3;
+        }
+        psSim->s8Direction = l_s8Direction;
+    }
+    if (psSim->u8ResetIn && --psSim->u8ResetIn == 0)
+    {
+        psSim->u16Counter = 0;
+    }
+    if (psSim->s8Direction)
+    {
+        /* 0.1 to 0.85 m/s */
+        psSim->fFraction += (0.1f + (rand() % 75) / 100.0f) * TICKS_PER_M / DRIVEMOTOR_POLL_HZ;
+        uint16_t l_u16Ticks = (uint16_t)psSim->fFraction;
+        psSim->fFraction -= l_u16Ticks;
+        psSim->u16Counter += l_u16Ticks;
+        psSim->u32Truth += l_u16Ticks;
+    }
+    if (psSim->u8HoldFor)
+    {
+        psSim->u8HoldFor--;
+    }
+    else
+    {
+        psSim->u16Shown = psSim->u16Counter;
+        if (rand() % 200 == 0)
+        {
+            psSim->u8HoldFor = 1 + rand() % 5;
+        }
+    }
+}
+
+static uint8_t test_u8DirectionBits(int8_t s8Direction)
+{
+    return s8Direction > 0 ? 3 : s8Direction < 0 ? 2 : 0;
+}
+
+/* a capture of u32Replies replies, returns its length */
+static uint32_t test_u32Simulate(TEST_SimWheel_t *psSims, uint32_t u32Replies, uint32_t u32Corrupted)
+{
+    uint32_t l_u32Cycles = 0xF0000000U;     /* the DWT counter wraps during the capture */
+    uint32_t n;
+
+    memset(psSims, 0, 2 * sizeof(TEST_SimWheel_t));
+    /* the left wheel goes straight for minutes and wraps, the right one turns often */
+    psSims[DRIVEMOTOR_LEFT].s8Direction = 1;
+    psSims[DRIVEMOTOR_LEFT].u8ResetIn = 1;
+    psSims[DRIVEMOTOR_LEFT].u16ChangeOdds = 20000;
+    psSims[DRIVEMOTOR_RIGHT].u16Counter = 12000;
+    psSims[DRIVEMOTOR_RIGHT].u16ChangeOdds = 400;
+    for (n = 0; n < u32Replies; n++)
+    {
+        uint8_t *l_pu8Record = &test_au8Capture[n * TEST_RECORD_SIZE];
+        uint8_t *l_pu8Frame = &l_pu8Record[4];
+        uint8_t l_u8Crc = 0;
+        uint8_t i;
+
+        test_simStep(&psSims[DRIVEMOTOR_LEFT]);
+        test_simStep(&psSims[DRIVEMOTOR_RIGHT]);
+
+        /* 20 ms +/- 2 ms */
+        l_u32Cycles += (TEST_REPLY_US - 2000 + rand() % 4000) * (TEST_CORE_CLOCK / 1000000U);
+        l_pu8Record[0] = l_u32Cycles;
+        l_pu8Record[1] = l_u32Cycles >> 8;
+        l_pu8Record[2] = l_u32Cycles >> 16;
+        l_pu8Record[3] = l_u32Cycles >> 24;
+
+        memset(l_pu8Frame, 0, DRIVEMOTOR_LENGTH_RECEIVED_MSG);
+        l_pu8Frame[0] = 0x55;
+        l_pu8Frame[1] = 0xAA;
+        l_pu8Frame[2] = DRIVEMOTOR_LENGTH_RECEIVED_MSG - FRAME_OVERHEAD;
+        l_pu8Frame[5] = test_u8DirectionBits(psSims[DRIVEMOTOR_LEFT].s8Direction) << 6 |
+                        test_u8DirectionBits(psSims[DRIVEMOTOR_RIGHT].s8Direction) << 4;
+        l_pu8Frame[13] = psSims[DRIVEMOTOR_LEFT].u16Shown;
+        l_pu8Frame[14] = psSims[DRIVEMOTOR_LEFT].u16Shown >> 8;
+        l_pu8Frame[15] = psSims[DRIVEMOTOR_RIGHT].u16Shown;
+        l_pu8Frame[16] = psSims[DRIVEMOTOR_RIGHT].u16Shown >> 8;
+        /* a counter bit flipped with a valid CRC, the decoder has to catch it */
+        if (u32Corrupted && rand() % (u32Replies / u32Corrupted) == 0)
+        {
+            l_pu8Frame[14] ^= 0x40;
+        }
+        for (i = 0; i < DRIVEMOTOR_LENGTH_RECEIVED_MSG - 1; i++)
+        {
+            l_u8Crc += l_pu8Frame[i];
+        }
+        l_pu8Frame[DRIVEMOTOR_LENGTH_RECEIVED_MSG - 1] = l_u8Crc;
+    }
+    return u32Replies * TEST_RECORD_SIZE;
+}
+
+static void test_checkDistance(const TEST_Replay_t *psReplay, const TEST_SimWheel_t *psSims, float fTolerance)
+{
+    char l_acMessage[128];
+    uint8_t w;
+
+    for (w = 0; w < 2; w++)
+    {
+        float l_fError = ((float)psReplay->asWheel[w].u32Ticks - psSims[w].u32Truth) / psSims[w].u32Truth;
+        snprintf(l_acMessage, sizeof(l_acMessage), "%s %.1f m, error %.3f%%, wraps %u resets %u held %u implausible %u",
+                 w == DRIVEMOTOR_LEFT ? "left" : "right", psSims[w].u32Truth / TICKS_PER_M, 100.0f * l_fError,
+                 psReplay->asWheel[w].u32Wraps, psReplay->asWheel[w].u32Resets, psReplay->asWheel[w].u32Held,
+                 psReplay->asWheel[w].u32Implausible);
+        TEST_MESSAGE(l_acMessage);
+        TEST_ASSERT_FLOAT_WITHIN(fTolerance, 0.0f, l_fError);
+    }
+}
+
+void setUp(void)
+{
+    srand(1);
+    ENCODER_Init(&test_sWheel);
+    /* running forward from 1000 */
+    test_u16Step(0, 1000);
+    test_u16Step(1, 1000);
+    test_u16Step(1, 1000);
+    test_u16Step(1, 1000);
+    test_u16Step(1, 1000);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_counts_forward(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(5, test_u16Step(1, 1005));
+    TEST_ASSERT_EQUAL_UINT16(6, test_u16Step(1, 1011));
+    TEST_ASSERT_EQUAL_UINT32(11, test_sWheel.u32Ticks);
+}
+
+static void test_wraps_around(void)
+{
+    ENCODER_Init(&test_sWheel);
+    test_u16Step(0, 65530);
+    test_u16Step(1, 65530);
+    test_u16Step(1, 65530);
+    test_u16Step(1, 65530);
+    test_u16Step(1, 65530);
+    TEST_ASSERT_EQUAL_UINT16(10, test_u16Step(1, 4));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sWheel.u32Wraps);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sWheel.u32Resets);
+}
+
+static void test_resets_on_reversal(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(3, test_u16Step(-1, 3));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sWheel.u32Resets);
+    TEST_ASSERT_EQUAL_UINT16(4, test_u16Step(-1, 7));
+}
+
+static void test_late_reset(void)
+{
+    /* the counter still counts from 1000 in the first replies after the reversal */
+    TEST_ASSERT_EQUAL_UINT16(5, test_u16Step(-1, 1005));
+    TEST_ASSERT_EQUAL_UINT16(2, test_u16Step(-1, 2));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sWheel.u32Resets);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sWheel.u32Implausible);
+}
+
+static void test_resets_on_start(void)
+{
+    test_u16Step(0, 1000);
+    TEST_ASSERT_EQUAL_UINT16(0, test_u16Step(0, 1000));
+    TEST_ASSERT_EQUAL_UINT16(4, test_u16Step(1, 4));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sWheel.u32Resets);
+}
+
+static void test_held_ticks_are_released(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(0, test_u16Step(1, 1000));
+    TEST_ASSERT_EQUAL_UINT16(0, test_u16Step(1, 1000));
+    TEST_ASSERT_EQUAL_UINT16(0, test_u16Step(1, 1000));
+    /* nothing counted for 160 ms, up to 68 ticks are plausible */
+    TEST_ASSERT_EQUAL_UINT16(30, test_u16Step(1, 1030));
+    TEST_ASSERT_EQUAL_UINT32(0, test_sWheel.u32Implausible);
+    TEST_ASSERT_TRUE(test_sWheel.u32Held >= 3);
+}
+
+static void test_implausible_delta_is_dropped(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(0, test_u16Step(1, 1500));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sWheel.u32Implausible);
+    /* the new counter is the reference */
+    TEST_ASSERT_EQUAL_UINT16(5, test_u16Step(1, 1505));
+    TEST_ASSERT_EQUAL_UINT32(5, test_sWheel.u32Ticks);
+}
+
+static void test_replay_of_a_simulated_capture(void)
+{
+    static TEST_Replay_t l_sReplay;
+    TEST_SimWheel_t l_asSims[2];
+    uint32_t l_u32Length = test_u32Simulate(l_asSims, TEST_REPLIES, 0);
+
+    test_replayInit(&l_sReplay);
+    test_replay(&l_sReplay, test_au8Capture, l_u32Length);
+    TEST_ASSERT_EQUAL_UINT32(TEST_REPLIES, l_sReplay.u32Records);
+    TEST_ASSERT_TRUE(l_sReplay.asWheel[DRIVEMOTOR_LEFT].u32Wraps > 0);
+    TEST_ASSERT_TRUE(l_sReplay.asWheel[DRIVEMOTOR_RIGHT].u32Resets > 0);
+    test_checkDistance(&l_sReplay, l_asSims, 0.001f);
+}
+
+static void test_replay_with_corrupted_counters(void)
+{
+    static TEST_Replay_t l_sReplay;
+    TEST_SimWheel_t l_asSims[2];
+    uint32_t l_u32Length = test_u32Simulate(l_asSims, TEST_REPLIES, 20);
+
+    /* and a few frames damaged on the way */
+    test_au8Capture[4 + 7] ^= 0x01;
+    test_au8Capture[100 * TEST_RECORD_SIZE + 4] = 0x00;
+
+    test_replayInit(&l_sReplay);
+    test_replay(&l_sReplay, test_au8Capture, l_u32Length);
+    TEST_ASSERT_EQUAL_UINT32(2, l_sReplay.u32BadFrames);
+    TEST_ASSERT_TRUE(l_sReplay.asWheel[DRIVEMOTOR_LEFT].u32Implausible > 0);
+    test_checkDistance(&l_sReplay, l_asSims, 0.005f);
+}
+
+static void test_replay_of_a_recorded_capture(void)
+{
+    static TEST_Replay_t l_sReplay;
+    const char *l_pcFile = getenv("ENCODER_CAPTURE");
+    const char *l_pcTruth = getenv("ENCODER_TRUTH_M");
+    char l_acMessage[128];
+    float l_afTruth[2];
+    uint32_t l_u32Length;
+    FILE *l_psFile;
+    uint8_t w;
+
+    if (l_pcFile == NULL)
+    {
+        TEST_IGNORE_MESSAGE("set ENCODER_CAPTURE to replay a drivemotor/capture recording");
+    }
+    l_psFile = fopen(l_pcFile, "rb");
+    TEST_ASSERT_NOT_NULL(l_psFile);
+    l_u32Length = fread(test_au8Capture, 1, sizeof(test_au8Capture), l_psFile);
+    fclose(l_psFile);
+
+    test_replayInit(&l_sReplay);
+    test_replay(&l_sReplay, test_au8Capture, l_u32Length);
+    for (w = 0; w < 2; w++)
+    {
+        snprintf(l_acMessage, sizeof(l_acMessage), "%s %.3f m, wraps %u resets %u held %u implausible %u, %u records %u bad",
+                 w == DRIVEMOTOR_LEFT ? "left" : "right", l_sReplay.asWheel[w].u32Ticks / TICKS_PER_M,
+                 l_sReplay.asWheel[w].u32Wraps, l_sReplay.asWheel[w].u32Resets, l_sReplay.asWheel[w].u32Held,
+                 l_sReplay.asWheel[w].u32Implausible, l_sReplay.u32Records, l_sReplay.u32BadFrames);
+        TEST_MESSAGE(l_acMessage);
+    }
+    if (l_pcTruth != NULL && sscanf(l_pcTruth, "%f %f", &l_afTruth[0], &l_afTruth[1]) == 2)
+    {
+        for (w = 0; w < 2; w++)
+        {
+            TEST_ASSERT_FLOAT_WITHIN(0.01f * l_afTruth[w], l_afTruth[w], l_sReplay.asWheel[w].u32Ticks / TICKS_PER_M);
+        }
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_counts_forward);
+    RUN_TEST(test_wraps_around);
+    RUN_TEST(test_resets_on_reversal);
+    RUN_TEST(test_late_reset);
+    RUN_TEST(test_resets_on_start);
+    RUN_TEST(test_held_ticks_are_released);
+    RUN_TEST(test_implausible_delta_is_dropped);
+    RUN_TEST(test_replay_of_a_simulated_capture);
+    RUN_TEST(test_replay_with_corrupted_counters);
+    RUN_TEST(test_replay_of_a_recorded_capture);
+    return UNITY_END();
+}
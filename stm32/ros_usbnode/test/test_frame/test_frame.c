@@ -0,0 +1,361 @@
+/****************************************************************************
+* Title                 :   frame scanner tests
+* Filename              :   test_frame.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_frame.c
+ *  \brief host tests and benchmark of FRAME_u8ReceiveIT()
+ *
+ *  The bytes are written into the circular buffer the way the DMA does, the
+ *  counter counting down to 1 and reloading the buffer size, then the scanner
+ *  is called as the UART idle / half / full interrupts would.
+ *  Run with : pio test -d test -f test_frame
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+
+#include "frame.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_DMA_SIZE 64
+/* the drive motor and blade motor replies */
+#define TEST_LONG_LENGTH 20
+#define TEST_SHORT_LENGTH 14
+#define TEST_BENCH_FRAMES 100000
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static const uint8_t test_pcu8LongPreamble[] = {0x55, 0xAA, 0x10, 0x01, 0xE0};
+static const uint8_t test_pcu8ShortPreamble[] = {0x55, 0xAA};
+
+static void test_longCallback(const uint8_t *pcu8Frame, uint8_t u8Length);
+static void test_shortCallback(const uint8_t *pcu8Frame, uint8_t u8Length);
+
+static const FRAME_Desc_t test_pcsDesc[] = {
+    {test_pcu8LongPreamble, sizeof(test_pcu8LongPreamble), TEST_LONG_LENGTH, test_longCallback},
+    {test_pcu8ShortPreamble, sizeof(test_pcu8ShortPreamble), TEST_SHORT_LENGTH, test_shortCallback},
+};
+
+static uint8_t test_au8Dma[TEST_DMA_SIZE];
+static DMA_HandleTypeDef test_sDma;
+static UART_HandleTypeDef test_sUart = {&test_sDma};
+static FRAME_Port_t test_sPort;
+static uint16_t test_u16Write;
+
+static uint32_t test_u32Long;
+static uint32_t test_u32Short;
+static uint8_t test_au8Last[FRAME_MAX_LENGTH];
+static const uint8_t *test_pcu8Last;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+static void test_longCallback(const uint8_t *pcu8Frame, uint8_t u8Length)
+{
+    TEST_ASSERT_EQUAL_UINT8(TEST_LONG_LENGTH, u8Length);
+    test_u32Long++;
+    test_pcu8Last = pcu8Frame;
+    memcpy(test_au8Last, pcu8Frame, u8Length);
+}
+
+static void test_shortCallback(const uint8_t *pcu8Frame, uint8_t u8Length)
+{
+    TEST_ASSERT_EQUAL_UINT8(TEST_SHORT_LENGTH, u8Length);
+    test_u32Short++;
+    test_pcu8Last = pcu8Frame;
+    memcpy(test_au8Last, pcu8Frame, u8Length);
+}
+
+/* one byte received by the DMA */
+static void test_put(uint8_t u8Byte)
+{
+    test_au8Dma[test_u16Write] = u8Byte;
+    test_u16Write = (test_u16Write + 1) % TEST_DMA_SIZE;
+    test_sDma.u32Counter = TEST_DMA_SIZE - test_u16Write;
+}
+
+static void test_putBuffer(const uint8_t *pcu8Data, uint8_t u8Length)
+{
+    uint8_t i;
+    for (i = 0; i < u8Length; i++)
+    {
+        test_put(pcu8Data[i]);
+    }
+}
+
+/* a frame of the descriptor with a running payload and its CRC */
+static uint8_t test_u8Build(uint8_t *pu8Frame, uint8_t bLong, uint8_t u8Seed)
+{
+    uint8_t l_u8Length = bLong ? TEST_LONG_LENGTH : TEST_SHORT_LENGTH;
+    uint8_t l_u8Crc = 0;
+    uint8_t i;
+
+    if (bLong)
+    {
+        memcpy(pu8Frame, test_pcu8LongPreamble, sizeof(test_pcu8LongPreamble));
+    }
+    else
+    {
+        pu8Frame[0] = 0x55;
+        pu8Frame[1] = 0xAA;
+        pu8Frame[2] = TEST_SHORT_LENGTH - FRAME_OVERHEAD;
+        pu8Frame[3] = 0x02;
+        pu8Frame[4] = 0xD0;
+    }
+    for (i = 5; i < l_u8Length - 1; i++)
+    {
+        pu8Frame[i] = (uint8_t)(u8Seed + i);
+    }
+    for (i = 0; i < l_u8Length - 1; i++)
+    {
+        l_u8Crc += pu8Frame[i];
+    }
+    pu8Frame[l_u8Length - 1] = l_u8Crc;
+    return l_u8Length;
+}
+
+/* move the write index, the next frame starts u16Offset bytes in the buffer */
+static void test_skipTo(uint16_t u16Offset)
+{
+    while (test_u16Write != u16Offset)
+    {
+        test_put(0x00);
+    }
+    FRAME_u8ReceiveIT(&test_sPort);
+}
+
+void setUp(void)
+{
+    memset(test_au8Dma, 0, sizeof(test_au8Dma));
+    test_u16Write = 0;
+    test_u32Long = 0;
+    test_u32Short = 0;
+    test_pcu8Last = NULL;
+    FRAME_Init(&test_sPort, &test_sUart, test_au8Dma, TEST_DMA_SIZE, test_pcsDesc, sizeof(test_pcsDesc) / sizeof(test_pcsDesc[0]));
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_valid_frames_point_into_the_dma_buffer(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 1, 1);
+
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_PTR(test_au8Dma, test_pcu8Last);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(l_au8Frame, test_au8Last, l_u8Length);
+
+    l_u8Length = test_u8Build(l_au8Frame, 0, 2);
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_PTR(&test_au8Dma[TEST_LONG_LENGTH], test_pcu8Last);
+    TEST_ASSERT_EQUAL_UINT32(1, test_u32Long);
+    TEST_ASSERT_EQUAL_UINT32(1, test_u32Short);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sPort.sStats.u32Resync);
+}
+
+static void test_partial_frames_wait_for_the_next_interrupt(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 1, 3);
+    uint8_t i;
+
+    for (i = 0; i < l_u8Length - 1; i++)
+    {
+        test_put(l_au8Frame[i]);
+        TEST_ASSERT_EQUAL_UINT8(0, FRAME_u8ReceiveIT(&test_sPort));
+    }
+    test_put(l_au8Frame[l_u8Length - 1]);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_UINT32(0, test_sPort.sStats.u32Resync);
+}
+
+static void test_resync_after_garbage(void)
+{
+    static const uint8_t l_pcu8Garbage[] = {0x12, 0x55, 0x55, 0xAA, 0x03, 0x55};
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 1, 4);
+
+    test_putBuffer(l_pcu8Garbage, sizeof(l_pcu8Garbage));
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(l_au8Frame, test_au8Last, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(l_pcu8Garbage), test_sPort.sStats.u32Resync);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sPort.sStats.u32CrcError);
+}
+
+static void test_a_lost_byte_costs_one_frame(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 1, 5);
+
+    /* the 8th byte is lost, the frame now ends inside the next one */
+    test_putBuffer(l_au8Frame, 7);
+    test_putBuffer(&l_au8Frame[8], l_u8Length - 8);
+    test_putBuffer(l_au8Frame, l_u8Length);
+    test_putBuffer(l_au8Frame, l_u8Length);
+    FRAME_u8ReceiveIT(&test_sPort);
+    TEST_ASSERT_EQUAL_UINT32(2, test_u32Long);
+    TEST_ASSERT_EQUAL_UINT32(1, test_sPort.sStats.u32CrcError);
+}
+
+static void test_crc_error(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 0, 6);
+
+    l_au8Frame[7] ^= 0x01;
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(0, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sPort.sStats.u32CrcError);
+    TEST_ASSERT_EQUAL_UINT32(l_u8Length, test_sPort.sStats.u32Resync);
+
+    /* the next good frame is not affected */
+    l_au8Frame[7] ^= 0x01;
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_UINT32(1, test_sPort.sStats.u32CrcError);
+}
+
+static void test_wrapping_frame_is_copied(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 1, 7);
+    uint8_t l_u8Tail;
+
+    /* every split of the frame around the buffer end */
+    for (l_u8Tail = 1; l_u8Tail < l_u8Length; l_u8Tail++)
+    {
+        setUp();
+        test_skipTo(TEST_DMA_SIZE - l_u8Tail);
+        test_putBuffer(l_au8Frame, l_u8Length);
+        TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+        TEST_ASSERT_EQUAL_PTR(test_sPort.au8Linear, test_pcu8Last);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(l_au8Frame, test_au8Last, l_u8Length);
+    }
+
+    /* ending exactly on the buffer end needs no copy */
+    setUp();
+    test_skipTo(TEST_DMA_SIZE - l_u8Length);
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_PTR(&test_au8Dma[TEST_DMA_SIZE - l_u8Length], test_pcu8Last);
+}
+
+static void test_uart_error_restarts_the_reception(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint8_t l_u8Length = test_u8Build(l_au8Frame, 0, 8);
+
+    test_putBuffer(l_au8Frame, 5);
+    test_sUart.RxState = HAL_UART_STATE_READY;
+    test_sUart.ErrorCode = HAL_UART_ERROR_ORE;
+    FRAME_u8ReceiveIT(&test_sPort);
+    TEST_ASSERT_EQUAL_UINT32(1, test_sPort.sStats.u32UartError);
+    TEST_ASSERT_EQUAL_UINT32(HAL_UART_STATE_BUSY_RX, test_sUart.RxState);
+
+    /* the DMA starts again from the beginning of the buffer */
+    test_u16Write = 0;
+    test_putBuffer(l_au8Frame, l_u8Length);
+    TEST_ASSERT_EQUAL_UINT8(1, FRAME_u8ReceiveIT(&test_sPort));
+    TEST_ASSERT_EQUAL_PTR(test_au8Dma, test_pcu8Last);
+}
+
+static void test_random_stream(void)
+{
+    uint8_t l_au8Frame[FRAME_MAX_LENGTH];
+    uint32_t l_u32Long = 0;
+    uint32_t l_u32Short = 0;
+    uint32_t l_u32Bad = 0;
+    uint32_t n;
+
+    srand(1);
+    for (n = 0; n < 10000; n++)
+    {
+        int l_iKind = rand() % 10;
+        uint8_t l_u8Length;
+
+        if (l_iKind < 5)
+        {
+            l_u8Length = test_u8Build(l_au8Frame, 1, (uint8_t)n);
+            l_u32Long++;
+        }
+        else if (l_iKind < 8)
+        {
+            l_u8Length = test_u8Build(l_au8Frame, 0, (uint8_t)n);
+            l_u32Short++;
+        }
+        else
+        {
+            l_u8Length = test_u8Build(l_au8Frame, 1, (uint8_t)n);
+            l_au8Frame[rand() % (l_u8Length - 5) + 5] ^= 0x10;
+            l_u32Bad++;
+        }
+        /* the interrupts come at any point of the frame */
+        uint8_t l_u8Split = rand() % l_u8Length;
+        test_putBuffer(l_au8Frame, l_u8Split);
+        FRAME_u8ReceiveIT(&test_sPort);
+        test_putBuffer(&l_au8Frame[l_u8Split], l_u8Length - l_u8Split);
+        FRAME_u8ReceiveIT(&test_sPort);
+    }
+    TEST_ASSERT_EQUAL_UINT32(l_u32Long, test_u32Long);
+    TEST_ASSERT_EQUAL_UINT32(l_u32Short, test_u32Short);
+    TEST_ASSERT_EQUAL_UINT32(l_u32Bad, test_sPort.sStats.u32CrcError);
+}
+
+static void test_benchmark(void)
+{
+    uint8_t l_au8Frame[2][FRAME_MAX_LENGTH];
+    uint8_t l_au8Length[2];
+    char l_acMessage[80];
+    uint32_t n;
+    clock_t l_tStart;
+    double l_dSeconds;
+
+    l_au8Length[0] = test_u8Build(l_au8Frame[0], 1, 9);
+    l_au8Length[1] = test_u8Build(l_au8Frame[1], 0, 9);
+    l_tStart = clock();
+    for (n = 0; n < TEST_BENCH_FRAMES; n++)
+    {
+        test_putBuffer(l_au8Frame[n & 1], l_au8Length[n & 1]);
+        FRAME_u8ReceiveIT(&test_sPort);
+    }
+    l_dSeconds = (double)(clock() - l_tStart) / CLOCKS_PER_SEC;
+    TEST_ASSERT_EQUAL_UINT32(TEST_BENCH_FRAMES, test_u32Long + test_u32Short);
+    snprintf(l_acMessage, sizeof(l_acMessage), "%.1f ns per frame on the host", l_dSeconds * 1e9 / TEST_BENCH_FRAMES);
+    TEST_MESSAGE(l_acMessage);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_valid_frames_point_into_the_dma_buffer);
+    RUN_TEST(test_partial_frames_wait_for_the_next_interrupt);
+    RUN_TEST(test_resync_after_garbage);
+    RUN_TEST(test_a_lost_byte_costs_one_frame);
+    RUN_TEST(test_crc_error);
+    RUN_TEST(test_wrapping_frame_is_copied);
+    RUN_TEST(test_uart_error_restarts_the_reception);
+    RUN_TEST(test_random_stream);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,329 @@
+/****************************************************************************
+* Title                 :   perimeter correlation tests
+* Filename              :   test_perimeter.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_perimeter.c
+ *  \brief host comparison of corrFilter() with the previous dot product
+ *
+ *  The run length kernel must give exactly the correlations and the result
+ *  of the dot product it replaced, for both codes. The reference below is
+ *  the previous corrFilter(), only given the capture and the code as
+ *  parameters. The benchmark times both on the same captures.
+ *  Run with : pio test -d test -f test_perimeter
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+
+#define OPTION_PERIMETER
+#include "perimeter.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_N (PERIMETER_NBPTS / PERIMETER_OVERSAMPLING)
+#define TEST_RANDOM_CAPTURES 10000
+#define TEST_BENCH_CAPTURES 2000
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+/* main.c */
+DMA_HandleTypeDef hdma_adc;
+
+static uint16_t test_au16Capture[PERIMETER_NBPTS] __ALIGNED(4);
+static uint16_t test_au16Reference[PERIMETER_NBPTS] __ALIGNED(4);
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+void debug_printf(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+void Error_Handler(void)
+{
+    TEST_FAIL_MESSAGE("Error_Handler");
+}
+
+/* the previous corrFilter() : full dot product at each lag, the correlations
+   stored after the oversampled samples */
+static double test_dReference(uint16_t *capture, const int32_t *code, int code_length)
+{
+  const int n=PERIMETER_NBPTS/PERIMETER_OVERSAMPLING;
+  {
+    uint16_t *p=capture;
+    for (int i=0; i<n; i++) {
+      uint16_t tmp=*(p++);
+      for (int j=PERIMETER_OVERSAMPLING; --j>0; ) {
+        tmp+=*(p++);
+      }
+      capture[i]=tmp;
+    }
+  }
+  int32_t *correlations=(int32_t*) (capture+n);
+
+  int32_t corr_max_abs=0,corr_max=0;
+  int corr_max_pos;
+
+  for (int i=0; i<=n-code_length; i++) {
+    int32_t sum=0;
+    uint16_t *datap=capture+i;
+    const int32_t *sigcodep=code;
+
+    for (int j=0; j<code_length; j++) sum+=*(datap++)**(sigcodep++);
+    correlations[i]=sum;
+    if (sum<0) {
+      if (-sum>corr_max_abs) {
+        corr_max=sum;
+        corr_max_abs=-sum;
+        corr_max_pos=i;
+      }
+    } else {
+      if (sum>corr_max_abs) {
+        corr_max_abs=corr_max=sum;
+        corr_max_pos=i;
+      }
+    }
+  }
+
+  if (corr_max_abs==0) return 0;
+
+  int64_t sx2=0,sx=0;
+  int sn=0;
+
+  int count=n/5;
+  int p=corr_max_pos-3*code_length/2;
+  while (count>0 && p>=0) {
+    int64_t s=correlations[p];
+    sx+=s;
+    sx2+=s*s;
+    p--;
+    count--;
+    sn++;
+  }
+  count=n/5;
+  p=corr_max_pos+3*code_length/2;
+  while (count>0 && p<n-code_length) {
+    int64_t s=correlations[p];
+    sx+=s;
+    sx2+=s*s;
+    p++;
+    count--;
+    sn++;
+  }
+
+  if (sn<=1) return 0;
+  double noiseDeviation=sqrt((sx2-sx*sx/(double) sn)/(sn-1));
+  if (noiseDeviation<1) return corr_max;
+  return corr_max/noiseDeviation;
+}
+
+/* both filters on copies of the capture : same result, same correlations */
+static void test_compare(const uint16_t *pcu16Capture)
+{
+    double l_dKernel;
+    double l_dReference;
+
+    memcpy(test_au16Capture, pcu16Capture, sizeof(test_au16Capture));
+    memcpy(test_au16Reference, pcu16Capture, sizeof(test_au16Reference));
+    l_dKernel = corrFilter(test_au16Capture);
+    l_dReference = test_dReference(test_au16Reference, sigcode, sigcode_length);
+
+    TEST_ASSERT_TRUE(memcmp(&l_dKernel, &l_dReference, sizeof(double)) == 0);
+    TEST_ASSERT_TRUE(memcmp(test_au16Capture, &test_au16Reference[TEST_N], (TEST_N - sigcode_length + 1) * sizeof(int32_t)) == 0);
+}
+
+/* the code sent at u16Lag, each chip PERIMETER_OVERSAMPLING samples, over noise */
+static void test_signal(uint16_t *pu16Capture, uint16_t u16Lag, int32_t s32Gain, int32_t s32Noise)
+{
+    int i;
+
+    for (i = 0; i < PERIMETER_NBPTS; i++)
+    {
+        int l_iChip = i / PERIMETER_OVERSAMPLING - u16Lag;
+        int32_t l_s32Value = 2048 + (s32Noise ? rand() % (2 * s32Noise + 1) - s32Noise : 0);
+
+        if (l_iChip >= 0 && l_iChip < sigcode_length)
+        {
+            l_s32Value += s32Gain * sigcode[l_iChip];
+        }
+        pu16Capture[i] = l_s32Value < 0 ? 0 : l_s32Value > 4095 ? 4095 : l_s32Value;
+    }
+}
+
+static void test_codes(void (*pfCase)(void))
+{
+    Perimeter_ListenOn(1);
+    pfCase();
+    Perimeter_ListenOn(2);
+    pfCase();
+    Perimeter_ListenOn(0);
+}
+
+void setUp(void)
+{
+    srand(1);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_kernel_has_one_tap_per_step(void)
+{
+    Perimeter_ListenOn(1);
+    TEST_ASSERT_EQUAL_INT(13, kernel_taps);
+    Perimeter_ListenOn(2);
+    TEST_ASSERT_EQUAL_INT(18, kernel_taps);
+    Perimeter_ListenOn(0);
+}
+
+static void test_flat_and_saturated_case(void)
+{
+    static const uint16_t l_pcu16Levels[] = {0, 1, 2048, 4095};
+    uint16_t l_au16Capture[PERIMETER_NBPTS];
+    unsigned l;
+    int i;
+
+    for (l = 0; l < sizeof(l_pcu16Levels) / sizeof(l_pcu16Levels[0]); l++)
+    {
+        for (i = 0; i < PERIMETER_NBPTS; i++)
+        {
+            l_au16Capture[i] = l_pcu16Levels[l];
+        }
+        test_compare(l_au16Capture);
+    }
+    /* full scale square waves */
+    for (i = 0; i < PERIMETER_NBPTS; i++)
+    {
+        l_au16Capture[i] = (i / 7) & 1 ? 4095 : 0;
+    }
+    test_compare(l_au16Capture);
+}
+
+static void test_flat_and_saturated(void)
+{
+    test_codes(test_flat_and_saturated_case);
+}
+
+static void test_random_case(void)
+{
+    uint16_t l_au16Capture[PERIMETER_NBPTS];
+    int n;
+    int i;
+
+    for (n = 0; n < TEST_RANDOM_CAPTURES; n++)
+    {
+        for (i = 0; i < PERIMETER_NBPTS; i++)
+        {
+            l_au16Capture[i] = rand() & 0xFFF;
+        }
+        test_compare(l_au16Capture);
+    }
+}
+
+static void test_random(void)
+{
+    test_codes(test_random_case);
+}
+
+static void test_code_shaped_case(void)
+{
+    uint16_t l_au16Capture[PERIMETER_NBPTS];
+    int n;
+
+    for (n = 0; n < TEST_RANDOM_CAPTURES; n++)
+    {
+        /* any lag, inverted or not, from a clean signal to saturation */
+        int32_t l_s32Gain = (rand() % 1200) - 600;
+        test_signal(l_au16Capture, rand() % TEST_N, l_s32Gain, rand() % 800);
+        test_compare(l_au16Capture);
+    }
+}
+
+static void test_code_shaped(void)
+{
+    test_codes(test_code_shaped_case);
+}
+
+static void test_detects_the_signal_case(void)
+{
+    uint16_t l_au16Capture[PERIMETER_NBPTS];
+
+    test_signal(l_au16Capture, 100, 300, 100);
+    memcpy(test_au16Capture, l_au16Capture, sizeof(test_au16Capture));
+    TEST_ASSERT_GREATER_THAN_FLOAT(10.0, corrFilter(test_au16Capture));
+
+    test_signal(l_au16Capture, 100, -300, 100);
+    memcpy(test_au16Capture, l_au16Capture, sizeof(test_au16Capture));
+    TEST_ASSERT_LESS_THAN_FLOAT(-10.0, corrFilter(test_au16Capture));
+}
+
+static void test_detects_the_signal(void)
+{
+    test_codes(test_detects_the_signal_case);
+}
+
+static void test_benchmark_case(void)
+{
+    static uint16_t l_au16Captures[8][PERIMETER_NBPTS];
+    char l_acMessage[96];
+    clock_t l_tStart;
+    double l_dKernel;
+    double l_dReference;
+    int n;
+
+    for (n = 0; n < 8; n++)
+    {
+        test_signal(l_au16Captures[n], rand() % TEST_N, 300, 200);
+    }
+    l_tStart = clock();
+    for (n = 0; n < TEST_BENCH_CAPTURES; n++)
+    {
+        memcpy(test_au16Reference, l_au16Captures[n & 7], sizeof(test_au16Reference));
+        test_dReference(test_au16Reference, sigcode, sigcode_length);
+    }
+    l_dReference = (double)(clock() - l_tStart) / CLOCKS_PER_SEC;
+    l_tStart = clock();
+    for (n = 0; n < TEST_BENCH_CAPTURES; n++)
+    {
+        memcpy(test_au16Capture, l_au16Captures[n & 7], sizeof(test_au16Capture));
+        corrFilter(test_au16Capture);
+    }
+    l_dKernel = (double)(clock() - l_tStart) / CLOCKS_PER_SEC;
+    snprintf(l_acMessage, sizeof(l_acMessage), "code of %d : dot product %.1f us, kernel %.1f us per capture on the host",
+             sigcode_length, l_dReference * 1e6 / TEST_BENCH_CAPTURES, l_dKernel * 1e6 / TEST_BENCH_CAPTURES);
+    TEST_MESSAGE(l_acMessage);
+}
+
+static void test_benchmark(void)
+{
+    test_codes(test_benchmark_case);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_kernel_has_one_tap_per_step);
+    RUN_TEST(test_flat_and_saturated);
+    RUN_TEST(test_random);
+    RUN_TEST(test_code_shaped);
+    RUN_TEST(test_detects_the_signal);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,269 @@
+/****************************************************************************
+* Title                 :   ramp tests
+* Filename              :   test_ramp.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_ramp.c
+ *  \brief host check of the wheel speed ramp against cmd_vel sequences
+ *
+ *  The sequences below are cmd_vel messages as the host sends them (time,
+ *  linear x, angular z) : teleop at 10 Hz, a path follower with small
+ *  corrections at 5 Hz, a stop and a reversal, and commands at 2 Hz. They
+ *  go through the conversion of CommandVelocityMessageCb() (wheel speeds
+ *  capped to MAX_MPS, PWM steps) and the ramp of each wheel runs at
+ *  DRIVEMOTOR_POLL_HZ with the poll jitter, as drivemotor_ramp() does. The
+ *  speed sent to the motors must keep its acceleration and jerk within the
+ *  limits and settle on every target.
+ *  Run with : pio test -d test -f test_ramp
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "drivemotor.h"
+#include "ramp.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_POLL_S (1.0f / DRIVEMOTOR_POLL_HZ)
+/* poll period jitter, +/- */
+#define TEST_JITTER_S 0.002f
+/* float rounding on the limits */
+#define TEST_EPSILON 1e-4f
+/* time to full speed from rest : v / a + a / j, plus one poll */
+#define TEST_RISE_S (MAX_MPS / DRIVEMOTOR_ACC_MAX + DRIVEMOTOR_ACC_MAX / DRIVEMOTOR_JERK_MAX + TEST_POLL_S)
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+/* one cmd_vel message */
+typedef struct
+{
+    uint32_t u32Ms;
+    float fVx;      /* m/s */
+    float fVz;      /* rad/s */
+} TEST_CmdVel_t;
+
+typedef struct
+{
+    float fMaxAcc;
+    float fMaxJerk;
+    float fMaxStepAcc;      /* of the targets themselves, what the motors got before */
+    float fMaxError;        /* at the end of each command held long enough */
+} TEST_Result_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+/* teleop : full speed, turn on the spot, stop, back up */
+static const TEST_CmdVel_t test_casTeleop[] = {
+    {0, 0.0f, 0.0f},     {100, 0.3f, 0.0f},   {2000, 0.3f, 0.5f},  {3000, 0.0f, 1.5f},
+    {4500, 0.0f, 0.0f},  {5500, -0.2f, 0.0f}, {7000, 0.3f, 0.0f},  {8500, 0.0f, 0.0f},
+    {10000, 0.0f, 0.0f},
+};
+
+/* path follower : cruise with small heading corrections every 200ms */
+static const TEST_CmdVel_t test_casFollower[] = {
+    {0, 0.25f, 0.0f},     {200, 0.25f, 0.12f},  {400, 0.25f, 0.2f},   {600, 0.25f, 0.1f},
+    {800, 0.25f, -0.05f}, {1000, 0.25f, -0.2f}, {1200, 0.25f, -0.1f}, {1400, 0.25f, 0.0f},
+    {1600, 0.25f, 0.3f},  {1800, 0.25f, 0.6f},  {2000, 0.2f, 0.8f},   {2200, 0.15f, 0.4f},
+    {2400, 0.25f, 0.0f},  {2600, 0.25f, 0.0f},  {4600, 0.0f, 0.0f},   {7000, 0.0f, 0.0f},
+};
+
+/* slow host : 2 Hz, the ramp interpolates between the setpoints */
+static const TEST_CmdVel_t test_casSlow[] = {
+    {0, 0.0f, 0.0f},    {500, 0.1f, 0.0f},  {1000, 0.2f, 0.0f}, {1500, 0.3f, 0.2f},
+    {2000, 0.3f, 0.0f}, {2500, 0.1f, 0.0f}, {3000, -0.1f, 0.0f}, {3500, 0.0f, 0.0f},
+    {6000, 0.0f, 0.0f},
+};
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+/* wheel speed requested by CommandVelocityMessageCb(), in PWM steps */
+static float test_fTarget(float fVx, float fVz, int iWheel)
+{
+    float l_fTwist = (iWheel == DRIVEMOTOR_LEFT ? -1.0f : 1.0f) * fVz * WHEEL_BASE * 0.5f;
+    float l_fMps = fVx + l_fTwist;
+    uint8_t l_u8Pwm;
+
+    if (l_fMps > MAX_MPS)
+    {
+        l_fMps = MAX_MPS;
+    }
+    else if (l_fMps < -MAX_MPS)
+    {
+        l_fMps = -MAX_MPS;
+    }
+    l_u8Pwm = abs((int)(l_fMps * PWM_PER_MPS));
+    return (l_fMps >= 0 ? 1.0f : -1.0f) * l_u8Pwm / PWM_PER_MPS;
+}
+
+/* run a sequence on both wheels, the limits seen on the output */
+static void test_run(const TEST_CmdVel_t *pcsCmd, uint16_t u16Cmds, TEST_Result_t *psResult)
+{
+    RAMP_State_t l_asRamp[2];
+    float l_afAcc[2] = {0.0f, 0.0f};
+    float l_afTarget[2] = {0.0f, 0.0f};
+    float l_fT = 0.0f;
+    uint16_t l_u16Cmd = 0;
+    int w;
+
+    memset(psResult, 0, sizeof(TEST_Result_t));
+    RAMP_Reset(&l_asRamp[0], 0.0f);
+    RAMP_Reset(&l_asRamp[1], 0.0f);
+    while (l_u16Cmd < u16Cmds)
+    {
+        float l_fDt = TEST_POLL_S + TEST_JITTER_S * (2.0f * rand() / RAND_MAX - 1.0f);
+
+        l_fT += l_fDt;
+        /* a command held until the next one : its target must be reached */
+        if (l_u16Cmd + 1 < u16Cmds && l_fT * 1000.0f >= pcsCmd[l_u16Cmd + 1].u32Ms)
+        {
+            if ((pcsCmd[l_u16Cmd + 1].u32Ms - pcsCmd[l_u16Cmd].u32Ms) / 1000.0f > TEST_RISE_S * 2)
+            {
+                for (w = 0; w < 2; w++)
+                {
+                    float l_fError = fabsf(l_asRamp[w].fVel - l_afTarget[w]);
+                    psResult->fMaxError = fmaxf(psResult->fMaxError, l_fError);
+                }
+            }
+            l_u16Cmd++;
+        }
+        else if (l_u16Cmd + 1 == u16Cmds)
+        {
+            /* the last one is only there to end the sequence */
+            break;
+        }
+        for (w = 0; w < 2; w++)
+        {
+            float l_fTarget = test_fTarget(pcsCmd[l_u16Cmd].fVx, pcsCmd[l_u16Cmd].fVz, w);
+            float l_fPrevious = l_asRamp[w].fVel;
+            float l_fAcc;
+
+            psResult->fMaxStepAcc = fmaxf(psResult->fMaxStepAcc, fabsf(l_fTarget - l_afTarget[w]) / l_fDt);
+            l_afTarget[w] = l_fTarget;
+            RAMP_fUpdate(&l_asRamp[w], l_fTarget, DRIVEMOTOR_ACC_MAX, DRIVEMOTOR_JERK_MAX, l_fDt);
+            l_fAcc = (l_asRamp[w].fVel - l_fPrevious) / l_fDt;
+            psResult->fMaxAcc = fmaxf(psResult->fMaxAcc, fabsf(l_fAcc));
+            psResult->fMaxJerk = fmaxf(psResult->fMaxJerk, fabsf(l_fAcc - l_afAcc[w]) / l_fDt);
+            l_afAcc[w] = l_fAcc;
+        }
+    }
+}
+
+static void test_check(const TEST_Result_t *pcsResult, const char *pcName)
+{
+    char l_acMessage[128];
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "%s : acc %.2f m/s^2 (steps %.1f), jerk %.2f m/s^3, error %.4f m/s",
+             pcName, pcsResult->fMaxAcc, pcsResult->fMaxStepAcc, pcsResult->fMaxJerk, pcsResult->fMaxError);
+    TEST_MESSAGE(l_acMessage);
+    TEST_ASSERT_LESS_THAN_FLOAT(DRIVEMOTOR_ACC_MAX + TEST_EPSILON, pcsResult->fMaxAcc);
+    TEST_ASSERT_LESS_THAN_FLOAT(DRIVEMOTOR_JERK_MAX + TEST_EPSILON / TEST_POLL_S, pcsResult->fMaxJerk);
+    TEST_ASSERT_LESS_THAN_FLOAT(TEST_EPSILON, pcsResult->fMaxError);
+}
+
+void setUp(void)
+{
+    srand(1);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_teleop(void)
+{
+    TEST_Result_t l_sResult;
+
+    test_run(test_casTeleop, sizeof(test_casTeleop) / sizeof(TEST_CmdVel_t), &l_sResult);
+    test_check(&l_sResult, "teleop 10 Hz");
+}
+
+static void test_path_follower(void)
+{
+    TEST_Result_t l_sResult;
+
+    test_run(test_casFollower, sizeof(test_casFollower) / sizeof(TEST_CmdVel_t), &l_sResult);
+    test_check(&l_sResult, "follower 5 Hz");
+}
+
+static void test_slow_host(void)
+{
+    TEST_Result_t l_sResult;
+
+    test_run(test_casSlow, sizeof(test_casSlow) / sizeof(TEST_CmdVel_t), &l_sResult);
+    test_check(&l_sResult, "host 2 Hz");
+}
+
+/* from rest to full speed and back : no overshoot, in the minimum time */
+static void test_full_speed_step(void)
+{
+    RAMP_State_t l_sRamp;
+    float l_fT = 0.0f;
+    float l_fPeak = 0.0f;
+
+    RAMP_Reset(&l_sRamp, 0.0f);
+    while (l_sRamp.fVel < MAX_MPS && l_fT < 5.0f)
+    {
+        RAMP_fUpdate(&l_sRamp, MAX_MPS, DRIVEMOTOR_ACC_MAX, DRIVEMOTOR_JERK_MAX, TEST_POLL_S);
+        l_fPeak = fmaxf(l_fPeak, l_sRamp.fVel);
+        l_fT += TEST_POLL_S;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, MAX_MPS, l_sRamp.fVel);
+    TEST_ASSERT_LESS_THAN_FLOAT(TEST_RISE_S + TEST_POLL_S, l_fT);
+    TEST_ASSERT_LESS_THAN_FLOAT(MAX_MPS + TEST_EPSILON, l_fPeak);
+
+    while (l_sRamp.fVel > 0.0f && l_fT < 10.0f)
+    {
+        RAMP_fUpdate(&l_sRamp, 0.0f, DRIVEMOTOR_ACC_MAX, DRIVEMOTOR_JERK_MAX, TEST_POLL_S);
+        TEST_ASSERT_TRUE(l_sRamp.fVel >= 0.0f);
+        l_fT += TEST_POLL_S;
+    }
+    TEST_ASSERT_TRUE(l_sRamp.fVel == 0.0f);
+}
+
+/* a setpoint every 500ms still moves the wheels a little at every poll */
+static void test_interpolates_between_setpoints(void)
+{
+    RAMP_State_t l_sRamp;
+    float l_fPrevious = 0.0f;
+    int n;
+
+    RAMP_Reset(&l_sRamp, 0.0f);
+    for (n = 0; n < (int)(0.5f / TEST_POLL_S); n++)
+    {
+        RAMP_fUpdate(&l_sRamp, 0.1f, DRIVEMOTOR_ACC_MAX, DRIVEMOTOR_JERK_MAX, TEST_POLL_S);
+        if (l_sRamp.fVel < 0.1f)
+        {
+            TEST_ASSERT_TRUE(l_sRamp.fVel > l_fPrevious);
+        }
+        l_fPrevious = l_sRamp.fVel;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(TEST_EPSILON, 0.1f, l_sRamp.fVel);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_teleop);
+    RUN_TEST(test_path_follower);
+    RUN_TEST(test_slow_host);
+    RUN_TEST(test_full_speed_step);
+    RUN_TEST(test_interpolates_between_setpoints);
+    return UNITY_END();
+}
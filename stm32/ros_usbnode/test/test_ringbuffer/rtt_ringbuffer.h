@@ -0,0 +1,189 @@
+/*
+ * File      : ringbuffer.c
+ * This file is part of RT-Thread RTOS
+ * COPYRIGHT (C) 2012, RT-Thread Development Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2012-09-30     Bernard      first version.
+ * 2013-05-08     Grissiom     reimplement
+ */
+
+/*
+ * The mirror ring ros_custom/ringbuffer.cpp was before the lock free one,
+ * renamed rtt_*, only kept as the reference of test_ringbuffer.
+ */
+#ifndef RTT_RINGBUFFER_H_
+#define RTT_RINGBUFFER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+struct rtt_ringbuffer {
+	uint8_t *buffer_ptr;
+	/* msb of the {read,write}_index as mirror bit, see the RT-Thread sources */
+	uint16_t read_mirror :1;
+	uint16_t read_index :15;
+	uint16_t write_mirror :1;
+	uint16_t write_index :15;
+	int16_t buffer_size;
+};
+
+static inline enum ringbuffer_state rtt_ringbuffer_status(struct rtt_ringbuffer *rb)
+{
+	if (rb->read_index == rb->write_index) {
+		if (rb->read_mirror == rb->write_mirror)
+			return RT_RINGBUFFER_EMPTY;
+		else
+			return RT_RINGBUFFER_FULL;
+	}
+	return RT_RINGBUFFER_HALFFULL;
+}
+
+static inline uint16_t rtt_ringbuffer_data_len(struct rtt_ringbuffer *rb)
+{
+	switch (rtt_ringbuffer_status(rb)) {
+	case RT_RINGBUFFER_EMPTY:
+		return 0;
+	case RT_RINGBUFFER_FULL:
+		return rb->buffer_size;
+	case RT_RINGBUFFER_HALFFULL:
+	default:
+		if (rb->write_index > rb->read_index)
+			return rb->write_index - rb->read_index;
+		else
+			return rb->buffer_size - (rb->read_index - rb->write_index);
+	};
+}
+
+static inline uint32_t rtt_ringbuffer_put(struct rtt_ringbuffer *rb, const uint8_t *ptr, uint16_t length)
+{
+    uint16_t size;
+
+    size = rb->buffer_size - rtt_ringbuffer_data_len(rb);
+    if (size == 0)
+        return 0;
+    if (size < length)
+        length = size;
+
+    if (rb->buffer_size - rb->write_index > length)
+    {
+        memcpy(&rb->buffer_ptr[rb->write_index], ptr, length);
+        rb->write_index += length;
+        return length;
+    }
+
+    memcpy(&rb->buffer_ptr[rb->write_index],
+           &ptr[0],
+           rb->buffer_size - rb->write_index);
+    memcpy(&rb->buffer_ptr[0],
+           &ptr[rb->buffer_size - rb->write_index],
+           length - (rb->buffer_size - rb->write_index));
+
+    rb->write_mirror = ~rb->write_mirror;
+    rb->write_index = length - (rb->buffer_size - rb->write_index);
+
+    return length;
+}
+
+static inline uint32_t rtt_ringbuffer_get(struct rtt_ringbuffer *rb, uint8_t *ptr, uint16_t length)
+{
+    uint32_t size;
+
+    size = rtt_ringbuffer_data_len(rb);
+    if (size == 0)
+        return 0;
+    if (size < length)
+        length = size;
+
+    if (rb->buffer_size - rb->read_index > length)
+    {
+        memcpy(ptr, &rb->buffer_ptr[rb->read_index], length);
+        rb->read_index += length;
+        return length;
+    }
+
+    memcpy(&ptr[0],
+           &rb->buffer_ptr[rb->read_index],
+           rb->buffer_size - rb->read_index);
+    memcpy(&ptr[rb->buffer_size - rb->read_index],
+           &rb->buffer_ptr[0],
+           length - (rb->buffer_size - rb->read_index));
+
+    rb->read_mirror = ~rb->read_mirror;
+    rb->read_index = length - (rb->buffer_size - rb->read_index);
+
+    return length;
+}
+
+static inline uint32_t rtt_ringbuffer_getchar(struct rtt_ringbuffer *rb, uint8_t *ch)
+{
+    if (!rtt_ringbuffer_data_len(rb))
+        return 0;
+
+    *ch = rb->buffer_ptr[rb->read_index];
+
+    if (rb->read_index == rb->buffer_size-1)
+    {
+        rb->read_mirror = ~rb->read_mirror;
+        rb->read_index = 0;
+    }
+    else
+    {
+        rb->read_index++;
+    }
+
+    return 1;
+}
+
+static inline uint16_t rtt_ringbuffer_peek(struct rtt_ringbuffer *rb, uint8_t **ptr)
+{
+    uint16_t size;
+
+    size = rtt_ringbuffer_data_len(rb);
+    *ptr = &rb->buffer_ptr[rb->read_index];
+
+    if (size > rb->buffer_size - rb->read_index)
+        size = rb->buffer_size - rb->read_index;
+
+    return size;
+}
+
+static inline void rtt_ringbuffer_consume(struct rtt_ringbuffer *rb, uint16_t length)
+{
+    if (length > rtt_ringbuffer_data_len(rb))
+        length = rtt_ringbuffer_data_len(rb);
+
+    if (rb->buffer_size - rb->read_index > length)
+    {
+        rb->read_index += length;
+        return;
+    }
+
+    rb->read_mirror = ~rb->read_mirror;
+    rb->read_index = length - (rb->buffer_size - rb->read_index);
+}
+
+static inline void rtt_ringbuffer_init(struct rtt_ringbuffer *rb, uint8_t *pool, int16_t size)
+{
+    rb->read_mirror = rb->read_index = 0;
+    rb->write_mirror = rb->write_index = 0;
+    rb->buffer_ptr = pool;
+    rb->buffer_size = size;
+}
+
+#endif /* RTT_RINGBUFFER_H_ */
@@ -0,0 +1,378 @@
+/****************************************************************************
+* Title                 :   ring buffer tests
+* Filename              :   test_ringbuffer.cpp
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_ringbuffer.cpp
+ *  \brief host tests of the USB receive ring, stress and benchmark
+ *
+ *  The stress test runs the producer (the USB interrupt, 1 to 64 byte
+ *  packets) and the consumer (the main loop, by byte, by block and in place)
+ *  on two threads and checks every byte and the count of dropped ones. The
+ *  fences of ringbuffer.cpp only order the compiler, as on the single core
+ *  target : the two threads need a host which keeps the order of the stores
+ *  (x86), it is skipped elsewhere.
+ *  The benchmark fills the ring with bursts of USB packets and drains it as
+ *  spinOnce() did (by byte) and does (in place), against the RT-Thread mirror
+ *  ring it replaced (rtt_ringbuffer.h). The cycles are those of the host
+ *  (TSC), only the ratio carries over to the F103.
+ *  Run with : pio test -d test -f test_ringbuffer
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <unity.h>
+
+#include "ros/ros_custom/ringbuffer.cpp"
+#include "rtt_ringbuffer.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_USB_PACKET 64
+/* USB packets per burst, at most */
+#define TEST_BURST_PACKETS 8
+/* bytes through the ring in the stress test */
+#define TEST_STRESS_BYTES (8U * 1024U * 1024U)
+/* packets through the ring in the benchmark */
+#define TEST_BENCH_PACKETS 200000U
+/* runs of the benchmark, the fastest is kept */
+#define TEST_RUNS 5
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+typedef enum
+{
+    TEST_BY_BYTE,           /* getchar */
+    TEST_BY_BLOCK,          /* get */
+    TEST_IN_PLACE           /* peek and consume */
+} TEST_Read_e;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static uint8_t test_au8Pool[RxBufferSize];
+static struct ringbuffer test_sRing;
+static struct rtt_ringbuffer test_sRtt;
+static uint8_t test_au8Packets[TEST_BURST_PACKETS * TEST_USB_PACKET];
+/* sum of the bytes read, so that the reads are not optimised out */
+static volatile uint32_t test_u32Sink;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+static uint64_t test_u64Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec l_sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+    return (uint64_t)l_sNow.tv_sec * 1000000000U + l_sNow.tv_nsec;
+#endif
+}
+
+/* byte n of the stream, not periodic with the pool size */
+static uint8_t test_u8Byte(uint32_t n)
+{
+    return (uint8_t)(n * 131U + (n >> 11));
+}
+
+/* the USB interrupt : packets of 1 to 64 bytes, only what was accepted is sent */
+static void test_producer(uint32_t *pu32Attempted)
+{
+    uint8_t l_au8Packet[TEST_USB_PACKET];
+    uint32_t l_u32Sent = 0;
+    uint32_t l_u32Seed = 1;
+
+    *pu32Attempted = 0;
+    while (l_u32Sent < TEST_STRESS_BYTES)
+    {
+        uint32_t l_u32Len;
+        uint32_t i;
+
+        l_u32Seed = l_u32Seed * 1103515245U + 12345U;
+        l_u32Len = 1 + (l_u32Seed >> 16) % TEST_USB_PACKET;
+        if (l_u32Len > TEST_STRESS_BYTES - l_u32Sent)
+        {
+            l_u32Len = TEST_STRESS_BYTES - l_u32Sent;
+        }
+        for (i = 0; i < l_u32Len; i++)
+        {
+            l_au8Packet[i] = test_u8Byte(l_u32Sent + i);
+        }
+        *pu32Attempted += l_u32Len;
+        l_u32Len = ringbuffer_put(&test_sRing, l_au8Packet, l_u32Len);
+        l_u32Sent += l_u32Len;
+        /* full, leave the core to the consumer when the host has only one */
+        if (l_u32Len == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/* the main loop, the three ways of reading in turn, the first wrong byte returned */
+static uint32_t test_u32Consumer(void)
+{
+    uint8_t l_au8Block[300];
+    uint32_t l_u32Received = 0;
+    uint32_t l_u32Turn = 0;
+
+    while (l_u32Received < TEST_STRESS_BYTES)
+    {
+        TEST_Read_e l_eRead = (TEST_Read_e)(l_u32Turn++ % 3);
+        uint8_t *l_pu8Data = l_au8Block;
+        uint32_t l_u32Len = 0;
+        uint32_t i;
+
+        if (l_eRead == TEST_BY_BYTE)
+        {
+            while (l_u32Len < 100 && ringbuffer_getchar(&test_sRing, &l_au8Block[l_u32Len]) == 1)
+            {
+                l_u32Len++;
+            }
+        }
+        else if (l_eRead == TEST_BY_BLOCK)
+        {
+            l_u32Len = ringbuffer_get(&test_sRing, l_au8Block, sizeof(l_au8Block));
+        }
+        else
+        {
+            l_u32Len = ringbuffer_peek_contiguous(&test_sRing, &l_pu8Data);
+        }
+        for (i = 0; i < l_u32Len; i++)
+        {
+            if (l_pu8Data[i] != test_u8Byte(l_u32Received + i))
+            {
+                return l_u32Received + i;
+            }
+        }
+        if (l_eRead == TEST_IN_PLACE)
+        {
+            ringbuffer_consume(&test_sRing, l_u32Len);
+        }
+        l_u32Received += l_u32Len;
+        if (l_u32Len == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    return UINT32_MAX;
+}
+
+/* packets in bursts, each burst drained before the next one, cycles of the reads */
+static uint64_t test_u64Bench(bool bRtt, TEST_Read_e eRead)
+{
+    uint64_t l_u64Cycles = 0;
+    uint32_t l_u32Packets = 0;
+    uint32_t l_u32Sum = 0;
+
+    ringbuffer_init(&test_sRing, test_au8Pool, sizeof(test_au8Pool));
+    rtt_ringbuffer_init(&test_sRtt, test_au8Pool, sizeof(test_au8Pool));
+    srand(1);
+    while (l_u32Packets < TEST_BENCH_PACKETS)
+    {
+        uint32_t l_u32Burst = 1 + rand() % TEST_BURST_PACKETS;
+        uint64_t l_u64Start;
+        uint32_t k;
+
+        for (k = 0; k < l_u32Burst; k++)
+        {
+            if (bRtt)
+            {
+                rtt_ringbuffer_put(&test_sRtt, &test_au8Packets[k * TEST_USB_PACKET], TEST_USB_PACKET);
+            }
+            else
+            {
+                ringbuffer_put(&test_sRing, &test_au8Packets[k * TEST_USB_PACKET], TEST_USB_PACKET);
+            }
+        }
+        l_u32Packets += l_u32Burst;
+
+        l_u64Start = test_u64Cycles();
+        if (eRead == TEST_BY_BYTE)
+        {
+            uint8_t l_u8Ch;
+
+            if (bRtt)
+            {
+                while (rtt_ringbuffer_getchar(&test_sRtt, &l_u8Ch) == 1)
+                {
+                    l_u32Sum += l_u8Ch;
+                }
+            }
+            else
+            {
+                while (ringbuffer_getchar(&test_sRing, &l_u8Ch) == 1)
+                {
+                    l_u32Sum += l_u8Ch;
+                }
+            }
+        }
+        else
+        {
+            uint8_t *l_pu8Data;
+            uint32_t l_u32Len;
+
+            while ((l_u32Len = bRtt ? rtt_ringbuffer_peek(&test_sRtt, &l_pu8Data) : ringbuffer_peek_contiguous(&test_sRing, &l_pu8Data)) > 0)
+            {
+                /* spinOnce() looks for the sync byte first */
+                l_u32Sum += (uint32_t)(uintptr_t)memchr(l_pu8Data, 0xff, l_u32Len);
+                if (bRtt)
+                {
+                    rtt_ringbuffer_consume(&test_sRtt, l_u32Len);
+                }
+                else
+                {
+                    ringbuffer_consume(&test_sRing, l_u32Len);
+                }
+            }
+        }
+        l_u64Cycles += test_u64Cycles() - l_u64Start;
+    }
+    test_u32Sink += l_u32Sum;
+    return l_u64Cycles;
+}
+
+static uint64_t test_u64Best(bool bRtt, TEST_Read_e eRead)
+{
+    uint64_t l_u64Best = UINT64_MAX;
+    int i;
+
+    for (i = 0; i < TEST_RUNS; i++)
+    {
+        uint64_t l_u64Cycles = test_u64Bench(bRtt, eRead);
+
+        if (l_u64Cycles < l_u64Best)
+        {
+            l_u64Best = l_u64Cycles;
+        }
+    }
+    return l_u64Best;
+}
+
+void setUp(void)
+{
+    ringbuffer_init(&test_sRing, test_au8Pool, sizeof(test_au8Pool));
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_wrap_and_full(void)
+{
+    uint8_t l_au8Data[RxBufferSize + 10];
+    uint8_t *l_pu8Data;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(l_au8Data); i++)
+    {
+        l_au8Data[i] = test_u8Byte(i);
+    }
+    /* the whole pool is used, the rest is dropped and counted */
+    TEST_ASSERT_EQUAL_UINT32(RxBufferSize, ringbuffer_put(&test_sRing, l_au8Data, sizeof(l_au8Data)));
+    TEST_ASSERT_EQUAL_UINT32(10, test_sRing.dropped);
+    TEST_ASSERT_EQUAL_INT(RT_RINGBUFFER_FULL, ringbuffer_status(&test_sRing));
+    TEST_ASSERT_EQUAL_UINT32(0, ringbuffer_putchar(&test_sRing, 0));
+    TEST_ASSERT_EQUAL_UINT32(11, test_sRing.dropped);
+
+    /* in place up to the end of the pool, the rest after the consume */
+    ringbuffer_consume(&test_sRing, RxBufferSize - 100);
+    TEST_ASSERT_EQUAL_UINT32(200, ringbuffer_put(&test_sRing, l_au8Data, 200));
+    TEST_ASSERT_EQUAL_UINT32(100, ringbuffer_peek_contiguous(&test_sRing, &l_pu8Data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&l_au8Data[RxBufferSize - 100], l_pu8Data, 100);
+    ringbuffer_consume(&test_sRing, 100);
+    TEST_ASSERT_EQUAL_UINT32(200, ringbuffer_peek_contiguous(&test_sRing, &l_pu8Data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(l_au8Data, l_pu8Data, 200);
+    TEST_ASSERT_TRUE(l_pu8Data == test_au8Pool);
+
+    /* more than there is is only what there is */
+    ringbuffer_consume(&test_sRing, 1000);
+    TEST_ASSERT_EQUAL_INT(RT_RINGBUFFER_EMPTY, ringbuffer_status(&test_sRing));
+    TEST_ASSERT_EQUAL_UINT32(0, ringbuffer_peek_contiguous(&test_sRing, &l_pu8Data));
+
+    /* the indices run freely over 2^32 */
+    test_sRing.head = test_sRing.tail = UINT32_MAX - 20;
+    TEST_ASSERT_EQUAL_UINT32(50, ringbuffer_put(&test_sRing, l_au8Data, 50));
+    TEST_ASSERT_EQUAL_UINT32(50, ringbuffer_data_len(&test_sRing));
+    memset(l_au8Data + RxBufferSize, 0, 10);
+    TEST_ASSERT_EQUAL_UINT32(50, ringbuffer_get(&test_sRing, l_au8Data + RxBufferSize - 50, 60));
+    TEST_ASSERT_EQUAL_UINT8(test_u8Byte(0), l_au8Data[RxBufferSize - 50]);
+
+    /* the size is rounded down to a power of two */
+    ringbuffer_init(&test_sRing, test_au8Pool, 1000);
+    TEST_ASSERT_EQUAL_UINT32(512, ringbuffer_get_size(&test_sRing));
+}
+
+static void test_two_threads(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t l_u32Attempted;
+    uint32_t l_u32Wrong;
+
+    std::thread l_cProducer(test_producer, &l_u32Attempted);
+    l_u32Wrong = test_u32Consumer();
+    l_cProducer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, l_u32Wrong);
+    TEST_ASSERT_EQUAL_UINT32(l_u32Attempted - TEST_STRESS_BYTES, test_sRing.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, ringbuffer_data_len(&test_sRing));
+#else
+    TEST_IGNORE_MESSAGE("the stores of the host may be reordered");
+#endif
+}
+
+static void test_benchmark(void)
+{
+    uint64_t l_u64Rtt;
+    uint64_t l_u64Ring;
+    uint64_t l_u64RttPeek;
+    uint64_t l_u64RingPeek;
+    char l_acMessage[160];
+    uint32_t i;
+
+    for (i = 0; i < sizeof(test_au8Packets); i++)
+    {
+        test_au8Packets[i] = test_u8Byte(i);
+    }
+    l_u64Rtt = test_u64Best(true, TEST_BY_BYTE);
+    l_u64Ring = test_u64Best(false, TEST_BY_BYTE);
+    l_u64RttPeek = test_u64Best(true, TEST_IN_PLACE);
+    l_u64RingPeek = test_u64Best(false, TEST_IN_PLACE);
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "per 64 byte packet, by byte : mirror ring %.0f cycles, lock free %.0f ; in place : %.0f, %.0f",
+             (double)l_u64Rtt / TEST_BENCH_PACKETS, (double)l_u64Ring / TEST_BENCH_PACKETS,
+             (double)l_u64RttPeek / TEST_BENCH_PACKETS, (double)l_u64RingPeek / TEST_BENCH_PACKETS);
+    TEST_MESSAGE(l_acMessage);
+
+    TEST_ASSERT_TRUE(l_u64Ring < l_u64Rtt);
+    TEST_ASSERT_TRUE(l_u64RingPeek < l_u64Ring);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wrap_and_full);
+    RUN_TEST(test_two_threads);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
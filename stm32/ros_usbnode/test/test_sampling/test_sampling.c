@@ -0,0 +1,302 @@
+/****************************************************************************
+* Title                 :   adc sampling tests
+* Filename              :   test_sampling.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_sampling.c
+ *  \brief host model of the charge current sampled in the middle of the PWM pulse
+ *
+ *  The inductor current is a triangle around its average, rising while the
+ *  charge PWM is high. The ADC2 interrupt of adc.c is fed every 250us with
+ *  the injected result of the last TIM1 trigger, at CCR4 as set by the
+ *  charger, and ADC_input() runs every 10ms. The reference is the previous
+ *  chain : conversions at any phase of the PWM, then the 0.8 IIR of the
+ *  float ADC_input(). Both see the same ADC noise.
+ *  Run with : pio test -d test -f test_sampling
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unity.h>
+
+#include "adc.c"
+#include "charger.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+/* TIM1 counts of one charge PWM period (ARR + 1) */
+#define TEST_PWM_COUNTS (CHARGER_PWM_PERIOD + 1)
+/* ADC2 interrupts between two ADC_input() */
+#define TEST_IRQ_PER_INPUT 40
+#define TEST_STEPS 300
+/* first ADC_input() compared, the filters and sums have settled */
+#define TEST_SETTLED 20
+
+#define TEST_MEAN_CURRENT 1.4
+/* inductor ripple, peak */
+#define TEST_RIPPLE 0.6
+/* ADC noise, peak, in A */
+#define TEST_NOISE 0.02
+/* 80% duty */
+#define TEST_PWM 1120
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+typedef struct
+{
+    double dMean;
+    double dRms;
+    int iT90;       /* ADC_input() calls to 90% of a step, -1 never */
+} test_result_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static uint32_t test_u32Tick;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+void debug_printf(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+void Error_Handler(void)
+{
+    TEST_FAIL_MESSAGE("Error_Handler");
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return test_u32Tick;
+}
+
+void BATTERY_SetFull(void)
+{
+}
+
+static double test_dUniform(void)
+{
+    return (double)rand() / RAND_MAX;
+}
+
+/* inductor current at the phase (0..1) of the PWM period */
+static double test_dInductor(double dMean, double dPhase)
+{
+    double l_dDuty = (double)TIM1->CCR1 / TEST_PWM_COUNTS;
+
+    if (dPhase < l_dDuty)
+    {
+        return dMean - TEST_RIPPLE + 2 * TEST_RIPPLE * dPhase / l_dDuty;
+    }
+    return dMean + TEST_RIPPLE - 2 * TEST_RIPPLE * (dPhase - l_dDuty) / (1 - l_dDuty);
+}
+
+/* ACS712 output (2.5V + 0.12V/A) converted with the ADC noise */
+static uint32_t test_u32Convert(double dCurrent)
+{
+    double l_dNoise = (2 * test_dUniform() - 1) * TEST_NOISE;
+    double l_dCode = (2.5 + (dCurrent + l_dNoise) * 0.12) / 3.3 * 4095;
+
+    return l_dCode < 0 ? 0 : l_dCode > 4095 ? 4095 : (uint32_t)(l_dCode + 0.5);
+}
+
+/*
+ * ADC_input() calls with the current mean given for each call. Synchronous :
+ * the injected conversion at the TIM1 trigger, new filters. Otherwise at any
+ * phase and the previous float filter on the same sums
+ */
+static void test_vRun(const double *pcdMean, bool bSynchronous, double *pdOut)
+{
+    double l_dPrevious = 0;
+    int n;
+    int j;
+
+    for (n = 0; n < TEST_STEPS; n++)
+    {
+        for (j = 0; j < TEST_IRQ_PER_INPUT; j++)
+        {
+            double l_dPhase = bSynchronous ? (double)TIM1->CCR4 / TEST_PWM_COUNTS : test_dUniform();
+
+            ADC2->JDR1 = test_u32Convert(test_dInductor(pcdMean[n], l_dPhase));
+            ADC2->JDR2 = 2000;
+            ADC2->DR = 2000;
+            HAL_ADC_ConvCpltCallback(&ADC2_Handle);
+        }
+        ADC_input();
+        if (bSynchronous)
+        {
+            pdOut[n] = current;
+        }
+        else
+        {
+            /* the previous ADC_input() */
+            double l_dTmp = (((float)adc_u16Current / ADC_FULL_SCALE) * 3.3f - 2.5f) * 100 / 12.0;
+            l_dPrevious = 0.8 * l_dTmp + 0.2 * l_dPrevious;
+            pdOut[n] = l_dPrevious;
+        }
+    }
+}
+
+static void test_vResult(const double *pcdOut, int iStep, double dTarget, test_result_t *psResult)
+{
+    double l_dSum = 0;
+    double l_dSquares = 0;
+    int n;
+
+    for (n = TEST_SETTLED; n < iStep; n++)
+    {
+        l_dSum += pcdOut[n];
+    }
+    psResult->dMean = l_dSum / (iStep - TEST_SETTLED);
+    for (n = TEST_SETTLED; n < iStep; n++)
+    {
+        l_dSquares += (pcdOut[n] - psResult->dMean) * (pcdOut[n] - psResult->dMean);
+    }
+    psResult->dRms = sqrt(l_dSquares / (iStep - TEST_SETTLED));
+    psResult->iT90 = -1;
+    for (n = iStep; n < TEST_STEPS; n++)
+    {
+        if (pcdOut[n] > 0.9 * dTarget)
+        {
+            psResult->iT90 = n - iStep;
+            break;
+        }
+    }
+}
+
+void setUp(void)
+{
+    srand(1);
+    test_u32Tick = 0;
+    ADC2_Init();
+    ADC_input();
+    charge_current_offset.f = 0.0f;
+    charger_SetPwm(TEST_PWM);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+static void test_trigger_in_the_middle_of_the_pulse(void)
+{
+    static const uint16_t l_cau16Pwm[] = {0, 1, 2, 3, 100, 701, CHARGER_PWM_MAX};
+    unsigned k;
+
+    for (k = 0; k < sizeof(l_cau16Pwm) / sizeof(l_cau16Pwm[0]); k++)
+    {
+        charger_SetPwm(l_cau16Pwm[k]);
+        TEST_ASSERT_EQUAL_UINT16(l_cau16Pwm[k], TIM1->CCR1);
+        /* never 0 : the trigger keeps running with the PWM off */
+        TEST_ASSERT_TRUE(TIM1->CCR4 >= 1);
+        TEST_ASSERT_TRUE(TIM1->CCR4 <= l_cau16Pwm[k] / 2 + 1);
+        if (l_cau16Pwm[k] > 2)
+        {
+            TEST_ASSERT_EQUAL_UINT16(l_cau16Pwm[k] / 2, TIM1->CCR4);
+        }
+    }
+    /* at half the pulse the inductor current is its average */
+    charger_SetPwm(TEST_PWM);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1.0, test_dInductor(1.0, (double)TIM1->CCR4 / TEST_PWM_COUNTS));
+}
+
+static void test_sums_published(void)
+{
+    static const uint16_t l_cau16Regular[ADC2_REGULAR_CHANNELS] = {100, 200, 300};
+    int n;
+
+    ADC2->JDR1 = 10;
+    ADC2->JDR2 = 20;
+    for (n = 0; n < ADC_OVERSAMPLING * ADC2_REGULAR_CHANNELS; n++)
+    {
+        ADC2->DR = l_cau16Regular[n % ADC2_REGULAR_CHANNELS];
+        HAL_ADC_ConvCpltCallback(&ADC2_Handle);
+        if (n == ADC_OVERSAMPLING - 1)
+        {
+            /* injected pair every interrupt : published first */
+            TEST_ASSERT_EQUAL_UINT16(10 * ADC_OVERSAMPLING, adc_u16Current);
+            TEST_ASSERT_EQUAL_UINT16(20 * ADC_OVERSAMPLING, adc_u16ChargerVoltage);
+            TEST_ASSERT_EQUAL_UINT16(0, adc_u16BatteryVoltage);
+        }
+    }
+    /* regular sequence NTC, battery, charger input, one per interrupt */
+    TEST_ASSERT_EQUAL_UINT16(100 * ADC_OVERSAMPLING, adc_u16Input_NTC);
+    TEST_ASSERT_EQUAL_UINT16(200 * ADC_OVERSAMPLING, adc_u16BatteryVoltage);
+    TEST_ASSERT_EQUAL_UINT16(300 * ADC_OVERSAMPLING, adc_u16ChargerInputVoltage);
+
+    /* a full scale sum still fits */
+    ADC2->JDR1 = 4095;
+    for (n = 0; n < ADC_OVERSAMPLING; n++)
+    {
+        HAL_ADC_ConvCpltCallback(&ADC2_Handle);
+    }
+    TEST_ASSERT_EQUAL_UINT16(4095 * ADC_OVERSAMPLING, adc_u16Current);
+}
+
+/* same mean, the ripple no longer in the value, less lag after a step */
+static void test_ripple_and_lag(void)
+{
+    static double l_adMean[TEST_STEPS];
+    static double l_adOut[TEST_STEPS];
+    const int l_iStep = TEST_STEPS / 2;
+    test_result_t l_sFree;
+    test_result_t l_sSynchronous;
+    char l_acMessage[128];
+    int n;
+
+    for (n = 0; n < TEST_STEPS; n++)
+    {
+        l_adMean[n] = n < l_iStep ? TEST_MEAN_CURRENT : 2 * TEST_MEAN_CURRENT;
+    }
+    test_vRun(l_adMean, false, l_adOut);
+    for (n = 0; n < TEST_STEPS; n++)
+    {
+        l_adOut[n] -= TEST_MEAN_CURRENT;
+    }
+    test_vResult(l_adOut, l_iStep, TEST_MEAN_CURRENT, &l_sFree);
+
+    setUp();
+    test_vRun(l_adMean, true, l_adOut);
+    for (n = 0; n < TEST_STEPS; n++)
+    {
+        l_adOut[n] -= TEST_MEAN_CURRENT;
+    }
+    test_vResult(l_adOut, l_iStep, TEST_MEAN_CURRENT, &l_sSynchronous);
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "any phase : %+.1f mA, %.1f mA rms, 90%% after %d calls ; mid pulse : %+.1f mA, %.1f mA rms, %d calls",
+             l_sFree.dMean * 1000, l_sFree.dRms * 1000, l_sFree.iT90,
+             l_sSynchronous.dMean * 1000, l_sSynchronous.dRms * 1000, l_sSynchronous.iT90);
+    TEST_MESSAGE(l_acMessage);
+
+    /* both measure the average, within the 1/4095 steps */
+    TEST_ASSERT_FLOAT_WITHIN(0.030, 0.0, l_sFree.dMean);
+    TEST_ASSERT_FLOAT_WITHIN(0.010, 0.0, l_sSynchronous.dMean);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.010, l_sSynchronous.dRms);
+    TEST_ASSERT_LESS_THAN_FLOAT(l_sFree.dRms / 5, l_sSynchronous.dRms);
+    TEST_ASSERT_TRUE(l_sSynchronous.iT90 >= 0);
+    TEST_ASSERT_TRUE(l_sSynchronous.iT90 < l_sFree.iT90);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_trigger_in_the_middle_of_the_pulse);
+    RUN_TEST(test_sums_published);
+    RUN_TEST(test_ripple_and_lag);
+    return UNITY_END();
+}
@@ -0,0 +1,323 @@
+/****************************************************************************
+* Title                 :   speed loop tests
+* Filename              :   test_speed.c
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_speed.c
+ *  \brief host model of a drive wheel under the speed loop, default gains
+ *
+ *  The PAC5210 and the mower are a first order model : the wheel speed goes
+ *  towards gain * PWM / PWM_PER_MPS - load with the time constant of the
+ *  motor and the mower mass. The gain is the battery and the motor against
+ *  the PWM_PER_MPS map, the load the slope or the grass. The target goes
+ *  through the wheel ramp, the wheel turns the PWM of the request until the
+ *  reply, the reply carries the whole ticks travelled, and SPEED_Update()
+ *  runs on it with the reply jitter, as DRIVEMOTOR_App_Rx() does. The
+ *  reference is the open loop : the same model with the PWM_PER_MPS map only.
+ *  Run with : pio test -d test -f test_speed
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "drivemotor.h"
+#include "ramp.c"
+#include "speed.c"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_REPLY_US (1000000U / DRIVEMOTOR_POLL_HZ)
+/* reply period jitter, +/- */
+#define TEST_JITTER_US 1000U
+/* model integration step */
+#define TEST_STEP_US 500U
+/* time constant of the wheel with the mower on it */
+#define TEST_TAU_S 0.15
+/* speed within this of the target : settled */
+#define TEST_BAND 0.03
+/* averaging of the true speed for the settling, a tick is ~0.17 m/s per reply */
+#define TEST_AVERAGE_REPLIES 10
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+typedef struct
+{
+    double dGain;           /* speed per PWM against the PWM_PER_MPS map */
+    double dLoad;           /* m/s lost to the load */
+    double dSpeed;          /* m/s */
+    double dDistance;       /* m, the ticks are its whole part */
+    uint32_t u32Ticks;
+    uint8_t u8Pwm;          /* of the last request */
+    uint8_t u8Dir;
+} TEST_Motor_t;
+
+typedef struct
+{
+    double dSettleS;        /* average within TEST_BAND for good, -1 never */
+    double dError;          /* average speed error over the last second */
+    double dPeak;           /* highest average speed */
+} TEST_Result_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+static const SPEED_Gains_t test_csDefault = {DRIVEMOTOR_KP, DRIVEMOTOR_KI, DRIVEMOTOR_KD};
+static const SPEED_Gains_t test_csOpenLoop = {0.0f, 0.0f, 0.0f};
+
+static SPEED_Wheel_t test_sWheel;
+static TEST_Motor_t test_sMotor;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+/* one reply period of the model, the ticks travelled during it */
+static uint32_t test_u32Motor(TEST_Motor_t *psMotor, uint32_t u32DtUs)
+{
+    uint32_t l_u32Prev = psMotor->u32Ticks;
+    uint32_t t;
+
+    for (t = 0; t < u32DtUs; t += TEST_STEP_US)
+    {
+        double l_dDrive = psMotor->dGain * psMotor->u8Pwm / PWM_PER_MPS;
+        double l_dTarget = l_dDrive > psMotor->dLoad ? l_dDrive - psMotor->dLoad : 0.0;
+
+        psMotor->dSpeed += (l_dTarget - psMotor->dSpeed) * (TEST_STEP_US * 1e-6) / TEST_TAU_S;
+        psMotor->dDistance += psMotor->dSpeed * TEST_STEP_US * 1e-6;
+    }
+    psMotor->u32Ticks = (uint32_t)(psMotor->dDistance * TICKS_PER_M);
+    return psMotor->u32Ticks - l_u32Prev;
+}
+
+/*
+ * u32Replies replies with the wheel asked for u8Speed forward, the load
+ * changed to dLoad after u32LoadAt replies. Settling counted from the start,
+ * or from the load change if any
+ */
+static void test_run(const SPEED_Gains_t *pcsGains, uint8_t u8Speed, uint32_t u32Replies, uint32_t u32LoadAt, double dLoad, TEST_Result_t *psResult)
+{
+    double l_adSpeed[TEST_AVERAGE_REPLIES] = {0};
+    double l_dTarget = u8Speed / PWM_PER_MPS;
+    double l_dErrorSum = 0.0;
+    uint32_t l_u32ErrorReplies = 0;
+    uint32_t l_u32From = u32LoadAt < u32Replies ? u32LoadAt : 0;
+    double l_dTime = 0.0;
+    RAMP_State_t l_sRamp;
+    uint8_t l_u8Out = (uint8_t)(test_sWheel.fTarget * PWM_PER_MPS + 0.5f);
+    uint32_t n;
+
+    psResult->dSettleS = -1.0;
+    psResult->dPeak = 0.0;
+    RAMP_Reset(&l_sRamp, test_sWheel.fTarget);
+    for (n = 0; n < u32Replies; n++)
+    {
+        uint32_t l_u32DtUs = TEST_REPLY_US - TEST_JITTER_US + (uint32_t)(rand() % (2 * TEST_JITTER_US + 1));
+        double l_dAverage = 0.0;
+        uint32_t l_u32Ticks;
+        int k;
+
+        if (n == u32LoadAt)
+        {
+            test_sMotor.dLoad = dLoad;
+        }
+        /* the ramp of drivemotor_ramp(), one step per request, as drivemotor_setOutput() */
+        RAMP_fUpdate(&l_sRamp, (float)l_dTarget, DRIVEMOTOR_ACC_MAX, DRIVEMOTOR_JERK_MAX, l_u32DtUs * 1e-6f);
+        if ((uint8_t)(l_sRamp.fVel * PWM_PER_MPS + 0.5f) != l_u8Out)
+        {
+            l_u8Out = (uint8_t)(l_sRamp.fVel * PWM_PER_MPS + 0.5f);
+            SPEED_Setpoint(&test_sWheel, l_u8Out, 1);
+        }
+        test_sMotor.u8Pwm = test_sWheel.u8Pwm;
+        test_sMotor.u8Dir = test_sWheel.u8Dir;
+        l_u32Ticks = test_u32Motor(&test_sMotor, l_u32DtUs);
+        SPEED_Update(&test_sWheel, pcsGains, l_u8Out, 1, l_u32Ticks, 1, l_u32DtUs);
+        l_dTime += l_u32DtUs * 1e-6;
+
+        l_adSpeed[n % TEST_AVERAGE_REPLIES] = test_sMotor.dSpeed;
+        for (k = 0; k < TEST_AVERAGE_REPLIES; k++)
+        {
+            l_dAverage += l_adSpeed[k] / TEST_AVERAGE_REPLIES;
+        }
+        if (n >= l_u32From + TEST_AVERAGE_REPLIES)
+        {
+            psResult->dPeak = fmax(psResult->dPeak, l_dAverage);
+        }
+        if (n >= l_u32From && fabs(l_dAverage - l_dTarget) > TEST_BAND * l_dTarget)
+        {
+            psResult->dSettleS = -1.0;
+        }
+        else if (n >= l_u32From && psResult->dSettleS < 0.0)
+        {
+            psResult->dSettleS = l_dTime - l_u32From * TEST_REPLY_US * 1e-6;
+        }
+        if (n + DRIVEMOTOR_POLL_HZ >= u32Replies)
+        {
+            l_dErrorSum += l_dTarget - test_sMotor.dSpeed;
+            l_u32ErrorReplies++;
+        }
+    }
+    psResult->dError = l_dErrorSum / l_u32ErrorReplies;
+}
+
+static void test_message(const char *pcName, const TEST_Result_t *pcsOpen, const TEST_Result_t *pcsClosed)
+{
+    char l_acMessage[160];
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "%s : open loop error %+.3f m/s ; closed loop error %+.3f m/s, settled after %.2f s, peak %.3f m/s",
+             pcName, pcsOpen->dError, pcsClosed->dError, pcsClosed->dSettleS, pcsClosed->dPeak);
+    TEST_MESSAGE(l_acMessage);
+}
+
+static void test_reset(double dGain, double dLoad)
+{
+    memset(&test_sWheel, 0, sizeof(test_sWheel));
+    memset(&test_sMotor, 0, sizeof(test_sMotor));
+    test_sMotor.dGain = dGain;
+    test_sMotor.dLoad = dLoad;
+}
+
+void setUp(void)
+{
+    srand(1);
+    test_reset(1.0, 0.0);
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+/* the map is right : nothing for the loop to do, the lag of the wheel behind
+   the ramp winds the integral a little */
+static void test_nominal(void)
+{
+    TEST_Result_t l_sOpen;
+    TEST_Result_t l_sClosed;
+
+    test_run(&test_csOpenLoop, 60, 5 * DRIVEMOTOR_POLL_HZ, UINT32_MAX, 0.0, &l_sOpen);
+    setUp();
+    test_run(&test_csDefault, 60, 5 * DRIVEMOTOR_POLL_HZ, UINT32_MAX, 0.0, &l_sClosed);
+    test_message("nominal 0.2 m/s", &l_sOpen, &l_sClosed);
+
+    TEST_ASSERT_TRUE(l_sClosed.dSettleS >= 0.0);
+    TEST_ASSERT_LESS_THAN_FLOAT(3.0, l_sClosed.dSettleS);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 0.0, l_sClosed.dError);
+    TEST_ASSERT_LESS_THAN_FLOAT(0.2 * 1.1, l_sClosed.dPeak);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sWheel.u32Saturated);
+}
+
+/* low battery and grass : the open loop is 25% slow, the loop settles on the
+   target. 0.1 m/s is 0.6 tick per reply, the slowest */
+static void test_weak_motor(void)
+{
+    static const uint8_t l_cau8Speed[] = {30, 60, 90};
+    unsigned k;
+
+    for (k = 0; k < sizeof(l_cau8Speed) / sizeof(l_cau8Speed[0]); k++)
+    {
+        TEST_Result_t l_sOpen;
+        TEST_Result_t l_sClosed;
+        char l_acName[32];
+
+        test_reset(0.85, 0.02);
+        test_run(&test_csOpenLoop, l_cau8Speed[k], 8 * DRIVEMOTOR_POLL_HZ, UINT32_MAX, 0.02, &l_sOpen);
+        test_reset(0.85, 0.02);
+        test_run(&test_csDefault, l_cau8Speed[k], 8 * DRIVEMOTOR_POLL_HZ, UINT32_MAX, 0.02, &l_sClosed);
+        snprintf(l_acName, sizeof(l_acName), "weak %.1f m/s", l_cau8Speed[k] / PWM_PER_MPS);
+        test_message(l_acName, &l_sOpen, &l_sClosed);
+
+        TEST_ASSERT_TRUE(l_sOpen.dError > 0.1 * l_cau8Speed[k] / PWM_PER_MPS);
+        TEST_ASSERT_TRUE(l_sClosed.dSettleS >= 0.0);
+        TEST_ASSERT_LESS_THAN_FLOAT(6.0, l_sClosed.dSettleS);
+        TEST_ASSERT_FLOAT_WITHIN(TEST_BAND * l_cau8Speed[k] / PWM_PER_MPS, 0.0, l_sClosed.dError);
+    }
+}
+
+/* up a slope at full speed, the wheel comes back to speed. The integral time
+   Kp / Ki is 0.5s, the slowest part of the loop */
+static void test_load_step(void)
+{
+    TEST_Result_t l_sOpen;
+    TEST_Result_t l_sClosed;
+
+    test_run(&test_csOpenLoop, 90, 8 * DRIVEMOTOR_POLL_HZ, 3 * DRIVEMOTOR_POLL_HZ, 0.08, &l_sOpen);
+    setUp();
+    test_run(&test_csDefault, 90, 8 * DRIVEMOTOR_POLL_HZ, 3 * DRIVEMOTOR_POLL_HZ, 0.08, &l_sClosed);
+    test_message("slope 0.3 m/s", &l_sOpen, &l_sClosed);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.08, l_sOpen.dError);
+    TEST_ASSERT_TRUE(l_sClosed.dSettleS >= 0.0);
+    TEST_ASSERT_LESS_THAN_FLOAT(4.5, l_sClosed.dSettleS);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_BAND * 0.3, 0.0, l_sClosed.dError);
+}
+
+/* wheel held, then released : the integral stays within its limit, a bounded overshoot */
+static void test_stall_release(void)
+{
+    TEST_Result_t l_sClosed;
+    char l_acMessage[96];
+
+    test_reset(1.0, 1.0);
+    test_run(&test_csDefault, 90, 2 * DRIVEMOTOR_POLL_HZ, UINT32_MAX, 1.0, &l_sClosed);
+    TEST_ASSERT_EQUAL_FLOAT(SPEED_I_LIMIT, test_sWheel.fIntegral);
+    TEST_ASSERT_EQUAL_UINT8(90 + (uint8_t)(DRIVEMOTOR_KP * 0.3f + SPEED_I_LIMIT + 0.5f), test_sWheel.u8Pwm);
+
+    test_run(&test_csDefault, 90, 5 * DRIVEMOTOR_POLL_HZ, 0, 0.0, &l_sClosed);
+    snprintf(l_acMessage, sizeof(l_acMessage), "released : settled after %.2f s, peak %.3f m/s, error %+.3f m/s",
+             l_sClosed.dSettleS, l_sClosed.dPeak, l_sClosed.dError);
+    TEST_MESSAGE(l_acMessage);
+    TEST_ASSERT_TRUE(l_sClosed.dSettleS >= 0.0);
+    TEST_ASSERT_LESS_THAN_FLOAT(5.0, l_sClosed.dSettleS);
+    /* at most the integral limit above the target */
+    TEST_ASSERT_LESS_THAN_FLOAT(0.3 + SPEED_I_LIMIT / PWM_PER_MPS, l_sClosed.dPeak);
+    TEST_ASSERT_FLOAT_WITHIN(TEST_BAND * 0.3, 0.0, l_sClosed.dError);
+}
+
+/* the statistics of DRIVEMOTOR_GetTracking() */
+static void test_tracking(void)
+{
+    TEST_Result_t l_sClosed;
+    float l_fRms;
+
+    test_reset(0.85, 0.02);
+    test_run(&test_csDefault, 60, 5 * DRIVEMOTOR_POLL_HZ, UINT32_MAX, 0.02, &l_sClosed);
+    l_fRms = sqrtf(test_sWheel.fSumSqError / test_sWheel.u32Samples);
+    /* every reply but the first, the ramp still at 0 */
+    TEST_ASSERT_EQUAL_UINT32(5 * DRIVEMOTOR_POLL_HZ - 1, test_sWheel.u32Samples);
+    TEST_ASSERT_TRUE(l_fRms > 0.0f);
+    TEST_ASSERT_TRUE(test_sWheel.fMaxError >= l_fRms);
+    TEST_ASSERT_TRUE(test_sWheel.fMaxError < 0.2f);
+
+    SPEED_ResetTracking(&test_sWheel);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sWheel.u32Samples);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, test_sWheel.fMaxError);
+
+    /* a stop is not a sample and drops the integral */
+    SPEED_Update(&test_sWheel, &test_csDefault, 0, 0, 1, 1, TEST_REPLY_US);
+    TEST_ASSERT_EQUAL_UINT32(0, test_sWheel.u32Samples);
+    TEST_ASSERT_EQUAL_UINT8(0, test_sWheel.u8Pwm);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, test_sWheel.fIntegral);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nominal);
+    RUN_TEST(test_weak_motor);
+    RUN_TEST(test_load_step);
+    RUN_TEST(test_stall_release);
+    RUN_TEST(test_tracking);
+    return UNITY_END();
+}
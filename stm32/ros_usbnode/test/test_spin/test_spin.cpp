@@ -0,0 +1,459 @@
+/****************************************************************************
+* Title                 :   rosserial receive benchmark
+* Filename              :   test_spin.cpp
+* Author                :   Nekraus
+* Origin Date           :   17/10/2026
+* Version               :   1.0.0
+
+*****************************************************************************/
+/** \file test_spin.cpp
+ *  \brief host benchmark of NodeHandle_::spinOnce() on bursty host traffic
+ *
+ *  The stream is what the host sends to the node : cmd_vel at 10 Hz,
+ *  mower_logic/current_state at 2 Hz, time sync replies, the parameter
+ *  replies at connection, a corrupted frame and some noise. It arrives in
+ *  bursts of 64 byte USB packets put in the 1024 byte rb ring buffer as
+ *  CDC_Receive_FS() does, and the main loop spins once per burst.
+ *  spinOnce() parses the contiguous spans of the ring and hands the frames
+ *  out in place. The reference is the byte wise path : read() and the mode_
+ *  state machine for every byte, the former spinOnce(). Both must deliver
+ *  the same messages. Reported : bytes/s on the mix and CPU cycles per
+ *  cmd_vel frame, of the host (TSC) so only the ratio carries over to the
+ *  F103.
+ *  A capture of the bytes the host sent can be replayed instead of the
+ *  generated mix :
+ *    SPIN_CAPTURE=capture.bin pio test -d test -f test_spin
+ *  Run with : pio test -d test -f test_spin
+ */
+/******************************************************************************
+ * Includes
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <unity.h>
+
+#include "ros/ros_custom/ringbuffer.cpp"
+#include "ros/node_handle.h"
+#include "time.cpp"
+#include "duration.cpp"
+#include "geometry_msgs/Twist.h"
+#include "mower_msgs/HighLevelStatus.h"
+
+/******************************************************************************
+ * Module Preprocessor Constants
+ *******************************************************************************/
+#define TEST_USB_PACKET 64
+/* USB packets per burst, at most */
+#define TEST_BURST_PACKETS 8
+#define TEST_STREAM_SIZE (256 * 1024)
+/* seconds of generated traffic */
+#define TEST_SECONDS 60
+/* runs of the benchmark, the fastest is kept */
+#define TEST_RUNS 5
+
+#define TEST_TOPIC_CMD_VEL 100
+#define TEST_TOPIC_STATE 101
+
+/******************************************************************************
+ * Module Typedefs
+ *******************************************************************************/
+/* STM32Hardware on the rb ring buffer, the output is thrown away */
+class TEST_Hardware
+{
+public:
+    void init()
+    {
+    }
+
+    int read()
+    {
+        uint8_t ch;
+
+        if (ringbuffer_getchar(&rb, &ch) == 1)
+            return ch;
+        return -1;
+    }
+
+    int peek(uint8_t **data)
+    {
+        return ringbuffer_peek_contiguous(&rb, data);
+    }
+
+    void consume(int length)
+    {
+        ringbuffer_consume(&rb, length);
+    }
+
+    void write(uint8_t *data, int length)
+    {
+        (void)data;
+        (void)length;
+    }
+
+    uint8_t *reserve(int length)
+    {
+        return length <= (int)sizeof(au8Out) ? au8Out : nullptr;
+    }
+
+    void commit(int length)
+    {
+        (void)length;
+    }
+
+    void dropped()
+    {
+    }
+
+    unsigned long time(void)
+    {
+        return u32Tick;
+    }
+
+    static struct ringbuffer rb;
+    static uint32_t u32Tick;
+
+private:
+    uint8_t au8Out[1024];
+};
+
+/* the byte wise path next to spinOnce() */
+class TEST_NodeHandle : public ros::NodeHandle_<TEST_Hardware>
+{
+public:
+    int spinBytes()
+    {
+        uint32_t c_time = hardware_.time();
+        int data;
+
+        if (mode_ != ros::MODE_FIRST_FF && c_time > last_msg_timeout_time)
+            mode_ = ros::MODE_FIRST_FF;
+        while ((data = hardware_.read()) >= 0)
+        {
+            if (parseByte(data, c_time) == ros::SPIN_ERR)
+                return ros::SPIN_ERR;
+        }
+        return ros::SPIN_OK;
+    }
+};
+
+typedef struct
+{
+    uint32_t u32CmdVel;
+    double dLinearSum;          /* the content, not only the count */
+    uint32_t u32State;
+    uint32_t u32StateSum;
+} TEST_Received_t;
+
+typedef struct
+{
+    double dSeconds;
+    uint64_t u64Cycles;
+} TEST_Time_t;
+
+/******************************************************************************
+ * Module Variable Definitions
+ *******************************************************************************/
+struct ringbuffer TEST_Hardware::rb;
+uint32_t TEST_Hardware::u32Tick;
+
+static uint8_t test_au8Pool[RxBufferSize];
+static uint8_t test_au8Stream[TEST_STREAM_SIZE];
+static uint32_t test_u32StreamLen;
+static uint8_t test_au8CmdVel[TEST_STREAM_SIZE];
+static uint32_t test_u32CmdVelLen;
+static uint32_t test_u32CmdVelFrames;
+static TEST_Received_t test_sReceived;
+
+/******************************************************************************
+ * Helpers
+ *******************************************************************************/
+
+static void test_cmdVel(const geometry_msgs::Twist &msg)
+{
+    test_sReceived.u32CmdVel++;
+    test_sReceived.dLinearSum += msg.linear.x + msg.angular.z;
+}
+
+static void test_state(const mower_msgs::HighLevelStatus &msg)
+{
+    test_sReceived.u32State++;
+    test_sReceived.u32StateSum += msg.state + msg.battery_percent;
+}
+
+static ros::Subscriber<geometry_msgs::Twist> test_subCmdVel("cmd_vel", test_cmdVel);
+static ros::Subscriber<mower_msgs::HighLevelStatus> test_subState("mower_logic/current_state", test_state);
+static TEST_NodeHandle test_nh;
+
+static uint64_t test_u64Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec l_sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+    return (uint64_t)l_sNow.tv_sec * 1000000000U + l_sNow.tv_nsec;
+#endif
+}
+
+static double test_dSeconds(void)
+{
+    struct timespec l_sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+    return l_sNow.tv_sec + l_sNow.tv_nsec * 1e-9;
+}
+
+/* rosserial frame of a message, as the host writes it */
+static uint32_t test_u32Frame(uint8_t *pu8Out, uint16_t u16Topic, const ros::Msg &msg)
+{
+    int l_iLength = msg.serialize(pu8Out + 7);
+    int l_iChecksum = 0;
+    int i;
+
+    pu8Out[0] = 0xff;
+    pu8Out[1] = ros::PROTOCOL_VER;
+    pu8Out[2] = l_iLength & 0xff;
+    pu8Out[3] = l_iLength >> 8;
+    pu8Out[4] = 255 - ((pu8Out[2] + pu8Out[3]) % 256);
+    pu8Out[5] = u16Topic & 0xff;
+    pu8Out[6] = u16Topic >> 8;
+    for (i = 5; i < l_iLength + 7; i++)
+    {
+        l_iChecksum += pu8Out[i];
+    }
+    pu8Out[l_iLength + 7] = 255 - (l_iChecksum % 256);
+    return l_iLength + 8;
+}
+
+static uint32_t test_u32CmdVelFrame(uint8_t *pu8Out, uint32_t u32N)
+{
+    geometry_msgs::Twist l_sTwist;
+
+    l_sTwist.linear.x = 0.01 * (u32N % 30);
+    l_sTwist.angular.z = -0.02 * (u32N % 17);
+    return test_u32Frame(pu8Out, TEST_TOPIC_CMD_VEL, l_sTwist);
+}
+
+/* the generated mix, TEST_SECONDS of it */
+static void test_generate(void)
+{
+    static char l_acName[] = "MOWING";
+    static char l_acSubName[] = "AREA_RECORDING";
+    static int32_t l_ai32Ints[4] = {1, 2, 3, 4};
+    static float l_afFloats[6] = {0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f};
+    mower_msgs::HighLevelStatus l_sState;
+    rosserial_msgs::RequestParamResponse l_sParam;
+    std_msgs::Time l_sTime;
+    uint32_t l_u32Len = 0;
+    uint32_t l_u32Ms;
+    int i;
+
+    l_sState.state_name = l_acName;
+    l_sState.sub_state_name = l_acSubName;
+    l_sParam.ints_length = 4;
+    l_sParam.ints = l_ai32Ints;
+    l_sParam.floats_length = 6;
+    l_sParam.floats = l_afFloats;
+
+    /* the parameters asked at connection */
+    for (i = 0; i < 12; i++)
+    {
+        l_u32Len += test_u32Frame(&test_au8Stream[l_u32Len], rosserial_msgs::TopicInfo::ID_PARAMETER_REQUEST, l_sParam);
+    }
+    test_u32CmdVelFrames = 0;
+    for (l_u32Ms = 0; l_u32Ms < TEST_SECONDS * 1000; l_u32Ms += 100)
+    {
+        l_u32Len += test_u32CmdVelFrame(&test_au8Stream[l_u32Len], test_u32CmdVelFrames++);
+        if (l_u32Ms % 500 == 0)
+        {
+            l_sState.state = (l_u32Ms / 500) % 4;
+            l_sState.battery_percent = (l_u32Ms / 1000) % 100;
+            l_u32Len += test_u32Frame(&test_au8Stream[l_u32Len], TEST_TOPIC_STATE, l_sState);
+        }
+        if (l_u32Ms % 2500 == 0)
+        {
+            l_sTime.data.sec = l_u32Ms / 1000;
+            l_u32Len += test_u32Frame(&test_au8Stream[l_u32Len], rosserial_msgs::TopicInfo::ID_TIME, l_sTime);
+        }
+        if (l_u32Ms % 10000 == 5000)
+        {
+            /* line noise, then a frame with a bad checksum */
+            memcpy(&test_au8Stream[l_u32Len], "\x00\x13\xfe\xff\x01", 5);
+            l_u32Len += 5;
+            i = test_u32CmdVelFrame(&test_au8Stream[l_u32Len], 0);
+            test_au8Stream[l_u32Len + i - 1] ^= 0x55;
+            l_u32Len += i;
+        }
+    }
+    test_u32StreamLen = l_u32Len;
+}
+
+/* the same number of cmd_vel frames alone, for the cost of one */
+static void test_generateCmdVel(void)
+{
+    uint32_t l_u32Len = 0;
+    uint32_t n;
+
+    for (n = 0; n < test_u32CmdVelFrames; n++)
+    {
+        l_u32Len += test_u32CmdVelFrame(&test_au8CmdVel[l_u32Len], n);
+    }
+    test_u32CmdVelLen = l_u32Len;
+}
+
+static bool test_bLoad(const char *pcPath)
+{
+    FILE *l_pFile = fopen(pcPath, "rb");
+
+    if (l_pFile == NULL)
+    {
+        return false;
+    }
+    test_u32StreamLen = fread(test_au8Stream, 1, sizeof(test_au8Stream), l_pFile);
+    fclose(l_pFile);
+    return true;
+}
+
+/* the stream in bursts through rb, one spin per burst, the time of the spins only */
+static void test_run(const uint8_t *pcu8Stream, uint32_t u32Len, bool bSpan, TEST_Time_t *psTime)
+{
+    uint32_t l_u32Pos = 0;
+
+    memset(&test_sReceived, 0, sizeof(test_sReceived));
+    ringbuffer_init(&TEST_Hardware::rb, test_au8Pool, sizeof(test_au8Pool));
+    TEST_Hardware::u32Tick = 0;
+    psTime->dSeconds = 0.0;
+    psTime->u64Cycles = 0;
+    srand(1);
+    while (l_u32Pos < u32Len)
+    {
+        uint32_t l_u32Packets = 1 + rand() % TEST_BURST_PACKETS;
+        uint32_t l_u32Packet;
+        double l_dStart;
+        uint64_t l_u64Start;
+
+        for (l_u32Packet = 0; l_u32Packet < l_u32Packets && l_u32Pos < u32Len; l_u32Packet++)
+        {
+            uint32_t l_u32Size = u32Len - l_u32Pos < TEST_USB_PACKET ? u32Len - l_u32Pos : TEST_USB_PACKET;
+
+            ringbuffer_put(&TEST_Hardware::rb, &pcu8Stream[l_u32Pos], l_u32Size);
+            l_u32Pos += l_u32Size;
+        }
+        l_dStart = test_dSeconds();
+        l_u64Start = test_u64Cycles();
+        if (bSpan)
+        {
+            test_nh.spinOnce();
+        }
+        else
+        {
+            test_nh.spinBytes();
+        }
+        psTime->u64Cycles += test_u64Cycles() - l_u64Start;
+        psTime->dSeconds += test_dSeconds() - l_dStart;
+        TEST_Hardware::u32Tick++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, TEST_Hardware::rb.dropped);
+}
+
+static void test_best(const uint8_t *pcu8Stream, uint32_t u32Len, bool bSpan, TEST_Time_t *psBest)
+{
+    TEST_Time_t l_sTime;
+    int i;
+
+    for (i = 0; i < TEST_RUNS; i++)
+    {
+        test_run(pcu8Stream, u32Len, bSpan, &l_sTime);
+        if (i == 0 || l_sTime.u64Cycles < psBest->u64Cycles)
+        {
+            *psBest = l_sTime;
+        }
+    }
+}
+
+void setUp(void)
+{
+    TEST_Hardware::u32Tick = 0;
+}
+
+void tearDown(void)
+{
+}
+
+/******************************************************************************
+ * Tests
+ *******************************************************************************/
+
+/* same messages from both paths, frames wrapping in rb included */
+static void test_same_messages(void)
+{
+    TEST_Received_t l_sBytes;
+    TEST_Time_t l_sTime;
+
+    test_run(test_au8Stream, test_u32StreamLen, false, &l_sTime);
+    l_sBytes = test_sReceived;
+    test_run(test_au8Stream, test_u32StreamLen, true, &l_sTime);
+
+    TEST_ASSERT_EQUAL_UINT32(l_sBytes.u32CmdVel, test_sReceived.u32CmdVel);
+    TEST_ASSERT_EQUAL_UINT32(l_sBytes.u32State, test_sReceived.u32State);
+    TEST_ASSERT_EQUAL_UINT32(l_sBytes.u32StateSum, test_sReceived.u32StateSum);
+    TEST_ASSERT_TRUE(l_sBytes.dLinearSum == test_sReceived.dLinearSum);
+    if (getenv("SPIN_CAPTURE") == NULL)
+    {
+        /* the corrupted ones are dropped */
+        TEST_ASSERT_EQUAL_UINT32(test_u32CmdVelFrames, test_sReceived.u32CmdVel);
+        TEST_ASSERT_EQUAL_UINT32(TEST_SECONDS * 2, test_sReceived.u32State);
+    }
+}
+
+static void test_benchmark(void)
+{
+    TEST_Time_t l_sBytes;
+    TEST_Time_t l_sSpan;
+    TEST_Time_t l_sCmdBytes;
+    TEST_Time_t l_sCmdSpan;
+    char l_acMessage[160];
+
+    test_best(test_au8Stream, test_u32StreamLen, false, &l_sBytes);
+    test_best(test_au8Stream, test_u32StreamLen, true, &l_sSpan);
+    test_best(test_au8CmdVel, test_u32CmdVelLen, false, &l_sCmdBytes);
+    test_best(test_au8CmdVel, test_u32CmdVelLen, true, &l_sCmdSpan);
+
+    snprintf(l_acMessage, sizeof(l_acMessage), "mix of %u bytes : byte wise %.1f MB/s, spans %.1f MB/s",
+             (unsigned)test_u32StreamLen, test_u32StreamLen / l_sBytes.dSeconds / 1e6, test_u32StreamLen / l_sSpan.dSeconds / 1e6);
+    TEST_MESSAGE(l_acMessage);
+    snprintf(l_acMessage, sizeof(l_acMessage), "cmd_vel frame (%u bytes) : byte wise %.0f cycles, spans %.0f cycles",
+             (unsigned)(test_u32CmdVelLen / test_u32CmdVelFrames),
+             (double)l_sCmdBytes.u64Cycles / test_u32CmdVelFrames, (double)l_sCmdSpan.u64Cycles / test_u32CmdVelFrames);
+    TEST_MESSAGE(l_acMessage);
+
+    TEST_ASSERT_TRUE(l_sSpan.u64Cycles < l_sBytes.u64Cycles);
+    TEST_ASSERT_TRUE(l_sCmdSpan.u64Cycles < l_sCmdBytes.u64Cycles);
+}
+
+int main(void)
+{
+    const char *l_pcCapture = getenv("SPIN_CAPTURE");
+
+    test_nh.initNode();
+    test_nh.subscribe(test_subCmdVel);
+    test_nh.subscribe(test_subState);
+    test_generate();
+    test_generateCmdVel();
+    if (l_pcCapture != NULL && !test_bLoad(l_pcCapture))
+    {
+        printf("cannot read %s\n", l_pcCapture);
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_same_messages);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}